@@ -22,6 +22,7 @@
 #include "app/controller.h"
 #include "app/input.h"
 #include "app/pathman.h"
+#include "app/replay.h"
 #include "app/system.h"
 
 #include "common/config_file.h"
@@ -52,6 +53,8 @@
 #include <SDL.h>
 #include <SDL_image.h>
 
+#include <cmath>
+#include <ctime>
 #include <stdlib.h>
 #include <libintl.h>
 #include <getopt.h>
@@ -126,6 +129,10 @@ CApplication::CApplication(CSystemUtils* systemUtils)
 
     m_simulationSpeed = 1.0f;
 
+    m_fixedStepLength = 0LL;
+    m_simulationLag = 0LL;
+    m_simulationStepCount = 0LL;
+
     m_realAbsTimeBase = 0LL;
     m_realAbsTime = 0LL;
     m_realRelTime = 0LL;
@@ -159,6 +166,14 @@ CApplication::CApplication(CSystemUtils* systemUtils)
 
     m_sceneTest = false;
     m_headless = false;
+    m_batchMode = false;
+    m_batchTimeLimit = 0.0f;
+
+    m_replaySeed = 0;
+    m_replayChecksumInterval = 60;
+    m_replaySpeed = 1.0f;
+    m_replayDiverged = false;
+    m_pathSearchBudget = 1000;
     m_resolutionOverride = false;
 
     m_language = LANGUAGE_ENV;
@@ -249,7 +264,17 @@ ParseArgsStatus CApplication::ParseArguments(int argc, char *argv[])
         OPT_HEADLESS,
         OPT_DEVICE,
         OPT_OPENGL_VERSION,
-        OPT_OPENGL_PROFILE
+        OPT_OPENGL_PROFILE,
+        OPT_FIXEDSTEP,
+        OPT_BATCH,
+        OPT_RESULTS,
+        OPT_TIMELIMIT,
+        OPT_TEAMPROGRAM,
+        OPT_RECORD,
+        OPT_REPLAY,
+        OPT_REPLAYSPEED,
+        OPT_CHECKSUM,
+        OPT_PATHBUDGET
     };
 
     option options[] =
@@ -268,6 +293,16 @@ ParseArgsStatus CApplication::ParseArguments(int argc, char *argv[])
         { "graphics", required_argument, nullptr, OPT_DEVICE },
         { "glversion", required_argument, nullptr, OPT_OPENGL_VERSION },
         { "glprofile", required_argument, nullptr, OPT_OPENGL_PROFILE },
+        { "fixedstep", required_argument, nullptr, OPT_FIXEDSTEP },
+        { "batch", no_argument, nullptr, OPT_BATCH },
+        { "results", required_argument, nullptr, OPT_RESULTS },
+        { "timelimit", required_argument, nullptr, OPT_TIMELIMIT },
+        { "teamprogram", required_argument, nullptr, OPT_TEAMPROGRAM },
+        { "record", required_argument, nullptr, OPT_RECORD },
+        { "replay", required_argument, nullptr, OPT_REPLAY },
+        { "replayspeed", required_argument, nullptr, OPT_REPLAYSPEED },
+        { "checksum", required_argument, nullptr, OPT_CHECKSUM },
+        { "pathbudget", required_argument, nullptr, OPT_PATHBUDGET },
         { nullptr, 0, nullptr, 0}
     };
 
@@ -313,6 +348,16 @@ ParseArgsStatus CApplication::ParseArguments(int argc, char *argv[])
                 GetLogger()->Message("  -graphics           changes graphics device (one of: default, auto, opengl, gl14, gl21, gl33\n");
                 GetLogger()->Message("  -glversion          sets OpenGL context version to use (either default or version in format #.#)\n");
                 GetLogger()->Message("  -glprofile          sets OpenGL context profile to use (one of: default, core, compatibility, opengles)\n");
+                GetLogger()->Message("  -fixedstep N        advance simulation in fixed steps, N steps per second of game time\n");
+                GetLogger()->Message("  -batch              batch mode - run -runscene headless as fast as possible and exit after it ends\n");
+                GetLogger()->Message("  -results file       in batch mode, append result of the match to file (one JSON object per line)\n");
+                GetLogger()->Message("  -timelimit seconds  in batch mode, end the match after given game time\n");
+                GetLogger()->Message("  -teamprogram T=file in batch mode, load program from file into all robots of team T and run it\n");
+                GetLogger()->Message("  -record file        record -runscene mission to replay file\n");
+                GetLogger()->Message("  -checksum N         when recording, store checksum of the world every N simulation steps (default 60)\n");
+                GetLogger()->Message("  -replay file        replay recorded mission, exits with code 7 if the result differs from the recording\n");
+                GetLogger()->Message("  -replayspeed X      speed of replay relative to the recording (use -headless for maximum speed)\n");
+                GetLogger()->Message("  -pathbudget N       time given to each goto() path search per frame, in microseconds (default 1000)\n");
                 return PARSE_ARGS_HELP;
             }
             case OPT_DEBUG:
@@ -337,19 +382,8 @@ ParseArgsStatus CApplication::ParseArguments(int argc, char *argv[])
             }
             case OPT_RUNSCENE:
             {
-                std::string file = optarg;
-                std::string cat = file.substr(0, file.size()-3);
-                m_runSceneCategory = GetLevelCategoryFromDir(cat);
-                m_runSceneRank = StrUtils::FromString<int>(file.substr(file.size()-3, 3));
-                if(m_runSceneCategory != LevelCategory::Max)
-                {
-                    GetLogger()->Info("Running scene '%s%d' on start\n", cat.c_str(), m_runSceneRank);
-                }
-                else
-                {
-                    GetLogger()->Error("Requested to run scene from unknown category '%s'\n", cat.c_str());
+                if (!SetRunScene(optarg))
                     return PARSE_ARGS_FAIL;
-                }
                 break;
             }
             case OPT_SCENETEST:
@@ -471,11 +505,139 @@ ParseArgsStatus CApplication::ParseArguments(int argc, char *argv[])
                 }
                 break;
             }
+            case OPT_FIXEDSTEP:
+            {
+                int stepsPerSecond = atoi(optarg);
+                if (stepsPerSecond <= 0)
+                {
+                    GetLogger()->Error("Invalid number of simulation steps per second: %s\n", optarg);
+                    return PARSE_ARGS_FAIL;
+                }
+
+                m_fixedStepLength = 1000000000LL / stepsPerSecond;
+                GetLogger()->Info("Using %d fixed simulation steps per second\n", stepsPerSecond);
+                break;
+            }
+            case OPT_BATCH:
+            {
+                m_batchMode = true;
+                m_headless = true;
+                break;
+            }
+            case OPT_RESULTS:
+            {
+                m_batchResultFile = optarg;
+                break;
+            }
+            case OPT_TIMELIMIT:
+            {
+                m_batchTimeLimit = static_cast<float>(atof(optarg));
+                break;
+            }
+            case OPT_TEAMPROGRAM:
+            {
+                std::string arg = optarg;
+                std::size_t separator = arg.find('=');
+                if (separator == std::string::npos || separator == 0)
+                {
+                    GetLogger()->Error("Invalid team program, expected team=file: %s\n", optarg);
+                    return PARSE_ARGS_FAIL;
+                }
+
+                int team = atoi(arg.substr(0, separator).c_str());
+                m_teamPrograms[team] = arg.substr(separator + 1);
+                break;
+            }
+            case OPT_RECORD:
+            {
+                m_recordFile = optarg;
+                break;
+            }
+            case OPT_REPLAY:
+            {
+                m_replayPlayer = MakeUnique<CReplayPlayer>();
+                if (!m_replayPlayer->Open(optarg))
+                    return PARSE_ARGS_FAIL;
+                break;
+            }
+            case OPT_REPLAYSPEED:
+            {
+                m_replaySpeed = static_cast<float>(atof(optarg));
+                if (m_replaySpeed <= 0.0f)
+                {
+                    GetLogger()->Error("Invalid replay speed: %s\n", optarg);
+                    return PARSE_ARGS_FAIL;
+                }
+                break;
+            }
+            case OPT_CHECKSUM:
+            {
+                m_replayChecksumInterval = atoi(optarg);
+                break;
+            }
+            case OPT_PATHBUDGET:
+            {
+                m_pathSearchBudget = atoi(optarg);
+                if (m_pathSearchBudget <= 0)
+                {
+                    GetLogger()->Error("Invalid path search budget: %s\n", optarg);
+                    return PARSE_ARGS_FAIL;
+                }
+                break;
+            }
             default:
                 assert(false); // should never get here
         }
     }
 
+    if (m_replayPlayer != nullptr)
+    {
+        if (!m_recordFile.empty())
+        {
+            GetLogger()->Error("Cannot record and replay at the same time\n");
+            return PARSE_ARGS_FAIL;
+        }
+
+        // Everything affecting the simulation comes from the replay
+        const ReplayHeader& header = m_replayPlayer->GetHeader();
+        if (!SetRunScene(header.scene))
+            return PARSE_ARGS_FAIL;
+        m_fixedStepLength = header.stepLength;
+        m_replaySeed = header.seed;
+        m_replayChecksumInterval = header.checksumInterval;
+        m_batchMode = header.batchMode;
+        m_batchTimeLimit = header.batchTimeLimit;
+        m_teamPrograms.clear();
+    }
+
+    if (!m_recordFile.empty())
+    {
+        if (m_runSceneCategory == LevelCategory::Max)
+        {
+            GetLogger()->Error("Recording requires -runscene\n");
+            return PARSE_ARGS_FAIL;
+        }
+
+        // Replay is deterministic only with fixed steps
+        if (m_fixedStepLength == 0)
+            m_fixedStepLength = 1000000000LL / 60;
+
+        m_replaySeed = static_cast<unsigned int>(time(nullptr));
+    }
+
+    if (m_batchMode && m_replayPlayer == nullptr)
+    {
+        if (m_runSceneCategory == LevelCategory::Max)
+        {
+            GetLogger()->Error("Batch mode requires -runscene\n");
+            return PARSE_ARGS_FAIL;
+        }
+
+        // Results must not depend on speed of the machine
+        if (m_fixedStepLength == 0)
+            m_fixedStepLength = 1000000000LL / 60;
+    }
+
     return PARSE_ARGS_OK;
 }
 
@@ -680,11 +842,39 @@ bool CApplication::Create()
         return false;
     }
 
+    if (m_headless && (m_batchMode || m_replayPlayer != nullptr))
+        m_engine->SetRenderEnable(false);
+
     m_eventQueue = MakeUnique<CEventQueue>();
 
     // Create the robot application.
     m_controller = MakeUnique<CController>();
 
+    if (!m_recordFile.empty())
+    {
+        ReplayHeader header;
+        header.seed = m_replaySeed;
+        header.scene = GetLevelCategoryDir(m_runSceneCategory) + StrUtils::Format("%.3d", m_runSceneRank);
+        header.stepLength = m_fixedStepLength;
+        header.checksumInterval = m_replayChecksumInterval;
+        header.batchMode = m_batchMode;
+        header.batchTimeLimit = m_batchTimeLimit;
+
+        m_replayRecorder = MakeUnique<CReplayRecorder>();
+        if (!m_replayRecorder->Open(m_recordFile, header))
+        {
+            m_errorMessage = "Unable to create replay file " + m_recordFile;
+            m_exitCode = 1;
+            return false;
+        }
+    }
+
+    if (m_replayPlayer != nullptr)
+        m_input->SetReplayMode(true);
+
+    if (m_replayRecorder != nullptr || m_replayPlayer != nullptr)
+        srand(m_replaySeed);
+
     if (m_runSceneCategory == LevelCategory::Max)
         m_controller->StartApp();
     else
@@ -1044,6 +1234,10 @@ int CApplication::Run()
 
                 Event virtualEvent = CreateVirtualEvent(event);
 
+                // During replay, input comes only from the replay file
+                if (m_replayPlayer != nullptr && IsReplayInputEvent(event.type))
+                    continue;
+
                 if (event.type != EVENT_NULL)
                     m_eventQueue->AddEvent(std::move(event));
 
@@ -1062,51 +1256,39 @@ int CApplication::Run()
             if (event.type == EVENT_SYS_QUIT)
                 goto end; // exit the loop
 
-            if (event.type != EVENT_NULL)
+            if (event.type != EVENT_NULL && m_replayPlayer == nullptr)
                 m_eventQueue->AddEvent(std::move(event));
         }
 
         // Enter game update & frame rendering only if active
         if (m_active)
         {
-            while (! m_eventQueue->IsEmpty())
-            {
-                Event event = m_eventQueue->GetEvent();
-
-                if (event.type == EVENT_SYS_QUIT || event.type == EVENT_QUIT)
-                    goto end; // exit both loops
-
-                LogEvent(event);
-
-                m_input->EventProcess(event);
-
-                bool passOn = true;
-                if (m_engine != nullptr)
-                    passOn = m_engine->ProcessEvent(event);
-
-                if (passOn && m_controller != nullptr)
-                    m_controller->ProcessEvent(event);
-            }
+            if (!ProcessEventQueue())
+                goto end; // exit both loops
 
             StopPerformanceCounter(PCNT_EVENT_PROCESSING);
 
             StartPerformanceCounter(PCNT_UPDATE_ALL);
 
             // Prepare and process step simulation event
-            Event event = CreateUpdateEvent();
-            if (event.type != EVENT_NULL && m_controller != nullptr)
+            if (m_replayPlayer != nullptr)
             {
-                LogEvent(event);
-
-                m_sound->FrameMove(m_relTime);
-
-                StartPerformanceCounter(PCNT_UPDATE_GAME);
-                m_controller->ProcessEvent(event);
-                StopPerformanceCounter(PCNT_UPDATE_GAME);
-
-                StartPerformanceCounter(PCNT_UPDATE_ENGINE);
-                m_engine->FrameUpdate();
-                StopPerformanceCounter(PCNT_UPDATE_ENGINE);
+                if (!PlayReplayFrames())
+                    goto end;
+                m_engine->SetRenderInterpolation(static_cast<float>(m_simulationLag) / m_fixedStepLength);
+            }
+            else if (m_fixedStepLength > 0)
+            {
+                int steps = PrepareFixedSteps();
+                RunFixedSteps(steps);
+                if (m_replayRecorder != nullptr)
+                    m_replayRecorder->RecordFrameEnd(steps);
+                m_engine->SetRenderInterpolation(static_cast<float>(m_simulationLag) / m_fixedStepLength);
+            }
+            else
+            {
+                Event event = CreateUpdateEvent();
+                ProcessUpdateEvent(event);
             }
 
             StopPerformanceCounter(PCNT_UPDATE_ALL);
@@ -1127,6 +1309,33 @@ end:
     return m_exitCode;
 }
 
+bool CApplication::ProcessEventQueue()
+{
+    while (! m_eventQueue->IsEmpty())
+    {
+        Event event = m_eventQueue->GetEvent();
+
+        if (event.type == EVENT_SYS_QUIT || event.type == EVENT_QUIT)
+            return false;
+
+        LogEvent(event);
+
+        m_input->EventProcess(event);
+
+        if (m_replayRecorder != nullptr && IsReplayInputEvent(event.type))
+            m_replayRecorder->RecordEvent(event);
+
+        bool passOn = true;
+        if (m_engine != nullptr)
+            passOn = m_engine->ProcessEvent(event);
+
+        if (passOn && m_controller != nullptr)
+            m_controller->ProcessEvent(event);
+    }
+
+    return true;
+}
+
 int CApplication::GetExitCode() const
 {
     return m_exitCode;
@@ -1454,6 +1663,7 @@ void CApplication::InternalResumeSimulation()
     m_systemUtils->CopyTimeStamp(m_curTimeStamp, m_baseTimeStamp);
     m_realAbsTimeBase = m_realAbsTime;
     m_absTimeBase = m_exactAbsTime;
+    m_simulationLag = 0LL;
 }
 
 bool CApplication::GetSimulationSuspended() const
@@ -1510,6 +1720,179 @@ Event CApplication::CreateUpdateEvent()
     return frameEvent;
 }
 
+void CApplication::ProcessUpdateEvent(Event& event)
+{
+    if (event.type == EVENT_NULL || m_controller == nullptr)
+        return;
+
+    LogEvent(event);
+
+    m_sound->FrameMove(m_relTime);
+
+    StartPerformanceCounter(PCNT_UPDATE_GAME);
+    m_controller->ProcessEvent(event);
+    StopPerformanceCounter(PCNT_UPDATE_GAME);
+
+    StartPerformanceCounter(PCNT_UPDATE_ENGINE);
+    m_engine->FrameUpdate();
+    StopPerformanceCounter(PCNT_UPDATE_ENGINE);
+}
+
+void CApplication::RunFixedSteps(int steps)
+{
+    for (int i = 0; i < steps; i++)
+    {
+        m_engine->BeginSimulationStep();
+        Event event = CreateFixedStepEvent();
+        ProcessUpdateEvent(event);
+
+        m_simulationStepCount++;
+        UpdateReplayChecksum();
+    }
+}
+
+bool CApplication::PlayReplayFrames()
+{
+    // Frames are played whole, the same way as they were recorded, so that events
+    // generated by the game are processed between the same simulation steps
+    int availableSteps = m_headless ? m_replayPlayer->GetNextFrameSteps() : PrepareFixedSteps();
+
+    while (!m_replayPlayer->IsFinished() && m_replayPlayer->GetNextFrameSteps() <= availableSteps)
+    {
+        ReplayFrame frame = m_replayPlayer->TakeNextFrame();
+        availableSteps -= frame.steps;
+
+        for (Event& event : frame.events)
+            m_eventQueue->AddEvent(std::move(event));
+
+        if (!ProcessEventQueue())
+            return false;
+
+        RunFixedSteps(frame.steps);
+
+        if (m_headless)
+            break;
+    }
+
+    // Unused time waits for the next frame
+    if (!m_headless)
+        m_simulationLag += availableSteps * m_fixedStepLength;
+
+    if (m_replayPlayer->IsFinished())
+    {
+        GetLogger()->Info("Replay finished after %lld steps\n", m_simulationStepCount);
+        return false;
+    }
+
+    return true;
+}
+
+void CApplication::UpdateReplayChecksum()
+{
+    if (m_replayChecksumInterval <= 0) return;
+    if (m_replayRecorder == nullptr && m_replayPlayer == nullptr) return;
+    if (m_simulationStepCount % m_replayChecksumInterval != 0) return;
+
+    unsigned long long checksum = ComputeWorldChecksum();
+
+    if (m_replayRecorder != nullptr)
+        m_replayRecorder->RecordChecksum(m_simulationStepCount, checksum);
+
+    if (m_replayPlayer != nullptr && !m_replayDiverged && !m_replayPlayer->CheckChecksum(m_simulationStepCount, checksum))
+    {
+        GetLogger()->Error("Replay diverged from the recording at step %lld (game time %.3f s)\n", m_simulationStepCount, m_absTime);
+        m_replayDiverged = true;
+        m_exitCode = 7;
+    }
+}
+
+int CApplication::PrepareFixedSteps()
+{
+    // Don't try to catch up after long freezes, slow down the game instead
+    const int MAX_STEPS_PER_FRAME = 32;
+
+    if (m_simulationSuspended)
+        return 0;
+
+    m_systemUtils->CopyTimeStamp(m_lastTimeStamp, m_curTimeStamp);
+    m_systemUtils->GetCurrentTimeStamp(m_curTimeStamp);
+
+    long long absDiff = m_systemUtils->TimeStampExactDiff(m_baseTimeStamp, m_curTimeStamp);
+    long long newRealAbsTime = m_realAbsTimeBase + absDiff;
+    long long newRealRelTime = m_systemUtils->TimeStampExactDiff(m_lastTimeStamp, m_curTimeStamp);
+
+    if (newRealAbsTime < m_realAbsTime || newRealRelTime < 0)
+    {
+        GetLogger()->Error("Fatal error: got negative system counter difference!\n");
+        GetLogger()->Error("This should never happen. Please report this error.\n");
+        m_eventQueue->AddEvent(Event(EVENT_SYS_QUIT));
+        return 0;
+    }
+
+    m_realAbsTime = newRealAbsTime;
+    m_realRelTime = newRealRelTime;
+
+    if (m_batchMode && m_replayPlayer == nullptr)
+    {
+        // Nobody is watching, don't wait for the real time to pass
+        m_simulationLag = 0LL;
+        return 1;
+    }
+
+    m_simulationLag += static_cast<long long>(m_simulationSpeed * m_replaySpeed * m_realRelTime);
+
+    long long steps = m_simulationLag / m_fixedStepLength;
+    if (steps > MAX_STEPS_PER_FRAME)
+    {
+        steps = MAX_STEPS_PER_FRAME;
+        m_simulationLag = m_fixedStepLength * steps;
+    }
+    m_simulationLag -= m_fixedStepLength * steps;
+
+    return static_cast<int>(steps);
+}
+
+Event CApplication::CreateFixedStepEvent()
+{
+    m_exactRelTime = m_fixedStepLength;
+    m_exactAbsTime += m_fixedStepLength;
+    m_relTime = m_exactRelTime / 1e9f;
+    m_absTime = m_exactAbsTime / 1e9f;
+
+    Event frameEvent(EVENT_FRAME);
+    frameEvent.rTime = m_relTime;
+    m_input->EventProcess(frameEvent);
+
+    return frameEvent;
+}
+
+void CApplication::SetFixedTimeStep(float stepLength)
+{
+    m_fixedStepLength = std::llround(stepLength * 1e9);
+    if (m_fixedStepLength < 0)
+        m_fixedStepLength = 0;
+
+    // Both modes compute absolute time differently, start again from the current state
+    m_systemUtils->GetCurrentTimeStamp(m_baseTimeStamp);
+    m_systemUtils->CopyTimeStamp(m_curTimeStamp, m_baseTimeStamp);
+    m_realAbsTimeBase = m_realAbsTime;
+    m_absTimeBase = m_exactAbsTime;
+    m_simulationLag = 0LL;
+
+    if (m_fixedStepLength == 0 && m_engine != nullptr)
+        m_engine->SetRenderInterpolation(1.0f);
+
+    if (m_fixedStepLength > 0)
+        GetLogger()->Info("Fixed simulation step = %.4f s\n", stepLength);
+    else
+        GetLogger()->Info("Variable simulation step\n");
+}
+
+float CApplication::GetFixedTimeStep() const
+{
+    return m_fixedStepLength / 1e9f;
+}
+
 float CApplication::GetSimulationSpeed() const
 {
     return m_simulationSpeed;
@@ -1892,6 +2275,65 @@ bool CApplication::GetSceneTestMode()
     return m_sceneTest;
 }
 
+bool CApplication::SetRunScene(const std::string& scene)
+{
+    std::string cat = scene.substr(0, scene.size()-3);
+    m_runSceneCategory = GetLevelCategoryFromDir(cat);
+    m_runSceneRank = StrUtils::FromString<int>(scene.substr(scene.size()-3, 3));
+    if (m_runSceneCategory == LevelCategory::Max)
+    {
+        GetLogger()->Error("Requested to run scene from unknown category '%s'\n", cat.c_str());
+        return false;
+    }
+
+    GetLogger()->Info("Running scene '%s%d' on start\n", cat.c_str(), m_runSceneRank);
+    return true;
+}
+
+bool CApplication::GetBatchMode() const
+{
+    return m_batchMode;
+}
+
+const std::string& CApplication::GetBatchResultFile() const
+{
+    return m_batchResultFile;
+}
+
+float CApplication::GetBatchTimeLimit() const
+{
+    return m_batchTimeLimit;
+}
+
+const std::map<int, std::string>& CApplication::GetTeamPrograms() const
+{
+    return m_teamPrograms;
+}
+
+int CApplication::GetPathSearchBudget() const
+{
+    // Time depends on the machine, recorded games have to find paths in the same frames
+    if (m_replayRecorder != nullptr || m_replayPlayer != nullptr || !m_recordFile.empty())
+        return 0;
+
+    return m_pathSearchBudget;
+}
+
+CSystemUtils* CApplication::GetSystemUtils() const
+{
+    return m_systemUtils;
+}
+
+CReplayRecorder* CApplication::GetReplayRecorder() const
+{
+    return m_replayRecorder.get();
+}
+
+CReplayPlayer* CApplication::GetReplayPlayer() const
+{
+    return m_replayPlayer.get();
+}
+
 void CApplication::SetTextInput(bool textInputEnabled)
 {
     if (textInputEnabled)
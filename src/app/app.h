@@ -33,6 +33,7 @@
 #include "level/level_category.h"
 
 
+#include <map>
 #include <string>
 #include <vector>
 
@@ -44,6 +45,8 @@ class CInput;
 class CPathManager;
 class CConfigFile;
 class CSystemUtils;
+class CReplayRecorder;
+class CReplayPlayer;
 struct SystemTimeStamp;
 
 namespace Gfx
@@ -106,6 +109,8 @@ enum PerformanceCounter
     PCNT_UPDATE_ENGINE,         //! < frame update in CEngine
     PCNT_UPDATE_PARTICLE,       //! < frame update in CParticle
     PCNT_UPDATE_GAME,           //! < frame update in CRobotMain
+    PCNT_UPDATE_CONDITIONS,     //! < checking end mission and audio conditions in CRobotMain
+    PCNT_UPDATE_PHYSICS_PREPARE, //! < sampling the terrain for physics objects on all cores in CRobotMain
 
     PCNT_RENDER_ALL,            //! < the whole rendering process
     PCNT_RENDER_PARTICLE,       //! < rendering the particles in 3D
@@ -228,6 +233,17 @@ public:
     float           GetSimulationSpeed() const;
     //@}
 
+    //@{
+    //! Management of fixed timestep simulation
+    /**
+     * With fixed timestep, the game is advanced in steps of constant length
+     * (possibly several per rendered frame) and rendering interpolates between
+     * the last two steps. Step length 0 disables fixed timestep.
+     */
+    void            SetFixedTimeStep(float stepLength);
+    float           GetFixedTimeStep() const;
+    //@}
+
     //! Returns the absolute time counter [seconds]
     float       GetAbsTime() const;
     //! Returns the exact absolute time counter [nanoseconds]
@@ -301,6 +317,27 @@ public:
 
     bool        GetSceneTestMode();
 
+    //@{
+    //! Batch mode settings, see -batch command line option
+    bool        GetBatchMode() const;
+    const std::string& GetBatchResultFile() const;
+    float       GetBatchTimeLimit() const;
+    //! Returns program files to load into robots of each team
+    const std::map<int, std::string>& GetTeamPrograms() const;
+    //@}
+
+    //@{
+    //! Replay being recorded (-record) or played (-replay), nullptr if none
+    CReplayRecorder* GetReplayRecorder() const;
+    CReplayPlayer* GetReplayPlayer() const;
+    //@}
+
+    //! Returns time given to one path search per frame [us], 0 if searches have to be deterministic
+    int         GetPathSearchBudget() const;
+
+    //! Returns the system utilities, e.g. for precise time measurement
+    CSystemUtils* GetSystemUtils() const;
+
     //! Renders the image in window
     void        Render();
 
@@ -322,6 +359,22 @@ protected:
     Event       CreateVirtualEvent(const Event& sourceEvent);
     //! Prepares a simulation update event
     TEST_VIRTUAL Event CreateUpdateEvent();
+    //! Measures elapsed time and returns number of fixed simulation steps to run in this frame
+    TEST_VIRTUAL int PrepareFixedSteps();
+    //! Advances time by one fixed step and prepares its update event
+    TEST_VIRTUAL Event CreateFixedStepEvent();
+    //! Sends update event to the game and the engine
+    void        ProcessUpdateEvent(Event& event);
+    //! Runs given number of fixed simulation steps
+    void        RunFixedSteps(int steps);
+    //! Processes all queued events; returns false if the application should quit
+    bool        ProcessEventQueue();
+    //! Plays recorded frames for which the time has come; returns false when the replay ended
+    bool        PlayReplayFrames();
+    //! Computes world checksum after a step, stores it or compares with the replay
+    void        UpdateReplayChecksum();
+    //! Sets -runscene scene from its name, returns false if the category is unknown
+    bool        SetRunScene(const std::string& scene);
     //! Logs debug data for event
     void        LogEvent(const Event& event);
 
@@ -398,6 +451,13 @@ protected:
 
     float           m_simulationSpeed;
     bool            m_simulationSuspended;
+
+    //! Length of fixed simulation step [nanoseconds], 0 if disabled
+    long long       m_fixedStepLength;
+    //! Game time not yet simulated in fixed steps [nanoseconds]
+    long long       m_simulationLag;
+    //! Number of fixed steps simulated since start
+    long long       m_simulationStepCount;
     //@}
 
     SystemTimeStamp* m_manualFrameLast;
@@ -444,6 +504,31 @@ protected:
     //! Headles mode
     bool            m_headless;
 
+    //@{
+    //! Batch mode - runs -runscene unattended and as fast as possible
+    bool            m_batchMode;
+    std::string     m_batchResultFile;
+    float           m_batchTimeLimit;
+    std::map<int, std::string> m_teamPrograms;
+    //@}
+
+    //@{
+    //! Recording and replaying of the played mission, see -record and -replay
+    std::unique_ptr<CReplayRecorder> m_replayRecorder;
+    std::unique_ptr<CReplayPlayer> m_replayPlayer;
+    std::string     m_recordFile;
+    unsigned int    m_replaySeed;
+    //! World checksum is recorded every this many steps
+    int             m_replayChecksumInterval;
+    //! Speed of replaying relative to the recorded speed
+    float           m_replaySpeed;
+    //! Replay didn't give the same results as the recording
+    bool            m_replayDiverged;
+    //@}
+
+    //! Time given to one path search per frame [us], see -pathbudget
+    int             m_pathSearchBudget;
+
     //! Static buffer for putenv locale
     static char m_languageLocale[50];
 };
@@ -100,10 +100,23 @@ void CInput::EventProcess(Event& event)
         event.type == EVENT_KEY_UP)
     {
         auto data = event.GetData<KeyEventData>();
-        data->slot = FindBinding(data->key);
+        if (!m_replayMode) // Bindings of the player who recorded the replay may be different
+            data->slot = FindBinding(data->key);
     }
 
-    event.kmodState = SDL_GetModState();
+    if (m_replayMode)
+    {
+        if (event.type > EVENT_FRAME && event.type < EVENT_SYS_MAX)
+        {
+            m_replayKmodState = event.kmodState;
+            m_mousePos = event.mousePos;
+        }
+        event.kmodState = m_replayKmodState;
+    }
+    else
+    {
+        event.kmodState = SDL_GetModState();
+    }
     event.mousePos = m_mousePos;
     event.mouseButtonsState = m_mouseButtonsState;
 
@@ -208,6 +221,8 @@ void CInput::EventProcess(Event& event)
 
 void CInput::MouseMove(Math::IntPoint pos)
 {
+    if (m_replayMode) return; // Mouse position comes from the replay
+
     m_mousePos = Gfx::CEngine::GetInstancePointer()->WindowToInterfaceCoords(pos);
 }
 
@@ -221,6 +236,12 @@ bool CInput::GetMouseButtonState(int index) const
     return (m_mouseButtonsState & (1<<index)) != 0;
 }
 
+void CInput::SetReplayMode(bool replay)
+{
+    m_replayMode = replay;
+    m_replayKmodState = 0;
+}
+
 void CInput::ResetKeyStates()
 {
     GetLogger()->Trace("Reset key states\n");
@@ -80,6 +80,9 @@ public:
     //! Called by CApplication on SDL MOUSE_MOTION event
     void MouseMove(Math::IntPoint pos);
 
+    //! In replay mode mouse position, key modifiers and binding slots are taken from the replayed events instead of the real devices
+    void SetReplayMode(bool replay);
+
 
     //! Returns whether the key is pressed
     bool        GetKeyState(InputSlot key) const;
@@ -143,6 +146,11 @@ private:
     //! Current state of mouse buttons (bitmask of MouseButton enum values)
     unsigned int    m_mouseButtonsState;
 
+    //! Replaying recorded input, see SetReplayMode()
+    bool            m_replayMode = false;
+    //! Key modifiers from the last replayed event
+    unsigned int    m_replayKmodState = 0;
+
 
     //! Motion vector set by keyboard or joystick buttons
     Math::Vector    m_keyMotion;
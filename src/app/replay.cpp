@@ -0,0 +1,463 @@
+/*
+ * This file is part of the Colobot: Gold Edition source code
+ * Copyright (C) 2001-2016, Daniel Roux, EPSITEC SA & TerranovaTeam
+ * http://epsitec.ch; http://colobot.info; http://github.com/colobot
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://gnu.org/licenses
+ */
+
+#include "app/replay.h"
+
+#include "common/logger.h"
+#include "common/make_unique.h"
+
+#include "object/object.h"
+#include "object/object_manager.h"
+
+#include "object/interface/power_container_object.h"
+#include "object/interface/shielded_object.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+namespace
+{
+
+const char* const REPLAY_MAGIC = "COLOBOT-REPLAY";
+const int REPLAY_VERSION = 2;
+
+// Floats are stored as their bit patterns, so they are read back exactly
+unsigned int FloatToBits(float value)
+{
+    unsigned int bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+float BitsToFloat(unsigned int bits)
+{
+    float value = 0.0f;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+std::string EncodeText(const std::string& text)
+{
+    if (text.empty()) return "-";
+
+    // Hex encoded, so spaces and new lines don't break the line-based format
+    std::ostringstream out;
+    out << std::hex << std::setfill('0');
+    for (char c : text)
+        out << std::setw(2) << static_cast<unsigned int>(static_cast<unsigned char>(c));
+    return out.str();
+}
+
+std::string DecodeText(const std::string& encoded)
+{
+    std::string text;
+    if (encoded == "-") return text;
+
+    for (std::size_t i = 0; i + 1 < encoded.size(); i += 2)
+        text += static_cast<char>(std::stoi(encoded.substr(i, 2), nullptr, 16));
+    return text;
+}
+
+class CChecksum
+{
+public:
+    void Add(const void* data, std::size_t size)
+    {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            m_hash ^= bytes[i];
+            m_hash *= 1099511628211ULL; // FNV-1a
+        }
+    }
+
+    void Add(int value) { Add(&value, sizeof(value)); }
+    void Add(float value) { Add(&value, sizeof(value)); }
+    void Add(const Math::Vector& value) { Add(value.x); Add(value.y); Add(value.z); }
+
+    unsigned long long Get() const { return m_hash; }
+
+private:
+    unsigned long long m_hash = 14695981039346656037ULL;
+};
+
+} // anonymous namespace
+
+
+bool IsReplayInputEvent(EventType type)
+{
+    return type > EVENT_FRAME && type < EVENT_SYS_MAX;
+}
+
+unsigned long long ComputeWorldChecksum()
+{
+    CChecksum checksum;
+
+    CObjectManager* objectManager = CObjectManager::GetInstancePointer();
+    if (objectManager == nullptr) return checksum.Get();
+
+    for (CObject* obj : objectManager->GetAllObjects())
+    {
+        checksum.Add(obj->GetID());
+        checksum.Add(static_cast<int>(obj->GetType()));
+        checksum.Add(obj->GetTeam());
+        checksum.Add(obj->GetPosition());
+        checksum.Add(obj->GetRotation());
+
+        if (CPowerContainerObject* power = obj->GetInterface<ObjectInterfaceType::PowerContainer>())
+            checksum.Add(power->GetEnergyLevel());
+        if (CShieldedObject* shielded = obj->GetInterface<ObjectInterfaceType::Shielded>())
+            checksum.Add(shielded->GetShield());
+    }
+
+    return checksum.Get();
+}
+
+
+bool CReplayRecorder::Open(const std::string& filename, const ReplayHeader& header)
+{
+    m_file.open(filename, std::ios::out | std::ios::trunc | std::ios::binary);
+    if (!m_file.is_open())
+    {
+        GetLogger()->Error("Unable to create replay file '%s'\n", filename.c_str());
+        return false;
+    }
+
+    m_file << REPLAY_MAGIC << " " << REPLAY_VERSION << "\n"
+           << "seed " << header.seed << "\n"
+           << "scene " << header.scene << "\n"
+           << "step " << header.stepLength << "\n"
+           << "checksum " << header.checksumInterval << "\n"
+           << "batch " << (header.batchMode ? 1 : 0) << " " << FloatToBits(header.batchTimeLimit) << "\n"
+           << "begin\n";
+
+    GetLogger()->Info("Recording replay to '%s'\n", filename.c_str());
+    return m_file.good();
+}
+
+void CReplayRecorder::RecordProgram(const ReplayProgram& program)
+{
+    m_file << "P " << program.objectId << " " << program.index << " " << program.restart
+           << " " << program.source.size() << "\n";
+    m_file.write(program.source.data(), program.source.size());
+    m_file << "\n";
+}
+
+void CReplayRecorder::RecordEvent(const Event& event)
+{
+    m_frameStarted = true;
+
+    m_file << "E " << static_cast<int>(event.type)
+           << " " << event.kmodState
+           << " " << FloatToBits(event.mousePos.x)
+           << " " << FloatToBits(event.mousePos.y);
+
+    switch (event.type)
+    {
+        case EVENT_KEY_DOWN:
+        case EVENT_KEY_UP:
+        {
+            auto data = event.GetData<KeyEventData>();
+            m_file << " " << (data->virt ? 1 : 0) << " " << data->key << " " << static_cast<int>(data->slot);
+            break;
+        }
+        case EVENT_TEXT_INPUT:
+        {
+            auto data = event.GetData<TextInputData>();
+            m_file << " " << EncodeText(data->text);
+            break;
+        }
+        case EVENT_MOUSE_BUTTON_DOWN:
+        case EVENT_MOUSE_BUTTON_UP:
+        {
+            auto data = event.GetData<MouseButtonEventData>();
+            m_file << " " << static_cast<int>(data->button);
+            break;
+        }
+        case EVENT_MOUSE_WHEEL:
+        {
+            auto data = event.GetData<MouseWheelEventData>();
+            m_file << " " << data->y << " " << data->x;
+            break;
+        }
+        case EVENT_JOY_AXIS:
+        {
+            auto data = event.GetData<JoyAxisEventData>();
+            m_file << " " << static_cast<int>(data->axis) << " " << data->value;
+            break;
+        }
+        case EVENT_JOY_BUTTON_DOWN:
+        case EVENT_JOY_BUTTON_UP:
+        {
+            auto data = event.GetData<JoyButtonEventData>();
+            m_file << " " << static_cast<int>(data->button);
+            break;
+        }
+        default:
+            break;
+    }
+
+    m_file << "\n";
+}
+
+void CReplayRecorder::RecordFrameEnd(int steps)
+{
+    if (!m_frameStarted && steps == 0) return;
+
+    m_file << "F " << steps << "\n";
+    m_frameStarted = false;
+}
+
+void CReplayRecorder::RecordChecksum(long long step, unsigned long long checksum)
+{
+    m_file << "C " << step << " " << checksum << "\n";
+}
+
+
+bool CReplayPlayer::Open(const std::string& filename)
+{
+    std::ifstream file(filename, std::ios::in | std::ios::binary);
+    if (!file.is_open())
+    {
+        GetLogger()->Error("Unable to open replay file '%s'\n", filename.c_str());
+        return false;
+    }
+
+    std::string line;
+    std::string magic;
+    int version = 0;
+    if (!std::getline(file, line) || !(std::istringstream(line) >> magic >> version) ||
+        magic != REPLAY_MAGIC || version != REPLAY_VERSION)
+    {
+        GetLogger()->Error("'%s' is not a replay file or has unsupported version\n", filename.c_str());
+        return false;
+    }
+
+    // Header
+    while (std::getline(file, line) && line != "begin")
+    {
+        std::istringstream in(line);
+        std::string key;
+        in >> key;
+        if (key == "seed")
+        {
+            in >> m_header.seed;
+        }
+        else if (key == "scene")
+        {
+            in >> m_header.scene;
+        }
+        else if (key == "step")
+        {
+            in >> m_header.stepLength;
+        }
+        else if (key == "checksum")
+        {
+            in >> m_header.checksumInterval;
+        }
+        else if (key == "batch")
+        {
+            int batchMode = 0;
+            unsigned int timeLimit = 0;
+            in >> batchMode >> timeLimit;
+            m_header.batchMode = batchMode != 0;
+            m_header.batchTimeLimit = BitsToFloat(timeLimit);
+        }
+        else
+        {
+            GetLogger()->Warn("Unknown replay header line: %s\n", line.c_str());
+        }
+    }
+
+    if (m_header.scene.empty() || m_header.stepLength <= 0)
+    {
+        GetLogger()->Error("Replay file '%s' has incomplete header\n", filename.c_str());
+        return false;
+    }
+
+    // Records
+    ReplayFrame frame;
+    while (std::getline(file, line))
+    {
+        if (line.empty()) continue;
+
+        std::istringstream in(line);
+        char record = 0;
+        in >> record;
+
+        if (record == 'P')
+        {
+            ReplayProgram program;
+            std::size_t length = 0;
+            in >> program.objectId >> program.index >> program.restart >> length;
+            program.source.resize(length);
+            file.read(&program.source[0], length);
+            m_programs.push_back(std::move(program));
+        }
+        else if (record == 'E')
+        {
+            int type = 0;
+            unsigned int mouseX = 0, mouseY = 0;
+            Event event;
+            in >> type >> event.kmodState >> mouseX >> mouseY;
+            event.type = static_cast<EventType>(type);
+            event.mousePos = Math::Point(BitsToFloat(mouseX), BitsToFloat(mouseY));
+
+            switch (event.type)
+            {
+                case EVENT_KEY_DOWN:
+                case EVENT_KEY_UP:
+                {
+                    auto data = MakeUnique<KeyEventData>();
+                    int virt = 0, slot = 0;
+                    in >> virt >> data->key >> slot;
+                    data->virt = virt != 0;
+                    data->slot = static_cast<InputSlot>(slot);
+                    event.data = std::move(data);
+                    break;
+                }
+                case EVENT_TEXT_INPUT:
+                {
+                    auto data = MakeUnique<TextInputData>();
+                    std::string text;
+                    in >> text;
+                    data->text = DecodeText(text);
+                    event.data = std::move(data);
+                    break;
+                }
+                case EVENT_MOUSE_BUTTON_DOWN:
+                case EVENT_MOUSE_BUTTON_UP:
+                {
+                    auto data = MakeUnique<MouseButtonEventData>();
+                    int button = 0;
+                    in >> button;
+                    data->button = static_cast<MouseButton>(button);
+                    event.data = std::move(data);
+                    break;
+                }
+                case EVENT_MOUSE_WHEEL:
+                {
+                    auto data = MakeUnique<MouseWheelEventData>();
+                    in >> data->y >> data->x;
+                    event.data = std::move(data);
+                    break;
+                }
+                case EVENT_JOY_AXIS:
+                {
+                    auto data = MakeUnique<JoyAxisEventData>();
+                    int axis = 0;
+                    in >> axis >> data->value;
+                    data->axis = static_cast<unsigned char>(axis);
+                    event.data = std::move(data);
+                    break;
+                }
+                case EVENT_JOY_BUTTON_DOWN:
+                case EVENT_JOY_BUTTON_UP:
+                {
+                    auto data = MakeUnique<JoyButtonEventData>();
+                    int button = 0;
+                    in >> button;
+                    data->button = static_cast<unsigned char>(button);
+                    event.data = std::move(data);
+                    break;
+                }
+                default:
+                    break;
+            }
+
+            frame.events.push_back(std::move(event));
+        }
+        else if (record == 'F')
+        {
+            in >> frame.steps;
+            m_frames.push_back(std::move(frame));
+            frame = ReplayFrame();
+        }
+        else if (record == 'C')
+        {
+            long long step = 0;
+            unsigned long long checksum = 0;
+            in >> step >> checksum;
+            m_checksums.push_back(std::make_pair(step, checksum));
+        }
+        else
+        {
+            GetLogger()->Error("Corrupted replay file '%s', unknown record: %s\n", filename.c_str(), line.c_str());
+            return false;
+        }
+    }
+
+    // Events after the last frame were processed before quitting
+    if (!frame.events.empty())
+        m_frames.push_back(std::move(frame));
+
+    std::sort(m_checksums.begin(), m_checksums.end());
+
+    GetLogger()->Info("Loaded replay '%s': %d frames, %d checksums\n", filename.c_str(),
+                      static_cast<int>(m_frames.size()), static_cast<int>(m_checksums.size()));
+    return true;
+}
+
+const ReplayHeader& CReplayPlayer::GetHeader() const
+{
+    return m_header;
+}
+
+const ReplayProgram* CReplayPlayer::GetProgram(int objectId, int index, int restart) const
+{
+    for (const ReplayProgram& program : m_programs)
+    {
+        if (program.objectId == objectId && program.index == index && program.restart == restart)
+            return &program;
+    }
+    return nullptr;
+}
+
+const std::vector<ReplayProgram>& CReplayPlayer::GetPrograms() const
+{
+    return m_programs;
+}
+
+bool CReplayPlayer::IsFinished() const
+{
+    return m_nextFrame >= m_frames.size();
+}
+
+int CReplayPlayer::GetNextFrameSteps() const
+{
+    if (IsFinished()) return 0;
+    return m_frames[m_nextFrame].steps;
+}
+
+ReplayFrame CReplayPlayer::TakeNextFrame()
+{
+    if (IsFinished()) return ReplayFrame();
+    return std::move(m_frames[m_nextFrame++]);
+}
+
+bool CReplayPlayer::CheckChecksum(long long step, unsigned long long checksum) const
+{
+    auto it = std::lower_bound(m_checksums.begin(), m_checksums.end(), std::make_pair(step, 0ULL));
+    if (it == m_checksums.end() || it->first != step)
+        return true; // Nothing to compare with
+
+    return it->second == checksum;
+}
@@ -0,0 +1,144 @@
+/*
+ * This file is part of the Colobot: Gold Edition source code
+ * Copyright (C) 2001-2016, Daniel Roux, EPSITEC SA & TerranovaTeam
+ * http://epsitec.ch; http://colobot.info; http://github.com/colobot
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://gnu.org/licenses
+ */
+
+/**
+ * \file app/replay.h
+ * \brief Recording and deterministic replay of played missions
+ */
+
+#pragma once
+
+#include "common/event.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+/**
+ * \struct ReplayHeader
+ * \brief Everything needed to start the recorded mission again in the same state
+ */
+struct ReplayHeader
+{
+    //! Seed given to srand() before the mission starts
+    unsigned int seed = 0;
+    //! Scene in the same format as -runscene argument
+    std::string scene;
+    //! Length of the fixed simulation step [ns]
+    long long stepLength = 0;
+    //! Checksum of the world is stored every this many steps, 0 if never
+    int checksumInterval = 0;
+    //! Settings of -batch mode, they change rules of the match
+    //@{
+    bool batchMode = false;
+    float batchTimeLimit = 0.0f;
+    //@}
+};
+
+/**
+ * \struct ReplayProgram
+ * \brief Source of a program as it was when the recorded mission started or was restarted
+ */
+struct ReplayProgram
+{
+    //! Owner of the program, -1 for programs given by -teamprogram
+    int objectId = -1;
+    //! Index of the program in owner's program storage, or team for -teamprogram
+    int index = 0;
+    //! Number of restarts of the mission before the program was stored
+    int restart = 0;
+    std::string source;
+};
+
+/**
+ * \struct ReplayFrame
+ * \brief One iteration of the main loop: input events and number of simulation steps done after them
+ */
+struct ReplayFrame
+{
+    std::vector<Event> events;
+    int steps = 0;
+};
+
+//! Returns true for events coming from outside of the game, which have to be stored in the replay
+bool IsReplayInputEvent(EventType type);
+
+//! Computes checksum of the state of all objects, used to detect desynchronization of replay
+unsigned long long ComputeWorldChecksum();
+
+/**
+ * \class CReplayRecorder
+ * \brief Writes replay file while playing
+ *
+ * The file is written as text, one record per line. Main loop records all input
+ * events after they were processed by CInput (so they contain mouse position and key
+ * modifiers) followed by number of simulation steps done in this iteration.
+ */
+class CReplayRecorder
+{
+public:
+    //! Creates the file and writes the header
+    bool Open(const std::string& filename, const ReplayHeader& header);
+
+    void RecordProgram(const ReplayProgram& program);
+    void RecordEvent(const Event& event);
+    //! Ends the current frame, empty frames are not stored at all
+    void RecordFrameEnd(int steps);
+    void RecordChecksum(long long step, unsigned long long checksum);
+
+private:
+    std::ofstream m_file;
+    //! Any events were recorded in the current frame
+    bool m_frameStarted = false;
+};
+
+/**
+ * \class CReplayPlayer
+ * \brief Reads replay file recorded by CReplayRecorder and gives back its contents frame by frame
+ */
+class CReplayPlayer
+{
+public:
+    //! Loads the whole file, returns false if it is not a valid replay
+    bool Open(const std::string& filename);
+
+    const ReplayHeader& GetHeader() const;
+    //! Returns recorded program with given owner and index after given number of restarts, nullptr if there is none
+    const ReplayProgram* GetProgram(int objectId, int index, int restart = 0) const;
+    //! Returns all recorded programs
+    const std::vector<ReplayProgram>& GetPrograms() const;
+
+    //! Returns true if all frames were played
+    bool IsFinished() const;
+    //! Returns number of steps of the next frame, without removing it
+    int GetNextFrameSteps() const;
+    //! Removes the next frame and returns it
+    ReplayFrame TakeNextFrame();
+
+    //! Compares checksum with the recorded one, returns false if they differ
+    bool CheckChecksum(long long step, unsigned long long checksum) const;
+
+private:
+    ReplayHeader m_header;
+    std::vector<ReplayProgram> m_programs;
+    std::vector<ReplayFrame> m_frames;
+    std::size_t m_nextFrame = 0;
+    //! Pairs of (step, checksum), ordered by step
+    std::vector<std::pair<long long, unsigned long long>> m_checksums;
+};
@@ -0,0 +1,247 @@
+/*
+ * This file is part of the Colobot: Gold Edition source code
+ * Copyright (C) 2001-2016, Daniel Roux, EPSITEC SA & TerranovaTeam
+ * http://epsitec.ch; http://colobot.info; http://github.com/colobot
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://gnu.org/licenses
+ */
+
+#include "common/thread/job_system.h"
+
+#include <SDL_cpuinfo.h>
+#include <SDL_thread.h>
+
+#include <algorithm>
+#include <cassert>
+
+
+CJobSystem::CJobSystem(int workerCount)
+    : m_workerCount(0),
+      m_queuedBatches(0),
+      m_unfinishedBatches(0),
+      m_quit(false)
+{
+    if (workerCount < 0)
+        workerCount = std::max(0, SDL_GetCPUCount() - 1);
+
+    // Queue 0 belongs to the thread calling ParallelFor(). All queues and worker
+    // data are created before any thread starts, workers only read them.
+    for (int i = 0; i < workerCount + 1; ++i)
+        m_queues.push_back(std::unique_ptr<Queue>(new Queue()));
+
+    for (int i = 0; i < workerCount; ++i)
+    {
+        std::unique_ptr<WorkerData> worker(new WorkerData());
+        worker->jobSystem = this;
+        worker->queueIndex = i + 1;
+        m_workers.push_back(std::move(worker));
+    }
+
+    // Batches put in the queue of a thread which failed to start are stolen by others
+    for (auto& worker : m_workers)
+    {
+        worker->thread = SDL_CreateThread(WorkerMain, "Job worker", worker.get());
+        if (worker->thread == nullptr)
+            break;
+
+        ++m_workerCount;
+    }
+}
+
+CJobSystem::~CJobSystem()
+{
+    SDL_LockMutex(*m_mutex);
+    m_quit = true;
+    SDL_CondBroadcast(*m_workAvailable);
+    SDL_UnlockMutex(*m_mutex);
+
+    for (auto& worker : m_workers)
+    {
+        if (worker->thread != nullptr)
+            SDL_WaitThread(worker->thread, nullptr);
+    }
+}
+
+int CJobSystem::GetWorkerCount() const
+{
+    return m_workerCount;
+}
+
+void CJobSystem::ParallelFor(int count, const std::function<void(int)>& func, int batchSize)
+{
+    if (count <= 0)
+        return;
+
+    batchSize = std::max(1, batchSize);
+
+    if (m_workerCount == 0 || count <= batchSize)
+    {
+        for (int i = 0; i < count; ++i)
+            func(i);
+        return;
+    }
+
+    int queueCount = static_cast<int>(m_queues.size());
+    int batchCount = (count + batchSize - 1) / batchSize;
+
+    // Batches are counted before they are queued, a worker still busy
+    // with the previous ones may take them right away
+    SDL_LockMutex(*m_mutex);
+    assert(m_unfinishedBatches == 0); // nested ParallelFor() is not supported
+    m_queuedBatches += batchCount;
+    m_unfinishedBatches += batchCount;
+    SDL_UnlockMutex(*m_mutex);
+
+    for (int i = 0; i < batchCount; ++i)
+    {
+        Batch batch;
+        batch.func = &func;
+        batch.begin = i * batchSize;
+        batch.end = std::min(count, batch.begin + batchSize);
+
+        Queue& queue = *m_queues[i % queueCount];
+        SDL_LockMutex(*queue.mutex);
+        queue.batches.push_back(batch);
+        SDL_UnlockMutex(*queue.mutex);
+    }
+
+    SDL_LockMutex(*m_mutex);
+    SDL_CondBroadcast(*m_workAvailable);
+    SDL_UnlockMutex(*m_mutex);
+
+    Batch batch;
+    while (TryGetBatch(0, batch))
+        RunBatch(batch);
+
+    SDL_LockMutex(*m_mutex);
+    while (m_unfinishedBatches > 0)
+        SDL_CondWait(*m_workDone, *m_mutex);
+    SDL_UnlockMutex(*m_mutex);
+}
+
+bool CJobSystem::Submit(std::function<void()> job, JobPriority priority)
+{
+    if (m_workerCount == 0)
+        return false;
+
+    SDL_LockMutex(*m_mutex);
+    if (priority == JobPriority::High)
+        m_urgentJobs.push_back(std::move(job));
+    else
+        m_backgroundJobs.push_back(std::move(job));
+    SDL_CondBroadcast(*m_workAvailable);
+    SDL_UnlockMutex(*m_mutex);
+    return true;
+}
+
+int CJobSystem::WorkerMain(void* data)
+{
+    WorkerData* worker = static_cast<WorkerData*>(data);
+    worker->jobSystem->WorkerLoop(worker->queueIndex);
+    return 0;
+}
+
+void CJobSystem::WorkerLoop(int queueIndex)
+{
+    while (true)
+    {
+        Batch batch;
+        if (TryGetBatch(queueIndex, batch))
+        {
+            RunBatch(batch);
+            continue;
+        }
+
+        // Batches go first, somebody is waiting for them
+        std::function<void()> job;
+        if (TryGetBackgroundJob(job))
+        {
+            job();
+            continue;
+        }
+
+        SDL_LockMutex(*m_mutex);
+        while (!m_quit && m_queuedBatches == 0 &&
+               m_urgentJobs.empty() && m_backgroundJobs.empty())
+            SDL_CondWait(*m_workAvailable, *m_mutex);
+        bool quit = m_quit;
+        SDL_UnlockMutex(*m_mutex);
+
+        if (quit)
+            break;
+    }
+}
+
+bool CJobSystem::TryGetBatch(int queueIndex, Batch& batch)
+{
+    int queueCount = static_cast<int>(m_queues.size());
+    bool found = false;
+
+    // Own queue first (newest batch), then steal the oldest batch from others
+    for (int i = 0; i < queueCount && !found; ++i)
+    {
+        Queue& queue = *m_queues[(queueIndex + i) % queueCount];
+        SDL_LockMutex(*queue.mutex);
+        if (!queue.batches.empty())
+        {
+            if (i == 0)
+            {
+                batch = queue.batches.back();
+                queue.batches.pop_back();
+            }
+            else
+            {
+                batch = queue.batches.front();
+                queue.batches.pop_front();
+            }
+            found = true;
+        }
+        SDL_UnlockMutex(*queue.mutex);
+    }
+
+    if (found)
+    {
+        SDL_LockMutex(*m_mutex);
+        --m_queuedBatches;
+        SDL_UnlockMutex(*m_mutex);
+    }
+
+    return found;
+}
+
+bool CJobSystem::TryGetBackgroundJob(std::function<void()>& job)
+{
+    SDL_LockMutex(*m_mutex);
+    std::deque<std::function<void()>>& jobs = m_urgentJobs.empty() ? m_backgroundJobs : m_urgentJobs;
+    bool found = !jobs.empty();
+    if (found)
+    {
+        job = std::move(jobs.front());
+        jobs.pop_front();
+    }
+    SDL_UnlockMutex(*m_mutex);
+    return found;
+}
+
+void CJobSystem::RunBatch(const Batch& batch)
+{
+    for (int i = batch.begin; i < batch.end; ++i)
+        (*batch.func)(i);
+
+    SDL_LockMutex(*m_mutex);
+    --m_unfinishedBatches;
+    if (m_unfinishedBatches == 0)
+        SDL_CondBroadcast(*m_workDone);
+    SDL_UnlockMutex(*m_mutex);
+}
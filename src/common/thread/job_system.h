@@ -0,0 +1,132 @@
+/*
+ * This file is part of the Colobot: Gold Edition source code
+ * Copyright (C) 2001-2016, Daniel Roux, EPSITEC SA & TerranovaTeam
+ * http://epsitec.ch; http://colobot.info; http://github.com/colobot
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://gnu.org/licenses
+ */
+
+/**
+ * \file common/thread/job_system.h
+ * \brief CJobSystem - pool of worker threads running batches of jobs
+ */
+
+#pragma once
+
+#include "common/thread/sdl_cond_wrapper.h"
+#include "common/thread/sdl_mutex_wrapper.h"
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+struct SDL_Thread;
+
+/**
+ * \enum JobPriority
+ * \brief Order in which background jobs are started
+ */
+enum class JobPriority
+{
+    Normal,     //!< started after all jobs submitted before
+    High,       //!< started before any Normal job, e.g. when the main thread is waiting for the result
+};
+
+/**
+ * \class CJobSystem
+ * \brief Work-stealing pool of worker threads
+ *
+ * Every thread (the workers and the thread calling ParallelFor()) has its own
+ * queue of batches. Threads take batches from the back of their own queue and,
+ * when it is empty, steal from the front of other queues.
+ *
+ * Besides batches, single background jobs can be submitted with Submit(). They run
+ * on a worker thread when it has no batches to do, while the caller goes on.
+ * High priority jobs are started before any normal one waiting in the queue.
+ *
+ * The job system doesn't define any order in which jobs are run. To get results
+ * independent of the number of threads, jobs must only read shared state and write
+ * to their own output slot. Anything else (object creation, sounds, particles etc.)
+ * has to be done afterwards on the main thread.
+ */
+class CJobSystem
+{
+public:
+    //! Creates the pool; workerCount < 0 means one worker per additional CPU core
+    explicit CJobSystem(int workerCount = -1);
+    ~CJobSystem();
+
+    CJobSystem(const CJobSystem&) = delete;
+    CJobSystem& operator=(const CJobSystem&) = delete;
+
+    //! Returns number of worker threads (not counting the calling thread)
+    int GetWorkerCount() const;
+
+    //! Calls func(i) for every i in [0, count) and waits until all calls are finished
+    /**
+     * The calling thread takes part in the work. Indexes are split in batches
+     * of batchSize. Must not be called from inside a job.
+     */
+    void ParallelFor(int count, const std::function<void(int)>& func, int batchSize = 16);
+
+    //! Runs job on a worker thread, without waiting for it
+    /**
+     * Returns false if there are no worker threads; the job is not run then.
+     * Jobs not started yet when the job system is destroyed are dropped.
+     */
+    bool Submit(std::function<void()> job, JobPriority priority = JobPriority::Normal);
+
+private:
+    struct Batch
+    {
+        const std::function<void(int)>* func = nullptr;
+        int begin = 0;
+        int end = 0;
+    };
+
+    struct Queue
+    {
+        CSDLMutexWrapper mutex;
+        std::deque<Batch> batches;
+    };
+
+    struct WorkerData
+    {
+        CJobSystem* jobSystem = nullptr;
+        int queueIndex = 0;
+        SDL_Thread* thread = nullptr;
+    };
+
+    static int WorkerMain(void* data);
+    void WorkerLoop(int queueIndex);
+
+    bool TryGetBatch(int queueIndex, Batch& batch);
+    bool TryGetBackgroundJob(std::function<void()>& job);
+    void RunBatch(const Batch& batch);
+
+private:
+    std::vector<std::unique_ptr<Queue>> m_queues;
+    std::vector<std::unique_ptr<WorkerData>> m_workers;
+    int m_workerCount; // started threads, only used by the owning thread
+
+    CSDLMutexWrapper m_mutex;
+    CSDLCondWrapper m_workAvailable;
+    CSDLCondWrapper m_workDone;
+    int m_queuedBatches;
+    int m_unfinishedBatches;
+    std::deque<std::function<void()>> m_backgroundJobs;
+    std::deque<std::function<void()>> m_urgentJobs;
+    bool m_quit;
+};
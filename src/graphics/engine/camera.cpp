@@ -53,22 +53,32 @@ namespace Gfx
 const float MOUSE_EDGE_MARGIN = 0.01f;
 
 //! Changes the level of transparency of an object and objects transported (battery & cargo)
-void SetTransparency(CObject* obj, float value)
+//! Handles of all changed objects are appended to changed, if given
+void SetTransparency(CObject* obj, float value, std::vector<ObjectHandle>* changed = nullptr)
 {
+    CObjectManager* objectManager = CObjectManager::GetInstancePointer();
+
     obj->SetTransparency(value);
+    if (changed != nullptr) changed->push_back(objectManager->GetObjectHandle(obj));
 
     if (obj->Implements(ObjectInterfaceType::Carrier))
     {
         CObject* cargo = dynamic_cast<CCarrierObject*>(obj)->GetCargo();
         if (cargo != nullptr)
+        {
             cargo->SetTransparency(value);
+            if (changed != nullptr) changed->push_back(objectManager->GetObjectHandle(cargo));
+        }
     }
 
     if (obj->Implements(ObjectInterfaceType::Powered))
     {
         CObject* power = dynamic_cast<CPoweredObject*>(obj)->GetPower();
         if (power != nullptr)
+        {
             power->SetTransparency(value);
+            if (changed != nullptr) changed->push_back(objectManager->GetObjectHandle(power));
+        }
     }
 }
 
@@ -255,15 +265,7 @@ CObject* CCamera::GetControllingObject()
 void CCamera::SetType(CameraType type)
 {
     if (m_type == CAM_TYPE_BACK)
-    {
-        for (CObject* obj : CObjectManager::GetInstancePointer()->GetAllObjects())
-        {
-            if (IsObjectBeingTransported(obj))
-                continue;
-
-            SetTransparency(obj, 0.0f);  // opaque object
-        }
-    }
+        ResetTransparency();
 
     if (type == CAM_TYPE_VISIT)  // *** -> visit ?
     {
@@ -501,9 +503,9 @@ void CCamera::EffectFrame(const Event &event)
     if ( m_effectType == CAM_EFFECT_TERRAFORM )
     {
         m_effectProgress += event.rTime * 0.7f;
-        m_effectOffset.x = (Math::Rand() - 0.5f) * 10.0f;
-        m_effectOffset.y = (Math::Rand() - 0.5f) * 10.0f;
-        m_effectOffset.z = (Math::Rand() - 0.5f) * 10.0f;
+        m_effectOffset.x = (Math::EffectRand() - 0.5f) * 10.0f;
+        m_effectOffset.y = (Math::EffectRand() - 0.5f) * 10.0f;
+        m_effectOffset.z = (Math::EffectRand() - 0.5f) * 10.0f;
 
         force *= 1.0f-m_effectProgress;
     }
@@ -511,9 +513,9 @@ void CCamera::EffectFrame(const Event &event)
     if ( m_effectType == CAM_EFFECT_EXPLO )
     {
         m_effectProgress += event.rTime * 1.0f;
-        m_effectOffset.x = (Math::Rand() - 0.5f)  *5.0f;
-        m_effectOffset.y = (Math::Rand() - 0.5f) * 5.0f;
-        m_effectOffset.z = (Math::Rand() - 0.5f) * 5.0f;
+        m_effectOffset.x = (Math::EffectRand() - 0.5f)  *5.0f;
+        m_effectOffset.y = (Math::EffectRand() - 0.5f) * 5.0f;
+        m_effectOffset.z = (Math::EffectRand() - 0.5f) * 5.0f;
 
         force *= 1.0f-m_effectProgress;
     }
@@ -521,9 +523,9 @@ void CCamera::EffectFrame(const Event &event)
     if ( m_effectType == CAM_EFFECT_SHOT )
     {
         m_effectProgress += event.rTime * 1.0f;
-        m_effectOffset.x = (Math::Rand() - 0.5f) * 2.0f;
-        m_effectOffset.y = (Math::Rand() - 0.5f) * 2.0f;
-        m_effectOffset.z = (Math::Rand() - 0.5f) * 2.0f;
+        m_effectOffset.x = (Math::EffectRand() - 0.5f) * 2.0f;
+        m_effectOffset.y = (Math::EffectRand() - 0.5f) * 2.0f;
+        m_effectOffset.z = (Math::EffectRand() - 0.5f) * 2.0f;
 
         force *= 1.0f-m_effectProgress;
     }
@@ -532,24 +534,24 @@ void CCamera::EffectFrame(const Event &event)
     {
         m_effectProgress += event.rTime * 5.0f;
         m_effectOffset.y = sinf(m_effectProgress * Math::PI) * 1.5f;
-        m_effectOffset.x = (Math::Rand() - 0.5f) * 1.0f * (1.0f - m_effectProgress);
-        m_effectOffset.z = (Math::Rand() - 0.5f) * 1.0f * (1.0f - m_effectProgress);
+        m_effectOffset.x = (Math::EffectRand() - 0.5f) * 1.0f * (1.0f - m_effectProgress);
+        m_effectOffset.z = (Math::EffectRand() - 0.5f) * 1.0f * (1.0f - m_effectProgress);
     }
 
     if ( m_effectType == CAM_EFFECT_VIBRATION )
     {
         m_effectProgress += event.rTime * 0.1f;
-        m_effectOffset.y = (Math::Rand() - 0.5f) * 1.0f * (1.0f - m_effectProgress);
-        m_effectOffset.x = (Math::Rand() - 0.5f) * 1.0f * (1.0f - m_effectProgress);
-        m_effectOffset.z = (Math::Rand() - 0.5f) * 1.0f * (1.0f - m_effectProgress);
+        m_effectOffset.y = (Math::EffectRand() - 0.5f) * 1.0f * (1.0f - m_effectProgress);
+        m_effectOffset.x = (Math::EffectRand() - 0.5f) * 1.0f * (1.0f - m_effectProgress);
+        m_effectOffset.z = (Math::EffectRand() - 0.5f) * 1.0f * (1.0f - m_effectProgress);
     }
 
     if ( m_effectType == CAM_EFFECT_PET )
     {
         m_effectProgress += event.rTime  *5.0f;
-        m_effectOffset.x = (Math::Rand() - 0.5f) * 0.2f;
-        m_effectOffset.y = (Math::Rand() - 0.5f) * 2.0f;
-        m_effectOffset.z = (Math::Rand() - 0.5f) * 0.2f;
+        m_effectOffset.x = (Math::EffectRand() - 0.5f) * 0.2f;
+        m_effectOffset.y = (Math::EffectRand() - 0.5f) * 2.0f;
+        m_effectOffset.z = (Math::EffectRand() - 0.5f) * 0.2f;
     }
 
     float dist = Math::Distance(m_eyePt, m_effectPos);
@@ -674,7 +676,7 @@ void CCamera::OverFrame(const Event &event)
     if (m_overType == CAM_OVER_EFFECT_LIGHTNING)
     {
         Color color;
-        if (rand() % 2 == 0)
+        if (Math::EffectRandom() % 2 == 0)
         {
             color.r = m_overColor.r * m_overForce;
             color.g = m_overColor.g * m_overForce;
@@ -833,32 +835,38 @@ void CCamera::IsCollisionBack()
     max.y = Math::Max(m_actualEye.y, m_actualLookat.y);
     max.z = Math::Max(m_actualEye.z, m_actualLookat.z);
 
-    for (CObject* obj : CObjectManager::GetInstancePointer()->GetAllObjects())
+    ResetTransparency();
+
+    if ( iType == OBJECT_BASE     ||  // building?
+         iType == OBJECT_DERRICK  ||
+         iType == OBJECT_FACTORY  ||
+         iType == OBJECT_STATION  ||
+         iType == OBJECT_CONVERT  ||
+         iType == OBJECT_REPAIR   ||
+         iType == OBJECT_DESTROYER||
+         iType == OBJECT_TOWER    ||
+         iType == OBJECT_RESEARCH ||
+         iType == OBJECT_RADAR    ||
+         iType == OBJECT_ENERGY   ||
+         iType == OBJECT_LABO     ||
+         iType == OBJECT_NUCLEAR  ||
+         iType == OBJECT_PARA     ||
+         iType == OBJECT_SAFE     ||
+         iType == OBJECT_HUSTON   )  return;
+
+    // Objects behind a hill are hidden by it anyway
+    float terrainDist = Math::Distance(m_actualEye, m_actualLookat);
+    Math::Vector hit;
+    if (m_terrain->IntersectRay(m_actualEye, m_actualLookat-m_actualEye, terrainDist, hit))
+        terrainDist = Math::Distance(m_actualEye, hit);
+
+    for (CObject* obj : CObjectManager::GetInstancePointer()->GetObjectsNearBox(min, max))
     {
         if (IsObjectBeingTransported(obj))
             continue;
 
-        SetTransparency(obj, 0.0f);  // opaque object
-
         if (obj == m_cameraObj) continue;
 
-        if ( iType == OBJECT_BASE     ||  // building?
-             iType == OBJECT_DERRICK  ||
-             iType == OBJECT_FACTORY  ||
-             iType == OBJECT_STATION  ||
-             iType == OBJECT_CONVERT  ||
-             iType == OBJECT_REPAIR   ||
-             iType == OBJECT_DESTROYER||
-             iType == OBJECT_TOWER    ||
-             iType == OBJECT_RESEARCH ||
-             iType == OBJECT_RADAR    ||
-             iType == OBJECT_ENERGY   ||
-             iType == OBJECT_LABO     ||
-             iType == OBJECT_NUCLEAR  ||
-             iType == OBJECT_PARA     ||
-             iType == OBJECT_SAFE     ||
-             iType == OBJECT_HUSTON   )  continue;
-
         ObjectType oType = obj->GetType();
         if ( oType == OBJECT_HUMAN  ||
              oType == OBJECT_TECH   ||
@@ -897,14 +905,29 @@ void CCamera::IsCollisionBack()
 
         float len = Math::Distance(m_actualEye, proj);
         if (len > del) continue;
+        if (len-oRadius > terrainDist) continue;
+
+        SetTransparency(obj, 1.0f, &m_transparentObjects);  // transparent object
+    }
+}
 
-        SetTransparency(obj, 1.0f);  // transparent object
+void CCamera::ResetTransparency()
+{
+    // Objects are reset one by one, as cargo may have been dropped meanwhile;
+    // handles of deleted objects don't resolve even if their ids were reused
+    CObjectManager* objectManager = CObjectManager::GetInstancePointer();
+    for (ObjectHandle handle : m_transparentObjects)
+    {
+        CObject* obj = objectManager->GetObjectByHandle(handle);
+        if (obj != nullptr)
+            obj->SetTransparency(0.0f);  // opaque object
     }
+    m_transparentObjects.clear();
 }
 
 void CCamera::IsCollisionFix(Math::Vector &eye, Math::Vector lookat)
 {
-    for (CObject* obj : CObjectManager::GetInstancePointer()->GetAllObjects())
+    for (CObject* obj : CObjectManager::GetInstancePointer()->GetObjectsNearBox(eye, eye))
     {
         if (obj == m_cameraObj) continue;
 
@@ -26,6 +26,8 @@
 
 #include "graphics/engine/engine.h"
 
+#include "object/object_manager.h"
+
 
 class CObject;
 class CRobotMain;
@@ -264,6 +266,8 @@ protected:
     void        IsCollision(Math::Vector &eye, Math::Vector lookat);
     //! Avoid the obstacles (CAM_TYPE_BACK)
     void        IsCollisionBack();
+    //! Makes objects which were made transparent by IsCollisionBack() opaque again
+    void        ResetTransparency();
     //! Avoid the obstacles (CAM_TYPE_FIX or CAM_TYPE_PLANE)
     void        IsCollisionFix(Math::Vector &eye, Math::Vector lookat);
 
@@ -301,6 +305,8 @@ protected:
     CameraSmooth m_smooth;
     //! Object linked to the camera
     CObject*     m_cameraObj;
+    //! Objects made transparent because they hide the camera object
+    std::vector<ObjectHandle> m_transparentObjects;
 
     //! Remaining time of initial camera entry animation
     float        m_initDelay;
@@ -58,6 +58,7 @@
 
 #include "ui/controls/interface.h"
 
+#include <algorithm>
 #include <iomanip>
 #include <SDL_surface.h>
 #include <SDL_thread.h>
@@ -182,6 +183,10 @@ CEngine::CEngine(CApplication *app, CSystemUtils* systemUtils)
     m_highlightTime = 0.0f;
     m_eyePt    = Math::Vector(0.0f, 0.0f, 0.0f);
     m_lookatPt = Math::Vector(0.0f, 0.0f, 1.0f);
+    m_upVec    = Math::Vector(0.0f, 1.0f, 0.0f);
+    m_prevEyePt    = m_eyePt;
+    m_prevLookatPt = m_lookatPt;
+    m_viewInterpolate = false;
     m_drawWorld = true;
     m_drawFront = false;
     m_particleDensity = 1.0f;
@@ -235,6 +240,15 @@ CEngine::CEngine(CApplication *app, CSystemUtils* systemUtils)
 
     m_lastState = -1;
     m_statisticTriangle = 0;
+    m_firstFreeObject = 0;
+    m_firstFreeShadowSpot = 0;
+    m_statisticPhysicsAwake = 0;
+    m_statisticPhysicsSleeping = 0;
+    m_statisticPathSearches = 0;
+    m_statisticPathFound = 0;
+    m_statisticPathTime = 0.0f;
+    m_statisticPathCacheHits = 0;
+    m_statisticPathCacheMisses = 0;
     m_fps = 0.0f;
     m_firstGroundSpot = false;
 }
@@ -606,6 +620,25 @@ void CEngine::SetStatisticPos(Math::Vector pos)
     m_statisticPos = pos;
 }
 
+void CEngine::SetStatisticPhysics(int awake, int sleeping)
+{
+    m_statisticPhysicsAwake = awake;
+    m_statisticPhysicsSleeping = sleeping;
+}
+
+void CEngine::SetStatisticPathSearch(int searches, int found, float time)
+{
+    m_statisticPathSearches = searches;
+    m_statisticPathFound = found;
+    m_statisticPathTime = time;
+}
+
+void CEngine::SetStatisticPathCache(int hits, int misses)
+{
+    m_statisticPathCacheHits = hits;
+    m_statisticPathCacheMisses = misses;
+}
+
 void CEngine::SetTimerDisplay(const std::string& text)
 {
     m_timerText = text;
@@ -880,7 +913,8 @@ void CEngine::DebugObject(int objRank)
 
 int CEngine::CreateObject()
 {
-    int objRank = 0;
+    // Ranks are still given out lowest first, the search just skips the part known to be taken
+    int objRank = m_firstFreeObject;
     for ( ; objRank < static_cast<int>( m_objects.size() ); objRank++)
     {
         if (! m_objects[objRank].used)
@@ -895,6 +929,7 @@ int CEngine::CreateObject()
 
 
     m_objects[objRank].used = true;
+    m_firstFreeObject = objRank+1;
 
     Math::Matrix mat;
     mat.LoadIdentity();
@@ -908,10 +943,18 @@ int CEngine::CreateObject()
     return objRank;
 }
 
+void CEngine::ReserveObjects(int count)
+{
+    m_objects.reserve(m_objects.size() + count);
+    m_shadowSpots.reserve(m_shadowSpots.size() + count);
+}
+
 void CEngine::DeleteAllObjects()
 {
     m_objects.clear();
     m_shadowSpots.clear();
+    m_firstFreeObject = 0;
+    m_firstFreeShadowSpot = 0;
 
     DeleteAllGroundSpots();
 }
@@ -922,6 +965,7 @@ void CEngine::DeleteObject(int objRank)
 
     // Mark object as deleted
     m_objects[objRank].used = false;
+    m_firstFreeObject = std::min(m_firstFreeObject, objRank);
 
     // Delete associated shadows
     DeleteShadowSpot(objRank);
@@ -961,6 +1005,7 @@ void CEngine::SetObjectTransform(int objRank, const Math::Matrix& transform)
     assert(objRank >= 0 && objRank < static_cast<int>( m_objects.size() ));
 
     m_objects[objRank].transform = transform;
+    m_objects[objRank].renderTransform = transform;
 }
 
 void CEngine::GetObjectTransform(int objRank, Math::Matrix& transform)
@@ -970,6 +1015,56 @@ void CEngine::GetObjectTransform(int objRank, Math::Matrix& transform)
     transform = m_objects[objRank].transform;
 }
 
+void CEngine::BeginSimulationStep()
+{
+    for (auto& object : m_objects)
+    {
+        if (! object.used)
+            continue;
+
+        object.prevTransform = object.transform;
+        object.interpolate = true;
+    }
+
+    m_prevEyePt = m_eyePt;
+    m_prevLookatPt = m_lookatPt;
+    m_viewInterpolate = true;
+}
+
+void CEngine::SetRenderInterpolation(float alpha)
+{
+    alpha = Math::Norm(alpha);
+
+    // Objects that moved further than this in one step were teleported, don't smear them
+    const float MAX_INTERPOLATED_DISTANCE = 20.0f;
+
+    for (auto& object : m_objects)
+    {
+        if (! object.used)
+            continue;
+
+        object.renderTransform = object.transform;
+        if (! object.interpolate || alpha == 1.0f)
+            continue;
+
+        Math::Vector prevPos(object.prevTransform.Get(1, 4), object.prevTransform.Get(2, 4), object.prevTransform.Get(3, 4));
+        Math::Vector pos(object.transform.Get(1, 4), object.transform.Get(2, 4), object.transform.Get(3, 4));
+        if (Math::Distance(prevPos, pos) > MAX_INTERPOLATED_DISTANCE)
+            continue;
+
+        for (int i = 0; i < 16; ++i)
+            object.renderTransform.m[i] = object.prevTransform.m[i] + (object.transform.m[i] - object.prevTransform.m[i]) * alpha;
+    }
+
+    m_matViewRender = m_matView;
+    if (m_viewInterpolate && alpha != 1.0f)
+    {
+        Math::Vector eyePt = m_prevEyePt + (m_eyePt - m_prevEyePt) * alpha;
+        Math::Vector lookatPt = m_prevLookatPt + (m_lookatPt - m_prevLookatPt) * alpha;
+        Math::LoadViewMatrix(m_matViewRender, eyePt, lookatPt, m_upVec);
+    }
+}
+
 void CEngine::SetObjectDrawWorld(int objRank, bool draw)
 {
     assert(objRank >= 0 && objRank < static_cast<int>( m_objects.size() ));
@@ -1333,7 +1428,7 @@ void CEngine::CreateShadowSpot(int objRank)
     if (m_objects[objRank].shadowRank != -1)
         return;
 
-    int index = 0;
+    int index = m_firstFreeShadowSpot;
     for ( ; index < static_cast<int>( m_shadowSpots.size() ); index++)
     {
         if (! m_shadowSpots[index].used)
@@ -1349,6 +1444,7 @@ void CEngine::CreateShadowSpot(int objRank)
     m_shadowSpots[index].used = true;
     m_shadowSpots[index].objRank = objRank;
     m_shadowSpots[index].height = 0.0f;
+    m_firstFreeShadowSpot = index+1;
 
     m_objects[objRank].shadowRank = index;
 }
@@ -1365,10 +1461,27 @@ void CEngine::DeleteShadowSpot(int objRank)
 
     m_shadowSpots[shadowRank].used = false;
     m_shadowSpots[shadowRank].objRank = -1;
+    m_firstFreeShadowSpot = std::min(m_firstFreeShadowSpot, shadowRank);
 
     m_objects[objRank].shadowRank = -1;
 }
 
+void CEngine::CopyShadowSpot(int sourceObjRank, int destObjRank)
+{
+    assert(sourceObjRank >= 0 && sourceObjRank < static_cast<int>( m_objects.size() ));
+    assert(destObjRank >= 0 && destObjRank < static_cast<int>( m_objects.size() ));
+
+    int sourceShadowRank = m_objects[sourceObjRank].shadowRank;
+    if (sourceShadowRank == -1)
+        return;
+
+    CreateShadowSpot(destObjRank);
+
+    int destShadowRank = m_objects[destObjRank].shadowRank;
+    m_shadowSpots[destShadowRank] = m_shadowSpots[sourceShadowRank];
+    m_shadowSpots[destShadowRank].objRank = destObjRank;
+}
+
 void CEngine::SetObjectShadowSpotHide(int objRank, bool hide)
 {
     assert(objRank >= 0 && objRank < static_cast<int>( m_objects.size() ));
@@ -1795,8 +1908,8 @@ int CEngine::DetectObject(Math::Point mouse, Math::Vector& targetPos, bool terra
         if (! m_objects[objRank].used)
             continue;
 
-        if (m_objects[objRank].type == ENG_OBJTYPE_TERRAIN && !terrain)
-            continue;
+        if (m_objects[objRank].type == ENG_OBJTYPE_TERRAIN)
+            continue;  // see below
 
         if (! DetectBBox(objRank, mouse))
             continue;
@@ -1849,6 +1962,29 @@ int CEngine::DetectObject(Math::Point mouse, Math::Vector& targetPos, bool terra
         }
     }
 
+    // The ground is tested directly on the relief, rather than triangle by triangle
+    if (terrain && m_terrain != nullptr)
+    {
+        Math::Matrix viewInverse = m_matView.Inverse();
+        Math::Vector eye = Math::Transform(viewInverse, Math::Vector(0.0f, 0.0f, 0.0f));
+        Math::Vector dir = Math::Transform(viewInverse, Math::Vector(
+            (mouse.x*2.0f-1.0f)*m_matProj.Inverse().Get(1,1),
+            (mouse.y*2.0f-1.0f)*m_matProj.Inverse().Get(2,2),
+            1.0f)) - eye;
+
+        if (m_terrain->IntersectRay(eye, dir, m_deepView[0]*2.0f, pos))
+        {
+            float dist = Math::Transform(m_matView, pos).z;
+            int objRank = m_terrain->GetMosaicObjRank(pos);
+            if (objRank != -1 && dist >= 2.0f && dist < min)
+            {
+                min = dist;
+                nearest = objRank;
+                targetPos = pos;
+            }
+        }
+    }
+
     return nearest;
 }
 
@@ -2233,6 +2369,8 @@ void CEngine::SetViewParams(const Math::Vector &eyePt, const Math::Vector &looka
     m_eyeDirV = Math::RotateAngle(Math::DistanceProjected(eyePt, lookatPt), eyePt.y - lookatPt.y);
 
     Math::LoadViewMatrix(m_matView, eyePt, lookatPt, upVec);
+    m_matViewRender = m_matView;
+    m_upVec = upVec;
 
     if (m_sound == nullptr)
         m_sound = m_app->GetSound();
@@ -3256,7 +3394,7 @@ void CEngine::Draw3DScene()
     m_device->SetFogParams(FOG_LINEAR, m_fogColor[m_rankView], fogStart, fogEnd, 1.0f);
 
     m_device->SetTransform(TRANSFORM_PROJECTION, m_matProj);
-    m_device->SetTransform(TRANSFORM_VIEW, m_matView);
+    m_device->SetTransform(TRANSFORM_VIEW, m_matViewRender);
 
     m_water->DrawBack();  // draws water background
 
@@ -3279,7 +3417,7 @@ void CEngine::Draw3DScene()
         if (! m_objects[objRank].drawWorld)
             continue;
 
-        m_device->SetTransform(TRANSFORM_WORLD, m_objects[objRank].transform);
+        m_device->SetTransform(TRANSFORM_WORLD, m_objects[objRank].renderTransform);
 
         if (! IsVisible(objRank))
             continue;
@@ -3339,7 +3477,7 @@ void CEngine::Draw3DScene()
         if (! m_objects[objRank].drawWorld)
             continue;
 
-        m_device->SetTransform(TRANSFORM_WORLD, m_objects[objRank].transform);
+        m_device->SetTransform(TRANSFORM_WORLD, m_objects[objRank].renderTransform);
 
         if (! IsVisible(objRank))
             continue;
@@ -3401,7 +3539,7 @@ void CEngine::Draw3DScene()
             if (! m_objects[objRank].drawWorld)
                 continue;
 
-            m_device->SetTransform(TRANSFORM_WORLD, m_objects[objRank].transform);
+            m_device->SetTransform(TRANSFORM_WORLD, m_objects[objRank].renderTransform);
 
             if (! IsVisible(objRank))
                 continue;
@@ -3845,7 +3983,7 @@ void CEngine::RenderShadowMap()
             m_device->SetRenderState(RENDER_STATE_CULLING, false);
         }
 
-        m_device->SetTransform(TRANSFORM_WORLD, m_objects[objRank].transform);
+        m_device->SetTransform(TRANSFORM_WORLD, m_objects[objRank].renderTransform);
 
         if (!IsVisible(objRank))
             continue;
@@ -4053,7 +4191,7 @@ void CEngine::DrawInterface()
         float fogEnd = m_deepView[m_rankView] * m_clippingDistance;
         m_device->SetFogParams(FOG_LINEAR, m_fogColor[m_rankView], fogStart, fogEnd, 1.0f);
 
-        m_device->SetTransform(TRANSFORM_VIEW, m_matView);
+        m_device->SetTransform(TRANSFORM_VIEW, m_matViewRender);
 
         for (int objRank = 0; objRank < static_cast<int>(m_objects.size()); objRank++)
         {
@@ -4066,7 +4204,7 @@ void CEngine::DrawInterface()
             if (! m_objects[objRank].drawFront)
                 continue;
 
-            m_device->SetTransform(TRANSFORM_WORLD, m_objects[objRank].transform);
+            m_device->SetTransform(TRANSFORM_WORLD, m_objects[objRank].renderTransform);
 
             if (! IsVisible(objRank))
                 continue;
@@ -5030,7 +5168,7 @@ void CEngine::DrawStats()
 
     float height = m_text->GetAscent(FONT_COLOBOT, 13.0f);
     float width = 0.25f;
-    const int TOTAL_LINES = 20;
+    const int TOTAL_LINES = 27;
 
     Math::Point pos(0.05f * m_size.x/m_size.y, 0.05f + TOTAL_LINES * height);
 
@@ -5100,6 +5238,8 @@ void CEngine::DrawStats()
     drawStatsValue  ("    Engine update",     engineUpdate);
     drawStatsCounter("    Particle update",   PCNT_UPDATE_PARTICLE);
     drawStatsCounter("    Game update",       PCNT_UPDATE_GAME);
+    drawStatsCounter("        Conditions",    PCNT_UPDATE_CONDITIONS);
+    drawStatsCounter("        Physics",       PCNT_UPDATE_PHYSICS_PREPARE);
     drawStatsValue(  "    Other update",      otherUpdate);
     drawStatsLine("", "");
     drawStatsCounter("Frame render",      PCNT_RENDER_ALL);
@@ -5113,6 +5253,13 @@ void CEngine::DrawStats()
     drawStatsCounter("Swap buffers & VSync",  PCNT_SWAP_BUFFERS);
     drawStatsLine("", "");
     drawStatsLine(   "Triangles",         StrUtils::ToString<int>(m_statisticTriangle));
+    drawStatsLine(   "Physics awake/sleeping", StrUtils::ToString<int>(m_statisticPhysicsAwake) + " / " +
+                                               StrUtils::ToString<int>(m_statisticPhysicsSleeping));
+    drawStatsLine(   "Paths found/searched", StrUtils::ToString<int>(m_statisticPathFound) + " / " +
+                                             StrUtils::ToString<int>(m_statisticPathSearches));
+    drawStatsValue(  "Path search [ms]",  m_statisticPathTime);
+    drawStatsLine(   "Path cache hits/misses", StrUtils::ToString<int>(m_statisticPathCacheHits) + " / " +
+                                               StrUtils::ToString<int>(m_statisticPathCacheMisses));
     drawStatsValue(  "FPS",               m_fps);
     drawStatsLine("", "");
     str.str("");
@@ -5224,73 +5371,34 @@ void CEngine::UpdateObjectShadowSpotNormal(int objRank)
     Math::Vector pos = m_shadowSpots[shadowRank].pos;
     float radius = m_shadowSpots[shadowRank].radius;
 
-    Math::Vector n[20];
-    Math::Vector norm;
-    int i = 0;
+    // Offsets of the locations and their weights
+    const float offset[9][2] =
+    {
+        {  0.0f,  0.0f },
+        {  0.6f,  0.6f }, { -0.6f,  0.6f }, {  0.6f, -0.6f }, { -0.6f, -0.6f },
+        {  1.0f,  1.0f }, { -1.0f,  1.0f }, {  1.0f, -1.0f }, { -1.0f, -1.0f },
+    };
+    const float weight[9] = { 3.0f, 2.0f, 2.0f, 2.0f, 2.0f, 1.0f, 1.0f, 1.0f, 1.0f };
+
+    Math::Vector shPos[9];
+    Math::Vector n[9];
+    for (int j = 0; j < 9; j++)
+    {
+        shPos[j] = pos;
+        shPos[j].x += radius*offset[j][0];
+        shPos[j].z += radius*offset[j][1];
+        n[j] = Math::Vector(0.0f, 1.0f, 0.0f);  // outside the terrain
+    }
+    m_terrain->GetNormals(shPos, n, 9);
 
-    m_terrain->GetNormal(norm, pos);
-    n[i++] = norm;
-    n[i++] = norm;
-    n[i++] = norm;
-
-    Math::Vector shPos = pos;
-    shPos.x += radius*0.6f;
-    shPos.z += radius*0.6f;
-    m_terrain->GetNormal(norm, shPos);
-    n[i++] = norm;
-    n[i++] = norm;
-
-    shPos = pos;
-    shPos.x -= radius*0.6f;
-    shPos.z += radius*0.6f;
-    m_terrain->GetNormal(norm, shPos);
-    n[i++] = norm;
-    n[i++] = norm;
-
-    shPos = pos;
-    shPos.x += radius*0.6f;
-    shPos.z -= radius*0.6f;
-    m_terrain->GetNormal(norm, shPos);
-    n[i++] = norm;
-    n[i++] = norm;
-
-    shPos = pos;
-    shPos.x -= radius*0.6f;
-    shPos.z -= radius*0.6f;
-    m_terrain->GetNormal(norm, shPos);
-    n[i++] = norm;
-    n[i++] = norm;
-
-    shPos = pos;
-    shPos.x += radius;
-    shPos.z += radius;
-    m_terrain->GetNormal(norm, shPos);
-    n[i++] = norm;
-
-    shPos = pos;
-    shPos.x -= radius;
-    shPos.z += radius;
-    m_terrain->GetNormal(norm, shPos);
-    n[i++] = norm;
-
-    shPos = pos;
-    shPos.x += radius;
-    shPos.z -= radius;
-    m_terrain->GetNormal(norm, shPos);
-    n[i++] = norm;
-
-    shPos = pos;
-    shPos.x -= radius;
-    shPos.z -= radius;
-    m_terrain->GetNormal(norm, shPos);
-    n[i++] = norm;
-
-    norm.LoadZero();
-    for (int j = 0; j < i; j++)
-    {
-        norm += n[j];
-    }
-    norm /= static_cast<float>(i);  // average vector
+    Math::Vector norm;
+    float total = 0.0f;
+    for (int j = 0; j < 9; j++)
+    {
+        norm += n[j]*weight[j];
+        total += weight[j];
+    }
+    norm /= total;  // average vector
 
     m_shadowSpots[shadowRank].normal = norm;
 }
@@ -277,6 +277,12 @@ struct EngineObject
     EngineObjectType       type = ENG_OBJTYPE_NULL;
     //! Transformation matrix
     Math::Matrix           transform;
+    //! Transformation matrix at the beginning of the last simulation step
+    Math::Matrix           prevTransform;
+    //! Transformation matrix used for drawing (interpolated between simulation steps)
+    Math::Matrix           renderTransform;
+    //! If true, prevTransform is valid and renderTransform is interpolated
+    bool                   interpolate = false;
     //! Distance to object from eye point
     float                  distance = 0.0f;
     //! Rank of the associated shadow
@@ -686,6 +692,12 @@ public:
 
     //! Sets the coordinates to display in stats window
     void            SetStatisticPos(Math::Vector pos);
+    //! Sets the number of simulated and sleeping physics bodies to display in stats window
+    void            SetStatisticPhysics(int awake, int sleeping);
+    //! Sets the number of goto() path searches, found paths and mean search time [ms] to display in stats window
+    void            SetStatisticPathSearch(int searches, int found, float time);
+    //! Sets the number of hits and misses of the goto() path cache to display in stats window
+    void            SetStatisticPathCache(int hits, int misses);
 
     //! Sets text to display as mission timer
     void            SetTimerDisplay(const std::string& text);
@@ -745,6 +757,8 @@ public:
 
     //! Creates a new object and returns its rank
     int             CreateObject();
+    //! Makes room for the given number of objects and shadows to be created in bulk
+    void            ReserveObjects(int count);
     //! Deletes all objects, shadows and ground spots
     void            DeleteAllObjects();
     //! Deletes the given object
@@ -768,6 +782,14 @@ public:
     void            GetObjectTransform(int objRank, Math::Matrix& transform);
     //@}
 
+    //@{
+    //! Interpolation of objects and camera between fixed simulation steps
+    //! Remembers the current state as the start of interpolation; called before each simulation step
+    void            BeginSimulationStep();
+    //! Sets the point between the last two simulation steps to draw (0 = previous, 1 = current)
+    void            SetRenderInterpolation(float alpha);
+    //@}
+
     //! Sets drawWorld for given object
     void            SetObjectDrawWorld(int objRank, bool draw);
     //! Sets drawFront for given object
@@ -813,6 +835,8 @@ public:
     void            CreateShadowSpot(int objRank);
     //! Deletes the shadow for given object
     void            DeleteShadowSpot(int objRank);
+    //! Gives the destination object a shadow with the same params as the source object, if it has one
+    void            CopyShadowSpot(int sourceObjRank, int destObjRank);
 
     //@{
     //! Management of different shadow params
@@ -1316,6 +1340,8 @@ protected:
     Math::Matrix    m_matProj;
     //! View matrix for 3D scene
     Math::Matrix    m_matView;
+    //! View matrix used for drawing (interpolated between simulation steps)
+    Math::Matrix    m_matViewRender;
     //! Camera angle for 3D scene
     float           m_focus;
 
@@ -1344,6 +1370,10 @@ protected:
     std::vector<EngineObject>     m_objects;
     //! Shadow list
     std::vector<EngineShadow>     m_shadowSpots;
+    //! No object in m_objects below this rank is free
+    int                           m_firstFreeObject;
+    //! No shadow in m_shadowSpots below this rank is free
+    int                           m_firstFreeShadowSpot;
     //! Ground spot list
     std::vector<EngineGroundSpot> m_groundSpots;
     //! Ground mark
@@ -1353,6 +1383,13 @@ protected:
     Math::Vector    m_eyePt;
     //! Camera target
     Math::Vector    m_lookatPt;
+    //! Camera up vector
+    Math::Vector    m_upVec;
+    //! Camera location and target at the beginning of the last simulation step
+    Math::Vector    m_prevEyePt;
+    Math::Vector    m_prevLookatPt;
+    //! If true, m_prevEyePt and m_prevLookatPt are valid
+    bool            m_viewInterpolate;
     float           m_eyeDirH;
     float           m_eyeDirV;
     int             m_rankView;
@@ -1364,6 +1401,13 @@ protected:
     Color           m_waterAddColor;
     int             m_statisticTriangle;
     Math::Vector    m_statisticPos;
+    int             m_statisticPhysicsAwake;
+    int             m_statisticPhysicsSleeping;
+    int             m_statisticPathSearches;
+    int             m_statisticPathFound;
+    float           m_statisticPathTime;
+    int             m_statisticPathCacheHits;
+    int             m_statisticPathCacheMisses;
     bool            m_updateGeometry;
     bool            m_updateStaticBuffers;
     bool            m_firstGroundSpot;
@@ -172,7 +172,7 @@ char RandomLetter()
         for(char c = '0'; c <= '9'; c++) for(int i = 0; i < 4; i++) chars.push_back(c);
     }
 
-    return chars[rand()%chars.size()];
+    return chars[Math::EffectRandom()%chars.size()];
 }
 
 /** Returns the channel of the particle created or -1 on error. */
@@ -327,7 +327,7 @@ int CParticle::CreateParticle(Math::Vector pos, Math::Vector speed, Math::Point
             if ( type == PARTIEXPLOT ||
                  type == PARTIEXPLOO )
             {
-                m_particle[i].angle = Math::Rand()*Math::PI*2.0f;
+                m_particle[i].angle = Math::EffectRand()*Math::PI*2.0f;
             }
 
             if ( type == PARTIGUN1 ||
@@ -450,7 +450,7 @@ int CParticle::CreateFrag(Math::Vector pos, Math::Vector speed,
             m_triangle[i].triangle[2].normal.z = n.z;
 
             if (type == PARTIFRAG)
-                m_particle[i].angle = Math::Rand()*Math::PI*2.0f;
+                m_particle[i].angle = Math::EffectRand()*Math::PI*2.0f;
 
             return i | ((m_particle[i].uniqueStamp&0xffff)<<16);
         }
@@ -616,17 +616,9 @@ void CParticle::CreateWheelTrace(const Math::Vector &p1, const Math::Vector &p2,
     if (m_terrain == nullptr)
         m_terrain = m_main->GetTerrain();
 
-    m_terrain->AdjustToFloor(m_wheelTrace[i].pos[0]);
-    m_wheelTrace[i].pos[0].y += 0.2f;  // just above the ground
-
-    m_terrain->AdjustToFloor(m_wheelTrace[i].pos[1]);
-    m_wheelTrace[i].pos[1].y += 0.2f;  // just above the ground
-
-    m_terrain->AdjustToFloor(m_wheelTrace[i].pos[2]);
-    m_wheelTrace[i].pos[2].y += 0.2f;  // just above the ground
-
-    m_terrain->AdjustToFloor(m_wheelTrace[i].pos[3]);
-    m_wheelTrace[i].pos[3].y += 0.2f;  // just above the ground
+    m_terrain->AdjustToFloors(m_wheelTrace[i].pos, 4);
+    for (int j = 0; j < 4; j++)
+        m_wheelTrace[i].pos[j].y += 0.2f;  // just above the ground
 
     if (m_wheelTraceTotal < max)
         m_wheelTraceTotal++;
@@ -808,7 +800,10 @@ void CParticle::FrameParticle(float rTime)
 
         if (m_particle[i].sheet == SH_WORLD)
         {
-            float h = rTime*m_particle[i].windSensitivity*Math::Rand()*2.0f;
+            // Shots hit objects, their drift belongs to the simulation
+            bool shot = (m_particle[i].type >= PARTIGUN1 && m_particle[i].type <= PARTIGUN4) ||
+                        m_particle[i].type == PARTITRACK11;
+            float h = rTime*m_particle[i].windSensitivity*(shot ? Math::Rand() : Math::EffectRand())*2.0f;
             m_particle[i].pos += wind*h;
         }
 
@@ -1000,7 +995,7 @@ void CParticle::FrameParticle(float rTime)
             }
 
             m_particle[i].zoom = 1.0f-progress;
-            m_particle[i].angle = Math::Rand()*Math::PI*2.0f;
+            m_particle[i].angle = Math::EffectRand()*Math::PI*2.0f;
 
             ts.x = 0.125f;
             ts.y = 0.750f;
@@ -1122,9 +1117,9 @@ void CParticle::FrameParticle(float rTime)
                         speed.z = 0.0f;
                         speed.y = 0.0f;
                         Math::Point dim;
-                        dim.x = Math::Rand()*6.0f+6.0f;
+                        dim.x = Math::EffectRand()*6.0f+6.0f;
                         dim.y = dim.x;
-                        float duration = Math::Rand()*1.0f+1.0f;
+                        float duration = Math::EffectRand()*1.0f+1.0f;
                         float mass = 0.0f;
                         CreateParticle(pos, speed, dim, PARTIEXPLOG1, duration, mass, 1.0f);
 
@@ -1132,13 +1127,13 @@ void CParticle::FrameParticle(float rTime)
                         int total = static_cast<int>(2.0f*m_engine->GetParticleDensity());
                         for (int j = 0; j < total; j++)
                         {
-                            speed.x = (Math::Rand()-0.5f)*20.0f;
-                            speed.z = (Math::Rand()-0.5f)*20.0f;
-                            speed.y = Math::Rand()*20.0f;
+                            speed.x = (Math::EffectRand()-0.5f)*20.0f;
+                            speed.z = (Math::EffectRand()-0.5f)*20.0f;
+                            speed.y = Math::EffectRand()*20.0f;
                             dim.x = 1.0f;
                             dim.y = dim.x;
-                            duration = Math::Rand()*1.0f+1.0f;
-                            mass = Math::Rand()*10.0f+15.0f;
+                            duration = Math::EffectRand()*1.0f+1.0f;
+                            mass = Math::EffectRand()*10.0f+15.0f;
                             CreateParticle(pos, speed, dim, PARTIEXPLOG1, duration, mass, 1.0f);
                         }
                     }
@@ -1167,9 +1162,9 @@ void CParticle::FrameParticle(float rTime)
                         speed.z = 0.0f;
                         speed.y = 0.0f;
                         Math::Point dim;
-                        dim.x = Math::Rand()*6.0f+6.0f;
+                        dim.x = Math::EffectRand()*6.0f+6.0f;
                         dim.y = dim.x;
-                        float duration = Math::Rand()*1.0f+1.0f;
+                        float duration = Math::EffectRand()*1.0f+1.0f;
                         float mass = 0.0f;
                         CreateParticle(pos, speed, dim, PARTIEXPLOG1, duration, mass, 1.0f);
 
@@ -1177,13 +1172,13 @@ void CParticle::FrameParticle(float rTime)
                         int total = static_cast<int>(2.0f*m_engine->GetParticleDensity());
                         for (int j = 0; j < total; j++)
                         {
-                            speed.x = (Math::Rand()-0.5f)*20.0f;
-                            speed.z = (Math::Rand()-0.5f)*20.0f;
-                            speed.y = Math::Rand()*20.0f;
+                            speed.x = (Math::EffectRand()-0.5f)*20.0f;
+                            speed.z = (Math::EffectRand()-0.5f)*20.0f;
+                            speed.y = Math::EffectRand()*20.0f;
                             dim.x = 1.0f;
                             dim.y = dim.x;
-                            duration = Math::Rand()*1.0f+1.0f;
-                            mass = Math::Rand()*10.0f+15.0f;
+                            duration = Math::EffectRand()*1.0f+1.0f;
+                            mass = Math::EffectRand()*10.0f+15.0f;
                             CreateParticle(pos, speed, dim, PARTIEXPLOG1, duration, mass, 1.0f);
                         }
                     }
@@ -1242,7 +1237,7 @@ void CParticle::FrameParticle(float rTime)
                 }
             }
 
-            m_particle[i].angle = Math::Rand()*Math::PI*2.0f;
+            m_particle[i].angle = Math::EffectRand()*Math::PI*2.0f;
             m_particle[i].zoom = 1.0f-progress;
 
             ts.x = 0.125f;
@@ -1316,9 +1311,9 @@ void CParticle::FrameParticle(float rTime)
                         speed.z = 0.0f;
                         speed.y = 0.0f;
                         Math::Point dim;
-                        dim.x = Math::Rand()*4.0f+2.0f;
+                        dim.x = Math::EffectRand()*4.0f+2.0f;
                         dim.y = dim.x;
-                        float duration = Math::Rand()*0.7f+0.7f;
+                        float duration = Math::EffectRand()*0.7f+0.7f;
                         float mass = 0.0f;
                         CreateParticle(pos, speed, dim, PARTIEXPLOG2, duration, mass, 1.0f);
                     }
@@ -1349,9 +1344,9 @@ void CParticle::FrameParticle(float rTime)
                         speed.z = 0.0f;
                         speed.y = 0.0f;
                         Math::Point dim;
-                        dim.x = Math::Rand()*4.0f+2.0f;
+                        dim.x = Math::EffectRand()*4.0f+2.0f;
                         dim.y = dim.x;
-                        float duration = Math::Rand()*0.7f+0.7f;
+                        float duration = Math::EffectRand()*0.7f+0.7f;
                         float mass = 0.0f;
                         CreateParticle(pos, speed, dim, PARTIEXPLOG2, duration, mass, 1.0f);
                     }
@@ -1364,7 +1359,7 @@ void CParticle::FrameParticle(float rTime)
                 }
             }
 
-            m_particle[i].angle = Math::Rand()*Math::PI*2.0f;
+            m_particle[i].angle = Math::EffectRand()*Math::PI*2.0f;
             m_particle[i].zoom = 1.0f-progress;
 
             ts.x = 0.125f;
@@ -1731,7 +1726,7 @@ void CParticle::FrameParticle(float rTime)
 
             m_particle[i].intensity = 1.0f-progress;
 
-            ts.x = 0.750f+(rand()%2)*0.125f;
+            ts.x = 0.750f+(Math::EffectRandom()%2)*0.125f;
             ts.y = 0.875f;
             ti.x = ts.x+0.125f;
             ti.y = ts.y+0.125f;
@@ -1891,7 +1886,7 @@ void CParticle::FrameParticle(float rTime)
                 pos = m_particle[i].pos;
                 Math::Vector speed = Math::Vector(0.0f, 0.0f, 0.0f);
                 Math::Point dim;
-                dim.x = 1.0f*(Math::Rand()*0.8f+0.6f);
+                dim.x = 1.0f*(Math::EffectRand()*0.8f+0.6f);
                 dim.y = dim.x;
                 CreateParticle(pos, speed, dim, PARTIGAS, 0.5f);
             }
@@ -1918,19 +1913,19 @@ void CParticle::FrameParticle(float rTime)
                 for (int j = 0; j < total; j++)
                 {
                     Math::Vector speed;
-                    speed.x = (Math::Rand()-0.5f)*20.0f;
-                    speed.y = (Math::Rand()-0.5f)*20.0f;
-                    speed.z = (Math::Rand()-0.5f)*20.0f;
+                    speed.x = (Math::EffectRand()-0.5f)*20.0f;
+                    speed.y = (Math::EffectRand()-0.5f)*20.0f;
+                    speed.z = (Math::EffectRand()-0.5f)*20.0f;
                     CreateParticle(pos, speed, dim, PARTIORGANIC2, duration, mass);
                 }
                 total = static_cast<int>((5.0f*m_engine->GetParticleDensity()));
                 for (int j = 0; j < total; j++)
                 {
                     Math::Vector speed;
-                    speed.x = (Math::Rand()-0.5f)*20.0f;
-                    speed.y = (Math::Rand()-0.5f)*20.0f;
-                    speed.z = (Math::Rand()-0.5f)*20.0f;
-                    duration *= Math::Rand()+0.8f;
+                    speed.x = (Math::EffectRand()-0.5f)*20.0f;
+                    speed.y = (Math::EffectRand()-0.5f)*20.0f;
+                    speed.z = (Math::EffectRand()-0.5f)*20.0f;
+                    duration *= Math::EffectRand()+0.8f;
                     CreateTrack(pos, speed, dim, PARTITRACK4, duration, mass, duration*0.2f, dim.x*2.0f);
                 }
                 continue;
@@ -2085,11 +2080,11 @@ void CParticle::FrameParticle(float rTime)
             if (progress >= 1.0f)
             {
                 m_particle[i].time = 0.0f;
-                m_particle[i].duration = 0.5f+Math::Rand()*2.0f;
-                m_particle[i].pos.x = m_particle[i].speed.x + (Math::Rand()-0.5f)*m_particle[i].mass;
-                m_particle[i].pos.y = m_particle[i].speed.y + (Math::Rand()-0.5f)*m_particle[i].mass;
-                m_particle[i].pos.z = m_particle[i].speed.z + (Math::Rand()-0.5f)*m_particle[i].mass;
-                m_particle[i].dim.x = 0.5f+Math::Rand()*1.5f;
+                m_particle[i].duration = 0.5f+Math::EffectRand()*2.0f;
+                m_particle[i].pos.x = m_particle[i].speed.x + (Math::EffectRand()-0.5f)*m_particle[i].mass;
+                m_particle[i].pos.y = m_particle[i].speed.y + (Math::EffectRand()-0.5f)*m_particle[i].mass;
+                m_particle[i].pos.z = m_particle[i].speed.z + (Math::EffectRand()-0.5f)*m_particle[i].mass;
+                m_particle[i].dim.x = 0.5f+Math::EffectRand()*1.5f;
                 m_particle[i].dim.y = m_particle[i].dim.x;
                 progress = 0.0f;
             }
@@ -3051,10 +3046,10 @@ void CParticle::DrawParticleRay(int i)
     corner[2].x = adv;
     corner[0].y =  dim.y;
     corner[2].y = -dim.y;
-    corner[0].z = (Math::Rand()-0.5f)*vario1;
-    corner[1].z = (Math::Rand()-0.5f)*vario1;
-    corner[2].z = (Math::Rand()-0.5f)*vario1;
-    corner[3].z = (Math::Rand()-0.5f)*vario1;
+    corner[0].z = (Math::EffectRand()-0.5f)*vario1;
+    corner[1].z = (Math::EffectRand()-0.5f)*vario1;
+    corner[2].z = (Math::EffectRand()-0.5f)*vario1;
+    corner[3].z = (Math::EffectRand()-0.5f)*vario1;
 
     Vertex vertex[4];
 
@@ -3062,20 +3057,20 @@ void CParticle::DrawParticleRay(int i)
     {
         corner[1].x = corner[0].x;
         corner[3].x = corner[2].x;
-        corner[0].x = adv+dim.x*2.0f+(Math::Rand()-0.5f)*vario2;
-        corner[2].x = adv+dim.x*2.0f+(Math::Rand()-0.5f)*vario2;
+        corner[0].x = adv+dim.x*2.0f+(Math::EffectRand()-0.5f)*vario2;
+        corner[2].x = adv+dim.x*2.0f+(Math::EffectRand()-0.5f)*vario2;
 
         corner[1].y = corner[0].y;
         corner[3].y = corner[2].y;
-        corner[0].y =  dim.y+(Math::Rand()-0.5f)*vario2;
-        corner[2].y = -dim.y+(Math::Rand()-0.5f)*vario2;
+        corner[0].y =  dim.y+(Math::EffectRand()-0.5f)*vario2;
+        corner[2].y = -dim.y+(Math::EffectRand()-0.5f)*vario2;
 
         if (rank >= first && rank <= last)
         {
             Math::Point texInf = m_particle[i].texInf;
             Math::Point texSup = m_particle[i].texSup;
 
-            int r = rand() % 16;
+            int r = Math::EffectRandom() % 16;
             texInf.x += 0.25f*(r/4);
             texSup.x += 0.25f*(r/4);
             if (r % 2 < 1 && adv > 0.0f && m_particle[i].type != PARTIRAY1)
@@ -3499,9 +3494,12 @@ CObject* CParticle::SearchObjectGun(Math::Vector old, Math::Vector pos,
     box2.y += min;
     box2.z += min;
 
+    // Hits are also searched around the center of objects, up to 4 units further
+    Math::Vector margin(4.0f, 4.0f, 4.0f);
+
     CObject* best = nullptr;
     bool shield = false;
-    for (CObject* obj : CObjectManager::GetInstancePointer()->GetAllObjects())
+    for (CObject* obj : CObjectManager::GetInstancePointer()->GetObjectsNearBox(box1 - margin, box2 + margin))
     {
         if (!obj->GetDetectable()) continue;  // inactive?
         if (obj == father) continue;
@@ -3602,7 +3600,7 @@ CObject* CParticle::SearchObjectRay(Math::Vector pos, Math::Vector goal,
     box2.y += min;
     box2.z += min;
 
-    for (CObject* obj : CObjectManager::GetInstancePointer()->GetAllObjects())
+    for (CObject* obj : CObjectManager::GetInstancePointer()->GetObjectsNearBox(box1, box2))
     {
         if (!obj->GetDetectable()) continue;  // inactive?
         if (obj == father) continue;
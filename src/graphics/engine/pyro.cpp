@@ -484,16 +484,16 @@ bool CPyro::Create(PyroType type, CObject* obj, float force)
             {
                 pos = m_posPower;
                 Math::Vector speed;
-                speed.x = (Math::Rand()-0.5f)*30.0f;
-                speed.z = (Math::Rand()-0.5f)*30.0f;
-                speed.y = Math::Rand()*30.0f;
+                speed.x = (Math::EffectRand()-0.5f)*30.0f;
+                speed.z = (Math::EffectRand()-0.5f)*30.0f;
+                speed.y = Math::EffectRand()*30.0f;
                 Math::Point dim;
                 dim.x = 1.0f;
                 dim.y = dim.x;
-                float duration = Math::Rand()*3.0f+2.0f;
-                float mass = Math::Rand()*10.0f+15.0f;
+                float duration = Math::EffectRand()*3.0f+2.0f;
+                float mass = Math::EffectRand()*10.0f+15.0f;
                 m_particle->CreateTrack(pos, speed, dim, PARTITRACK1,
-                                         duration, mass, Math::Rand()+0.7f, 1.0f);
+                                         duration, mass, Math::EffectRand()+0.7f, 1.0f);
             }
         }
 
@@ -524,14 +524,14 @@ bool CPyro::Create(PyroType type, CObject* obj, float force)
         {
             pos = m_pos;
             Math::Vector speed;
-            speed.x = (Math::Rand()-0.5f)*30.0f;
-            speed.z = (Math::Rand()-0.5f)*30.0f;
-            speed.y = Math::Rand()*50.0f;
+            speed.x = (Math::EffectRand()-0.5f)*30.0f;
+            speed.z = (Math::EffectRand()-0.5f)*30.0f;
+            speed.y = Math::EffectRand()*50.0f;
             Math::Point dim;
             dim.x = 1.0f;
             dim.y = dim.x;
-            float duration = Math::Rand()*1.0f+0.8f;
-            float mass = Math::Rand()*10.0f+15.0f;
+            float duration = Math::EffectRand()*1.0f+0.8f;
+            float mass = Math::EffectRand()*10.0f+15.0f;
             m_particle->CreateParticle(pos, speed, dim, PARTIORGANIC1,
                                          duration, mass);
         }
@@ -540,14 +540,14 @@ bool CPyro::Create(PyroType type, CObject* obj, float force)
         {
             pos = m_pos;
             Math::Vector speed;
-            speed.x = (Math::Rand()-0.5f)*30.0f;
-            speed.z = (Math::Rand()-0.5f)*30.0f;
-            speed.y = Math::Rand()*50.0f;
+            speed.x = (Math::EffectRand()-0.5f)*30.0f;
+            speed.z = (Math::EffectRand()-0.5f)*30.0f;
+            speed.y = Math::EffectRand()*50.0f;
             Math::Point dim;
             dim.x = 1.0f;
             dim.y = dim.x;
-            float duration = Math::Rand()*2.0f+1.4f;
-            float mass = Math::Rand()*10.0f+15.0f;
+            float duration = Math::EffectRand()*2.0f+1.4f;
+            float mass = Math::EffectRand()*10.0f+15.0f;
             m_particle->CreateTrack(pos, speed, dim, PARTITRACK4,
                                      duration, mass, duration*0.5f, dim.x*2.0f);
         }
@@ -575,18 +575,18 @@ bool CPyro::Create(PyroType type, CObject* obj, float force)
         for (int i = 0; i < total; i++)
         {
             pos = m_pos;
-            pos.x += (Math::Rand()-0.5f)*3.0f;
-            pos.z += (Math::Rand()-0.5f)*3.0f;
-            pos.y += (Math::Rand()-0.5f)*2.0f;
+            pos.x += (Math::EffectRand()-0.5f)*3.0f;
+            pos.z += (Math::EffectRand()-0.5f)*3.0f;
+            pos.y += (Math::EffectRand()-0.5f)*2.0f;
             Math::Vector speed;
-            speed.x = (Math::Rand()-0.5f)*24.0f;
-            speed.z = (Math::Rand()-0.5f)*24.0f;
-            speed.y = 7.0f+Math::Rand()*7.0f;
+            speed.x = (Math::EffectRand()-0.5f)*24.0f;
+            speed.z = (Math::EffectRand()-0.5f)*24.0f;
+            speed.y = 7.0f+Math::EffectRand()*7.0f;
             Math::Point dim;
             dim.x = 1.0f;
             dim.y = dim.x;
             m_particle->CreateTrack(pos, speed, dim, PARTITRACK3,
-                                    2.0f+Math::Rand()*2.0f, 10.0f, 2.0f, 0.6f);
+                                    2.0f+Math::EffectRand()*2.0f, 10.0f, 2.0f, 0.6f);
         }
     }
 
@@ -697,15 +697,15 @@ bool CPyro::EventProcess(const Event &event)
         for (int i = 0; i < r; i++)
         {
             Math::Vector pos = m_pos;
-            pos.x += (Math::Rand()-0.5f)*20.0f;
-            pos.z += (Math::Rand()-0.5f)*20.0f;
+            pos.x += (Math::EffectRand()-0.5f)*20.0f;
+            pos.z += (Math::EffectRand()-0.5f)*20.0f;
             pos.y += 8.0f;
             Math::Vector speed;
-            speed.x = (Math::Rand()-0.5f)*40.0f;
-            speed.z = (Math::Rand()-0.5f)*40.0f;
-            speed.y = Math::Rand()*40.0f;
+            speed.x = (Math::EffectRand()-0.5f)*40.0f;
+            speed.z = (Math::EffectRand()-0.5f)*40.0f;
+            speed.y = Math::EffectRand()*40.0f;
             Math::Point dim;
-            dim.x = Math::Rand()*8.0f+8.0f*m_force;
+            dim.x = Math::EffectRand()*8.0f+8.0f*m_force;
             dim.y = dim.x;
 
             m_particle->CreateParticle(pos, speed, dim, PARTIBLOODM, 2.0f, 50.0f, 0.0f);
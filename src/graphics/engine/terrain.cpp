@@ -30,6 +30,7 @@
 
 #include "math/geometry.h"
 
+#include <algorithm>
 #include <sstream>
 
 #include <SDL.h>
@@ -39,6 +40,78 @@
 namespace Gfx
 {
 
+namespace
+{
+
+//! Number of local changes remembered by GetChangedAreas()
+const std::size_t MAX_CHANGED_AREAS = 64;
+
+//! Clips the ray parameter range [t0, t1] to the slab min..max along one axis
+bool ClipRaySlab(float origin, float dir, float min, float max, float& t0, float& t1)
+{
+    if (fabs(dir) < 1e-8f)
+        return origin >= min && origin <= max;
+
+    float ta = (min-origin)/dir;
+    float tb = (max-origin)/dir;
+    if (ta > tb) std::swap(ta, tb);
+
+    t0 = std::max(t0, ta);
+    t1 = std::min(t1, tb);
+    return t0 <= t1;
+}
+
+//! Ray and triangle intersection, tolerant to hits exactly on the edges
+bool IntersectRayTriangle(const Math::Vector& origin, const Math::Vector& dir,
+                          const Math::Vector& a, const Math::Vector& b, const Math::Vector& c,
+                          float& t)
+{
+    const float EPSILON = 1e-5f;
+
+    Math::Vector e1 = b-a;
+    Math::Vector e2 = c-a;
+    Math::Vector p = Math::CrossProduct(dir, e2);
+    float det = Math::DotProduct(e1, p);
+    if (fabs(det) < 1e-8f) return false;  // parallel
+
+    Math::Vector s = origin-a;
+    float u = Math::DotProduct(s, p)/det;
+    if (u < -EPSILON || u > 1.0f+EPSILON) return false;
+
+    Math::Vector q = Math::CrossProduct(s, e1);
+    float v = Math::DotProduct(dir, q)/det;
+    if (v < -EPSILON || u+v > 1.0f+EPSILON) return false;
+
+    t = Math::DotProduct(e2, q)/det;
+    return t >= 0.0f;
+}
+
+} // anonymous namespace
+
+//! Number of positions processed at once by batch queries
+const int TERRAIN_BATCH_SIZE = 64;
+//! Size of the cells of the building level grid
+const float BUILDING_LEVEL_CELL_SIZE = 40.0f;
+
+/**
+ * \struct CTerrain::FloorBlock
+ * \brief Block of positions for batch queries, stored as structure of arrays
+ */
+struct CTerrain::FloorBlock
+{
+    //! Position inside the grid square, relative to its size
+    float u[TERRAIN_BATCH_SIZE];
+    float v[TERRAIN_BATCH_SIZE];
+    //! Heights of the corners of the square: (x,y), (x+1,y), (x,y+1), (x+1,y+1)
+    float h1[TERRAIN_BATCH_SIZE];
+    float h2[TERRAIN_BATCH_SIZE];
+    float h3[TERRAIN_BATCH_SIZE];
+    float h4[TERRAIN_BATCH_SIZE];
+    //! Result of InterpolateFloorBlock()
+    float level[TERRAIN_BATCH_SIZE];
+    bool  valid[TERRAIN_BATCH_SIZE];
+};
+
 
 CTerrain::CTerrain()
 {
@@ -62,6 +135,8 @@ CTerrain::CTerrain()
     m_maxMaterialID = 0;
     m_materialAutoID = 0;
     m_materialPointCount = 0;
+    m_revision = 0;
+    m_changedAreasRevision = 0;
 
     FlushBuildingLevel();
     FlushFlyingLimit();
@@ -75,6 +150,9 @@ CTerrain::~CTerrain()
 bool CTerrain::Generate(int mosaicCount, int brickCountPow2, float brickSize,
                         float vision, int depth, float hardness)
 {
+    AddChange();
+    m_heightBoundsDirty = true;
+
     m_mosaicCount   = mosaicCount;
     m_brickCount    = 1 << brickCountPow2;
     m_brickSize     = brickSize;
@@ -100,6 +178,8 @@ bool CTerrain::Generate(int mosaicCount, int brickCountPow2, float brickSize,
     dim = m_mosaicCount*m_mosaicCount;
     std::vector<int>(dim, -1).swap(m_objRanks);
 
+    UpdateBuildingLevelCells();
+
     return true;
 }
 
@@ -272,6 +352,9 @@ TerrainRes CTerrain::GetResource(const Math::Vector &pos)
 
 void CTerrain::FlushRelief()
 {
+    AddChange();
+    m_heightBoundsDirty = true;
+
     m_relief.clear();
     m_resources.clear();
     m_textures.clear();
@@ -298,6 +381,9 @@ void CTerrain::FlushRelief()
 bool CTerrain::LoadRelief(const std::string &fileName, float scaleRelief,
                           bool adjustBorder)
 {
+    AddChange();
+    m_heightBoundsDirty = true;
+
     m_scaleRelief = scaleRelief;
 
     CImage img;
@@ -348,6 +434,9 @@ bool CTerrain::LoadRelief(const std::string &fileName, float scaleRelief,
 
 bool CTerrain::RandomizeRelief()
 {
+    AddChange();
+    m_heightBoundsDirty = true;
+
     // Perlin noise
     // Based on Python implementation by Marek Rogalski (mafik)
     // http://amt2014.pl/archiwum/perlin.py
@@ -402,6 +491,9 @@ bool CTerrain::RandomizeRelief()
 
 bool CTerrain::AddReliefPoint(Math::Vector pos, float scaleRelief)
 {
+    AddChange();
+    m_heightBoundsDirty = true;
+
     float dim = (m_mosaicCount*m_brickCount*m_brickSize)/2.0f;
     int size = (m_mosaicCount*m_brickCount)+1;
 
@@ -422,6 +514,9 @@ bool CTerrain::AddReliefPoint(Math::Vector pos, float scaleRelief)
 
 void CTerrain::AdjustRelief()
 {
+    AddChange();
+    m_heightBoundsDirty = true;
+
     if (m_depth == 1) return;
 
     int ii = m_mosaicCount*m_brickCount+1;
@@ -1282,6 +1377,8 @@ bool CTerrain::CreateObjects()
 /** ATTENTION: ok only with m_depth = 2! */
 bool CTerrain::Terraform(const Math::Vector &p1, const Math::Vector &p2, float height)
 {
+    AddChange();
+
     float dim = (m_mosaicCount*m_brickCount*m_brickSize)/2.0f;
 
     Math::IntPoint tp1, tp2;
@@ -1306,6 +1403,9 @@ bool CTerrain::Terraform(const Math::Vector &p1, const Math::Vector &p2, float h
 
     int size = (m_mosaicCount*m_brickCount)+1;
 
+    // AdjustRelief() marks the whole height tree dirty, only the changed part is updated below
+    bool heightBoundsValid = !m_heightBoundsDirty;
+
     // Calculates the current average height
     float avg = 0.0f;
     int nb = 0;
@@ -1365,6 +1465,74 @@ bool CTerrain::Terraform(const Math::Vector &p1, const Math::Vector &p2, float h
     }
     m_engine->Update();
 
+    if (heightBoundsValid)
+    {
+        // Squares sharing border points with the recreated mosaics are included
+        UpdateHeightBounds(pp1.x*m_brickCount-1, pp1.y*m_brickCount-1,
+                           (pp2.x+1)*m_brickCount, (pp2.y+1)*m_brickCount);
+        m_heightBoundsDirty = false;
+    }
+
+    return true;
+}
+
+std::vector<float> CTerrain::GetReliefCopy() const
+{
+    return m_relief;
+}
+
+bool CTerrain::RestoreRelief(const std::vector<float>& relief)
+{
+    if (relief.size() != m_relief.size())
+        return false;
+
+    int size = (m_mosaicCount*m_brickCount)+1;
+
+    // Finds the squares touched by terraforming since the copy was made
+    std::vector<bool> changed(m_mosaicCount*m_mosaicCount, false);
+    bool anyChanged = false;
+    for (int y = 0; y < size; y++)
+    {
+        for (int x = 0; x < size; x++)
+        {
+            if (m_relief[x+y*size] == relief[x+y*size]) continue;
+
+            // Points on the border belong to both squares, and normals are computed
+            // from neighbouring points as well, so recreate the squares around too
+            for (int sy = y/m_brickCount-1; sy <= y/m_brickCount+1; sy++)
+            {
+                for (int sx = x/m_brickCount-1; sx <= x/m_brickCount+1; sx++)
+                {
+                    if (sx < 0 || sx >= m_mosaicCount || sy < 0 || sy >= m_mosaicCount) continue;
+                    changed[sx+sy*m_mosaicCount] = true;
+                }
+            }
+            anyChanged = true;
+        }
+    }
+
+    if (!anyChanged)
+        return true;
+
+    AddChange();
+    m_heightBoundsDirty = true;
+    m_relief = relief;
+
+    for (int y = 0; y < m_mosaicCount; y++)
+    {
+        for (int x = 0; x < m_mosaicCount; x++)
+        {
+            if (!changed[x+y*m_mosaicCount]) continue;
+
+            int objRank = m_objRanks[x+y*m_mosaicCount];
+            int baseObjRank = m_engine->GetObjectBaseRank(objRank);
+            m_engine->DeleteBaseObject(baseObjRank);
+            m_engine->DeleteObject(objRank);
+            CreateSquare(x, y);  // recreates the square
+        }
+    }
+    m_engine->Update();
+
     return true;
 }
 
@@ -1411,6 +1579,49 @@ float CTerrain::GetCoarseSlope(const Math::Vector &pos)
     return atanf((max-min)/m_brickSize);
 }
 
+unsigned int CTerrain::GetRevision() const
+{
+    return m_revision;
+}
+
+bool CTerrain::GetChangedAreas(unsigned int revision, std::vector<ChangedArea>& areas) const
+{
+    areas.clear();
+    if (revision < m_changedAreasRevision)
+        return false;
+
+    for (const ChangedArea& area : m_changedAreas)
+    {
+        if (area.revision > revision)
+            areas.push_back(area);
+    }
+    return true;
+}
+
+void CTerrain::AddChange()
+{
+    ++m_revision;
+    m_changedAreas.clear();
+    m_changedAreasRevision = m_revision;
+}
+
+void CTerrain::AddChange(const Math::Point& min, const Math::Point& max)
+{
+    ++m_revision;
+
+    ChangedArea area;
+    area.revision = m_revision;
+    area.min = min;
+    area.max = max;
+    m_changedAreas.push_back(area);
+
+    if (m_changedAreas.size() > MAX_CHANGED_AREAS)
+    {
+        m_changedAreasRevision = m_changedAreas.front().revision;
+        m_changedAreas.pop_front();
+    }
+}
+
 bool CTerrain::GetNormal(Math::Vector &n, const Math::Vector &p)
 {
     float dim = (m_mosaicCount*m_brickCount*m_brickSize)/2.0f;
@@ -1541,6 +1752,373 @@ bool CTerrain::AdjustToFloor(Math::Vector &pos, bool brut, bool water)
     return true;
 }
 
+void CTerrain::PrepareFloorBlock(const Math::Vector* pos, int count, FloorBlock& block)
+{
+    int   size = m_mosaicCount*m_brickCount;
+    float dim  = (size*m_brickSize)/2.0f;
+    int   ix[TERRAIN_BATCH_SIZE];
+    int   iy[TERRAIN_BATCH_SIZE];
+
+    for (int i = 0; i < count; i++)
+    {
+        float fx = (pos[i].x+dim)/m_brickSize;
+        float fy = (pos[i].z+dim)/m_brickSize;
+        ix[i] = static_cast<int>(fx);
+        iy[i] = static_cast<int>(fy);
+        block.u[i] = fx-ix[i];
+        block.v[i] = fy-iy[i];
+    }
+
+    // Same rules as GetVector(): corners outside the relief have zero height
+    for (int i = 0; i < count; i++)
+    {
+        int x = ix[i];
+        int y = iy[i];
+
+        block.valid[i] = x >= 0 && x <= size && y >= 0 && y <= size;
+        if (!block.valid[i] || m_relief.empty())
+        {
+            block.h1[i] = block.h2[i] = block.h3[i] = block.h4[i] = 0.0f;
+            continue;
+        }
+
+        const float* row = &m_relief[x+y*(size+1)];
+        bool right = x < size;
+        bool down  = y < size;
+        block.h1[i] = row[0];
+        block.h2[i] = right ? row[1] : 0.0f;
+        block.h3[i] = down ? row[size+1] : 0.0f;
+        block.h4[i] = right && down ? row[size+2] : 0.0f;
+    }
+}
+
+void CTerrain::InterpolateFloorBlock(FloorBlock& block, int count)
+{
+    // The square is split along the diagonal from (x+1,y) to (x,y+1), like in GetFloorLevel()
+    for (int i = 0; i < count; i++)
+    {
+        float u = block.u[i];
+        float v = block.v[i];
+        float lower = block.h1[i] + u*(block.h2[i]-block.h1[i]) + v*(block.h3[i]-block.h1[i]);
+        float upper = block.h4[i] + (1.0f-u)*(block.h3[i]-block.h4[i]) + (1.0f-v)*(block.h2[i]-block.h4[i]);
+        block.level[i] = fabs(v) < fabs(1.0f-u) ? lower : upper;
+    }
+}
+
+/**
+ * Positions outside the terrain get level 0, as with GetFloorLevel()
+ */
+void CTerrain::GetFloorLevels(const Math::Vector* pos, float* levels, int count, bool brut, bool water)
+{
+    float waterLevel = m_water->GetLevel();
+    FloorBlock block;
+
+    for (int start = 0; start < count; start += TERRAIN_BATCH_SIZE)
+    {
+        int n = std::min(TERRAIN_BATCH_SIZE, count-start);
+        PrepareFloorBlock(pos+start, n, block);
+        InterpolateFloorBlock(block, n);
+
+        for (int i = 0; i < n; i++)
+        {
+            if (!block.valid[i])
+            {
+                levels[start+i] = 0.0f;
+                continue;
+            }
+
+            Math::Vector ps = pos[start+i];
+            ps.y = block.level[i];
+
+            if (! brut) AdjustBuildingLevel(ps);
+
+            if (water)  // not going underwater?
+            {
+                if (ps.y < waterLevel) ps.y = waterLevel;  // not under water
+            }
+
+            levels[start+i] = ps.y;
+        }
+    }
+}
+
+bool CTerrain::AdjustToFloors(Math::Vector* pos, int count, bool brut, bool water)
+{
+    float waterLevel = m_water->GetLevel();
+    bool all = true;
+    FloorBlock block;
+
+    for (int start = 0; start < count; start += TERRAIN_BATCH_SIZE)
+    {
+        int n = std::min(TERRAIN_BATCH_SIZE, count-start);
+        PrepareFloorBlock(pos+start, n, block);
+        InterpolateFloorBlock(block, n);
+
+        for (int i = 0; i < n; i++)
+        {
+            if (!block.valid[i])
+            {
+                all = false;
+                continue;
+            }
+
+            Math::Vector& ps = pos[start+i];
+            ps.y = block.level[i];
+
+            if (! brut) AdjustBuildingLevel(ps);
+
+            if (water)  // not going underwater?
+            {
+                if (ps.y < waterLevel) ps.y = waterLevel;  // not under water
+            }
+        }
+    }
+
+    return all;
+}
+
+void CTerrain::GetNormals(const Math::Vector* pos, Math::Vector* normals, int count)
+{
+    FloorBlock block;
+
+    for (int start = 0; start < count; start += TERRAIN_BATCH_SIZE)
+    {
+        int n = std::min(TERRAIN_BATCH_SIZE, count-start);
+        PrepareFloorBlock(pos+start, n, block);
+
+        // Cross product of the triangle edges, see Math::NormalToPlane()
+        for (int i = 0; i < n; i++)
+        {
+            if (!block.valid[i]) continue;
+
+            float u = block.u[i];
+            float v = block.v[i];
+            float dx, dz;
+            if ( fabs(v) < fabs(1.0f-u) )
+            {
+                dx = block.h2[i]-block.h1[i];
+                dz = block.h3[i]-block.h1[i];
+            }
+            else
+            {
+                dx = block.h4[i]-block.h3[i];
+                dz = block.h4[i]-block.h2[i];
+            }
+
+            normals[start+i] = Math::Normalize(Math::Vector(-dx*m_brickSize, m_brickSize*m_brickSize, -dz*m_brickSize));
+        }
+    }
+}
+
+bool CTerrain::IntersectRay(const Math::Vector& origin, const Math::Vector& dir, float maxDist, Math::Vector& hit)
+{
+    if (m_heightBoundsDirty)
+        BuildHeightBounds();
+
+    if (m_heightBounds.empty()) return false;
+
+    float length = dir.Length();
+    if (length == 0.0f) return false;
+
+    Math::Vector d = dir/length;
+    int top = static_cast<int>( m_heightBounds.size() ) - 1;
+
+    float entry = 0.0f;
+    if (! GetRayNodeEntry(top, 0, 0, origin, d, maxDist, entry)) return false;
+
+    return IntersectRayNode(top, 0, 0, origin, d, maxDist, hit);
+}
+
+int CTerrain::GetMosaicObjRank(const Math::Vector& pos)
+{
+    float dim = (m_mosaicCount*m_brickCount*m_brickSize)/2.0f;
+
+    int x = static_cast<int>((pos.x+dim)/(m_brickCount*m_brickSize));
+    int y = static_cast<int>((pos.z+dim)/(m_brickCount*m_brickSize));
+
+    if ( x < 0 || x >= m_mosaicCount ||
+         y < 0 || y >= m_mosaicCount )  return -1;
+
+    if (m_objRanks.empty()) return -1;
+
+    return m_objRanks[x+y*m_mosaicCount];
+}
+
+void CTerrain::BuildHeightBounds()
+{
+    m_heightBoundsDirty = false;
+    m_heightBounds.clear();
+
+    int size = m_mosaicCount*m_brickCount;
+    if (m_relief.empty() || size <= 0) return;
+
+    int levelSize = size;
+    while (true)
+    {
+        HeightBounds level;
+        level.size = levelSize;
+        level.min.resize(levelSize*levelSize);
+        level.max.resize(levelSize*levelSize);
+        m_heightBounds.push_back(std::move(level));
+
+        if (levelSize == 1) break;
+        levelSize = (levelSize+1)/2;
+    }
+
+    UpdateHeightBounds(0, 0, size-1, size-1);
+}
+
+void CTerrain::UpdateHeightBounds(int x1, int y1, int x2, int y2)
+{
+    if (m_heightBounds.empty()) return;
+
+    int size = m_mosaicCount*m_brickCount;
+
+    x1 = std::max(x1, 0);
+    y1 = std::max(y1, 0);
+    x2 = std::min(x2, size-1);
+    y2 = std::min(y2, size-1);
+    if (x1 > x2 || y1 > y2) return;
+
+    HeightBounds& squares = m_heightBounds[0];
+    for (int y = y1; y <= y2; y++)
+    {
+        for (int x = x1; x <= x2; x++)
+        {
+            const float* row = &m_relief[x+y*(size+1)];
+            squares.min[x+y*size] = Math::Min(row[0], row[1], row[size+1], row[size+2]);
+            squares.max[x+y*size] = Math::Max(row[0], row[1], row[size+1], row[size+2]);
+        }
+    }
+
+    for (int l = 1; l < static_cast<int>( m_heightBounds.size() ); l++)
+    {
+        x1 /= 2;
+        y1 /= 2;
+        x2 /= 2;
+        y2 /= 2;
+
+        HeightBounds& level = m_heightBounds[l];
+        const HeightBounds& below = m_heightBounds[l-1];
+
+        for (int y = y1; y <= y2; y++)
+        {
+            for (int x = x1; x <= x2; x++)
+            {
+                float min = below.min[(x*2)+(y*2)*below.size];
+                float max = below.max[(x*2)+(y*2)*below.size];
+
+                for (int cy = y*2; cy <= std::min(y*2+1, below.size-1); cy++)
+                {
+                    for (int cx = x*2; cx <= std::min(x*2+1, below.size-1); cx++)
+                    {
+                        min = Math::Min(min, below.min[cx+cy*below.size]);
+                        max = Math::Max(max, below.max[cx+cy*below.size]);
+                    }
+                }
+
+                level.min[x+y*level.size] = min;
+                level.max[x+y*level.size] = max;
+            }
+        }
+    }
+}
+
+bool CTerrain::GetRayNodeEntry(int level, int x, int y, const Math::Vector& origin, const Math::Vector& dir, float maxDist, float& entry)
+{
+    const HeightBounds& bounds = m_heightBounds[level];
+
+    int   size = m_mosaicCount*m_brickCount;
+    float dim  = (size*m_brickSize)/2.0f;
+    int   span = 1 << level;  // squares on a side of the node
+
+    float minX = x*span*m_brickSize - dim;
+    float minZ = y*span*m_brickSize - dim;
+    float maxX = std::min((x+1)*span, size)*m_brickSize - dim;
+    float maxZ = std::min((y+1)*span, size)*m_brickSize - dim;
+
+    float t0 = 0.0f;
+    float t1 = maxDist;
+    if (! ClipRaySlab(origin.x, dir.x, minX, maxX, t0, t1)) return false;
+    if (! ClipRaySlab(origin.z, dir.z, minZ, maxZ, t0, t1)) return false;
+    if (! ClipRaySlab(origin.y, dir.y, bounds.min[x+y*bounds.size], bounds.max[x+y*bounds.size], t0, t1)) return false;
+
+    entry = t0;
+    return true;
+}
+
+bool CTerrain::IntersectRayNode(int level, int x, int y, const Math::Vector& origin, const Math::Vector& dir, float& maxDist, Math::Vector& hit)
+{
+    if (level == 0)
+        return IntersectRaySquare(x, y, origin, dir, maxDist, hit);
+
+    struct Child
+    {
+        int x, y;
+        float entry;
+    };
+    Child children[4];
+    int count = 0;
+
+    const HeightBounds& below = m_heightBounds[level-1];
+    for (int cy = y*2; cy <= std::min(y*2+1, below.size-1); cy++)
+    {
+        for (int cx = x*2; cx <= std::min(x*2+1, below.size-1); cx++)
+        {
+            float entry = 0.0f;
+            if (! GetRayNodeEntry(level-1, cx, cy, origin, dir, maxDist, entry)) continue;
+
+            // Keeps the children sorted from the nearest
+            int i = count++;
+            while (i > 0 && children[i-1].entry > entry)
+            {
+                children[i] = children[i-1];
+                i--;
+            }
+            children[i] = { cx, cy, entry };
+        }
+    }
+
+    bool found = false;
+    for (int i = 0; i < count; i++)
+    {
+        if (children[i].entry > maxDist) break;  // behind a hit already found
+
+        if (IntersectRayNode(level-1, children[i].x, children[i].y, origin, dir, maxDist, hit))
+            found = true;
+    }
+    return found;
+}
+
+bool CTerrain::IntersectRaySquare(int x, int y, const Math::Vector& origin, const Math::Vector& dir, float& maxDist, Math::Vector& hit)
+{
+    // Same triangles as in GetFloorLevel()
+    Math::Vector p1 = GetVector(x+0, y+0);
+    Math::Vector p2 = GetVector(x+1, y+0);
+    Math::Vector p3 = GetVector(x+0, y+1);
+    Math::Vector p4 = GetVector(x+1, y+1);
+
+    bool found = false;
+    float t = 0.0f;
+
+    if (IntersectRayTriangle(origin, dir, p1, p2, p3, t) && t <= maxDist)
+    {
+        maxDist = t;
+        found = true;
+    }
+
+    if (IntersectRayTriangle(origin, dir, p2, p4, p3, t) && t <= maxDist)
+    {
+        maxDist = t;
+        found = true;
+    }
+
+    if (found)
+        hit = origin + dir*maxDist;
+
+    return found;
+}
+
 /**
  * \param pos position to adjust
  * \returns \c false if the initial coordinate was outside terrain area; \c true otherwise
@@ -1618,7 +2196,10 @@ bool CTerrain::AdjustToBounds(Math::Vector& pos, float margin)
 
 void CTerrain::FlushBuildingLevel()
 {
+    AddChange();
+
     m_buildingLevels.clear();
+    UpdateBuildingLevelCells();
 }
 
 bool CTerrain::AddBuildingLevel(Math::Vector center, float min, float max,
@@ -1634,8 +2215,21 @@ bool CTerrain::AddBuildingLevel(Math::Vector center, float min, float max,
         }
     }
 
+    // Replaced level is changed too
+    Math::Point changeMin(center.x-max, center.z-max);
+    Math::Point changeMax(center.x+max, center.z+max);
     if (i == static_cast<int>( m_buildingLevels.size() ))
+    {
         m_buildingLevels.push_back(BuildingLevel());
+    }
+    else
+    {
+        changeMin.x = Math::Min(changeMin.x, m_buildingLevels[i].bboxMinX);
+        changeMin.y = Math::Min(changeMin.y, m_buildingLevels[i].bboxMinZ);
+        changeMax.x = Math::Max(changeMax.x, m_buildingLevels[i].bboxMaxX);
+        changeMax.y = Math::Max(changeMax.y, m_buildingLevels[i].bboxMaxZ);
+    }
+    AddChange(changeMin, changeMax);
 
     m_buildingLevels[i].center   = center;
     m_buildingLevels[i].min      = min;
@@ -1648,6 +2242,7 @@ bool CTerrain::AddBuildingLevel(Math::Vector center, float min, float max,
     m_buildingLevels[i].bboxMinZ = center.z-max;
     m_buildingLevels[i].bboxMaxZ = center.z+max;
 
+    UpdateBuildingLevelCells();
     return true;
 }
 
@@ -1658,6 +2253,8 @@ bool CTerrain::UpdateBuildingLevel(Math::Vector center)
         if ( center.x == m_buildingLevels[i].center.x &&
              center.z == m_buildingLevels[i].center.z )
         {
+            AddChange(Math::Point(m_buildingLevels[i].bboxMinX, m_buildingLevels[i].bboxMinZ),
+                      Math::Point(m_buildingLevels[i].bboxMaxX, m_buildingLevels[i].bboxMaxZ));
             m_buildingLevels[i].center = center;
             m_buildingLevels[i].level  = GetFloorLevel(center, true);
             return true;
@@ -1673,66 +2270,128 @@ bool CTerrain::DeleteBuildingLevel(Math::Vector center)
         if ( center.x == m_buildingLevels[i].center.x &&
              center.z == m_buildingLevels[i].center.z )
         {
+            AddChange(Math::Point(m_buildingLevels[i].bboxMinX, m_buildingLevels[i].bboxMinZ),
+                      Math::Point(m_buildingLevels[i].bboxMaxX, m_buildingLevels[i].bboxMaxZ));
+
             for (int j = i+1; j < static_cast<int>( m_buildingLevels.size() ); j++)
                 m_buildingLevels[j-1] = m_buildingLevels[j];
 
             m_buildingLevels.pop_back();
+            UpdateBuildingLevelCells();
             return true;
         }
     }
     return false;
 }
 
-float CTerrain::GetBuildingFactor(const Math::Vector &pos)
+float CTerrain::GetBuildingFactor(const Math::Vector &pos) const
 {
-    for (int i = 0; i < static_cast<int>( m_buildingLevels.size() ); i++)
-    {
-        if ( pos.x < m_buildingLevels[i].bboxMinX ||
-             pos.x > m_buildingLevels[i].bboxMaxX ||
-             pos.z < m_buildingLevels[i].bboxMinZ ||
-             pos.z > m_buildingLevels[i].bboxMaxZ )  continue;
+    int i = FindBuildingLevel(pos);
+    if (i == -1) return 1.0f;  // it is normal on the ground
 
-        float dist = Math::DistanceProjected(pos, m_buildingLevels[i].center);
+    return m_buildingLevels[i].factor;
+}
 
-        if (dist <= m_buildingLevels[i].max)
-            return m_buildingLevels[i].factor;
+void CTerrain::AdjustBuildingLevel(Math::Vector &p)
+{
+    int i = FindBuildingLevel(p);
+    if (i == -1) return;
+
+    float dist = Math::DistanceProjected(p, m_buildingLevels[i].center);
+
+    if (dist < m_buildingLevels[i].min)
+    {
+        p.y = m_buildingLevels[i].level + m_buildingLevels[i].height;
+        return;
     }
-    return 1.0f;  // it is normal on the ground
+
+    Math::Vector border;
+    border.x = ((p.x - m_buildingLevels[i].center.x) * m_buildingLevels[i].max) /
+               dist + m_buildingLevels[i].center.x;
+    border.z = ((p.z - m_buildingLevels[i].center.z) * m_buildingLevels[i].max) /
+               dist + m_buildingLevels[i].center.z;
+
+    float base = GetFloorLevel(border, true);
+
+    p.y = (m_buildingLevels[i].max - dist) /
+          (m_buildingLevels[i].max - m_buildingLevels[i].min) *
+          (m_buildingLevels[i].level + m_buildingLevels[i].height-base) +
+          base;
 }
 
-void CTerrain::AdjustBuildingLevel(Math::Vector &p)
+/**
+ * Building levels are checked in the order they were added, the first one
+ * containing the position wins. Only levels registered in the grid cell
+ * of the position are tested; positions outside the grid test all levels.
+ * The grid is rebuilt by every function changing the levels, so this only
+ * reads and can be called from several threads at once.
+ */
+int CTerrain::FindBuildingLevel(const Math::Vector &p) const
 {
-    for (int i = 0; i < static_cast<int>( m_buildingLevels.size() ); i++)
+    if (m_buildingLevels.empty()) return -1;
+
+    float dim = (m_mosaicCount*m_brickCount*m_brickSize)/2.0f;
+    int x = static_cast<int>(floor((p.x+dim)/BUILDING_LEVEL_CELL_SIZE));
+    int y = static_cast<int>(floor((p.z+dim)/BUILDING_LEVEL_CELL_SIZE));
+
+    auto test = [&](int i)
     {
         if ( p.x < m_buildingLevels[i].bboxMinX ||
              p.x > m_buildingLevels[i].bboxMaxX ||
              p.z < m_buildingLevels[i].bboxMinZ ||
-             p.z > m_buildingLevels[i].bboxMaxZ ) continue;
+             p.z > m_buildingLevels[i].bboxMaxZ )  return false;
 
         float dist = Math::DistanceProjected(p, m_buildingLevels[i].center);
+        return dist <= m_buildingLevels[i].max;
+    };
 
-        if (dist > m_buildingLevels[i].max) continue;
-
-        if (dist < m_buildingLevels[i].min)
+    if ( x < 0 || x >= m_buildingLevelCellCount ||
+         y < 0 || y >= m_buildingLevelCellCount )
+    {
+        for (int i = 0; i < static_cast<int>( m_buildingLevels.size() ); i++)
         {
-            p.y = m_buildingLevels[i].level + m_buildingLevels[i].height;
-            return;
+            if (test(i)) return i;
         }
+        return -1;
+    }
+
+    for (int i : m_buildingLevelCells[x+y*m_buildingLevelCellCount])
+    {
+        if (test(i)) return i;
+    }
+    return -1;
+}
 
-        Math::Vector border;
-        border.x = ((p.x - m_buildingLevels[i].center.x) * m_buildingLevels[i].max) /
-                   dist + m_buildingLevels[i].center.x;
-        border.z = ((p.z - m_buildingLevels[i].center.z) * m_buildingLevels[i].max) /
-                   dist + m_buildingLevels[i].center.z;
+void CTerrain::UpdateBuildingLevelCells()
+{
+    float size = m_mosaicCount*m_brickCount*m_brickSize;
+    float dim = size/2.0f;
 
-        float base = GetFloorLevel(border, true);
+    m_buildingLevelCellCount = static_cast<int>(ceil(size/BUILDING_LEVEL_CELL_SIZE));
+    m_buildingLevelCells.clear();
+    m_buildingLevelCells.resize(m_buildingLevelCellCount*m_buildingLevelCellCount);
 
-        p.y = (m_buildingLevels[i].max - dist) /
-              (m_buildingLevels[i].max - m_buildingLevels[i].min) *
-              (m_buildingLevels[i].level + m_buildingLevels[i].height-base) +
-              base;
+    for (int i = 0; i < static_cast<int>( m_buildingLevels.size() ); i++)
+    {
+        const BuildingLevel& level = m_buildingLevels[i];
+        int minX = static_cast<int>(floor((level.bboxMinX+dim)/BUILDING_LEVEL_CELL_SIZE));
+        int minY = static_cast<int>(floor((level.bboxMinZ+dim)/BUILDING_LEVEL_CELL_SIZE));
+        int maxX = static_cast<int>(floor((level.bboxMaxX+dim)/BUILDING_LEVEL_CELL_SIZE));
+        int maxY = static_cast<int>(floor((level.bboxMaxZ+dim)/BUILDING_LEVEL_CELL_SIZE));
 
-        return;
+        minX = std::max(minX, 0);
+        minY = std::max(minY, 0);
+        maxX = std::min(maxX, m_buildingLevelCellCount-1);
+        maxY = std::min(maxY, m_buildingLevelCellCount-1);
+
+        // Indexes are added in increasing order, so the first match is the same as in a linear search
+        for (int y = minY; y <= maxY; y++)
+        {
+            for (int x = minX; x <= maxX; x++)
+            {
+                m_buildingLevelCells[x+y*m_buildingLevelCellCount].push_back(i);
+            }
+        }
     }
 }
 
@@ -1809,24 +2468,30 @@ float CTerrain::GetFlatZoneRadius(Math::Vector center, float max)
     Math::Point c(center.x, center.z);
     float radius = 1.0f;
 
+    // Each ring is tested in 8 directions. The sweep used to take
+    // 2*PI*radius samples with the same step, which only repeated them.
+    Math::Vector ring[8];
+    float levels[8];
+
     while (radius <= max)
     {
         angle = 0.0f;
-        int nb = static_cast<int>(2.0f*Math::PI*radius);
-        if (nb < 8) nb = 8;
 
         Math::Point p (center.x+radius, center.z);
-        for (int i = 0; i < nb; i++)
+        for (int i = 0; i < 8; i++)
         {
             Math::Point result = Math::RotatePoint(c, angle, p);
-            Math::Vector pos;
-            pos.x = result.x;
-            pos.z = result.y;
-            float h = GetFloorLevel(pos, true);
-            if ( fabs(h-ref) > 1.0f )  return radius;
+            ring[i].x = result.x;
+            ring[i].z = result.y;
 
             angle += Math::PI*2.0f/8.0f;
         }
+
+        GetFloorLevels(ring, levels, 8, true);
+        for (int i = 0; i < 8; i++)
+        {
+            if ( fabs(levels[i]-ref) > 1.0f )  return radius;
+        }
         radius += 1.0f;
     }
     return max;
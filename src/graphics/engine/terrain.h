@@ -30,6 +30,7 @@
 #include "math/point.h"
 #include "math/vector.h"
 
+#include <deque>
 #include <string>
 #include <vector>
 
@@ -141,6 +142,17 @@ Gfx::IntColor ResourceToColor(TerrainRes res);
  *
  * Underground resources can be supplied by loading them from image like relief data.
  *
+ * \subsection BatchQueries Batch queries
+ *
+ * GetFloorLevels(), AdjustToFloors() and GetNormals() answer the same questions
+ * as their single point counterparts for whole arrays of positions. Points are
+ * processed in blocks, with coordinates kept in separate arrays so that
+ * the interpolation loops can be vectorized by the compiler.
+ *
+ * IntersectRay() finds the exact intersection of a ray with the relief. It descends
+ * a tree of minimum and maximum heights (level 0 holds single squares, each next level
+ * merges 2x2 nodes), so only squares whose height range is crossed by the ray are tested.
+ *
  * Terrain also specifies flying limits for player: one global level and possible
  * additional spherical restrictions.
  */
@@ -182,6 +194,12 @@ public:
     //! Modifies the terrain's relief
     bool        Terraform(const Math::Vector& p1, const Math::Vector& p2, float height);
 
+    //! Returns a copy of the current relief, see RestoreRelief()
+    std::vector<float> GetReliefCopy() const;
+    //! Restores relief previously returned by GetReliefCopy()
+    /** Only mosaic squares that actually changed since then are recreated */
+    bool        RestoreRelief(const std::vector<float>& relief);
+
     //@{
     //! Management of the wind
     void         SetWind(Math::Vector speed);
@@ -200,6 +218,17 @@ public:
     float       GetHeightToFloor(const Math::Vector& pos, bool brut=false, bool water=false);
     //! Modifies the Y coordinate of 3D position to rest on the ground floor
     bool        AdjustToFloor(Math::Vector& pos, bool brut=false, bool water=false);
+    //! Batch version of GetFloorLevel(), fills \a levels with \a count heights
+    void        GetFloorLevels(const Math::Vector* pos, float* levels, int count, bool brut=false, bool water=false);
+    //! Batch version of AdjustToFloor(); returns \c false if any of the positions was outside the terrain
+    bool        AdjustToFloors(Math::Vector* pos, int count, bool brut=false, bool water=false);
+    //! Batch version of GetNormal(); normals of positions outside the terrain are left unchanged
+    void        GetNormals(const Math::Vector* pos, Math::Vector* normals, int count);
+    //! Finds the nearest intersection of a ray with the relief, not further than maxDist
+    /** Building levels are not taken into account. \a dir doesn't have to be normalized. */
+    bool        IntersectRay(const Math::Vector& origin, const Math::Vector& dir, float maxDist, Math::Vector& hit);
+    //! Returns rank of the engine object of the mosaic at 2D (XZ) position or -1
+    int         GetMosaicObjRank(const Math::Vector& pos);
     //! Adjusts 3D position so that it is within standard terrain boundaries
     bool        AdjustToStandardBounds(Math::Vector &pos);
     //! Adjusts 3D position so that it is within terrain boundaries and the given margin
@@ -216,7 +245,7 @@ public:
     //! Removes the elevation for a building when it was destroyed
     bool        DeleteBuildingLevel(Math::Vector center);
     //! Returns the influence factor whether a position is on a possible rise
-    float       GetBuildingFactor(const Math::Vector& pos);
+    float       GetBuildingFactor(const Math::Vector& pos) const;
     //! Returns the hardness of the ground in a given place
     float       GetHardness(const Math::Vector& pos);
 
@@ -234,6 +263,26 @@ public:
     //! Calculates the radius of the largest flat area available
     float       GetFlatZoneRadius(Math::Vector center, float max);
 
+    //! Returns counter incremented on every change of relief or building levels
+    /** Can be used to detect outdated results of terrain queries */
+    unsigned int GetRevision() const;
+
+    /**
+     * \struct ChangedArea
+     * \brief Part of the map changed by one revision of the terrain
+     */
+    struct ChangedArea
+    {
+        unsigned int revision = 0;
+        //! Corners on XZ plane (y of the points is z)
+        Math::Point  min;
+        Math::Point  max;
+    };
+    //! Gets the areas changed after given revision, oldest first
+    /** Returns false if the change can't be narrowed to some areas: the whole relief
+        has changed since, or the revision is too old to be remembered */
+    bool        GetChangedAreas(unsigned int revision, std::vector<ChangedArea>& areas) const;
+
     //@{
     //! Management of the global max flying height
     void        SetFlyingMaxHeight(float height);
@@ -284,6 +333,27 @@ protected:
 
     //! Adjusts a position according to a possible rise
     void        AdjustBuildingLevel(Math::Vector &p);
+    //! Returns index of the building level containing the position or -1
+    int         FindBuildingLevel(const Math::Vector &p) const;
+    //! Rebuilds the grid of building levels after a change
+    void        UpdateBuildingLevelCells();
+
+    //! Rebuilds the whole tree of minimum and maximum heights
+    void        BuildHeightBounds();
+    //! Updates the tree of minimum and maximum heights for a range of squares (inclusive)
+    void        UpdateHeightBounds(int x1, int y1, int x2, int y2);
+    //! Computes the distance at which a ray enters a node of the height tree
+    bool        GetRayNodeEntry(int level, int x, int y, const Math::Vector& origin, const Math::Vector& dir, float maxDist, float& entry);
+    //! Recursive part of IntersectRay(), shortens maxDist on every hit
+    bool        IntersectRayNode(int level, int x, int y, const Math::Vector& origin, const Math::Vector& dir, float& maxDist, Math::Vector& hit);
+    //! Intersects a ray with the two triangles of a square
+    bool        IntersectRaySquare(int x, int y, const Math::Vector& origin, const Math::Vector& dir, float& maxDist, Math::Vector& hit);
+
+    struct FloorBlock;
+    //! Locates up to TERRAIN_BATCH_SIZE positions on the grid and fetches heights of their squares
+    void        PrepareFloorBlock(const Math::Vector* pos, int count, FloorBlock& block);
+    //! Interpolates raw heights of a block prepared by PrepareFloorBlock()
+    void        InterpolateFloorBlock(FloorBlock& block, int count);
 
 protected:
     CEngine*        m_engine;
@@ -384,6 +454,25 @@ protected:
         float        bboxMaxZ = 0.0f;
     };
     std::vector<BuildingLevel> m_buildingLevels;
+    //! Indexes of building levels touching each cell of a coarse grid
+    std::vector<std::vector<int>> m_buildingLevelCells;
+    //! Number of cells on a side of the grid
+    int             m_buildingLevelCellCount = 0;
+
+    /**
+     * \struct HeightBounds
+     * \brief One level of the tree of minimum and maximum heights, see IntersectRay()
+     */
+    struct HeightBounds
+    {
+        //! Number of nodes on a side
+        int size = 0;
+        std::vector<float> min;
+        std::vector<float> max;
+    };
+    std::vector<HeightBounds> m_heightBounds;
+    //! True if the relief changed and the tree must be rebuilt before use
+    bool            m_heightBoundsDirty = true;
 
     //! Wind speed
     Math::Vector    m_wind;
@@ -404,6 +493,18 @@ protected:
     };
     //! List of local flight limits
     std::vector<FlyingLimit> m_flyingLimits;
+
+    //! Starts a new revision changing the whole terrain
+    void        AddChange();
+    //! Starts a new revision changing only given area
+    void        AddChange(const Math::Point& min, const Math::Point& max);
+
+    //! Revision of relief and building levels, see GetRevision()
+    unsigned int    m_revision;
+    //! Areas changed by the last revisions, see GetChangedAreas()
+    std::deque<ChangedArea> m_changedAreas;
+    //! Revision after which all changes are in m_changedAreas
+    unsigned int    m_changedAreasRevision;
 };
 
 
@@ -0,0 +1,98 @@
+/*
+ * This file is part of the Colobot: Gold Edition source code
+ * Copyright (C) 2001-2016, Daniel Roux, EPSITEC SA & TerranovaTeam
+ * http://epsitec.ch; http://colobot.info; http://github.com/colobot
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://gnu.org/licenses
+ */
+
+#include "level/batch_result.h"
+
+#include "common/logger.h"
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace
+{
+
+std::string JsonString(const std::string& str)
+{
+    std::ostringstream out;
+    out << '"';
+    for (char c : str)
+    {
+        switch (c)
+        {
+            case '"':  out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\n': out << "\\n";  break;
+            case '\r': out << "\\r";  break;
+            case '\t': out << "\\t";  break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20)
+                    out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec;
+                else
+                    out << c;
+        }
+    }
+    out << '"';
+    return out.str();
+}
+
+} // anonymous namespace
+
+bool WriteBatchMatchResult(const std::string& filename, const BatchMatchResult& result)
+{
+    std::ofstream file(filename, std::ios::out | std::ios::app);
+    if (!file.is_open())
+    {
+        GetLogger()->Error("Unable to write batch result to '%s'\n", filename.c_str());
+        return false;
+    }
+
+    std::ostringstream line;
+    line << "{\"scene\": " << JsonString(result.scene)
+         << ", \"result\": " << JsonString(result.result)
+         << ", \"winner\": " << result.winnerTeam
+         << ", \"gameTime\": " << result.gameTime
+         << ", \"realTime\": " << result.realTime
+         << ", \"cpuTime\": " << result.cpuTime
+         << ", \"pathSearches\": " << result.pathSearches
+         << ", \"pathsFound\": " << result.pathsFound
+         << ", \"pathSearchTime\": " << result.pathSearchTime
+         << ", \"pathSearchFrames\": " << result.pathSearchFrames
+         << ", \"flowFields\": " << result.flowFields
+         << ", \"flowPaths\": " << result.flowPaths
+         << ", \"pathCacheHits\": " << result.pathCacheHits
+         << ", \"pathCacheMisses\": " << result.pathCacheMisses
+         << ", \"teams\": [";
+
+    for (std::size_t i = 0; i < result.teams.size(); ++i)
+    {
+        const BatchTeamResult& team = result.teams[i];
+        if (i > 0) line << ", ";
+        line << "{\"team\": " << team.team
+             << ", \"name\": " << JsonString(team.name)
+             << ", \"objects\": " << team.objectCount << "}";
+    }
+
+    line << "]}\n";
+
+    // Single write, so lines from processes appending to the same file don't interleave
+    file << line.str();
+    file.flush();
+    return file.good();
+}
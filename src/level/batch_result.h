@@ -0,0 +1,80 @@
+/*
+ * This file is part of the Colobot: Gold Edition source code
+ * Copyright (C) 2001-2016, Daniel Roux, EPSITEC SA & TerranovaTeam
+ * http://epsitec.ch; http://colobot.info; http://github.com/colobot
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://gnu.org/licenses
+ */
+
+/**
+ * \file level/batch_result.h
+ * \brief Results of matches played in batch mode
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+/**
+ * \struct BatchTeamResult
+ * \brief State of one team at the end of a batch match
+ */
+struct BatchTeamResult
+{
+    int         team = 0;
+    std::string name;
+    //! Number of objects of the team left at the end
+    int         objectCount = 0;
+};
+
+/**
+ * \struct BatchMatchResult
+ * \brief Result of a match played in batch mode (see -batch command line option)
+ */
+struct BatchMatchResult
+{
+    //! Scene in the same format as -runscene argument
+    std::string scene;
+    //! One of: "win", "lost", "timeout"
+    std::string result;
+    //! Winning team, 0 if there is none or the mission doesn't use teams
+    int         winnerTeam = 0;
+    //! Simulated game time [seconds]
+    float       gameTime = 0.0f;
+    //! Wall clock time since start of the program [seconds]
+    float       realTime = 0.0f;
+    //! Processor time used by the process [seconds]
+    float       cpuTime = 0.0f;
+    //! Number of finished goto() path searches
+    int         pathSearches = 0;
+    //! Number of path searches which found a path
+    int         pathsFound = 0;
+    //! Time spent in path searches [seconds]
+    float       pathSearchTime = 0.0f;
+    //! Number of frames path searches were spread over
+    int         pathSearchFrames = 0;
+    //! Number of flow fields computed for goals many robots went to
+    int         flowFields = 0;
+    //! Number of paths read from a flow field
+    int         flowPaths = 0;
+    //! Number of paths taken from the path cache
+    int         pathCacheHits = 0;
+    //! Number of path requests not found in the path cache
+    int         pathCacheMisses = 0;
+    std::vector<BatchTeamResult> teams;
+};
+
+//! Appends result as one line of JSON to the given file
+bool WriteBatchMatchResult(const std::string& filename, const BatchMatchResult& result);
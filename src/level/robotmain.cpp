@@ -24,6 +24,7 @@
 #include "app/app.h"
 #include "app/input.h"
 #include "app/pausemanager.h"
+#include "app/replay.h"
 
 #include "common/config_file.h"
 #include "common/event.h"
@@ -37,6 +38,8 @@
 #include "common/resources/outputstream.h"
 #include "common/resources/resourcemanager.h"
 
+#include "common/thread/job_system.h"
+
 #include "graphics/engine/camera.h"
 #include "graphics/engine/cloud.h"
 #include "graphics/engine/engine.h"
@@ -52,21 +55,28 @@
 
 #include "graphics/model/model_manager.h"
 
+#include "level/batch_result.h"
 #include "level/mainmovie.h"
 #include "level/player_profile.h"
 #include "level/scene_conditions.h"
+#include "level/world_snapshot.h"
 
 #include "level/parser/parser.h"
 
 #include "math/const.h"
 #include "math/geometry.h"
 
+#include "object/navigation_grid.h"
 #include "object/object.h"
 #include "object/object_create_exception.h"
+#include "object/object_factory.h"
 #include "object/object_manager.h"
 
 #include "object/auto/auto.h"
 
+#include "object/interface/program_storage_object.h"
+#include "object/interface/programmable_object.h"
+
 #include "object/motion/motion.h"
 #include "object/motion/motionhuman.h"
 #include "object/motion/motiontoto.h"
@@ -156,6 +166,7 @@ CRobotMain::CRobotMain()
     m_ui          = MakeUnique<Ui::CMainUserInterface>();
     m_short       = MakeUnique<Ui::CMainShort>();
     m_map         = MakeUnique<Ui::CMainMap>();
+    m_jobSystem   = MakeUnique<CJobSystem>();
 
     m_objMan = MakeUnique<CObjectManager>(
         m_engine,
@@ -301,6 +312,11 @@ Ui::CDisplayText* CRobotMain::GetDisplayText()
     return m_displayText.get();
 }
 
+CJobSystem* CRobotMain::GetJobSystem()
+{
+    return m_jobSystem.get();
+}
+
 CPauseManager* CRobotMain::GetPauseManager()
 {
     return m_pause.get();
@@ -360,12 +376,20 @@ bool IsMainMenuPhase(Phase phase)
 //! Changes phase
 void CRobotMain::ChangePhase(Phase phase)
 {
+    // Restarting the mission, skip loading the level again if possible
+    if (m_phase == PHASE_SIMUL && phase == PHASE_SIMUL && m_sceneReadPath.empty())
+    {
+        if (RestoreWorldSnapshot()) return;
+    }
+
     bool resetWorld = false;
     if ((IsPhaseWithWorld(m_phase) || IsPhaseWithWorld(phase)) && !IsInSimulationConfigPhase(m_phase) && !IsInSimulationConfigPhase(phase))
     {
         if (IsPhaseWithWorld(m_phase) && !IsPhaseWithWorld(phase) && m_exitAfterMission)
         {
             GetLogger()->Info("Mission finished in single mission mode, exiting\n");
+            if (m_app->GetBatchMode())
+                WriteBatchResult(phase);
             m_eventQueue->AddEvent(Event(EVENT_QUIT));
             return;
         }
@@ -1399,6 +1423,25 @@ void CRobotMain::ExecuteCmd(const std::string& cmd)
         return;
     }
 
+    if (cmd == "memreport")
+    {
+        std::size_t totalBytes = 0;
+        int totalCount = 0;
+        GetLogger()->Info("Object memory usage:\n");
+        for (const auto& it : m_objMan->GetMemoryReport())
+        {
+            GetLogger()->Info("  %-20s %6d objects %10lu bytes (%lu per object)\n",
+                              CLevelParserParam::FromObjectType(it.first).c_str(), it.second.count,
+                              static_cast<unsigned long>(it.second.bytes),
+                              static_cast<unsigned long>(it.second.bytes / it.second.count));
+            totalBytes += it.second.bytes;
+            totalCount += it.second.count;
+        }
+        GetLogger()->Info("  %-20s %6d objects %10lu bytes\n", "total", totalCount,
+                          static_cast<unsigned long>(totalBytes));
+        return;
+    }
+
     if (cmd == "invui")
     {
         m_engine->SetRenderInterface(!m_engine->GetRenderInterface());
@@ -1777,9 +1820,8 @@ CObject* CRobotMain::GetSelectObject()
 CObject* CRobotMain::DeselectAll()
 {
     CObject* prev = nullptr;
-    for (CObject* obj : m_objMan->GetAllObjects())
+    for (CObject* obj : m_objMan->GetObjectsImplementing(ObjectInterfaceType::Controllable))
     {
-        if (!obj->Implements(ObjectInterfaceType::Controllable)) continue;
         auto controllableObj = dynamic_cast<CControllableObject*>(obj);
         if (controllableObj->GetSelect()) prev = obj;
         controllableObj->SetSelect(false);
@@ -1960,9 +2002,8 @@ CObject* CRobotMain::SearchNearest(Math::Vector pos, CObject* exclu)
 //! Returns the selected object
 CObject* CRobotMain::GetSelect()
 {
-    for (CObject* obj : m_objMan->GetAllObjects())
+    for (CObject* obj : m_objMan->GetObjectsImplementing(ObjectInterfaceType::Controllable))
     {
-        if (!obj->Implements(ObjectInterfaceType::Controllable)) continue;
         if (dynamic_cast<CControllableObject*>(obj)->GetSelect())
             return obj;
     }
@@ -2070,9 +2111,8 @@ void CRobotMain::HiliteClear()
     int rank = -1;
     m_engine->SetHighlightRank(&rank);  // nothing more selected
 
-    for (CObject* obj : m_objMan->GetAllObjects())
+    for (CObject* obj : m_objMan->GetObjectsImplementing(ObjectInterfaceType::Controllable))
     {
-        if (!obj->Implements(ObjectInterfaceType::Controllable)) continue;
         dynamic_cast<CControllableObject*>(obj)->SetHighlight(false);
     }
     m_map->SetHighlight(nullptr);
@@ -2334,6 +2374,11 @@ void CRobotMain::UpdateInfoText()
             Math::Vector pos = obj->GetPosition();
             m_engine->SetStatisticPos(pos / g_unit);
         }
+
+        const PathSearchStatistics& paths = m_objMan->GetNavigationGrid()->GetPathSearchStatistics();
+        float pathTime = paths.searches == 0 ? 0.0f : paths.time / 1e6f / paths.searches;
+        m_engine->SetStatisticPathSearch(paths.searches, paths.found, pathTime);
+        m_engine->SetStatisticPathCache(paths.cacheHits, paths.cacheMisses);
     }
     m_engine->SetTimerDisplay(m_missionTimerEnabled && m_missionTimerStarted ? TimeFormat(m_missionTimer) : "");
 }
@@ -2347,6 +2392,37 @@ void CRobotMain::InitEye()
                        Math::Vector(10.0f,  5.0f, 0.0f), 0.0f);
 }
 
+//! Prefetches the terrain under moving objects on all cores
+/**
+ * Only terrain queries run in parallel: jobs store the samples in their own
+ * CPhysics, which makes the outcome independent of the number of threads. The
+ * object updates themselves still run afterwards, one object at a time, in EventFrame().
+ */
+void CRobotMain::PrepareObjectFrames(float rTime)
+{
+    std::vector<CPhysics*> physicsList;
+    int sleeping = 0;
+    for (CObject* obj : m_objMan->GetAllObjects())
+    {
+        CMovableObject* movable = obj->GetInterface<ObjectInterfaceType::Movable>();
+        if (movable == nullptr) continue;
+
+        CPhysics* physics = movable->GetPhysics();
+        if (physics == nullptr) continue;
+
+        if (physics->IsSleeping())
+            sleeping++;
+        else
+            physicsList.push_back(physics);
+    }
+    m_engine->SetStatisticPhysics(static_cast<int>(physicsList.size()), sleeping);
+
+    m_jobSystem->ParallelFor(static_cast<int>(physicsList.size()), [&physicsList, rTime](int i)
+    {
+        physicsList[i]->PrepareFrame(rTime);
+    });
+}
+
 //! Advances the entire scene
 bool CRobotMain::EventFrame(const Event &event)
 {
@@ -2401,9 +2477,29 @@ bool CRobotMain::EventFrame(const Event &event)
         if (pm != nullptr) pm->FlushObject();
     }
 
+    // Before any program had a chance to run
+    if (m_phase == PHASE_SIMUL && m_worldSnapshotPending)
+    {
+        m_worldSnapshotPending = false;
+        TakeWorldSnapshot();
+    }
+
+    if (m_phase == PHASE_SIMUL && !m_replayProgramsSynced)
+    {
+        m_replayProgramsSynced = true;
+        SyncReplayPrograms();
+    }
+
     CObject* toto = nullptr;
     if (!m_pause->IsPauseType(PAUSE_OBJECT_UPDATES))
     {
+        m_app->StartPerformanceCounter(PCNT_UPDATE_PHYSICS_PREPARE);
+        PrepareObjectFrames(event.rTime);
+        m_app->StopPerformanceCounter(PCNT_UPDATE_PHYSICS_PREPARE);
+
+        // Robots following a path see where the others went in the last frame
+        m_objMan->GetNavigationGrid()->NextFrame();
+
         // Advances all the robots, but not toto.
         for (CObject* obj : m_objMan->GetAllObjects())
         {
@@ -2415,8 +2511,8 @@ bool CRobotMain::EventFrame(const Event &event)
 
             if (obj->GetType() == OBJECT_TOTO)
                 toto = obj;
-            else if (obj->Implements(ObjectInterfaceType::Interactive))
-                dynamic_cast<CInteractiveObject*>(obj)->EventProcess(event);
+            else if (CInteractiveObject* interactive = obj->GetInterface<ObjectInterfaceType::Interactive>())
+                interactive->EventProcess(event);
 
             if ( obj->GetProxyActivate() )  // active if it is near?
             {
@@ -2438,11 +2534,14 @@ bool CRobotMain::EventFrame(const Event &event)
             if (! IsObjectBeingTransported(obj))
                 continue;
 
-            if (obj->Implements(ObjectInterfaceType::Interactive))
-                dynamic_cast<CInteractiveObject*>(obj)->EventProcess(event);
+            if (CInteractiveObject* interactive = obj->GetInterface<ObjectInterfaceType::Interactive>())
+                interactive->EventProcess(event);
         }
 
         m_engine->GetPyroManager()->EventProcess(event);
+
+        // Objects have moved, changed state...
+        m_objMan->InvalidateRadarCache();
     }
 
     // The camera follows the object, because its position
@@ -2564,8 +2663,10 @@ bool CRobotMain::EventFrame(const Event &event)
     {
         if (!m_editLock)
         {
+            m_app->StartPerformanceCounter(PCNT_UPDATE_CONDITIONS);
             CheckEndMission(true);
             UpdateAudio(true);
+            m_app->StopPerformanceCounter(PCNT_UPDATE_CONDITIONS);
         }
 
         if (m_winDelay > 0.0f && !m_editLock)
@@ -2593,13 +2694,18 @@ bool CRobotMain::EventFrame(const Event &event)
         }
     }
 
+    if (m_phase == PHASE_SIMUL && m_app->GetBatchMode())
+        UpdateBatchMode();
+
     if (GetMissionType() == MISSION_CODE_BATTLE)
     {
         if (!m_codeBattleInit)
         {
             // NOTE: It's important to do this AFTER the first update event finished processing
             //       because otherwise all robot parts are misplaced
-            m_userPause = m_pause->ActivatePause(PAUSE_ENGINE);
+            // In batch mode there is nobody to press the start button
+            if (!m_app->GetBatchMode())
+                m_userPause = m_pause->ActivatePause(PAUSE_ENGINE);
             m_codeBattleInit = true; // Will start on resume
         }
 
@@ -2617,6 +2723,479 @@ bool CRobotMain::EventFrame(const Event &event)
     return true;
 }
 
+//! Batch mode: gives programs to the teams and enforces the time limit
+void CRobotMain::UpdateBatchMode()
+{
+    if (!m_batchProgramsLoaded)
+    {
+        m_batchProgramsLoaded = true;
+        LoadBatchTeamPrograms();
+    }
+
+    float timeLimit = m_app->GetBatchTimeLimit();
+    if (timeLimit > 0.0f && m_gameTime >= timeLimit && !m_batchTimedOut)
+    {
+        GetLogger()->Info("Time limit of %.1f s reached, ending the match\n", timeLimit);
+        m_batchTimedOut = true;
+        m_eventQueue->AddEvent(Event(EVENT_LOST));
+    }
+}
+
+//! Loads programs given by -teamprogram into all programmable robots of their team and starts them
+void CRobotMain::LoadBatchTeamPrograms()
+{
+    const std::map<int, std::string>& teamPrograms = m_app->GetTeamPrograms();
+    CReplayRecorder* recorder = m_app->GetReplayRecorder();
+    CReplayPlayer* replay = m_app->GetReplayPlayer();
+
+    // Source of the program of each team, from the replay or from the first robot which loaded the file
+    std::map<int, std::string> sources;
+    if (replay != nullptr)
+    {
+        for (const ReplayProgram& program : replay->GetPrograms())
+        {
+            if (program.objectId == -1)
+                sources[program.index] = program.source;
+        }
+    }
+
+    if (teamPrograms.empty() && sources.empty()) return;
+
+    for (CObject* obj : m_objMan->GetAllObjects())
+    {
+        int team = obj->GetTeam();
+        auto file = teamPrograms.find(team);
+        auto source = sources.find(team);
+        if (file == teamPrograms.end() && source == sources.end()) continue;
+
+        CProgramStorageObject* programStorage = obj->GetInterface<ObjectInterfaceType::ProgramStorage>();
+        CProgrammableObject* programmable = obj->GetInterface<ObjectInterfaceType::Programmable>();
+        if (programStorage == nullptr || programmable == nullptr) continue;
+
+        Program* program = programStorage->AddProgram();
+        if (source != sources.end())
+        {
+            program->script->SendScript(source->second.c_str());
+        }
+        else
+        {
+            if (!programStorage->ReadProgram(program, file->second))
+            {
+                GetLogger()->Error("Unable to load program '%s' for team %d\n", file->second.c_str(), team);
+                continue;
+            }
+
+            sources[team] = program->script->GetScriptText();
+            if (recorder != nullptr)
+            {
+                ReplayProgram recorded;
+                recorded.objectId = -1;
+                recorded.index = team;
+                recorded.source = sources[team];
+                recorder->RecordProgram(recorded);
+            }
+        }
+
+        if (!programStorage->GetCompile(program))
+        {
+            GetLogger()->Error("Program for team %d doesn't compile\n", team);
+            continue;
+        }
+
+        programmable->RunProgram(program);
+    }
+}
+
+//! Stores programs of all robots in the replay being recorded, or replaces them with the recorded ones when replaying
+void CRobotMain::SyncReplayPrograms()
+{
+    CReplayRecorder* recorder = m_app->GetReplayRecorder();
+    CReplayPlayer* replay = m_app->GetReplayPlayer();
+    if (recorder == nullptr && replay == nullptr) return;
+
+    int replaced = 0;
+    for (CObject* obj : m_objMan->GetAllObjects())
+    {
+        CProgramStorageObject* programStorage = obj->GetInterface<ObjectInterfaceType::ProgramStorage>();
+        if (programStorage == nullptr) continue;
+
+        if (recorder != nullptr)
+        {
+            for (int i = 0; i < programStorage->GetProgramCount(); i++)
+            {
+                ReplayProgram recorded;
+                recorded.objectId = obj->GetID();
+                recorded.index = i;
+                recorded.restart = m_replayRestarts;
+                recorded.source = programStorage->GetProgram(i)->script->GetScriptText();
+                recorder->RecordProgram(recorded);
+            }
+            continue;
+        }
+
+        // User programs of the player watching the replay may differ from the recorded ones
+        CProgrammableObject* programmable = obj->GetInterface<ObjectInterfaceType::Programmable>();
+        int count = 0;
+        for (const ReplayProgram* recorded = replay->GetProgram(obj->GetID(), count, m_replayRestarts); recorded != nullptr;
+             recorded = replay->GetProgram(obj->GetID(), ++count, m_replayRestarts))
+        {
+            Program* program = programStorage->GetOrAddProgram(count);
+            if (program->script->GetScriptText() == recorded->source) continue;
+
+            program->script->SendScript(recorded->source.c_str());
+            replaced++;
+
+            // Started by the level, but didn't execute anything yet
+            if (programmable != nullptr && programmable->GetCurrentProgram() == program)
+            {
+                programmable->StopProgram();
+                programmable->RunProgram(program);
+            }
+        }
+
+        while (programStorage->GetProgramCount() > count)
+        {
+            Program* program = programStorage->GetProgram(programStorage->GetProgramCount() - 1);
+            if (programmable != nullptr && programmable->GetCurrentProgram() == program)
+                programmable->StopProgram();
+            programStorage->RemoveProgram(program);
+            replaced++;
+        }
+    }
+
+    if (replaced > 0)
+        GetLogger()->Info("Replaced %d programs with their versions from the replay\n", replaced);
+}
+
+//! Stores state of the mission that just started, see RestoreWorldSnapshot()
+void CRobotMain::TakeWorldSnapshot()
+{
+    // Code battles have their own start sequence, they are always fully reloaded
+    if (m_missionType == MISSION_CODE_BATTLE) return;
+
+    m_worldSnapshot = MakeUnique<WorldSnapshot>();
+    m_worldSnapshot->category = m_levelCategory;
+    m_worldSnapshot->chap = m_levelChap;
+    m_worldSnapshot->rank = m_levelRank;
+    m_worldSnapshot->soluce = m_ui->GetSceneSoluce();
+    m_worldSnapshot->objects.SetLevelPaths(m_levelCategory, m_levelChap, m_levelRank);
+
+    for (CObject* obj : m_objMan->GetAllObjects())
+    {
+        if (IsObjectBeingTransported(obj)) continue;
+        if (obj->Implements(ObjectInterfaceType::Destroyable) && dynamic_cast<CDestroyableObject*>(obj)->IsDying()) continue;
+
+        CLevelParserLineUPtr line;
+
+        if (obj->Implements(ObjectInterfaceType::Carrier))
+        {
+            CObject* cargo = dynamic_cast<CCarrierObject*>(obj)->GetCargo();
+            if (cargo != nullptr)
+            {
+                line = MakeUnique<CLevelParserLine>("CreateFret");
+                IOWriteObjectState(line.get(), cargo);
+                WriteSnapshotPrograms(cargo);
+                m_worldSnapshot->objects.AddLine(std::move(line));
+            }
+        }
+
+        if (obj->Implements(ObjectInterfaceType::Powered))
+        {
+            CObject* power = dynamic_cast<CPoweredObject*>(obj)->GetPower();
+            if (power != nullptr)
+            {
+                line = MakeUnique<CLevelParserLine>("CreatePower");
+                IOWriteObjectState(line.get(), power);
+                WriteSnapshotPrograms(power);
+                m_worldSnapshot->objects.AddLine(std::move(line));
+            }
+        }
+
+        line = MakeUnique<CLevelParserLine>("CreateObject");
+        IOWriteObjectState(line.get(), obj);
+        WriteSnapshotPrograms(obj);
+        m_worldSnapshot->objects.AddLine(std::move(line));
+    }
+
+    m_camera->GetCamera(m_worldSnapshot->cameraEye, m_worldSnapshot->cameraLookat);
+
+    m_worldSnapshot->relief = m_terrain->GetReliefCopy();
+
+    m_worldSnapshot->researchDone = m_researchDone;
+    m_worldSnapshot->researchEnable = m_researchEnable;
+    m_worldSnapshot->build = m_build;
+
+    m_worldSnapshot->lightning = m_lightning->GetStatus(m_worldSnapshot->lightningSleep,
+                                                        m_worldSnapshot->lightningDelay,
+                                                        m_worldSnapshot->lightningMagnetic,
+                                                        m_worldSnapshot->lightningProgress);
+
+    m_worldSnapshot->endTakeWinDelay = m_endTakeWinDelay;
+    m_worldSnapshot->endTakeLostDelay = m_endTakeLostDelay;
+
+    GetLogger()->Debug("World snapshot taken, %d objects\n", static_cast<int>(m_worldSnapshot->objects.GetLines().size()));
+}
+
+//! Stores programs of the object in the world snapshot
+void CRobotMain::WriteSnapshotPrograms(CObject* obj)
+{
+    CProgramStorageObject* programStorage = obj->GetInterface<ObjectInterfaceType::ProgramStorage>();
+    if (programStorage == nullptr) return;
+
+    WorldSnapshotObjectPrograms& programs = m_worldSnapshot->programs[obj->GetID()];
+    for (int i = 0; i < programStorage->GetProgramCount(); i++)
+    {
+        Program* program = programStorage->GetProgram(i);
+
+        WorldSnapshotProgram stored;
+        stored.source = program->script->GetScriptText();
+        stored.filename = program->filename;
+        stored.readOnly = program->readOnly;
+        stored.runnable = program->runnable;
+        programs.programs.push_back(stored);
+    }
+
+    CProgrammableObject* programmable = obj->GetInterface<ObjectInterfaceType::Programmable>();
+    if (programmable != nullptr)
+        programs.run = programStorage->GetProgramIndex(programmable->GetCurrentProgram());
+}
+
+//! Gives the object its programs from the world snapshot
+void CRobotMain::ReadSnapshotPrograms(CObject* obj)
+{
+    CProgramStorageObject* programStorage = obj->GetInterface<ObjectInterfaceType::ProgramStorage>();
+    if (programStorage == nullptr) return;
+
+    auto it = m_worldSnapshot->programs.find(obj->GetID());
+    if (it == m_worldSnapshot->programs.end()) return;
+    const WorldSnapshotObjectPrograms& programs = it->second;
+
+    // User programs are taken from the user directory instead, exactly like
+    // when loading the level, so that changes made since the start are kept
+    bool userPrograms = programStorage->GetProgramStorageIndex() >= 0;
+
+    for (const WorldSnapshotProgram& stored : programs.programs)
+    {
+        if (userPrograms && stored.filename.empty()) continue;
+
+        Program* program = programStorage->AddProgram();
+        program->script->SendScript(stored.source.c_str());
+        program->filename = stored.filename;
+        program->readOnly = stored.readOnly;
+        program->runnable = stored.runnable;
+    }
+
+    if (userPrograms)
+    {
+        char categoryChar = GetLevelCategoryDir(m_levelCategory)[0];
+        CLevelParserLine noLevelPrograms("CreateObject");
+        programStorage->LoadAllProgramsForLevel(
+            &noLevelPrograms,
+            m_playerProfile->GetSaveFile(StrUtils::Format("%c%.3d%.3d", categoryChar, m_levelChap, m_levelRank)),
+            false
+        );
+    }
+
+    CProgrammableObject* programmable = obj->GetInterface<ObjectInterfaceType::Programmable>();
+    if (programmable != nullptr && programs.run >= 0 && programs.run < programStorage->GetProgramCount())
+        programmable->RunProgram(programStorage->GetProgram(programs.run));
+}
+
+//! Restarts the current mission from the state it had when it started
+bool CRobotMain::RestoreWorldSnapshot()
+{
+    if (m_worldSnapshot == nullptr) return false;
+    if (m_worldSnapshot->category != m_levelCategory ||
+        m_worldSnapshot->chap != m_levelChap ||
+        m_worldSnapshot->rank != m_levelRank ||
+        m_worldSnapshot->soluce != m_ui->GetSceneSoluce()) return false;
+
+    GetLogger()->Info("Restarting mission from the world snapshot...\n");
+
+    SaveAllScript();
+    m_camera->SetControllingObject(nullptr);
+
+    if (m_gameTime > 10.0f)  // did you play at least 10 seconds?
+    {
+        m_playerProfile->IncrementLevelTryCount(m_levelCategory, m_levelChap, m_levelRank);
+    }
+
+    // Removes all bullets in progress.
+    m_particle->DeleteParticle(Gfx::PARTIGUN1);
+    m_particle->DeleteParticle(Gfx::PARTIGUN2);
+    m_particle->DeleteParticle(Gfx::PARTIGUN3);
+    m_particle->DeleteParticle(Gfx::PARTIGUN4);
+
+    DeselectAll();  // removes the control buttons
+    DeleteAllObjects();  // removes all the current 3D Scene
+    m_controller = nullptr;
+
+    m_particle->FlushParticle();
+    m_terrain->FlushBuildingLevel();
+    m_terrain->RestoreRelief(m_worldSnapshot->relief);
+    m_base = nullptr;
+
+    m_researchDone = m_worldSnapshot->researchDone;
+    m_researchEnable = m_worldSnapshot->researchEnable;
+    m_build = m_worldSnapshot->build;
+
+    m_lightning->Flush();
+    if (m_worldSnapshot->lightning)
+    {
+        m_lightning->SetStatus(m_worldSnapshot->lightningSleep,
+                               m_worldSnapshot->lightningDelay,
+                               m_worldSnapshot->lightningMagnetic,
+                               m_worldSnapshot->lightningProgress);
+    }
+
+    m_pause->FlushPause();
+    m_freePhotoPause = nullptr;
+    m_userPause = nullptr;
+    m_focusPause = nullptr;
+    FlushDisplayInfo();
+    m_sound->StopAll();
+    m_movie->Flush();
+    SetSpeed(1.0f);
+
+    m_winDelay    = 0.0f;
+    m_lostDelay   = 0.0f;
+    m_beginSatCom = false;
+    m_movieLock   = false;
+    m_satComLock  = false;
+    m_editLock    = false;
+    m_resetCreate = false;
+    m_infoObject  = nullptr;
+
+    m_missionResult = ERR_MISSION_NOTERM;
+    m_missionResultFromScript = false;
+    m_endTakeWinDelay = m_worldSnapshot->endTakeWinDelay;
+    m_endTakeLostDelay = m_worldSnapshot->endTakeLostDelay;
+    m_winnerTeam = 0;
+    // Programs restored from the snapshot are recorded again, they may have been edited since the start
+    m_replayProgramsSynced = false;
+    m_replayRestarts++;
+
+    m_missionTimerEnabled = false;
+    m_missionTimerStarted = false;
+    m_missionTimer = 0.0f;
+
+    for (std::unique_ptr<CAudioChangeCondition>& audioChange : m_audioChange)
+        audioChange->changed = false;
+
+    CObject* cargo = nullptr;
+    CObject* power = nullptr;
+    CObject* sel   = nullptr;
+    try
+    {
+        for (const CLevelParserLineUPtr& line : m_worldSnapshot->objects.GetLines())
+        {
+            CObject* obj = IOCreateObject(line.get());
+            if (obj->GetType() == OBJECT_CONTROLLER)
+                m_controller = obj;
+
+            if (line->GetCommand() == "CreateFret")
+            {
+                cargo = obj;
+                continue;
+            }
+
+            if (line->GetCommand() == "CreatePower")
+            {
+                power = obj;
+                continue;
+            }
+
+            if (line->GetParam("select")->AsBool(false))
+                sel = obj;
+
+            IOAttachObjects(obj, cargo, power);
+            cargo = nullptr;
+            power = nullptr;
+        }
+
+        // Only after all objects exist, programs may refer to them
+        for (CObject* obj : m_objMan->GetAllObjects())
+        {
+            ReadSnapshotPrograms(obj);
+        }
+    }
+    catch (const std::runtime_error& e)
+    {
+        LevelLoadingError("An error occurred while trying to restore the world snapshot", e);
+        return true;
+    }
+
+    m_map->UpdateMap();
+    m_input->ResetKeyStates();
+    m_time = 0.0f;
+    m_gameTime = 0.0f;
+    m_gameTimeAbsolute = 0.0f;
+    m_autosaveLast = 0.0f;
+    m_infoUsed = 0;
+
+    m_camera->SetType(Gfx::CAM_TYPE_NULL);
+    m_camera->Init(m_worldSnapshot->cameraEye, m_worldSnapshot->cameraLookat, 0.0f);
+
+    m_selectObject = sel;
+    if (m_base == nullptr && !m_fixScene)
+    {
+        CObject* obj = sel;
+        if (sel == nullptr)
+            obj = SearchHuman();
+
+        if (obj != nullptr)
+        {
+            assert(obj->Implements(ObjectInterfaceType::Controllable));
+            SelectObject(obj);
+            m_camera->SetControllingObject(obj);
+            m_camera->SetType(dynamic_cast<CControllableObject*>(obj)->GetCameraType());
+        }
+    }
+
+    CreateShortcuts();
+    m_app->ResetTimeAfterLoading();
+    return true;
+}
+
+//! Batch mode: appends result of the finished match to the -results file
+void CRobotMain::WriteBatchResult(Phase phase)
+{
+    const std::string& filename = m_app->GetBatchResultFile();
+    if (filename.empty()) return;
+
+    BatchMatchResult result;
+    result.scene = StrUtils::Format("%s%d", GetLevelCategoryDir(m_levelCategory).c_str(), m_levelChap * 100 + m_levelRank);
+    if (m_batchTimedOut)
+        result.result = "timeout";
+    else
+        result.result = phase == PHASE_WIN ? "win" : "lost";
+    result.winnerTeam = m_batchTimedOut ? 0 : m_winnerTeam;
+    result.gameTime = m_gameTime;
+    result.realTime = static_cast<float>(m_app->GetRealAbsTime() / 1e9);
+    result.cpuTime = static_cast<float>(std::clock()) / CLOCKS_PER_SEC;
+
+    const PathSearchStatistics& paths = m_objMan->GetNavigationGrid()->GetPathSearchStatistics();
+    result.pathSearches = paths.searches;
+    result.pathsFound = paths.found;
+    result.pathSearchTime = static_cast<float>(paths.time / 1e9);
+    result.pathSearchFrames = paths.frames;
+    result.flowFields = paths.flowFields;
+    result.flowPaths = paths.flowPaths;
+    result.pathCacheHits = paths.cacheHits;
+    result.pathCacheMisses = paths.cacheMisses;
+
+    for (const auto& it : m_teamNames)
+    {
+        BatchTeamResult team;
+        team.team = it.first;
+        team.name = it.second;
+        team.objectCount = static_cast<int>(m_objMan->GetObjectsOfTeam(it.first).size());
+        result.teams.push_back(team);
+    }
+
+    WriteBatchMatchResult(filename, result);
+}
+
 void CRobotMain::ShowSaveIndicator(bool show)
 {
     Ui::CControl* pc = m_interface->SearchControl(EVENT_OBJECT_SAVING);
@@ -2655,9 +3234,9 @@ bool CRobotMain::EventObject(const Event &event)
 
     for (CObject* obj : m_objMan->GetAllObjects())
     {
-        if (obj->Implements(ObjectInterfaceType::Interactive))
+        if (CInteractiveObject* interactive = obj->GetInterface<ObjectInterfaceType::Interactive>())
         {
-            dynamic_cast<CInteractiveObject*>(obj)->EventProcess(event);
+            interactive->EventProcess(event);
         }
     }
 
@@ -2773,6 +3352,14 @@ void CRobotMain::CreateScene(bool soluce, bool fixScene, bool resetObject)
         m_codeBattleStarted = false;
 
         m_teamNames.clear();
+        m_winnerTeam = 0;
+        m_batchProgramsLoaded = false;
+        m_batchTimedOut = false;
+        m_replayProgramsSynced = false;
+        m_replayRestarts = 0;
+
+        m_worldSnapshot.reset();
+        m_worldSnapshotPending = m_sceneReadPath.empty() && !fixScene;
 
         m_missionResult = ERR_MISSION_NOTERM;
         m_missionResultFromScript = false;
@@ -2809,8 +3396,11 @@ void CRobotMain::CreateScene(bool soluce, bool fixScene, bool resetObject)
         int rankObj = 0;
         CObject* sel = nullptr;
 
-        for (auto& line : levelParser.GetLines())
+        const auto& lines = levelParser.GetLines();
+        for (std::size_t lineIndex = 0; lineIndex < lines.size(); lineIndex++)
         {
+            const CLevelParserLineUPtr& line = lines[lineIndex];
+
             if (line->GetCommand() == "Title" && !resetObject)
             {
                 //strcpy(m_title, line->GetParam("text")->AsString().c_str());
@@ -3377,6 +3967,46 @@ void CRobotMain::CreateScene(bool soluce, bool fixScene, bool resetObject)
             {
                 ObjectCreateParams params = CObject::ReadCreateParams(line.get());
 
+                if (CObjectFactory::CanClone(params.type))
+                {
+                    // Runs of identical ores, plants etc. are cloned from the first of them
+                    std::vector<ObjectCreateParams> batchParams = { params };
+                    std::vector<CLevelParserLine*> batchLines = { line.get() };
+                    while (lineIndex+1 < lines.size() && lines[lineIndex+1]->GetCommand() == "CreateObject")
+                    {
+                        ObjectCreateParams nextParams = CObject::ReadCreateParams(lines[lineIndex+1].get());
+                        if (!CObjectFactory::IsSamePrototype(params, nextParams)) break;
+
+                        lineIndex++;
+                        batchParams.push_back(nextParams);
+                        batchLines.push_back(lines[lineIndex].get());
+                    }
+
+                    float objectProgress = static_cast<float>(rankObj) / static_cast<float>(numObjects);
+                    std::string details = StrUtils::ToString<int>(rankObj+1)+" / "+StrUtils::ToString<int>(numObjects);
+                    #if DEV_BUILD
+                    details += ": "+CLevelParserParam::FromObjectType(params.type);
+                    #endif
+                    m_ui->GetLoadingScreen()->SetProgress(0.25f+objectProgress*0.75f, RT_LOADING_OBJECTS, details);
+
+                    try
+                    {
+                        std::vector<CObject*> objects = m_objMan->CreateObjects(batchParams);
+                        for (std::size_t i = 0; i < objects.size(); i++)
+                        {
+                            objects[i]->Read(batchLines[i]);
+                        }
+                    }
+                    catch (const CObjectCreateException& e)
+                    {
+                        GetLogger()->Error("Error loading level object: %s\n", e.what());
+                        throw;
+                    }
+
+                    rankObj += batchParams.size();
+                    continue;
+                }
+
                 float objectProgress = static_cast<float>(rankObj) / static_cast<float>(numObjects);
                 std::string details = StrUtils::ToString<int>(rankObj+1)+" / "+StrUtils::ToString<int>(numObjects);
                 #if DEV_BUILD
@@ -3969,48 +4599,70 @@ void CRobotMain::ChangeColor()
 //! Calculates the distance to the nearest object
 float CRobotMain::SearchNearestObject(Math::Vector center, CObject *exclu)
 {
+    // The searched area grows until it contains an object closer than its radius,
+    // objects outside of it can't be any closer. The margin covers the bases,
+    // which keep 80 units of free space around them.
+    float size = m_terrain->GetMosaicCount()*m_terrain->GetBrickCount()*m_terrain->GetBrickSize();
+    for (float radius = 10.0f*g_unit; radius < size*2.0f; radius *= 2.0f)
+    {
+        float min = 100000.0f;
+        for (CObject* obj : m_objMan->GetCollisionCandidates(center, radius+80.0f))
+        {
+            min = Math::Min(min, GetObjectClearance(obj, center, exclu));
+        }
+        if (min <= radius) return min;
+    }
+
     float min = 100000.0f;
     for (CObject* obj : m_objMan->GetAllObjects())
     {
-        if (!obj->GetDetectable()) continue;  // inactive?
-        if (IsObjectBeingTransported(obj)) continue;
+        min = Math::Min(min, GetObjectClearance(obj, center, exclu));
+    }
+    return min;
+}
+
+//! Calculates the distance to an object, for SearchNearestObject()
+float CRobotMain::GetObjectClearance(CObject* obj, Math::Vector center, CObject *exclu)
+{
+    float min = 100000.0f;
 
-        if (obj == exclu)  continue;
+    if (!obj->GetDetectable()) return min;  // inactive?
+    if (IsObjectBeingTransported(obj)) return min;
 
-        ObjectType type = obj->GetType();
+    if (obj == exclu)  return min;
 
-        if (type == OBJECT_BASE)
-        {
-            Math::Vector oPos = obj->GetPosition();
-            if (oPos.x != center.x ||
-                oPos.z != center.z)
-            {
-                float dist = Math::Distance(center, oPos)-80.0f;
-                if (dist < 0.0f) dist = 0.0f;
-                min = Math::Min(min, dist);
-                continue;
-            }
-        }
+    ObjectType type = obj->GetType();
 
-        if (type == OBJECT_STATION   ||
-            type == OBJECT_REPAIR    ||
-            type == OBJECT_DESTROYER)
+    if (type == OBJECT_BASE)
+    {
+        Math::Vector oPos = obj->GetPosition();
+        if (oPos.x != center.x ||
+            oPos.z != center.z)
         {
-            Math::Vector oPos = obj->GetPosition();
-            float dist = Math::Distance(center, oPos)-8.0f;
+            float dist = Math::Distance(center, oPos)-80.0f;
             if (dist < 0.0f) dist = 0.0f;
-            min = Math::Min(min, dist);
+            return dist;
         }
+    }
 
-        for (const auto& crashSphere : obj->GetAllCrashSpheres())
-        {
-            Math::Vector oPos = crashSphere.sphere.pos;
-            float oRadius = crashSphere.sphere.radius;
+    if (type == OBJECT_STATION   ||
+        type == OBJECT_REPAIR    ||
+        type == OBJECT_DESTROYER)
+    {
+        Math::Vector oPos = obj->GetPosition();
+        float dist = Math::Distance(center, oPos)-8.0f;
+        if (dist < 0.0f) dist = 0.0f;
+        min = Math::Min(min, dist);
+    }
 
-            float dist = Math::Distance(center, oPos)-oRadius;
-            if (dist < 0.0f) dist = 0.0f;
-            min = Math::Min(min, dist);
-        }
+    for (const auto& crashSphere : obj->GetAllCrashSpheres())
+    {
+        Math::Vector oPos = crashSphere.sphere.pos;
+        float oRadius = crashSphere.sphere.radius;
+
+        float dist = Math::Distance(center, oPos)-oRadius;
+        if (dist < 0.0f) dist = 0.0f;
+        min = Math::Min(min, dist);
     }
     return min;
 }
@@ -4392,6 +5044,7 @@ void CRobotMain::SaveAllScript()
 void CRobotMain::SaveOneScript(CObject *obj)
 {
     if (! obj->Implements(ObjectInterfaceType::ProgramStorage)) return;
+    if (m_app->GetReplayPlayer() != nullptr) return; // Don't overwrite user programs with the replayed ones
 
     CProgramStorageObject* programStorage = dynamic_cast<CProgramStorageObject*>(obj);
 
@@ -4480,30 +5133,7 @@ bool CRobotMain::IOIsBusy()
 //! Writes an object into the backup file
 void CRobotMain::IOWriteObject(CLevelParserLine* line, CObject* obj, const std::string& programDir, int objRank)
 {
-    line->AddParam("type", MakeUnique<CLevelParserParam>(obj->GetType()));
-    line->AddParam("id", MakeUnique<CLevelParserParam>(obj->GetID()));
-    line->AddParam("pos", MakeUnique<CLevelParserParam>(obj->GetPosition()/g_unit));
-    line->AddParam("angle", MakeUnique<CLevelParserParam>(obj->GetRotation() * Math::RAD_TO_DEG));
-    line->AddParam("zoom", MakeUnique<CLevelParserParam>(obj->GetScale()));
-
-    if (obj->Implements(ObjectInterfaceType::Old))
-    {
-        line->AddParam("option", MakeUnique<CLevelParserParam>(obj->GetOption()));
-    }
-
-    if (obj->Implements(ObjectInterfaceType::Controllable))
-    {
-        auto controllableObj = dynamic_cast<CControllableObject*>(obj);
-        line->AddParam("trainer", MakeUnique<CLevelParserParam>(controllableObj->GetTrainer()));
-        if (controllableObj->GetSelect())
-            line->AddParam("select", MakeUnique<CLevelParserParam>(true));
-    }
-
-    obj->Write(line);
-
-    if (obj->GetType() == OBJECT_BASE)
-        line->AddParam("run", MakeUnique<CLevelParserParam>(3));  // stops and open (PARAM_FIXSCENE)
-
+    IOWriteObjectState(line, obj);
 
     if (obj->Implements(ObjectInterfaceType::ProgramStorage))
     {
@@ -4532,6 +5162,34 @@ void CRobotMain::IOWriteObject(CLevelParserLine* line, CObject* obj, const std::
     }
 }
 
+//! Writes state of an object, without its programs
+void CRobotMain::IOWriteObjectState(CLevelParserLine* line, CObject* obj)
+{
+    line->AddParam("type", MakeUnique<CLevelParserParam>(obj->GetType()));
+    line->AddParam("id", MakeUnique<CLevelParserParam>(obj->GetID()));
+    line->AddParam("pos", MakeUnique<CLevelParserParam>(obj->GetPosition()/g_unit));
+    line->AddParam("angle", MakeUnique<CLevelParserParam>(obj->GetRotation() * Math::RAD_TO_DEG));
+    line->AddParam("zoom", MakeUnique<CLevelParserParam>(obj->GetScale()));
+
+    if (obj->Implements(ObjectInterfaceType::Old))
+    {
+        line->AddParam("option", MakeUnique<CLevelParserParam>(obj->GetOption()));
+    }
+
+    if (obj->Implements(ObjectInterfaceType::Controllable))
+    {
+        auto controllableObj = dynamic_cast<CControllableObject*>(obj);
+        line->AddParam("trainer", MakeUnique<CLevelParserParam>(controllableObj->GetTrainer()));
+        if (controllableObj->GetSelect())
+            line->AddParam("select", MakeUnique<CLevelParserParam>(true));
+    }
+
+    obj->Write(line);
+
+    if (obj->GetType() == OBJECT_BASE)
+        line->AddParam("run", MakeUnique<CLevelParserParam>(3));  // stops and open (PARAM_FIXSCENE)
+}
+
 //! Saves the current game
 bool CRobotMain::IOWriteScene(std::string filename, std::string filecbot, std::string filescreenshot, const std::string& info, bool emergencySave)
 {
@@ -4688,17 +5346,33 @@ void CRobotMain::IOWriteSceneFinished()
 //! Resumes the game
 CObject* CRobotMain::IOReadObject(CLevelParserLine *line, const std::string& programDir, const std::string& objCounterText, float objectProgress, int objRank)
 {
-    ObjectCreateParams params = CObject::ReadCreateParams(line);
-    params.power = -1.0f;
-    params.id = line->GetParam("id")->AsInt();
-
     std::string details = objCounterText;
     #if DEV_BUILD
     // Object categories may spoil the level a bit, so hide them in release builds
-    details += ": "+CLevelParserParam::FromObjectType(params.type);
+    details += ": "+CLevelParserParam::FromObjectType(line->GetParam("type")->AsObjectType());
     #endif
     m_ui->GetLoadingScreen()->SetProgress(0.25f+objectProgress*0.7f, RT_LOADING_OBJECTS_SAVED, details);
 
+    CObject* obj = IOCreateObject(line);
+
+    if (obj->Implements(ObjectInterfaceType::ProgramStorage))
+    {
+        CProgramStorageObject* programStorage = dynamic_cast<CProgramStorageObject*>(obj);
+        if (!line->GetParam("programStorageIndex")->IsDefined()) // Backwards compatibility
+            programStorage->SetProgramStorageIndex(objRank);
+        programStorage->LoadAllProgramsForSavedScene(line, programDir);
+    }
+
+    return obj;
+}
+
+//! Creates an object written by IOWriteObjectState()
+CObject* CRobotMain::IOCreateObject(CLevelParserLine *line)
+{
+    ObjectCreateParams params = CObject::ReadCreateParams(line);
+    params.power = -1.0f;
+    params.id = line->GetParam("id")->AsInt();
+
     CObject* obj = m_objMan->CreateObject(params);
 
     if (obj->Implements(ObjectInterfaceType::Old))
@@ -4720,15 +5394,28 @@ CObject* CRobotMain::IOReadObject(CLevelParserLine *line, const std::string& pro
             automat->Start(run);  // starts the film
     }
 
-    if (obj->Implements(ObjectInterfaceType::ProgramStorage))
+    return obj;
+}
+
+//! Puts cargo and power cell read together with the object back in place
+void CRobotMain::IOAttachObjects(CObject* obj, CObject* cargo, CObject* power)
+{
+    if (cargo != nullptr)
     {
-        CProgramStorageObject* programStorage = dynamic_cast<CProgramStorageObject*>(obj);
-        if (!line->GetParam("programStorageIndex")->IsDefined()) // Backwards compatibility
-            programStorage->SetProgramStorageIndex(objRank);
-        programStorage->LoadAllProgramsForSavedScene(line, programDir);
+        assert(obj->Implements(ObjectInterfaceType::Carrier)); // TODO: exception?
+        assert(obj->Implements(ObjectInterfaceType::Old));
+        dynamic_cast<CCarrierObject*>(obj)->SetCargo(cargo);
+        auto task = MakeUnique<CTaskManip>(dynamic_cast<COldObject*>(obj));
+        task->Start(TMO_AUTO, TMA_GRAB);  // holds the object!
     }
 
-    return obj;
+    if (power != nullptr)
+    {
+        assert(obj->Implements(ObjectInterfaceType::Powered));
+        dynamic_cast<CPoweredObject*>(obj)->SetPower(power);
+        assert(power->Implements(ObjectInterfaceType::Transportable));
+        dynamic_cast<CTransportableObject*>(power)->SetTransporter(obj);
+    }
 }
 
 //! Resumes some part of the game
@@ -4784,22 +5471,7 @@ CObject* CRobotMain::IOReadScene(std::string filename, std::string filecbot)
             if (line->GetParam("select")->AsBool(false))
                 sel = obj;
 
-            if (cargo != nullptr)
-            {
-                assert(obj->Implements(ObjectInterfaceType::Carrier)); // TODO: exception?
-                assert(obj->Implements(ObjectInterfaceType::Old));
-                dynamic_cast<CCarrierObject*>(obj)->SetCargo(cargo);
-                auto task = MakeUnique<CTaskManip>(dynamic_cast<COldObject*>(obj));
-                task->Start(TMO_AUTO, TMA_GRAB);  // holds the object!
-            }
-
-            if (power != nullptr)
-            {
-                assert(obj->Implements(ObjectInterfaceType::Powered));
-                dynamic_cast<CPoweredObject*>(obj)->SetPower(power);
-                assert(power->Implements(ObjectInterfaceType::Transportable));
-                dynamic_cast<CTransportableObject*>(power)->SetTransporter(obj);
-            }
+            IOAttachObjects(obj, cargo, power);
             cargo = nullptr;
             power = nullptr;
 
@@ -5009,6 +5681,7 @@ Error CRobotMain::ProcessEndMissionTake()
                     if (m_winDelay == 0.0f)
                     {
                         GetLogger()->Info("Team %d won\n", team);
+                        m_winnerTeam = team;
 
                         m_displayText->DisplayText(("<<< Team "+boost::lexical_cast<std::string>(team)+" won the game >>>").c_str(), Math::Vector(0.0f,0.0f,0.0f));
                         if (m_missionTimerEnabled && m_missionTimerStarted)
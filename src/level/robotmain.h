@@ -91,7 +91,9 @@ class CPlayerProfile;
 class CSettings;
 class COldObject;
 class CPauseManager;
+class CJobSystem;
 struct ActivePause;
+struct WorldSnapshot;
 
 namespace Gfx
 {
@@ -166,6 +168,7 @@ public:
     Gfx::CTerrain* GetTerrain();
     Ui::CInterface* GetInterface();
     Ui::CDisplayText* GetDisplayText();
+    CJobSystem* GetJobSystem();
     CPauseManager* GetPauseManager();
 
     void        ChangePhase(Phase phase);
@@ -252,6 +255,7 @@ public:
     void        ChangeColor();
 
     float       SearchNearestObject(Math::Vector center, CObject *exclu);
+    float       GetObjectClearance(CObject* obj, Math::Vector center, CObject *exclu);
     bool        FreeSpace(Math::Vector &center, float minRadius, float maxRadius, float space, CObject *exclu);
     bool        FlatFreeSpace(Math::Vector &center, float minFlat, float minRadius, float maxRadius, float space, CObject *exclu);
     float       GetFlatZoneRadius(Math::Vector center, float maxRadius, CObject *exclu);
@@ -282,6 +286,10 @@ public:
     void        IOWriteObject(CLevelParserLine *line, CObject* obj, const std::string& programDir, int objRank);
     CObject*    IOReadObject(CLevelParserLine *line, const std::string& programDir, const std::string& objCounterText, float objectProgress, int objRank = -1);
 
+    //! Restarts the current mission from the state it had when it started
+    /** Returns false if there is no snapshot of the current mission, full reload is needed then */
+    bool        RestoreWorldSnapshot();
+
     int         CreateSpot(Math::Vector pos, Gfx::Color color);
 
     CObject*    GetSelect();
@@ -372,6 +380,17 @@ public:
 
 protected:
     bool        EventFrame(const Event &event);
+    void        PrepareObjectFrames(float rTime);
+    void        UpdateBatchMode();
+    void        LoadBatchTeamPrograms();
+    void        SyncReplayPrograms();
+    void        TakeWorldSnapshot();
+    void        WriteSnapshotPrograms(CObject* obj);
+    void        ReadSnapshotPrograms(CObject* obj);
+    void        IOWriteObjectState(CLevelParserLine *line, CObject* obj);
+    CObject*    IOCreateObject(CLevelParserLine *line);
+    void        IOAttachObjects(CObject* obj, CObject* cargo, CObject* power);
+    void        WriteBatchResult(Phase phase);
     bool        EventObject(const Event &event);
     void        InitEye();
 
@@ -441,6 +460,7 @@ protected:
     std::unique_ptr<Ui::CDisplayText> m_displayText;
     std::unique_ptr<Ui::CDebugMenu> m_debugMenu;
     std::unique_ptr<CSettings> m_settings;
+    std::unique_ptr<CJobSystem> m_jobSystem;
 
     //! Progress of loaded player
     std::unique_ptr<CPlayerProfile> m_playerProfile;
@@ -530,6 +550,22 @@ protected:
     bool            m_codeBattleSpectator = true;
 
     std::map<int, std::string> m_teamNames;
+    //! Last team which fulfilled its end conditions, 0 if none
+    int             m_winnerTeam = 0;
+
+    //! Programs from -teamprogram were already given to the robots
+    bool            m_batchProgramsLoaded = false;
+    //! Batch match was ended by -timelimit
+    bool            m_batchTimedOut = false;
+    //! Programs were already stored to / restored from the replay
+    bool            m_replayProgramsSynced = false;
+    //! Number of restarts from the world snapshot, programs stored in the replay are tagged with it
+    int             m_replayRestarts = 0;
+
+    //! State of the current mission right after it started, see RestoreWorldSnapshot()
+    std::unique_ptr<WorldSnapshot> m_worldSnapshot;
+    //! The snapshot is to be taken on the first frame of the mission
+    bool            m_worldSnapshotPending = false;
 
     std::vector<NewScriptName> m_newScriptName;
 
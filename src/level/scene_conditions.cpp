@@ -26,6 +26,7 @@
 #include "object/object.h"
 #include "object/object_manager.h"
 
+#include "object/interface/carrier_object.h"
 #include "object/interface/powered_object.h"
 #include "object/interface/transportable_object.h"
 
@@ -46,84 +47,174 @@ void CSceneCondition::Read(CLevelParserLine* line)
     this->max      = line->GetParam("max")->AsInt(9999);
 }
 
-int CSceneCondition::CountObjects()
+bool CSceneCondition::IsCandidate(CObject* obj)
 {
-    Math::Vector bPos = this->pos;
-    bPos.y = 0.0f;
+    ObjectType type = obj->GetType();
 
-    Math::Vector oPos;
+    ToolType tool = GetToolFromObject(type);
+    DriveType drive = GetDriveFromObject(type);
+    if (this->tool != ToolType::Other &&
+        tool != this->tool)
+        return false;
+
+    if (this->drive != DriveType::Other &&
+        drive != this->drive)
+        return false;
+
+    if (this->tool == ToolType::Other &&
+        this->drive == DriveType::Other &&
+        type != this->type &&
+        this->type != OBJECT_NULL)
+        return false;
+
+    if ((this->team > 0 && obj->GetTeam() != this->team) ||
+        (this->team < 0 && (obj->GetTeam() == -(this->team) || obj->GetTeam() == 0)))
+        return false;
+
+    return true;
+}
 
-    int nb = 0;
-    for (CObject* obj : CObjectManager::GetInstancePointer()->GetAllObjects())
+bool CSceneCondition::IsMatching(CObject* obj)
+{
+    if (!obj->GetActive()) return false;
+
+    if (!this->countTransported)
     {
-        if (!obj->GetActive()) continue;
+        if (IsObjectBeingTransported(obj)) return false;
+    }
 
-        if (!this->countTransported)
+    float energyLevel = -1;
+    CPowerContainerObject* power = nullptr;
+    if (obj->Implements(ObjectInterfaceType::PowerContainer))
+    {
+        power = dynamic_cast<CPowerContainerObject*>(obj);
+    }
+    else if (obj->Implements(ObjectInterfaceType::Powered))
+    {
+        CObject* powerObj = dynamic_cast<CPoweredObject*>(obj)->GetPower();
+        if(powerObj != nullptr && powerObj->Implements(ObjectInterfaceType::PowerContainer))
         {
-            if (IsObjectBeingTransported(obj)) continue;
+            power = dynamic_cast<CPowerContainerObject*>(powerObj);
         }
+    }
+
+    if (power != nullptr)
+    {
+        energyLevel = power->GetEnergy();
+        if (power->GetCapacity() > 1.0f) energyLevel *= 10; // TODO: Who designed it like that ?!?!
+    }
+    if (energyLevel < this->powermin || energyLevel > this->powermax) return false;
 
-        ObjectType type = obj->GetType();
+    Math::Vector oPos;
+    if (IsObjectBeingTransported(obj))
+        oPos = dynamic_cast<CTransportableObject*>(obj)->GetTransporter()->GetPosition();
+    else
+        oPos = obj->GetPosition();
 
-        ToolType tool = GetToolFromObject(type);
-        DriveType drive = GetDriveFromObject(type);
-        if (this->tool != ToolType::Other &&
-            tool != this->tool)
-            continue;
+    oPos.y = 0.0f;
 
-        if (this->drive != DriveType::Other &&
-            drive != this->drive)
-            continue;
+    Math::Vector bPos = this->pos;
+    bPos.y = 0.0f;
 
-        if (this->tool == ToolType::Other &&
-            this->drive == DriveType::Other &&
-            type != this->type &&
-            this->type != OBJECT_NULL)
-            continue;
+    return Math::DistanceProjected(oPos, bPos) <= this->dist;
+}
 
-        if ((this->team > 0 && obj->GetTeam() != this->team) ||
-            (this->team < 0 && (obj->GetTeam() == -(this->team) || obj->GetTeam() == 0)))
-            continue;
+void CSceneCondition::CountAll()
+{
+    CObjectManager* objectManager = CObjectManager::GetInstancePointer();
 
-        float energyLevel = -1;
-        CPowerContainerObject* power = nullptr;
-        if (obj->Implements(ObjectInterfaceType::PowerContainer))
-        {
-            power = dynamic_cast<CPowerContainerObject*>(obj);
-        }
-        else if (obj->Implements(ObjectInterfaceType::Powered))
+    // Start from the smallest index matching the condition, if there is one
+    std::vector<CObject*> objects;
+    if (this->tool == ToolType::Other &&
+        this->drive == DriveType::Other &&
+        this->type != OBJECT_NULL)
+    {
+        objects = objectManager->GetObjectsOfType(this->type);
+    }
+    else if (this->team > 0)
+    {
+        objects = objectManager->GetObjectsOfTeam(this->team);
+    }
+    else
+    {
+        for (CObject* obj : objectManager->GetAllObjects())
+            objects.push_back(obj);
+    }
+
+    m_candidates.clear();
+    m_count = 0;
+    for (CObject* obj : objects)
+    {
+        if (!IsCandidate(obj)) continue;
+
+        bool matching = IsMatching(obj);
+        m_candidates[obj] = matching;
+        if (matching) m_count++;
+    }
+}
+
+void CSceneCondition::UpdateMatch(CObject* obj)
+{
+    auto it = m_candidates.find(obj);
+    if (it == m_candidates.end()) return;
+
+    bool matching = IsMatching(obj);
+    if (matching == it->second) return;
+
+    it->second = matching;
+    m_count += matching ? 1 : -1;
+}
+
+int CSceneCondition::CountObjects()
+{
+    CObjectManager* objectManager = CObjectManager::GetInstancePointer();
+
+    // Objects created or deleted, or too many changes to check them one by one
+    if (!m_countValid ||
+        m_indexRevision != objectManager->GetIndexRevision() ||
+        !objectManager->GetChangedObjects(m_changeRevision, m_changedObjects))
+    {
+        CountAll();
+    }
+    else
+    {
+        for (CObject* obj : m_changedObjects)
         {
-            CObject* powerObj = dynamic_cast<CPoweredObject*>(obj)->GetPower();
-            if(powerObj != nullptr && powerObj->Implements(ObjectInterfaceType::PowerContainer))
+            UpdateMatch(obj);
+
+            // Transported objects are at the position of their transporter,
+            // and robots have the energy of their power cell
+            if (obj->Implements(ObjectInterfaceType::Carrier))
             {
-                power = dynamic_cast<CPowerContainerObject*>(powerObj);
+                CObject* cargo = dynamic_cast<CCarrierObject*>(obj)->GetCargo();
+                if (cargo != nullptr) UpdateMatch(cargo);
+            }
+            if (obj->Implements(ObjectInterfaceType::Powered))
+            {
+                CObject* power = dynamic_cast<CPoweredObject*>(obj)->GetPower();
+                if (power != nullptr) UpdateMatch(power);
+            }
+            if (IsObjectBeingTransported(obj))
+            {
+                UpdateMatch(dynamic_cast<CTransportableObject*>(obj)->GetTransporter());
             }
         }
+    }
 
-        if (power != nullptr)
-        {
-            energyLevel = power->GetEnergy();
-            if (power->GetCapacity() > 1.0f) energyLevel *= 10; // TODO: Who designed it like that ?!?!
-        }
-        if (energyLevel < this->powermin || energyLevel > this->powermax) continue;
-
-        if (IsObjectBeingTransported(obj))
-            oPos = dynamic_cast<CTransportableObject*>(obj)->GetTransporter()->GetPosition();
-        else
-            oPos = obj->GetPosition();
-
-        oPos.y = 0.0f;
+    m_indexRevision = objectManager->GetIndexRevision();
+    m_changeRevision = objectManager->GetChangeRevision();
+    m_countValid = true;
+    return m_count;
+}
 
-        if (Math::DistanceProjected(oPos, bPos) <= this->dist)
-            nb ++;
-    }
-    return nb;
+bool CSceneCondition::CheckCount(int nb)
+{
+    return nb >= this->min && nb <= this->max;
 }
 
 bool CSceneCondition::Check()
 {
-    int nb = CountObjects();
-    return nb >= this->min && nb <= this->max;
+    return CheckCount(CountObjects());
 }
 
 
@@ -143,7 +234,10 @@ bool CSceneEndCondition::CheckLost()
 
 Error CSceneEndCondition::GetMissionResult()
 {
-    if (CheckLost())
+    // Counted once for both the lost and the win check
+    int nb = CountObjects();
+
+    if (nb <= this->lost)
     {
         if (this->type == OBJECT_HUMAN)
             return INFO_LOSTq;
@@ -151,7 +245,7 @@ Error CSceneEndCondition::GetMissionResult()
             return INFO_LOST;
     }
 
-    if (!Check())
+    if (!CheckCount(nb))
     {
         return ERR_MISSION_NOTERM;
     }
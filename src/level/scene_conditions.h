@@ -33,7 +33,11 @@
 #include "object/object_type.h"
 #include "object/tool_type.h"
 
+#include <unordered_map>
+#include <vector>
+
 class CLevelParserLine;
+class CObject;
 
 /**
  * \class CSceneCondition
@@ -64,6 +68,29 @@ public:
 protected:
     //! Count all object matching the conditions
     int CountObjects();
+    //! Checks if given number of matching objects meets the condition
+    bool CheckCount(int nb);
+
+private:
+    //! Checks conditions which may only change when the object changes type or team
+    bool IsCandidate(CObject* obj);
+    //! Checks the remaining conditions: active state, energy and position
+    bool IsMatching(CObject* obj);
+    //! Collects candidates and counts the matching ones
+    void CountAll();
+    //! Checks again a candidate which changed, or whose transporter or power cell changed
+    void UpdateMatch(CObject* obj);
+
+private:
+    //! Objects passing IsCandidate(), and whether they pass IsMatching() as well
+    std::unordered_map<CObject*, bool> m_candidates;
+    //! Number of matching candidates, updated by object changes recorded by CObjectManager
+    int           m_count = 0;
+    //! CObjectManager::GetIndexRevision() and GetChangeRevision() when m_count was updated
+    unsigned int  m_indexRevision = 0;
+    unsigned int  m_changeRevision = 0;
+    bool          m_countValid = false;
+    std::vector<CObject*> m_changedObjects;
 };
 
 /**
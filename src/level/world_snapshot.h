@@ -0,0 +1,102 @@
+/*
+ * This file is part of the Colobot: Gold Edition source code
+ * Copyright (C) 2001-2016, Daniel Roux, EPSITEC SA & TerranovaTeam
+ * http://epsitec.ch; http://colobot.info; http://github.com/colobot
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://gnu.org/licenses
+ */
+
+/**
+ * \file level/world_snapshot.h
+ * \brief In-memory copy of the world used for fast mission restart
+ */
+
+#pragma once
+
+#include "level/level_category.h"
+
+#include "level/parser/parser.h"
+
+#include "math/vector.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * \struct WorldSnapshotProgram
+ * \brief Program of an object, as it was at the time the snapshot was taken
+ */
+struct WorldSnapshotProgram
+{
+    std::string source;
+    //! Name of the level file the program comes from, empty for user programs
+    std::string filename;
+    bool        readOnly = false;
+    bool        runnable = true;
+};
+
+/**
+ * \struct WorldSnapshotObjectPrograms
+ * \brief All programs of one object
+ */
+struct WorldSnapshotObjectPrograms
+{
+    std::vector<WorldSnapshotProgram> programs;
+    //! Index of the running program, -1 if none
+    int         run = -1;
+};
+
+/**
+ * \struct WorldSnapshot
+ * \brief State of the simulation right after the scene was created
+ *
+ * Objects are stored as the same lines that are written to saved games,
+ * except they are never written to disk and don't refer to any program files.
+ * Things that don't change during the game (sky, lights, end conditions etc.)
+ * are not stored at all, they are simply left as they are when restoring.
+ */
+struct WorldSnapshot
+{
+    //! Level the snapshot was taken in
+    //@{
+    LevelCategory category = LevelCategory::Max;
+    int         chap = 0;
+    int         rank = 0;
+    bool        soluce = false;
+    //@}
+
+    //! CreateObject, CreatePower and CreateFret lines in saved game format
+    CLevelParser objects;
+    //! Programs by object id
+    std::map<int, WorldSnapshotObjectPrograms> programs;
+
+    Math::Vector cameraEye;
+    Math::Vector cameraLookat;
+
+    std::vector<float> relief;
+
+    std::map<int, int> researchDone;
+    long        researchEnable = 0;
+    int         build = 0;
+
+    bool        lightning = false;
+    float       lightningSleep = 0.0f;
+    float       lightningDelay = 0.0f;
+    float       lightningMagnetic = 0.0f;
+    float       lightningProgress = 0.0f;
+
+    float       endTakeWinDelay = 0.0f;
+    float       endTakeLostDelay = 0.0f;
+};
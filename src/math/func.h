@@ -30,6 +30,7 @@
 
 #include <cmath>
 #include <cstdlib>
+#include <random>
 
 
 // Math module namespace
@@ -140,6 +141,25 @@ inline float Rand()
     return static_cast<float>(rand()) / static_cast<float>(RAND_MAX);
 }
 
+/**
+ * \brief Returns a random value between 0 and RAND_MAX for visual effects
+ *
+ * Effects have their own generator. How many values they take depends on rendering
+ * and on settings like particle density, so they must not take them from rand(),
+ * whose sequence the simulation (and a replay of it) depends on.
+ */
+inline int EffectRandom()
+{
+    static std::minstd_rand generator;
+    return static_cast<int>((generator() - generator.min()) % (static_cast<unsigned int>(RAND_MAX) + 1u));
+}
+
+//! Returns a random value between 0 and 1 for visual effects, see EffectRandom()
+inline float EffectRand()
+{
+    return static_cast<float>(EffectRandom()) / static_cast<float>(RAND_MAX);
+}
+
 //! Returns whether \a x is an even power of 2
 inline bool IsPowerOfTwo(unsigned int x)
 {
@@ -99,6 +99,7 @@ void CAuto::DeleteObject(bool bAll)
 void CAuto::Init()
 {
     m_bBusy = false;
+    WakeUp();
 }
 
 // Starts the object.
@@ -155,6 +156,73 @@ bool CAuto::EventProcess(const Event &event)
     return true;
 }
 
+// Management of an event, used instead of EventProcess by the owner object.
+// While sleeping, frames only accumulate time. The controller wakes up
+// when the delay elapses, when the object is selected or contaminated,
+// and gets the whole elapsed time as a single frame.
+
+bool CAuto::DispatchEvent(const Event &event)
+{
+    if ( !m_bSleeping || event.type != EVENT_FRAME )
+    {
+        return EventProcess(event);
+    }
+
+    if ( m_engine->GetPause() )  return true;
+
+    m_sleepTime += event.rTime;
+
+    if ( m_object->GetSelect()     ||
+         m_object->GetVirusMode()  ||
+         (m_sleepDelay >= 0.0f && m_sleepTime >= m_sleepDelay) )
+    {
+        Event frame = event.Clone();
+        frame.rTime = m_sleepTime;
+        WakeUp();
+        return EventProcess(frame);
+    }
+
+    EventSleeping(event.rTime);
+    return true;
+}
+
+// Skips frames for the given time.
+
+void CAuto::SleepFor(float delay)
+{
+    if ( m_object->GetSelect() )  return;  // interface is updated each frame
+
+    m_bSleeping = true;
+    m_sleepTime = 0.0f;
+    m_sleepDelay = delay;
+}
+
+// Skips frames until something wakes the controller up.
+
+void CAuto::SleepUntilWoken()
+{
+    SleepFor(-1.0f);
+}
+
+// Stops skipping frames.
+
+void CAuto::WakeUp()
+{
+    m_bSleeping = false;
+    m_sleepTime = 0.0f;
+}
+
+bool CAuto::IsSleeping()
+{
+    return m_bSleeping;
+}
+
+// Animation done while frames are skipped.
+
+void CAuto::EventSleeping(float rTime)
+{
+}
+
 // Indicates whether the controller has finished its activity.
 
 Error CAuto::IsEnded()
@@ -424,6 +492,7 @@ bool CAuto::Read(CLevelParserLine* line)
     m_time = line->GetParam("aTime")->AsFloat(m_time);
     m_progressTime = line->GetParam("aProgressTime")->AsFloat(m_progressTime);
     m_progressTotal = line->GetParam("aProgressTotal")->AsFloat(m_progressTotal);
+    WakeUp();
 
     return false;
 }
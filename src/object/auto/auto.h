@@ -61,6 +61,8 @@ public:
     virtual void    Init();
     virtual void    Start(int param);
     virtual bool    EventProcess(const Event &event);
+    //! Passes the event to EventProcess(), skipping frames while the controller sleeps
+    bool            DispatchEvent(const Event &event);
     virtual Error   IsEnded();
     virtual bool    Abort();
 
@@ -84,7 +86,19 @@ public:
     virtual bool    Write(CLevelParserLine* line);
     virtual bool    Read(CLevelParserLine* line);
 
+    //! Cancels sleep, the next frame is processed normally
+    void            WakeUp();
+    //! Indicates whether frames are currently skipped
+    bool            IsSleeping();
+
 protected:
+    //! Skips frames until given time elapses; the elapsed time is then delivered as one frame
+    void        SleepFor(float delay);
+    //! Skips frames until WakeUp() is called
+    void        SleepUntilWoken();
+    //! Called on each skipped frame, for purely cosmetic animation
+    virtual void EventSleeping(float rTime);
+
     void        CheckInterface(Ui::CWindow *pw, EventType event, bool bState);
     void        EnableInterface(Ui::CWindow *pw, EventType event, bool bState);
     void        VisibleInterface(Ui::CWindow *pw, EventType event, bool bState);
@@ -114,4 +128,8 @@ protected:
     float       m_lastUpdateTime = 0.0f;
     float       m_progressTime = 0.0f;
     float       m_progressTotal = 0.0f;
+
+    bool        m_bSleeping = false;
+    float       m_sleepTime = 0.0f;     // time accumulated while sleeping
+    float       m_sleepDelay = 0.0f;    // < 0 = until woken
 };
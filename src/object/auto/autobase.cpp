@@ -414,15 +414,15 @@ begin:
             max = static_cast<int>(50.0f*m_engine->GetParticleDensity());
             for ( i=0 ; i<max ; i++ )
             {
-                angle = Math::Rand()*(Math::PI*2.0f);
+                angle = Math::EffectRand()*(Math::PI*2.0f);
                 p = Math::RotatePoint(angle, 46.0f);
                 pos = m_pos;
                 pos.x += p.x;
                 pos.z += p.y;
                 speed = Math::Vector(0.0f, 0.0f, 0.0f);
-                dim.x = Math::Rand()*10.0f+10.0f;
+                dim.x = Math::EffectRand()*10.0f+10.0f;
                 dim.y = dim.x;
-                time = Math::Rand()*2.0f+1.5f;
+                time = Math::EffectRand()*2.0f+1.5f;
                 m_particle->CreateParticle(pos, speed, dim, Gfx::PARTICRASH, time, 0.0f, 2.0f);
             }
 
@@ -507,16 +507,16 @@ begin:
             max = static_cast<int>(20.0f*m_engine->GetParticleDensity());
             for ( i=0 ; i<max ; i++ )
             {
-                angle = Math::Rand()*(20.0f*Math::PI/180.0f)-(10.0f*Math::PI/180.0f);
-                angle += (Math::PI/4.0f)*(rand()%8);
+                angle = Math::EffectRand()*(20.0f*Math::PI/180.0f)-(10.0f*Math::PI/180.0f);
+                angle += (Math::PI/4.0f)*(Math::EffectRandom()%8);
                 p = Math::RotatePoint(angle, 74.0f);
                 pos = m_pos;
                 pos.x += p.x;
                 pos.z += p.y;
                 speed = Math::Vector(0.0f, 0.0f, 0.0f);
-                dim.x = Math::Rand()*8.0f+8.0f;
+                dim.x = Math::EffectRand()*8.0f+8.0f;
                 dim.y = dim.x;
-                time = Math::Rand()*2.0f+1.5f;
+                time = Math::EffectRand()*2.0f+1.5f;
                 m_particle->CreateParticle(pos, speed, dim, Gfx::PARTICRASH, time, 0.0f, 2.0f);
             }
 
@@ -665,16 +665,16 @@ begin:
             max = static_cast<int>(20.0f*m_engine->GetParticleDensity());
             for ( i=0 ; i<max ; i++ )
             {
-                angle = Math::Rand()*Math::PI*2.0f;
+                angle = Math::EffectRand()*Math::PI*2.0f;
                 p = Math::RotatePoint(angle, 32.0f);
                 pos = m_pos;
                 pos.x += p.x;
                 pos.z += p.y;
                 pos.y += 85.0f;
                 speed = Math::Vector(0.0f, 0.0f, 0.0f);
-                dim.x = Math::Rand()*3.0f+3.0f;
+                dim.x = Math::EffectRand()*3.0f+3.0f;
                 dim.y = dim.x;
-                time = Math::Rand()*1.0f+1.0f;
+                time = Math::EffectRand()*1.0f+1.0f;
                 m_particle->CreateParticle(pos, speed, dim, Gfx::PARTICRASH, time);
             }
             m_sound->Play(SOUND_BOUM, m_object->GetPosition());
@@ -854,15 +854,15 @@ begin:
             max = static_cast<int>(50.0f*m_engine->GetParticleDensity());
             for ( i=0 ; i<max ; i++ )
             {
-                angle = Math::Rand()*(Math::PI*2.0f);
+                angle = Math::EffectRand()*(Math::PI*2.0f);
                 p = Math::RotatePoint(angle, 46.0f);
                 pos = m_pos;
                 pos.x += p.x;
                 pos.z += p.y;
                 speed = Math::Vector(0.0f, 0.0f, 0.0f);
-                dim.x = Math::Rand()*10.0f+10.0f;
+                dim.x = Math::EffectRand()*10.0f+10.0f;
                 dim.y = dim.x;
-                time = Math::Rand()*2.0f+1.5f;
+                time = Math::EffectRand()*2.0f+1.5f;
                 m_particle->CreateParticle(pos, speed, dim, Gfx::PARTICRASH, time, 0.0f, 2.0f);
             }
 
@@ -143,6 +143,7 @@ bool CAutoConvert::EventProcess(const Event &event)
                 m_phase    = ACP_WAIT;  // still waiting ...
                 m_progress = 0.0f;
                 m_speed    = 1.0f/2.0f;
+                SleepFor(1.0f/m_speed);
             }
             else
             {
@@ -155,6 +155,7 @@ Error CAutoFactory::StartAction(int param)
         m_phase    = AFP_CLOSE_S;
         m_progress = 0.0f;
         m_speed    = 1.0f/3.0f;
+        WakeUp();
         return ERR_OK;
     }
     return ERR_UNKNOWN;
@@ -242,6 +243,7 @@ bool CAutoFactory::EventProcess(const Event &event)
             m_phase    = AFP_WAIT;  // still waiting ...
             m_progress = 0.0f;
             m_speed    = 1.0f/2.0f;
+            SleepUntilWoken();  // until StartAction()
         }
     }
 
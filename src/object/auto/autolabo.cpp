@@ -151,6 +151,7 @@ Error CAutoLabo::StartAction(int param)
     m_phase    = ALAP_OPEN1;
     m_progress = 0.0f;
     m_speed    = 1.0f/1.0f;
+    WakeUp();
     return ERR_OK;
 }
 
@@ -210,6 +211,7 @@ bool CAutoLabo::EventProcess(const Event &event)
             m_phase    = ALAP_WAIT;  // still waiting ...
             m_progress = 0.0f;
             m_speed    = 1.0f/2.0f;
+            SleepUntilWoken();  // until StartAction()
         }
     }
 
@@ -148,6 +148,7 @@ bool CAutoNuclearPlant::EventProcess(const Event &event)
                 m_phase    = ANUP_WAIT;  // still waiting ...
                 m_progress = 0.0f;
                 m_speed    = 1.0f/2.0f;
+                SleepFor(1.0f/m_speed);
             }
             else
             {
@@ -183,12 +184,12 @@ bool CAutoNuclearPlant::EventProcess(const Event &event)
             {
                 pos.x = 27.0f;
                 pos.y =  0.0f;
-                pos.z = (Math::Rand()-0.5f)*8.0f;
+                pos.z = (Math::EffectRand()-0.5f)*8.0f;
                 pos = Transform(*mat, pos);
                 speed.y = 0.0f;
                 speed.x = 0.0f;
                 speed.z = 0.0f;
-                dim.x = Math::Rand()*1.0f+1.0f;
+                dim.x = Math::EffectRand()*1.0f+1.0f;
                 dim.y = dim.x;
                 m_particle->CreateParticle(pos, speed, dim, Gfx::PARTICRASH);
             }
@@ -248,15 +249,15 @@ bool CAutoNuclearPlant::EventProcess(const Event &event)
             for ( i=0 ; i<max ; i++ )
             {
                 pos = m_pos;
-                pos.x += (Math::Rand()-0.5f)*3.0f;
-                pos.y += (Math::Rand()-0.5f)*3.0f;
-                pos.z += (Math::Rand()-0.5f)*3.0f;
+                pos.x += (Math::EffectRand()-0.5f)*3.0f;
+                pos.y += (Math::EffectRand()-0.5f)*3.0f;
+                pos.z += (Math::EffectRand()-0.5f)*3.0f;
                 speed.y = 0.0f;
                 speed.x = 0.0f;
                 speed.z = 0.0f;
-                dim.x = Math::Rand()*2.0f+2.0f;
+                dim.x = Math::EffectRand()*2.0f+2.0f;
                 dim.y = dim.x;
-                m_particle->CreateParticle(pos, speed, dim, Gfx::PARTIBLUE, Math::Rand()*5.0f+5.0f, 0.0f, 0.0f);
+                m_particle->CreateParticle(pos, speed, dim, Gfx::PARTIBLUE, Math::EffectRand()*5.0f+5.0f, 0.0f, 0.0f);
             }
 
             m_sound->Play(SOUND_OPEN, m_object->GetPosition(), 1.0f, 1.4f);
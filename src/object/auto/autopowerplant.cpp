@@ -219,6 +219,7 @@ bool CAutoPowerPlant::EventProcess(const Event &event)
                     m_phase    = AENP_WAIT;  // still waiting ...
                     m_progress = 0.0f;
                     m_speed    = 1.0f/2.0f;
+                    SleepFor(1.0f/m_speed);
                 }
             }
         }
@@ -111,6 +111,7 @@ bool CAutoRepair::EventProcess(const Event &event)
                 m_phase    = ARP_WAIT;  // still waiting ...
                 m_progress = 0.0f;
                 m_speed    = 1.0f/1.0f;
+                SleepFor(1.0f/m_speed);
             }
             else
             {
@@ -145,6 +145,7 @@ Error CAutoResearch::StartAction(int param)
     m_phase    = ALP_SEARCH;
     m_progress = 0.0f;
     m_speed    = 1.0f/time;
+    WakeUp();
     return ERR_OK;
 }
 
@@ -157,7 +158,6 @@ bool CAutoResearch::EventProcess(const Event &event)
     Math::Vector    pos, speed;
     Error       message;
     Math::Point     dim;
-    float       angle;
 
     CAuto::EventProcess(event);
 
@@ -204,15 +204,12 @@ bool CAutoResearch::EventProcess(const Event &event)
     UpdateInterface(event.rTime);
     EventProgress(event.rTime);
 
-    angle = m_time*0.1f;
-    m_object->SetPartRotationY(1, angle);  // rotates the antenna
-
-    angle = (30.0f+sinf(m_time*0.3f)*20.0f)*Math::PI/180.0f;
-    m_object->SetPartRotationZ(2, angle);  // directs the antenna
+    MoveAntenna(m_time);
 
     if ( m_phase == ALP_WAIT )
     {
         FireStopUpdate(m_progress, false);  // extinguished
+        SleepUntilWoken();  // until StartAction()
         return true;
     }
 
@@ -286,6 +283,26 @@ bool CAutoResearch::EventProcess(const Event &event)
 }
 
 
+// Keeps the antenna moving while frames are skipped.
+
+void CAutoResearch::EventSleeping(float rTime)
+{
+    MoveAntenna(m_time+m_sleepTime);
+}
+
+// Moves the antenna.
+
+void CAutoResearch::MoveAntenna(float time)
+{
+    float   angle;
+
+    angle = time*0.1f;
+    m_object->SetPartRotationY(1, angle);  // rotates the antenna
+
+    angle = (30.0f+sinf(time*0.3f)*20.0f)*Math::PI/180.0f;
+    m_object->SetPartRotationZ(2, angle);  // directs the antenna
+}
+
 // Returns an error due the state of the automation.
 
 Error CAutoResearch::GetError()
@@ -52,6 +52,8 @@ public:
     bool        Read(CLevelParserLine* line) override;
 
 protected:
+    void        EventSleeping(float rTime) override;
+    void        MoveAntenna(float time);
     void        UpdateInterface();
     void        UpdateInterface(float rTime);
     void        OkayButton(Ui::CWindow *pw, EventType event);
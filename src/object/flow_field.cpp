@@ -0,0 +1,149 @@
+/*
+ * This file is part of the Colobot: Gold Edition source code
+ * Copyright (C) 2001-2016, Daniel Roux, EPSITEC SA & TerranovaTeam
+ * http://epsitec.ch; http://colobot.info; http://github.com/colobot
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://gnu.org/licenses
+ */
+
+#include "object/flow_field.h"
+
+#include "object/path_planner.h"
+
+#include <cassert>
+#include <cmath>
+#include <functional>
+#include <queue>
+#include <utility>
+
+
+const int CFlowField::DIRECTION_X[8] = { 1,  1,  0, -1, -1, -1,  0,  1 };
+const int CFlowField::DIRECTION_Y[8] = { 0,  1,  1,  1,  0, -1, -1, -1 };
+
+
+CFlowField::CFlowField(std::shared_ptr<const PathMap> map, Math::IntPoint goal)
+    : m_map(std::move(map)),
+      m_goal(goal),
+      m_reachable(0)
+{
+    assert(m_map != nullptr);
+
+    std::size_t size = m_map->width*m_map->height;
+    m_distance.assign(size, -1.0f);
+    m_direction.assign(size, -1);
+
+    int goalIndex = GetIndex(goal.x, goal.y);
+    if ( goalIndex == -1 )  return;
+
+    // Dijkstra from the goal; ties are broken by the index,
+    // so the field depends only on the map
+    typedef std::pair<float, int> Entry;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+    std::vector<bool> closed(size, false);
+
+    m_distance[goalIndex] = 0.0f;
+    open.push(Entry(0.0f, goalIndex));
+
+    const float diagonal = sqrtf(2.0f);
+    while ( !open.empty() )
+    {
+        Entry entry = open.top();
+        open.pop();
+        int index = entry.second;
+        if ( closed[index] )  continue;
+        closed[index] = true;
+        m_reachable ++;
+
+        int x = m_map->minX + index%m_map->width;
+        int y = m_map->minY + index/m_map->width;
+
+        for ( int d=0 ; d<8 ; d++ )
+        {
+            int dx = DIRECTION_X[d];
+            int dy = DIRECTION_Y[d];
+            int next = GetIndex(x+dx, y+dy);
+            if ( next == -1 || closed[next] )  continue;
+            if ( !m_map->IsFree(x+dx, y+dy) )  continue;
+            if ( dx != 0 && dy != 0 &&
+                 (!m_map->IsFree(x+dx, y) || !m_map->IsFree(x, y+dy)) )  continue;
+
+            float distance = entry.first + (dx != 0 && dy != 0 ? diagonal : 1.0f);
+            if ( m_distance[next] >= 0.0f && m_distance[next] <= distance )  continue;
+
+            m_distance[next] = distance;
+            m_direction[next] = (d+4)%8;  // back the way we came
+            open.push(Entry(distance, next));
+        }
+    }
+}
+
+Math::IntPoint CFlowField::GetGoal() const
+{
+    return m_goal;
+}
+
+int CFlowField::GetReachableCount() const
+{
+    return m_reachable;
+}
+
+int CFlowField::GetDirection(int x, int y) const
+{
+    int index = GetIndex(x, y);
+    if ( index == -1 )  return -1;
+    return m_direction[index];
+}
+
+float CFlowField::GetDistance(int x, int y) const
+{
+    int index = GetIndex(x, y);
+    if ( index == -1 )  return -1.0f;
+    return m_distance[index];
+}
+
+bool CFlowField::Trace(Math::IntPoint start, float goalRadius, std::vector<Math::IntPoint>& path) const
+{
+    path.clear();
+    path.push_back(start);
+
+    Math::IntPoint cell = start;
+    int lastDirection = -1;
+    for ( std::size_t steps=0 ; steps<=m_direction.size() ; steps++ )
+    {
+        if ( Math::IntPoint(cell.x-m_goal.x, cell.y-m_goal.y).Length() <= goalRadius )
+        {
+            if ( path.back() != cell )  path.push_back(cell);
+            return true;
+        }
+
+        int direction = GetDirection(cell.x, cell.y);
+        if ( direction == -1 )  break;
+
+        if ( lastDirection != -1 && direction != lastDirection )  path.push_back(cell);
+        lastDirection = direction;
+        cell.x += DIRECTION_X[direction];
+        cell.y += DIRECTION_Y[direction];
+    }
+
+    path.clear();
+    return false;
+}
+
+int CFlowField::GetIndex(int x, int y) const
+{
+    x -= m_map->minX;
+    y -= m_map->minY;
+    if ( x < 0 || x >= m_map->width || y < 0 || y >= m_map->height )  return -1;
+    return y*m_map->width + x;
+}
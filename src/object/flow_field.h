@@ -0,0 +1,82 @@
+/*
+ * This file is part of the Colobot: Gold Edition source code
+ * Copyright (C) 2001-2016, Daniel Roux, EPSITEC SA & TerranovaTeam
+ * http://epsitec.ch; http://colobot.info; http://github.com/colobot
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://gnu.org/licenses
+ */
+
+/**
+ * \file object/flow_field.h
+ * \brief Directions to one goal from every cell around it
+ */
+
+#pragma once
+
+#include "math/intpoint.h"
+
+#include <memory>
+#include <vector>
+
+struct PathMap;
+
+/**
+ * \class CFlowField
+ * \brief Shortest path tree to one goal cell over a PathMap
+ *
+ * The field is computed once with Dijkstra's algorithm from the goal
+ * (the integration field) and keeps, for every cell, the direction
+ * of the next step towards the goal (the direction field). Any number
+ * of robots heading to the same goal can then read their path from it,
+ * instead of searching it each.
+ *
+ * Moves follow the rules of CPathPlanner: 8 directions, no cutting
+ * of obstacle corners. The goal cell itself may be blocked, e.g. by
+ * the building robots go to.
+ */
+class CFlowField
+{
+public:
+    //! Computes the field over the whole map
+    CFlowField(std::shared_ptr<const PathMap> map, Math::IntPoint goal);
+
+    //! Returns the goal cell
+    Math::IntPoint GetGoal() const;
+    //! Returns the number of cells the goal can be reached from
+    int         GetReachableCount() const;
+
+    //! Returns the direction (0..7) of the next step from a cell, -1 if the goal can't be reached
+    int         GetDirection(int x, int y) const;
+    //! Returns the length of the path from a cell to the goal (in cells), -1 if the goal can't be reached
+    float       GetDistance(int x, int y) const;
+
+    //! Follows the field from start to the first cell closer than goalRadius to the goal
+    /** The path holds the start, the cells where the direction changes and the last cell.
+        Returns false if the goal can't be reached from start. */
+    bool        Trace(Math::IntPoint start, float goalRadius, std::vector<Math::IntPoint>& path) const;
+
+    //! Steps along X and Y for each direction
+    static const int DIRECTION_X[8];
+    static const int DIRECTION_Y[8];
+
+protected:
+    int         GetIndex(int x, int y) const;
+
+protected:
+    std::shared_ptr<const PathMap> m_map;
+    Math::IntPoint  m_goal;
+    int             m_reachable;
+    std::vector<float> m_distance;          //!< integration field, -1 if not reachable
+    std::vector<signed char> m_direction;   //!< direction field, -1 if not reachable
+};
@@ -19,8 +19,11 @@
 
 #include "object/implementation/power_container_impl.h"
 
-CPowerContainerObjectImpl::CPowerContainerObjectImpl(ObjectInterfaceTypes& types)
+#include "object/object_manager.h"
+
+CPowerContainerObjectImpl::CPowerContainerObjectImpl(ObjectInterfaceTypes& types, CObject* object)
     : CPowerContainerObject(types)
+    , m_object(object)
     , m_energyLevel(1.0f)
 {}
 
@@ -29,7 +32,12 @@ CPowerContainerObjectImpl::~CPowerContainerObjectImpl()
 
 void CPowerContainerObjectImpl::SetEnergyLevel(float level)
 {
+    if (level == m_energyLevel) return;
     m_energyLevel = level;
+
+    // Scene conditions count objects by their energy
+    if (CObjectManager::IsCreated())
+        CObjectManager::GetInstancePointer()->UpdateObjectState(m_object);
 }
 
 float CPowerContainerObjectImpl::GetEnergyLevel()
@@ -21,16 +21,18 @@
 
 #include "object/interface/power_container_object.h"
 
+class CObject;
 
 class CPowerContainerObjectImpl : public CPowerContainerObject
 {
 public:
-    explicit CPowerContainerObjectImpl(ObjectInterfaceTypes& types);
+    explicit CPowerContainerObjectImpl(ObjectInterfaceTypes& types, CObject* object);
     virtual ~CPowerContainerObjectImpl();
 
     void SetEnergyLevel(float level) override;
     float GetEnergyLevel() override;
 
 private:
+    CObject* m_object;
     float m_energyLevel;
 };
@@ -53,6 +53,6 @@ public:
 
 inline bool IsObjectBeingTransported(CObject* obj)
 {
-    return obj->Implements(ObjectInterfaceType::Transportable) &&
-           dynamic_cast<CTransportableObject*>(obj)->IsBeingTransported();
+    CTransportableObject* transportable = obj->GetInterface<ObjectInterfaceType::Transportable>();
+    return transportable != nullptr && transportable->IsBeingTransported();
 }
@@ -0,0 +1,1136 @@
+/*
+ * This file is part of the Colobot: Gold Edition source code
+ * Copyright (C) 2001-2016, Daniel Roux, EPSITEC SA & TerranovaTeam
+ * http://epsitec.ch; http://colobot.info; http://github.com/colobot
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://gnu.org/licenses
+ */
+
+#include "object/navigation_grid.h"
+
+#include "common/thread/job_system.h"
+#include "common/thread/sdl_cond_wrapper.h"
+#include "common/thread/sdl_mutex_wrapper.h"
+
+#include "graphics/engine/engine.h"
+#include "graphics/engine/terrain.h"
+#include "graphics/engine/water.h"
+
+#include "math/geometry.h"
+
+#include "object/flow_field.h"
+#include "object/object.h"
+#include "object/path_planner.h"
+
+#include "object/interface/transportable_object.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+
+
+namespace
+{
+
+//! Side of a terrain tile (in cells), terrain is calculated by whole tiles
+const int TERRAIN_TILE_SIZE = 32;
+const int TERRAIN_TILE_COUNT = (NAVIGATION_GRID_SIZE+TERRAIN_TILE_SIZE-1)/TERRAIN_TILE_SIZE;
+
+//! Number of object layers kept while no task uses them
+const std::size_t MAX_UNUSED_OBJECT_LAYERS = 4;
+
+//! Distance from the goal covered by a flow field (in cells)
+const int FLOW_FIELD_RADIUS = 128;
+//! Number of flow fields kept
+const std::size_t MAX_FLOW_FIELDS = 8;
+//! Number of path searches to a goal after which a flow field is computed for it
+const int FLOW_FIELD_MIN_REQUESTS = 2;
+//! Number of goals whose path searches are counted
+const std::size_t MAX_FLOW_FIELD_REQUESTS = 256;
+//! Number of frames after which a requested flow field is used
+const int FLOW_FIELD_FRAMES = 10;
+
+//! Number of paths kept in the path cache
+const std::size_t MAX_CACHED_PATHS = 64;
+//! Distance at which a blocked cell looks for a free one to tell its connected area (in cells)
+const int COMPONENT_SEARCH_RADIUS = 2;
+//! Distance around a changed area of terrain where cells may change too (in cells),
+//! slopes and water are looked for next to the cell
+const int TERRAIN_CHANGE_MARGIN = 2;
+
+int GetCellIndex(int x, int y)
+{
+    return y*NAVIGATION_GRID_SIZE + x;
+}
+
+int GetCell(float coord)
+{
+    return static_cast<int>(floorf((coord+1600.0f)/NAVIGATION_CELL_SIZE));
+}
+
+bool IsInGrid(int x, int y)
+{
+    return x >= 0 && x < NAVIGATION_GRID_SIZE &&
+           y >= 0 && y < NAVIGATION_GRID_SIZE;
+}
+
+//! Calls func for every cell of a path given by its jump points
+template<typename Func>
+bool AnyPathCell(const std::vector<Math::IntPoint>& path, Func func)
+{
+    for ( std::size_t i=0 ; i<path.size() ; i++ )
+    {
+        Math::IntPoint cell = path[i];
+        if ( func(cell.x, cell.y) )  return true;
+        if ( i+1 == path.size() )  break;
+
+        int dx = (path[i+1].x > cell.x) - (path[i+1].x < cell.x);
+        int dy = (path[i+1].y > cell.y) - (path[i+1].y < cell.y);
+        while ( true )
+        {
+            cell.x += dx;
+            cell.y += dy;
+            if ( cell == path[i+1] )  break;
+            if ( func(cell.x, cell.y) )  return true;
+        }
+    }
+    return false;
+}
+
+//! Labels the connected areas of free cells, blocked cells get -1
+/** Moves are those of the path search: 8 directions, no cutting of corners */
+void LabelComponents(const std::vector<unsigned char>& blocked, std::vector<int>& components)
+{
+    components.assign(NAVIGATION_GRID_SIZE*NAVIGATION_GRID_SIZE, -1);
+
+    auto isFree = [&](int x, int y)
+    {
+        return IsInGrid(x, y) && blocked[GetCellIndex(x, y)] == 0;
+    };
+
+    int label = 0;
+    std::vector<int> stack;
+    for ( int i=0 ; i<NAVIGATION_GRID_SIZE*NAVIGATION_GRID_SIZE ; i++ )
+    {
+        if ( blocked[i] != 0 || components[i] != -1 )  continue;
+
+        components[i] = label;
+        stack.push_back(i);
+        while ( !stack.empty() )
+        {
+            int index = stack.back();
+            stack.pop_back();
+            int x = index%NAVIGATION_GRID_SIZE;
+            int y = index/NAVIGATION_GRID_SIZE;
+
+            for ( int dy=-1 ; dy<=1 ; dy++ )
+            {
+                for ( int dx=-1 ; dx<=1 ; dx++ )
+                {
+                    if ( !isFree(x+dx, y+dy) )  continue;
+                    if ( dx != 0 && dy != 0 && (!isFree(x+dx, y) || !isFree(x, y+dy)) )  continue;
+
+                    int next = GetCellIndex(x+dx, y+dy);
+                    if ( components[next] != -1 )  continue;
+                    components[next] = label;
+                    stack.push_back(next);
+                }
+            }
+        }
+        label ++;
+    }
+}
+
+} // anonymous namespace
+
+
+
+CNavigationObjectLayer::CNavigationObjectLayer(float radius, float altitude)
+    : m_radius(radius),
+      m_altitude(altitude),
+      m_count(NAVIGATION_GRID_SIZE*NAVIGATION_GRID_SIZE, 0)
+{
+}
+
+bool CNavigationObjectLayer::IsBlocked(int x, int y, CObject* const* ignored, int ignoredCount) const
+{
+    if ( !IsInGrid(x, y) )  return false;
+
+    int count = m_count[GetCellIndex(x, y)];
+    if ( count == 0 )  return false;
+
+    for ( int i=0 ; i<ignoredCount ; i++ )
+    {
+        auto it = m_objectCircles.find(ignored[i]);
+        if ( it == m_objectCircles.end() )  continue;
+
+        for ( const Circle& circle : it->second )
+        {
+            if ( IsInCircle(circle, x, y) )  count --;
+        }
+    }
+    return count > 0;
+}
+
+void CNavigationObjectLayer::Clear()
+{
+    std::fill(m_count.begin(), m_count.end(), 0);
+    m_objectCircles.clear();
+}
+
+void CNavigationObjectLayer::SetObject(CObject* object, const NavigationFootprint& footprint)
+{
+    bool bFly = m_altitude > 0.0f;
+    float h = footprint.floor;
+    if ( bFly )  h += m_altitude;
+
+    std::vector<Circle> circles;
+    for ( const auto& sphere : footprint.spheres )
+    {
+        if ( bFly )  // flying?
+        {
+            if ( sphere.bottom > h+8.0f ||
+                 sphere.top    < h-8.0f )  continue;
+        }
+        else    // crawling?
+        {
+            if ( sphere.bottom > h+8.0f )  continue;
+        }
+
+        Circle circle;
+        circle.x = static_cast<int>((sphere.x+1600.0f)/NAVIGATION_CELL_SIZE);
+        circle.y = static_cast<int>((sphere.z+1600.0f)/NAVIGATION_CELL_SIZE);
+        circle.radius = (sphere.radius+m_radius)/NAVIGATION_CELL_SIZE;
+        circles.push_back(circle);
+    }
+
+    auto it = m_objectCircles.find(object);
+    if ( it != m_objectCircles.end() )
+    {
+        std::vector<Circle>& old = it->second;
+        bool same = old.size() == circles.size();
+        for ( std::size_t i=0 ; same && i<old.size() ; i++ )
+        {
+            same = old[i].x == circles[i].x &&
+                   old[i].y == circles[i].y &&
+                   old[i].radius == circles[i].radius;
+        }
+        if ( same )  return;  // moved inside the same cells
+
+        for ( const Circle& circle : old )  AddCircle(circle, -1);
+    }
+
+    for ( const Circle& circle : circles )  AddCircle(circle, 1);
+
+    if ( circles.empty() )
+    {
+        if ( it != m_objectCircles.end() )  m_objectCircles.erase(it);
+    }
+    else
+    {
+        m_objectCircles[object] = std::move(circles);
+    }
+}
+
+void CNavigationObjectLayer::RemoveObject(CObject* object)
+{
+    auto it = m_objectCircles.find(object);
+    if ( it == m_objectCircles.end() )  return;
+
+    for ( const Circle& circle : it->second )  AddCircle(circle, -1);
+    m_objectCircles.erase(it);
+}
+
+void CNavigationObjectLayer::AddCircle(const Circle& circle, int delta)
+{
+    int r = static_cast<int>(circle.radius);
+    for ( int y=circle.y-r ; y<=circle.y+r ; y++ )
+    {
+        for ( int x=circle.x-r ; x<=circle.x+r ; x++ )
+        {
+            if ( !IsInGrid(x, y) )  continue;
+            if ( !IsInCircle(circle, x, y) )  continue;
+
+            unsigned short& count = m_count[GetCellIndex(x, y)];
+            assert(delta > 0 || count > 0);
+            count += delta;
+        }
+    }
+}
+
+bool CNavigationObjectLayer::IsInCircle(const Circle& circle, int x, int y)
+{
+    int r = static_cast<int>(circle.radius);
+    if ( abs(x-circle.x) > r || abs(y-circle.y) > r )  return false;
+
+    float d = Math::Point(static_cast<float>(x-circle.x), static_cast<float>(y-circle.y)).Length();
+    return d <= circle.radius;
+}
+
+
+
+CNavigationGrid::CNavigationGrid(Gfx::CEngine* engine, Gfx::CTerrain* terrain)
+    : m_engine(engine),
+      m_terrain(terrain),
+      m_terrainRevision(0),
+      m_waterLevel(0.0f),
+      m_flyingMaxHeight(0.0f),
+      m_frame(0),
+      m_refreshing(false)
+{
+}
+
+CNavigationGrid::~CNavigationGrid()
+{
+}
+
+MobilityClass CNavigationGrid::GetMobilityClass(ObjectType type)
+{
+    if ( type == OBJECT_MOBILEta ||
+         type == OBJECT_MOBILEtc ||
+         type == OBJECT_MOBILEti ||
+         type == OBJECT_MOBILEts )  // caterpillars?
+    {
+        return MobilityClass::Tracked;
+    }
+
+    if ( type == OBJECT_MOBILErt ||
+         type == OBJECT_MOBILErc ||
+         type == OBJECT_MOBILErr ||
+         type == OBJECT_MOBILErs )  // large caterpillars?
+    {
+        return MobilityClass::Tracked;
+    }
+
+    if ( type == OBJECT_MOBILEsa )  // submarine caterpillars?
+    {
+        return MobilityClass::Amphibious;
+    }
+
+    if ( type == OBJECT_MOBILEdr )  // designer caterpillars?
+    {
+        return MobilityClass::Tracked;
+    }
+
+    if ( type == OBJECT_MOBILEfa ||
+         type == OBJECT_MOBILEfc ||
+         type == OBJECT_MOBILEfs ||
+         type == OBJECT_MOBILEfi ||
+         type == OBJECT_MOBILEft )  // flying?
+    {
+        return MobilityClass::Flying;
+    }
+
+    if ( type == OBJECT_MOBILEia ||
+         type == OBJECT_MOBILEic ||
+         type == OBJECT_MOBILEis ||
+         type == OBJECT_MOBILEii )  // insect legs?
+    {
+        return MobilityClass::Legged;
+    }
+
+    return MobilityClass::Wheeled;  // wheels and everything else
+}
+
+void CNavigationGrid::Clear()
+{
+    m_objects.clear();
+    m_changedObjects.clear();
+    m_footprints.clear();
+    for ( auto& layer : m_objectLayers )  layer->Clear();
+    InvalidateTerrain();
+    m_pathSearchStatistics = PathSearchStatistics();
+}
+
+void CNavigationGrid::AddObject(CObject* object)
+{
+    m_objects.insert(object);
+    if ( !m_objectLayers.empty() )  m_changedObjects.insert(object);
+    else                            m_pathCache.clear();  // changes are not followed
+}
+
+void CNavigationGrid::RemoveObject(CObject* object)
+{
+    if ( m_objects.erase(object) == 0 )  return;
+
+    auto it = m_footprints.find(object);
+    if ( it != m_footprints.end() )
+    {
+        InvalidateCachedPaths(it->second);
+        m_footprints.erase(it);
+    }
+    if ( m_objectLayers.empty() )  m_pathCache.clear();
+
+    m_changedObjects.erase(object);
+    for ( auto& layer : m_objectLayers )  layer->RemoveObject(object);
+}
+
+void CNavigationGrid::UpdateObject(CObject* object)
+{
+    if ( m_refreshing )  return;  // caused by reading the crash spheres
+    if ( m_objects.count(object) == 0 )  return;  // still being created
+
+    if ( m_objectLayers.empty() )  // nobody is interested?
+    {
+        m_pathCache.clear();
+        return;
+    }
+
+    m_changedObjects.insert(object);
+}
+
+void CNavigationGrid::Refresh()
+{
+    if ( UpdateTerrainState() )
+    {
+        // Obstacles are filtered by their height above the floor
+        if ( !m_objectLayers.empty() )  m_changedObjects = m_objects;
+    }
+
+    if ( m_changedObjects.empty() )  return;
+
+    m_refreshing = true;
+    for ( CObject* object : m_changedObjects )
+    {
+        NavigationFootprint& footprint = m_footprints[object];
+        InvalidateCachedPaths(footprint);  // where it was
+        ComputeFootprint(object, footprint);
+        InvalidateCachedPaths(footprint);  // where it is
+        for ( auto& layer : m_objectLayers )  layer->SetObject(object, footprint);
+    }
+    m_changedObjects.clear();
+    m_refreshing = false;
+}
+
+bool CNavigationGrid::IsTerrainBlocked(MobilityClass mobility, int x, int y)
+{
+    if ( !IsInGrid(x, y) )  return false;
+
+    if ( m_terrainLayers[0].bits.empty() )  UpdateTerrainState();
+
+    TerrainLayer& layer = m_terrainLayers[static_cast<int>(mobility)];
+    int tx = x/TERRAIN_TILE_SIZE;
+    int ty = y/TERRAIN_TILE_SIZE;
+    if ( !layer.tileValid[ty*TERRAIN_TILE_COUNT + tx] )
+    {
+        layer.tileValid[ty*TERRAIN_TILE_COUNT + tx] = true;
+        ComputeTerrainTile(mobility, tx, ty);
+    }
+
+    int i = GetCellIndex(x, y);
+    return (layer.bits[i/8] & (1<<i%8)) != 0;
+}
+
+std::shared_ptr<const CNavigationObjectLayer> CNavigationGrid::GetObjectLayer(float radius, float altitude)
+{
+    Refresh();
+
+    for ( std::size_t i=0 ; i<m_objectLayers.size() ; i++ )
+    {
+        if ( m_objectLayers[i]->GetRadius() != radius )  continue;
+        if ( m_objectLayers[i]->GetAltitude() != altitude )  continue;
+
+        // Most recently used layers are kept at the end
+        std::shared_ptr<CNavigationObjectLayer> layer = m_objectLayers[i];
+        m_objectLayers.erase(m_objectLayers.begin()+i);
+        m_objectLayers.push_back(layer);
+        return layer;
+    }
+
+    // Throws away the least recently used layers nobody holds
+    std::size_t unused = 0;
+    for ( const auto& layer : m_objectLayers )
+    {
+        if ( layer.use_count() == 1 )  unused ++;
+    }
+    for ( auto it = m_objectLayers.begin() ; it != m_objectLayers.end() && unused >= MAX_UNUSED_OBJECT_LAYERS ; )
+    {
+        if ( it->use_count() == 1 )
+        {
+            it = m_objectLayers.erase(it);
+            unused --;
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    if ( m_objectLayers.empty() )  // changes were not recorded, footprints are outdated
+    {
+        m_refreshing = true;
+        for ( CObject* object : m_objects )
+        {
+            ComputeFootprint(object, m_footprints[object]);
+        }
+        m_refreshing = false;
+    }
+
+    auto layer = std::make_shared<CNavigationObjectLayer>(radius, altitude);
+    for ( const auto& footprint : m_footprints )
+    {
+        layer->SetObject(footprint.first, footprint.second);
+    }
+    m_objectLayers.push_back(layer);
+    return layer;
+}
+
+// Flow field computed by a worker thread.
+
+struct CNavigationGrid::FlowFieldJob
+{
+    FlowFieldJob(std::shared_ptr<const PathMap> map, Math::IntPoint goal)
+        : map(map), goal(goal)
+    {}
+
+    std::shared_ptr<const PathMap> map;
+    Math::IntPoint      goal;
+    CSDLMutexWrapper    mutex;
+    CSDLCondWrapper     finished;
+    // The following members are protected by the mutex
+    bool                started = false;    // a worker computes the field
+    bool                taken = false;      // the main thread computes it, the worker mustn't start
+    bool                cancelled = false;  // nobody wants it anymore
+    std::shared_ptr<const CFlowField> field;
+};
+
+void CNavigationGrid::NextFrame()
+{
+    m_frame ++;
+    Refresh();
+
+    // Fields due in this frame are handed over, whatever the speed of the
+    // workers, so that robots take the same paths on every machine
+    for ( FlowField& flowField : m_flowFields )
+    {
+        if ( flowField.job == nullptr || flowField.readyFrame > m_frame )  continue;
+
+        FlowFieldJob& job = *flowField.job;
+        SDL_LockMutex(*job.mutex);
+        if ( !job.started )  // no worker got to it?
+        {
+            job.taken = true;
+        }
+        else
+        {
+            while ( job.field == nullptr )
+            {
+                SDL_CondWait(*job.finished, *job.mutex);
+            }
+            flowField.field = job.field;
+        }
+        SDL_UnlockMutex(*job.mutex);
+
+        if ( flowField.field == nullptr )
+        {
+            flowField.field = std::make_shared<const CFlowField>(job.map, job.goal);
+        }
+        flowField.job.reset();
+        m_pathSearchStatistics.flowFields ++;
+    }
+}
+
+std::shared_ptr<const CFlowField> CNavigationGrid::GetFlowField(MobilityClass mobility, Math::IntPoint goal,
+                                                                CJobSystem* jobSystem)
+{
+    if ( !IsInGrid(goal.x, goal.y) )  return nullptr;
+
+    Refresh();
+
+    for ( std::size_t i=0 ; i<m_flowFields.size() ; i++ )
+    {
+        if ( m_flowFields[i].mobility != mobility )  continue;
+        if ( m_flowFields[i].goal != goal )  continue;
+
+        // Most recently used fields are kept at the end
+        FlowField flowField = m_flowFields[i];
+        m_flowFields.erase(m_flowFields.begin()+i);
+        m_flowFields.push_back(flowField);
+        return flowField.field;  // nullptr until handed over by NextFrame()
+    }
+
+    // A field costs more than a search, it pays off only for goals
+    // several robots go to
+    if ( m_flowFieldRequests.size() >= MAX_FLOW_FIELD_REQUESTS )  m_flowFieldRequests.clear();
+    int key = static_cast<int>(mobility)*NAVIGATION_GRID_SIZE*NAVIGATION_GRID_SIZE + GetCellIndex(goal.x, goal.y);
+    if ( ++m_flowFieldRequests[key] < FLOW_FIELD_MIN_REQUESTS )  return nullptr;
+    m_flowFieldRequests.erase(key);
+
+    auto map = std::make_shared<PathMap>();
+    map->minX = std::max(goal.x-FLOW_FIELD_RADIUS, 0);
+    map->minY = std::max(goal.y-FLOW_FIELD_RADIUS, 0);
+    map->width  = std::min(goal.x+FLOW_FIELD_RADIUS, NAVIGATION_GRID_SIZE-1)-map->minX+1;
+    map->height = std::min(goal.y+FLOW_FIELD_RADIUS, NAVIGATION_GRID_SIZE-1)-map->minY+1;
+    map->blocked.resize(map->width*map->height);
+
+    unsigned char* cell = map->blocked.data();
+    for ( int y=map->minY ; y<map->minY+map->height ; y++ )
+    {
+        for ( int x=map->minX ; x<map->minX+map->width ; x++ )
+        {
+            *cell++ = IsTerrainBlocked(mobility, x, y) ? 1 : 0;
+        }
+    }
+
+    // Paths are searched as usual until the field is handed over;
+    // without workers, the main thread computes it then
+    FlowField flowField;
+    flowField.mobility = mobility;
+    flowField.goal = goal;
+    flowField.readyFrame = m_frame+FLOW_FIELD_FRAMES;
+    flowField.job = std::make_shared<FlowFieldJob>(map, goal);
+    if ( jobSystem != nullptr )
+    {
+        std::shared_ptr<FlowFieldJob> job = flowField.job;
+        jobSystem->Submit([job]() { FlowFieldWorker(job); });
+    }
+
+    if ( m_flowFields.size() >= MAX_FLOW_FIELDS )
+    {
+        CancelFlowField(m_flowFields.front());
+        m_flowFields.erase(m_flowFields.begin());
+    }
+    m_flowFields.push_back(flowField);
+    return nullptr;
+}
+
+// Computes a flow field on a worker thread.
+
+void CNavigationGrid::FlowFieldWorker(const std::shared_ptr<FlowFieldJob>& job)
+{
+    SDL_LockMutex(*job->mutex);
+    bool skip = job->taken || job->cancelled;
+    job->started = !skip;
+    SDL_UnlockMutex(*job->mutex);
+    if ( skip )  return;
+
+    auto field = std::make_shared<const CFlowField>(job->map, job->goal);
+
+    SDL_LockMutex(*job->mutex);
+    job->field = field;
+    SDL_CondSignal(*job->finished);
+    SDL_UnlockMutex(*job->mutex);
+}
+
+// Tells the worker a dropped field is not needed, if it hasn't started yet.
+
+void CNavigationGrid::CancelFlowField(const FlowField& flowField)
+{
+    if ( flowField.job == nullptr )  return;
+
+    SDL_LockMutex(*flowField.job->mutex);
+    flowField.job->cancelled = true;
+    SDL_UnlockMutex(*flowField.job->mutex);
+}
+
+bool CNavigationGrid::FindCachedPath(const PathCacheKey& key, std::vector<Math::IntPoint>& path)
+{
+    Refresh();
+
+    for ( std::size_t i=0 ; i<m_pathCache.size() ; i++ )
+    {
+        if ( !(m_pathCache[i].key == key) )  continue;
+
+        // Most recently used paths are kept at the end
+        CachedPath cachedPath = m_pathCache[i];
+        m_pathCache.erase(m_pathCache.begin()+i);
+        m_pathCache.push_back(cachedPath);
+        path = cachedPath.path;
+        return true;
+    }
+    return false;
+}
+
+void CNavigationGrid::AddCachedPath(const PathCacheKey& key, const std::vector<Math::IntPoint>& path)
+{
+    if ( path.empty() )  return;
+
+    RemoveCachedPath(key);
+    if ( m_pathCache.size() >= MAX_CACHED_PATHS )  m_pathCache.erase(m_pathCache.begin());
+
+    CachedPath cachedPath;
+    cachedPath.key = key;
+    cachedPath.path = path;
+    cachedPath.minX = cachedPath.maxX = path[0].x;
+    cachedPath.minY = cachedPath.maxY = path[0].y;
+    for ( const Math::IntPoint& cell : path )
+    {
+        cachedPath.minX = std::min(cachedPath.minX, cell.x);
+        cachedPath.minY = std::min(cachedPath.minY, cell.y);
+        cachedPath.maxX = std::max(cachedPath.maxX, cell.x);
+        cachedPath.maxY = std::max(cachedPath.maxY, cell.y);
+    }
+    m_pathCache.push_back(cachedPath);
+}
+
+void CNavigationGrid::RemoveCachedPath(const PathCacheKey& key)
+{
+    m_pathCache.erase(std::remove_if(m_pathCache.begin(), m_pathCache.end(),
+                                     [&key](const CachedPath& cachedPath) { return cachedPath.key == key; }),
+                      m_pathCache.end());
+}
+
+void CNavigationGrid::AddPathCacheLookup(bool hit)
+{
+    if ( hit )  m_pathSearchStatistics.cacheHits ++;
+    else        m_pathSearchStatistics.cacheMisses ++;
+}
+
+// Connected areas labelled by a worker thread.
+
+struct CNavigationGrid::ComponentsJob
+{
+    CSDLMutexWrapper    mutex;
+    // Protected by the mutex
+    bool                done = false;
+    std::vector<int>    components;
+};
+
+bool CNavigationGrid::IsReachable(MobilityClass mobility, Math::IntPoint start, Math::IntPoint goal,
+                                  CJobSystem* jobSystem, bool& reachable)
+{
+    Refresh();
+
+    int m = static_cast<int>(mobility);
+    if ( m_components[m].empty() )
+    {
+        if ( m_componentsJobs[m] == nullptr )  ComputeComponents(mobility, jobSystem);
+
+        if ( m_componentsJobs[m] != nullptr )
+        {
+            ComponentsJob& job = *m_componentsJobs[m];
+            SDL_LockMutex(*job.mutex);
+            if ( job.done )  m_components[m].swap(job.components);
+            SDL_UnlockMutex(*job.mutex);
+
+            if ( m_components[m].empty() )  return false;  // still labelled
+            m_componentsJobs[m].reset();
+        }
+    }
+
+    int component = GetComponent(mobility, start.x, start.y);
+    reachable = component != -1 && component == GetComponent(mobility, goal.x, goal.y);
+    return true;
+}
+
+void CNavigationGrid::AddPathSearch(bool found, long long time, int frames)
+{
+    m_pathSearchStatistics.searches ++;
+    if ( found )  m_pathSearchStatistics.found ++;
+    m_pathSearchStatistics.time += time;
+    m_pathSearchStatistics.frames += frames;
+}
+
+void CNavigationGrid::AddFlowFieldPath()
+{
+    m_pathSearchStatistics.flowPaths ++;
+}
+
+const PathSearchStatistics& CNavigationGrid::GetPathSearchStatistics() const
+{
+    return m_pathSearchStatistics;
+}
+
+// Calculates one tile of terrain obstacles.
+// Tiles cover whole bytes of the bits, so several tiles
+// can be calculated at once by different threads.
+
+void CNavigationGrid::ComputeTerrainTile(MobilityClass mobility, int tx, int ty)
+{
+    TerrainLayer& layer = m_terrainLayers[static_cast<int>(mobility)];
+
+    float aLimit = 20.0f*Math::PI/180.0f;
+    if ( mobility == MobilityClass::Tracked    )  aLimit = 35.0f*Math::PI/180.0f;
+    if ( mobility == MobilityClass::Amphibious )  aLimit = 35.0f*Math::PI/180.0f;
+    if ( mobility == MobilityClass::Legged     )  aLimit = 60.0f*Math::PI/180.0f;
+    bool bFly = mobility == MobilityClass::Flying;
+    bool bAcceptWater = mobility == MobilityClass::Amphibious;
+
+    int minx = tx*TERRAIN_TILE_SIZE;
+    int miny = ty*TERRAIN_TILE_SIZE;
+    int maxx = std::min(minx+TERRAIN_TILE_SIZE, NAVIGATION_GRID_SIZE)-1;
+    int maxy = std::min(miny+TERRAIN_TILE_SIZE, NAVIGATION_GRID_SIZE)-1;
+
+    // Cells next to water are blocked too (*), so the levels
+    // are needed one cell around the tile
+    int width = maxx-minx+3;
+    int height = maxy-miny+3;
+    std::vector<Math::Vector> pos(width*height);
+    std::vector<float> level(width*height);
+    if ( bFly || !bAcceptWater )
+    {
+        for ( int y=0 ; y<height ; y++ )
+        {
+            for ( int x=0 ; x<width ; x++ )
+            {
+                pos[y*width+x].x = (minx+x-1)*NAVIGATION_CELL_SIZE-1600.0f;
+                pos[y*width+x].z = (miny+y-1)*NAVIGATION_CELL_SIZE-1600.0f;
+            }
+        }
+        m_terrain->GetFloorLevels(pos.data(), level.data(), width*height, true);
+    }
+
+    float waterLimit = m_waterLevel-2.0f;
+    auto isUnderWater = [&](int x, int y)
+    {
+        if ( !IsInGrid(x, y) )  return false;
+        return level[(y-miny+1)*width + (x-minx+1)] < waterLimit;
+    };
+
+    for ( int y=miny ; y<=maxy ; y++ )
+    {
+        for ( int x=minx ; x<=maxx ; x++ )
+        {
+            bool blocked;
+            if ( bFly )  // flying robot?
+            {
+                blocked = level[(y-miny+1)*width + (x-minx+1)] >= m_flyingMaxHeight-5.0f;
+            }
+            else if ( !bAcceptWater &&
+                      (isUnderWater(x,   y  ) ||
+                       isUnderWater(x-1, y  ) ||
+                       isUnderWater(x+1, y  ) ||
+                       isUnderWater(x,   y-1) ||
+                       isUnderWater(x,   y+1)) )  // under water (*)?
+            {
+                blocked = true;
+            }
+            else
+            {
+                blocked = m_terrain->GetFineSlope(pos[(y-miny+1)*width + (x-minx+1)]) > aLimit;
+            }
+
+            int i = GetCellIndex(x, y);
+            if ( blocked )  layer.bits[i/8] |=  (1<<i%8);
+            else            layer.bits[i/8] &= ~(1<<i%8);
+        }
+    }
+}
+
+// (*)  Accepts that a robot is 50cm under water, for example Tropica 3!
+
+// Forgets terrain obstacles, they are recalculated on demand.
+
+void CNavigationGrid::InvalidateTerrain()
+{
+    for ( auto& layer : m_terrainLayers )
+    {
+        layer.bits.clear();
+        layer.tileValid.clear();
+    }
+    InvalidatePaths();
+}
+
+// Forgets everything found over the terrain, it has changed.
+
+void CNavigationGrid::InvalidatePaths()
+{
+    for ( const FlowField& flowField : m_flowFields )  CancelFlowField(flowField);
+    m_flowFields.clear();
+    m_flowFieldRequests.clear();
+    m_pathCache.clear();
+    for ( auto& components : m_components )  components.clear();
+    for ( auto& job : m_componentsJobs )  job.reset();
+}
+
+// Drops cached paths going near an object.
+
+void CNavigationGrid::InvalidateCachedPaths(const NavigationFootprint& footprint)
+{
+    for ( const auto& sphere : footprint.spheres )
+    {
+        int x = static_cast<int>((sphere.x+1600.0f)/NAVIGATION_CELL_SIZE);
+        int y = static_cast<int>((sphere.z+1600.0f)/NAVIGATION_CELL_SIZE);
+
+        auto isNear = [&](const CachedPath& cachedPath)
+        {
+            int r = static_cast<int>((sphere.radius+cachedPath.key.radius)/NAVIGATION_CELL_SIZE)+1;
+            if ( x+r < cachedPath.minX || x-r > cachedPath.maxX ||
+                 y+r < cachedPath.minY || y-r > cachedPath.maxY )  return false;
+
+            return AnyPathCell(cachedPath.path, [&](int cx, int cy)
+            {
+                return abs(cx-x) <= r && abs(cy-y) <= r;
+            });
+        };
+        m_pathCache.erase(std::remove_if(m_pathCache.begin(), m_pathCache.end(), isNear),
+                          m_pathCache.end());
+    }
+}
+
+// Drops cached paths going through or near a rectangle of cells.
+
+void CNavigationGrid::InvalidateCachedPaths(const CellRect& rect)
+{
+    auto isNear = [&](const CachedPath& cachedPath)
+    {
+        int r = static_cast<int>(cachedPath.key.radius/NAVIGATION_CELL_SIZE)+1;
+        if ( rect.maxX+r < cachedPath.minX || rect.minX-r > cachedPath.maxX ||
+             rect.maxY+r < cachedPath.minY || rect.minY-r > cachedPath.maxY )  return false;
+
+        return AnyPathCell(cachedPath.path, [&](int cx, int cy)
+        {
+            return cx >= rect.minX-r && cx <= rect.maxX+r &&
+                   cy >= rect.minY-r && cy <= rect.maxY+r;
+        });
+    };
+    m_pathCache.erase(std::remove_if(m_pathCache.begin(), m_pathCache.end(), isNear),
+                      m_pathCache.end());
+}
+
+// Forgets what was found over changed areas of terrain.
+// Terrain tiles, flow fields and cached paths elsewhere are kept,
+// and so are connected areas if no cell got blocked or free.
+
+void CNavigationGrid::InvalidateTerrainAreas(const std::vector<CellRect>& rects)
+{
+    for ( int m=0 ; m<static_cast<int>(MobilityClass::Max) ; m++ )
+    {
+        MobilityClass mobility = static_cast<MobilityClass>(m);
+        TerrainLayer& layer = m_terrainLayers[m];
+
+        // Connected areas were labelled over all tiles, so the old
+        // cells are at hand to see if they are still right
+        std::vector<bool> blocked;
+        bool labelled = !m_components[m].empty() || m_componentsJobs[m] != nullptr;
+        if ( labelled )
+        {
+            for ( const CellRect& rect : rects )
+            {
+                for ( int y=rect.minY ; y<=rect.maxY ; y++ )
+                {
+                    for ( int x=rect.minX ; x<=rect.maxX ; x++ )
+                    {
+                        blocked.push_back(IsTerrainBlocked(mobility, x, y));
+                    }
+                }
+            }
+        }
+
+        for ( const CellRect& rect : rects )
+        {
+            for ( int ty=rect.minY/TERRAIN_TILE_SIZE ; ty<=rect.maxY/TERRAIN_TILE_SIZE ; ty++ )
+            {
+                for ( int tx=rect.minX/TERRAIN_TILE_SIZE ; tx<=rect.maxX/TERRAIN_TILE_SIZE ; tx++ )
+                {
+                    layer.tileValid[ty*TERRAIN_TILE_COUNT + tx] = false;
+                }
+            }
+        }
+
+        auto it = blocked.begin();
+        for ( const CellRect& rect : rects )
+        {
+            for ( int y=rect.minY ; y<=rect.maxY && labelled ; y++ )
+            {
+                for ( int x=rect.minX ; x<=rect.maxX ; x++ )
+                {
+                    if ( IsTerrainBlocked(mobility, x, y) != *it++ )
+                    {
+                        m_components[m].clear();
+                        m_componentsJobs[m].reset();
+                        labelled = false;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    for ( const CellRect& rect : rects )
+    {
+        auto isNear = [&](const FlowField& flowField)
+        {
+            const Math::IntPoint& goal = flowField.goal;
+            bool isNear = goal.x+FLOW_FIELD_RADIUS >= rect.minX && goal.x-FLOW_FIELD_RADIUS <= rect.maxX &&
+                          goal.y+FLOW_FIELD_RADIUS >= rect.minY && goal.y-FLOW_FIELD_RADIUS <= rect.maxY;
+            if ( isNear )  CancelFlowField(flowField);
+            return isNear;
+        };
+        m_flowFields.erase(std::remove_if(m_flowFields.begin(), m_flowFields.end(), isNear),
+                           m_flowFields.end());
+
+        InvalidateCachedPaths(rect);
+    }
+
+    // Obstacles are filtered by their height above the floor
+    if ( m_objectLayers.empty() )  return;
+    for ( CObject* object : m_objects )
+    {
+        Math::Vector pos = object->GetPosition();
+        int x = GetCell(pos.x);
+        int y = GetCell(pos.z);
+        for ( const CellRect& rect : rects )
+        {
+            if ( x >= rect.minX && x <= rect.maxX && y >= rect.minY && y <= rect.maxY )
+            {
+                m_changedObjects.insert(object);
+                break;
+            }
+        }
+    }
+}
+
+// Labels the connected areas of free cells.
+// The terrain is calculated here, the labelling is done by a job
+// if there is a job system, otherwise right away.
+
+void CNavigationGrid::ComputeComponents(MobilityClass mobility, CJobSystem* jobSystem)
+{
+    if ( m_terrainLayers[0].bits.empty() )  UpdateTerrainState();
+
+    TerrainLayer& layer = m_terrainLayers[static_cast<int>(mobility)];
+    std::vector<int> tiles;
+    for ( int i=0 ; i<TERRAIN_TILE_COUNT*TERRAIN_TILE_COUNT ; i++ )
+    {
+        if ( !layer.tileValid[i] )  tiles.push_back(i);
+    }
+    auto computeTile = [this, mobility, &tiles](int i)
+    {
+        ComputeTerrainTile(mobility, tiles[i]%TERRAIN_TILE_COUNT, tiles[i]/TERRAIN_TILE_COUNT);
+    };
+    if ( jobSystem != nullptr )
+    {
+        jobSystem->ParallelFor(static_cast<int>(tiles.size()), computeTile, 1);
+    }
+    else
+    {
+        for ( int i=0 ; i<static_cast<int>(tiles.size()) ; i++ )  computeTile(i);
+    }
+    for ( int tile : tiles )  layer.tileValid[tile] = true;
+
+    std::vector<unsigned char> blocked(NAVIGATION_GRID_SIZE*NAVIGATION_GRID_SIZE);
+    for ( int i=0 ; i<NAVIGATION_GRID_SIZE*NAVIGATION_GRID_SIZE ; i++ )
+    {
+        blocked[i] = (layer.bits[i/8] & (1<<i%8)) != 0 ? 1 : 0;
+    }
+
+    auto job = std::make_shared<ComponentsJob>();
+    bool submitted = jobSystem != nullptr && jobSystem->Submit([job, blocked]()
+    {
+        std::vector<int> components;
+        LabelComponents(blocked, components);
+        SDL_LockMutex(*job->mutex);
+        job->components.swap(components);
+        job->done = true;
+        SDL_UnlockMutex(*job->mutex);
+    });
+
+    if ( submitted )
+    {
+        m_componentsJobs[static_cast<int>(mobility)] = job;
+    }
+    else
+    {
+        LabelComponents(blocked, m_components[static_cast<int>(mobility)]);
+    }
+}
+
+// Returns the connected area of a cell; a blocked cell, where a robot
+// may stand anyway, belongs to the area of the closest free cell.
+
+int CNavigationGrid::GetComponent(MobilityClass mobility, int x, int y)
+{
+    const std::vector<int>& components = m_components[static_cast<int>(mobility)];
+    if ( !IsInGrid(x, y) )  return -1;
+    if ( components[GetCellIndex(x, y)] != -1 )  return components[GetCellIndex(x, y)];
+
+    for ( int r=1 ; r<=COMPONENT_SEARCH_RADIUS ; r++ )
+    {
+        for ( int dy=-r ; dy<=r ; dy++ )
+        {
+            for ( int dx=-r ; dx<=r ; dx++ )
+            {
+                if ( std::max(abs(dx), abs(dy)) != r )  continue;  // ring only
+                if ( !IsInGrid(x+dx, y+dy) )  continue;
+
+                int component = components[GetCellIndex(x+dx, y+dy)];
+                if ( component != -1 )  return component;
+            }
+        }
+    }
+    return -1;
+}
+
+// Checks if the terrain has changed since terrain obstacles were calculated.
+// Changes limited to some areas, e.g. a building was built, are applied here.
+// Returns true if everything is to be calculated again.
+
+bool CNavigationGrid::UpdateTerrainState()
+{
+    unsigned int revision = m_terrain->GetRevision();
+    float waterLevel = m_engine->GetWater()->GetLevel();
+    float flyingMaxHeight = m_terrain->GetFlyingMaxHeight();
+
+    if ( !m_terrainLayers[0].bits.empty() &&
+         waterLevel == m_waterLevel &&
+         flyingMaxHeight == m_flyingMaxHeight )
+    {
+        if ( revision == m_terrainRevision )  return false;
+
+        std::vector<Gfx::CTerrain::ChangedArea> areas;
+        if ( m_terrain->GetChangedAreas(m_terrainRevision, areas) )
+        {
+            m_terrainRevision = revision;
+
+            std::vector<CellRect> rects;
+            for ( const auto& area : areas )
+            {
+                CellRect rect;
+                rect.minX = std::max(GetCell(area.min.x)-TERRAIN_CHANGE_MARGIN, 0);
+                rect.minY = std::max(GetCell(area.min.y)-TERRAIN_CHANGE_MARGIN, 0);
+                rect.maxX = std::min(GetCell(area.max.x)+TERRAIN_CHANGE_MARGIN, NAVIGATION_GRID_SIZE-1);
+                rect.maxY = std::min(GetCell(area.max.y)+TERRAIN_CHANGE_MARGIN, NAVIGATION_GRID_SIZE-1);
+                if ( rect.minX <= rect.maxX && rect.minY <= rect.maxY )  rects.push_back(rect);
+            }
+            InvalidateTerrainAreas(rects);
+            return false;
+        }
+    }
+
+    m_terrainRevision = revision;
+    m_waterLevel = waterLevel;
+    m_flyingMaxHeight = flyingMaxHeight;
+
+    for ( auto& layer : m_terrainLayers )
+    {
+        layer.bits.assign(NAVIGATION_GRID_SIZE*NAVIGATION_GRID_SIZE/8, 0);
+        layer.tileValid.assign(TERRAIN_TILE_COUNT*TERRAIN_TILE_COUNT, false);
+    }
+    InvalidatePaths();
+    return true;
+}
+
+// Reads what the object looks like as an obstacle.
+
+void CNavigationGrid::ComputeFootprint(CObject* object, NavigationFootprint& footprint)
+{
+    footprint.spheres.clear();
+    footprint.floor = m_terrain->GetFloorLevel(object->GetPosition(), false);
+
+    if ( IsObjectBeingTransported(object) )  return;
+
+    for ( const auto& crashSphere : object->GetAllCrashSpheres() )
+    {
+        NavigationFootprint::Sphere sphere;
+        sphere.x = crashSphere.sphere.pos.x;
+        sphere.z = crashSphere.sphere.pos.z;
+        sphere.bottom = crashSphere.sphere.pos.y-crashSphere.sphere.radius;
+        sphere.top    = crashSphere.sphere.pos.y+crashSphere.sphere.radius;
+        sphere.radius = crashSphere.sphere.radius;
+        if ( object->GetType() == OBJECT_PARA )  sphere.radius -= 2.0f;
+        footprint.spheres.push_back(sphere);
+    }
+}
@@ -0,0 +1,327 @@
+/*
+ * This file is part of the Colobot: Gold Edition source code
+ * Copyright (C) 2001-2016, Daniel Roux, EPSITEC SA & TerranovaTeam
+ * http://epsitec.ch; http://colobot.info; http://github.com/colobot
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://gnu.org/licenses
+ */
+
+/**
+ * \file object/navigation_grid.h
+ * \brief Navigation grid shared by path finding tasks
+ */
+
+#pragma once
+
+#include "math/intpoint.h"
+
+#include "object/object_type.h"
+
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace Gfx
+{
+class CEngine;
+class CTerrain;
+} // namespace Gfx
+
+class CFlowField;
+class CJobSystem;
+class CObject;
+
+//! Size of one cell of the navigation grid (in world units)
+const float NAVIGATION_CELL_SIZE = 5.0f;
+//! Number of cells along each side of the map
+const int   NAVIGATION_GRID_SIZE = static_cast<int>(3200.0f/NAVIGATION_CELL_SIZE);
+
+/**
+ * \enum MobilityClass
+ * \brief Kind of terrain an object can move through
+ */
+enum class MobilityClass : unsigned char
+{
+    Wheeled     = 0,    //!< slopes up to 20 degrees, no water
+    Tracked     = 1,    //!< slopes up to 35 degrees, no water
+    Amphibious  = 2,    //!< slopes up to 35 degrees, under water too
+    Legged      = 3,    //!< slopes up to 60 degrees, no water
+    Flying      = 4,    //!< anything below the flying ceiling
+    Max
+};
+
+/**
+ * \struct NavigationFootprint
+ * \brief Crash spheres of an object, as needed to make obstacles from them
+ */
+struct NavigationFootprint
+{
+    struct Sphere
+    {
+        float   x, z;           //!< center on XZ plane
+        float   bottom, top;    //!< vertical extent
+        float   radius;         //!< radius used for the obstacle
+    };
+
+    //! Floor level under the object
+    float               floor = 0.0f;
+    //! Spheres, empty if the object is not an obstacle (e.g. it is transported)
+    std::vector<Sphere> spheres;
+};
+
+/**
+ * \struct PathSearchStatistics
+ * \brief Summary of path searches done since the level was loaded
+ */
+struct PathSearchStatistics
+{
+    //! Number of finished searches
+    int         searches = 0;
+    //! Number of searches which found a path
+    int         found = 0;
+    //! Time spent in finished searches [ns]
+    long long   time = 0;
+    //! Number of frames finished searches were spread over
+    int         frames = 0;
+    //! Number of flow fields computed
+    int         flowFields = 0;
+    //! Number of paths read from a flow field instead of being searched
+    int         flowPaths = 0;
+    //! Number of paths taken from the path cache
+    int         cacheHits = 0;
+    //! Number of path requests not found in the path cache
+    int         cacheMisses = 0;
+};
+
+/**
+ * \struct PathCacheKey
+ * \brief Identifies a path request in the path cache
+ *
+ * Positions are quantized to the cells of the navigation grid,
+ * so robots going again and again between the same places share the key.
+ */
+struct PathCacheKey
+{
+    MobilityClass   mobility = MobilityClass::Wheeled;
+    //! Radius and altitude of the object layer the path was searched in
+    float           radius = 0.0f;
+    float           altitude = 0.0f;
+    Math::IntPoint  start;
+    Math::IntPoint  goal;
+    //! Distance to the goal at which the path ends (in cells)
+    float           goalRadius = 0.0f;
+
+    bool operator==(const PathCacheKey& other) const
+    {
+        return mobility == other.mobility &&
+               radius == other.radius &&
+               altitude == other.altitude &&
+               start == other.start &&
+               goal == other.goal &&
+               goalRadius == other.goalRadius;
+    }
+};
+
+/**
+ * \class CNavigationObjectLayer
+ * \brief Obstacles made by objects, as seen by a robot of given size at given altitude
+ *
+ * Every cell counts the object circles covering it, so objects can be moved
+ * without rebuilding the whole layer. A robot asking for a path doesn't block itself:
+ * the objects passed as ignored to IsBlocked() are subtracted from the counts.
+ */
+class CNavigationObjectLayer
+{
+public:
+    CNavigationObjectLayer(float radius, float altitude);
+
+    //! Radius of the robot this layer was made for
+    float   GetRadius() const { return m_radius; }
+    //! Flying altitude this layer was made for, 0 for robots on the ground
+    float   GetAltitude() const { return m_altitude; }
+
+    //! Tests if a cell is blocked by any object other than the ignored ones
+    bool    IsBlocked(int x, int y, CObject* const* ignored, int ignoredCount) const;
+
+protected:
+    friend class CNavigationGrid;
+
+    struct Circle
+    {
+        int     x, y;       //!< center cell
+        float   radius;     //!< in cells
+    };
+
+    void    Clear();
+    void    SetObject(CObject* object, const NavigationFootprint& footprint);
+    void    RemoveObject(CObject* object);
+    void    AddCircle(const Circle& circle, int delta);
+    static bool IsInCircle(const Circle& circle, int x, int y);
+
+protected:
+    float   m_radius;
+    float   m_altitude;
+    std::vector<unsigned short> m_count;
+    std::unordered_map<CObject*, std::vector<Circle>> m_objectCircles;
+};
+
+/**
+ * \class CNavigationGrid
+ * \brief World level navigation grid, shared by all CTaskGoto
+ *
+ * The grid is owned by CObjectManager. It knows two kinds of obstacles:
+ * \li terrain, one layer per MobilityClass, calculated lazily by tiles;
+ *     when a building level changes only the tiles around it are invalidated,
+ *     everything when the relief, the water level or the flying ceiling changes;
+ * \li objects, one CNavigationObjectLayer per robot radius and altitude,
+ *     kept up to date as objects are created, moved and deleted.
+ *
+ * Changes of objects are only recorded when they happen; Refresh() applies them.
+ * Path searches call it when they start, and NextFrame(), called by CRobotMain
+ * once per frame, for the robots following their path.
+ *
+ * Goals robots often go to (a base attacked by aliens, a drop-off point...) get
+ * a CFlowField over the terrain of each mobility class, so that robots heading
+ * there read their path instead of searching it. Fields are computed by a worker
+ * thread and handed over in a fixed frame; in the meantime paths are searched.
+ *
+ * Paths found by searches are cached too. A cached path is dropped when an object
+ * appears, moves or disappears near its cells, or when the terrain changes there.
+ * Connected areas of terrain are labelled on demand by a worker thread, to tell
+ * quickly if a place can be reached at all.
+ */
+class CNavigationGrid
+{
+public:
+    CNavigationGrid(Gfx::CEngine* engine, Gfx::CTerrain* terrain);
+    ~CNavigationGrid();
+
+    //! Returns the mobility class of given object type
+    static MobilityClass GetMobilityClass(ObjectType type);
+
+    //! Forgets all objects, called when the level is unloaded
+    void    Clear();
+    //! Registers a new object
+    void    AddObject(CObject* object);
+    //! Unregisters a deleted object
+    void    RemoveObject(CObject* object);
+    //! Records that object's crash spheres or transport state have changed
+    void    UpdateObject(CObject* object);
+
+    //! Applies all recorded changes of objects and terrain
+    void    Refresh();
+    //! Called once per frame of the simulation, refreshes and hands over flow fields due in this frame
+    void    NextFrame();
+
+    //! Tests if a cell is blocked by terrain for given mobility class
+    bool    IsTerrainBlocked(MobilityClass mobility, int x, int y);
+    //! Returns the object layer for given robot radius and altitude (0 = on the ground)
+    std::shared_ptr<const CNavigationObjectLayer> GetObjectLayer(float radius, float altitude);
+    //! Returns the terrain flow field to a goal cell
+    /** Returns nullptr if few robots went there so far, or until the field is handed
+        over a fixed number of frames later. It is computed by a job of jobSystem,
+        or by the main thread if no worker started it by then. */
+    std::shared_ptr<const CFlowField> GetFlowField(MobilityClass mobility, Math::IntPoint goal,
+                                                   CJobSystem* jobSystem);
+
+    //! Records the result of a finished path search
+    void    AddPathSearch(bool found, long long time, int frames);
+    //! Records a path read from a flow field
+    void    AddFlowFieldPath();
+
+    //! Looks for a path found earlier for the same request
+    bool    FindCachedPath(const PathCacheKey& key, std::vector<Math::IntPoint>& path);
+    //! Stores the jump points of a path found by a search
+    void    AddCachedPath(const PathCacheKey& key, const std::vector<Math::IntPoint>& path);
+    //! Drops a cached path, e.g. found blocked by the robot which wanted to use it
+    void    RemoveCachedPath(const PathCacheKey& key);
+    //! Records if a path request was answered by the path cache
+    void    AddPathCacheLookup(bool hit);
+
+    //! Tests if goal can be reached from start on terrain, regardless of objects
+    /** Returns false while the connected areas are labelled by a job of jobSystem,
+        after the terrain has changed; without jobSystem they are labelled right away */
+    bool    IsReachable(MobilityClass mobility, Math::IntPoint start, Math::IntPoint goal,
+                        CJobSystem* jobSystem, bool& reachable);
+    //! Returns statistics of path searches since the level was loaded
+    const PathSearchStatistics& GetPathSearchStatistics() const;
+
+protected:
+    struct TerrainLayer
+    {
+        std::vector<unsigned char>  bits;
+        std::vector<bool>           tileValid;
+    };
+
+    struct CellRect
+    {
+        int     minX, minY, maxX, maxY;     // inclusive
+    };
+
+    void    ComputeTerrainTile(MobilityClass mobility, int tx, int ty);
+    void    InvalidateTerrain();
+    void    InvalidatePaths();
+    void    InvalidateCachedPaths(const NavigationFootprint& footprint);
+    void    InvalidateCachedPaths(const CellRect& rect);
+    void    InvalidateTerrainAreas(const std::vector<CellRect>& rects);
+    void    ComputeComponents(MobilityClass mobility, CJobSystem* jobSystem);
+    int     GetComponent(MobilityClass mobility, int x, int y);
+    bool    UpdateTerrainState();
+    void    ComputeFootprint(CObject* object, NavigationFootprint& footprint);
+
+protected:
+    Gfx::CEngine*   m_engine;
+    Gfx::CTerrain*  m_terrain;
+
+    TerrainLayer    m_terrainLayers[static_cast<int>(MobilityClass::Max)];
+    unsigned int    m_terrainRevision;
+    float           m_waterLevel;
+    float           m_flyingMaxHeight;
+
+    struct FlowFieldJob;
+    struct FlowField
+    {
+        MobilityClass   mobility;
+        Math::IntPoint  goal;
+        std::shared_ptr<const CFlowField> field;    // nullptr until handed over
+        std::shared_ptr<FlowFieldJob> job;
+        int             readyFrame;
+    };
+    static void FlowFieldWorker(const std::shared_ptr<FlowFieldJob>& job);
+    static void CancelFlowField(const FlowField& flowField);
+    std::vector<FlowField> m_flowFields;
+    std::unordered_map<int, int> m_flowFieldRequests;  // by mobility and goal cell
+
+    struct CachedPath
+    {
+        PathCacheKey    key;
+        std::vector<Math::IntPoint> path;
+        int             minX, minY, maxX, maxY;     // bounding box of the path
+    };
+    std::vector<CachedPath> m_pathCache;    // most recently used at the end
+
+    struct ComponentsJob;
+    std::vector<int> m_components[static_cast<int>(MobilityClass::Max)];
+    std::shared_ptr<ComponentsJob> m_componentsJobs[static_cast<int>(MobilityClass::Max)];
+
+    std::vector<std::shared_ptr<CNavigationObjectLayer>> m_objectLayers;
+    std::unordered_set<CObject*> m_objects;
+    std::unordered_set<CObject*> m_changedObjects;
+    std::unordered_map<CObject*, NavigationFootprint> m_footprints;
+    int             m_frame;    // counted by NextFrame()
+    bool            m_refreshing;
+
+    PathSearchStatistics m_pathSearchStatistics;
+};
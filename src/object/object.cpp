@@ -30,8 +30,11 @@
 #include "level/parser/parserline.h"
 #include "level/parser/parserparam.h"
 
+#include "object/object_manager.h"
+
 #include "script/scriptfunc.h"
 
+#include <algorithm>
 #include <stdexcept>
 
 
@@ -41,6 +44,7 @@ CObject::CObject(int id, ObjectType type)
     , m_position(0.0f, 0.0f, 0.0f)
     , m_rotation(0.0f, 0.0f, 0.0f)
     , m_scale(1.0f, 1.0f, 1.0f)
+    , m_worldCrashSpheresValid(false)
     , m_animateOnReset(false)
     , m_collisions(true)
     , m_team(0)
@@ -49,6 +53,7 @@ CObject::CObject(int id, ObjectType type)
     , m_lock(false)
 {
     m_implementedInterfaces.fill(false);
+    m_interfacePointers.fill(nullptr);
     m_botVar = CScriptFunctions::CreateObjectVar(this);
 }
 
@@ -86,29 +91,68 @@ void CObject::SetCrashSpheres(const std::vector<Gfx::ModelCrashSphere>& crashSph
 void CObject::AddCrashSphere(const CrashSphere& crashSphere)
 {
     m_crashSpheres.push_back(crashSphere);
+    InvalidateCrashSpheres();
 }
 
 CrashSphere CObject::GetFirstCrashSphere()
 {
     assert(m_crashSpheres.size() >= 1);
 
-    CrashSphere transformedFirstCrashSphere = m_crashSpheres[0];
-    TransformCrashSphere(transformedFirstCrashSphere.sphere);
-    return transformedFirstCrashSphere;
+    return GetAllCrashSpheres()[0];
 }
 
-std::vector<CrashSphere> CObject::GetAllCrashSpheres()
+const std::vector<CrashSphere>& CObject::GetAllCrashSpheres()
 {
-    std::vector<CrashSphere> allCrashSpheres;
+    UpdatePendingTransform();
+
+    if (!m_worldCrashSpheresValid)
+    {
+        // Transforming may update the world matrix which invalidates the cache,
+        // so it is marked valid only after all spheres are done
+        m_worldCrashSpheres.resize(m_crashSpheres.size());
+        for (std::size_t i = 0; i < m_crashSpheres.size(); ++i)
+        {
+            m_worldCrashSpheres[i] = m_crashSpheres[i];
+            TransformCrashSphere(m_worldCrashSpheres[i].sphere);
+        }
+        m_worldCrashSpheresValid = true;
+    }
+
+    return m_worldCrashSpheres;
+}
 
+float CObject::GetCrashSphereExtent()
+{
+    // Rotation doesn't change the distance from object's origin, so this doesn't
+    // need to be recalculated when the object turns; shrinking never makes it smaller
+    Math::Vector scale = GetScale();
+    float maxScale = std::max(1.0f, std::max(fabsf(scale.x), std::max(fabsf(scale.y), fabsf(scale.z))));
+
+    float extent = 0.0f;
     for (const auto& crashSphere : m_crashSpheres)
     {
-        CrashSphere transformedCrashSphere = crashSphere;
-        TransformCrashSphere(transformedCrashSphere.sphere);
-        allCrashSpheres.push_back(transformedCrashSphere);
+        extent = std::max(extent, crashSphere.sphere.pos.Length() + crashSphere.sphere.radius);
     }
+    return extent * maxScale;
+}
+
+void CObject::SetImplements(ObjectInterfaceType type, bool implements)
+{
+    if (Implements(type) == implements)
+        return;
+
+    m_implementedInterfaces[static_cast<int>(type)] = implements;
+
+    if (CObjectManager::IsCreated())
+        CObjectManager::GetInstancePointer()->UpdateObjectIndexes(this);
+}
+
+void CObject::InvalidateCrashSpheres()
+{
+    m_worldCrashSpheresValid = false;
 
-    return allCrashSpheres;
+    if (CObjectManager::IsCreated())
+        CObjectManager::GetInstancePointer()->UpdateObjectShape(this);
 }
 
 bool CObject::CanCollideWith(CObject* other)
@@ -259,6 +303,7 @@ int CObject::GetCrashSphereCount()
 void CObject::DeleteAllCrashSpheres()
 {
     m_crashSpheres.clear();
+    InvalidateCrashSpheres();
 }
 
 void CObject::SetCameraCollisionSphere(const Math::Sphere& sphere)
@@ -296,6 +341,9 @@ bool CObject::GetCollisions()
 void CObject::SetTeam(int team)
 {
     m_team = team;
+
+    if (CObjectManager::IsCreated())
+        CObjectManager::GetInstancePointer()->UpdateObjectIndexes(this);
 }
 
 int CObject::GetTeam()
@@ -328,6 +376,12 @@ CBot::CBotVar* CObject::GetBotVar()
     return m_botVar;
 }
 
+std::size_t CObject::GetMemoryUsage() const
+{
+    return sizeof(CObject) +
+           (m_crashSpheres.capacity() + m_worldCrashSpheres.capacity()) * sizeof(CrashSphere);
+}
+
 std::string CObject::GetTooltipText()
 {
     std::string name;
@@ -346,6 +400,9 @@ std::string CObject::GetTooltipText()
 void CObject::SetLock(bool lock)
 {
     m_lock = lock;
+
+    if (CObjectManager::IsCreated())
+        CObjectManager::GetInstancePointer()->UpdateObjectState(this);
 }
 
 bool CObject::GetLock()
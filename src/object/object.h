@@ -99,6 +99,18 @@ public:
         return m_implementedInterfaces[static_cast<int>(type)];
     }
 
+    //! Returns pointer to the given interface or nullptr if object doesn't implement it
+    /**
+     * Constant time replacement for Implements() + dynamic_cast<>. The pointers are
+     * resolved once at construction, so this is safe to use in per-frame loops.
+     */
+    template<ObjectInterfaceType type>
+    inline typename ObjectInterfaceClass<type>::Type* GetInterface() const
+    {
+        if (!Implements(type)) return nullptr;
+        return static_cast<typename ObjectInterfaceClass<type>::Type*>(m_interfacePointers[static_cast<int>(type)]);
+    }
+
     //! Returns object's position
     virtual Math::Vector GetPosition() const;
     //! Sets object's position
@@ -149,8 +161,14 @@ public:
     /** Crash sphere position is returned in world coordinates */
     CrashSphere GetFirstCrashSphere();
     //! Returns all crash spheres
-    /** Crash sphere position is returned in world coordinates */
-    std::vector<CrashSphere> GetAllCrashSpheres();
+    /**
+     * Crash sphere position is returned in world coordinates.
+     * The spheres are cached and transformed again only after the object's transform changes,
+     * so the returned reference stays valid until crash spheres are added or removed.
+     */
+    const std::vector<CrashSphere>& GetAllCrashSpheres();
+    //! Returns radius around object's position which encloses all its crash spheres
+    float GetCrashSphereExtent();
     //! Removes all crash spheres
     void DeleteAllCrashSpheres();
     //! Returns true if this object can collide with the other one
@@ -206,7 +224,26 @@ public:
     //! Is this object detectable (not dead and not underground)?
     virtual bool GetDetectable() { return true; }
 
+    //! Returns approximate number of bytes used by this object, not counting engine resources
+    virtual std::size_t GetMemoryUsage() const;
+
 protected:
+    //! Stores resolved pointer to the given interface; to be called from subclass constructors
+    template<ObjectInterfaceType type>
+    inline void SetInterfacePointer(typename ObjectInterfaceClass<type>::Type* pointer)
+    {
+        m_interfacePointers[static_cast<int>(type)] = pointer;
+    }
+
+    //! Switches interface on or off after construction, keeping indexes in CObjectManager up to date
+    void SetImplements(ObjectInterfaceType type, bool implements);
+
+    //! Marks cached world space crash spheres as outdated
+    void InvalidateCrashSpheres();
+    //! Applies transform changes which are not yet reflected in world matrix
+    /** Called before cached crash spheres are used */
+    virtual void UpdatePendingTransform() {}
+
     //! Transform crash sphere by object's world matrix
     virtual void TransformCrashSphere(Math::Sphere& crashSphere) = 0;
     //! Transform crash sphere by object's world matrix
@@ -216,10 +253,13 @@ protected:
     const int m_id; //!< unique identifier
     ObjectType m_type; //!< object type
     ObjectInterfaceTypes m_implementedInterfaces; //!< interfaces that the object implements
+    std::array<void*, static_cast<std::size_t>(ObjectInterfaceType::Max)> m_interfacePointers; //!< resolved interface pointers, see GetInterface()
     Math::Vector m_position;
     Math::Vector m_rotation;
     Math::Vector m_scale;
     std::vector<CrashSphere> m_crashSpheres; //!< crash spheres
+    std::vector<CrashSphere> m_worldCrashSpheres; //!< cached crash spheres in world coordinates
+    bool m_worldCrashSpheresValid;
     Math::Sphere m_cameraCollisionSphere;
     bool m_animateOnReset;
     bool m_collisions;
@@ -0,0 +1,252 @@
+/*
+ * This file is part of the Colobot: Gold Edition source code
+ * Copyright (C) 2001-2016, Daniel Roux, EPSITEC SA & TerranovaTeam
+ * http://epsitec.ch; http://colobot.info; http://github.com/colobot
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://gnu.org/licenses
+ */
+
+#include "object/object_bvh.h"
+
+#include "object/object.h"
+
+#include <algorithm>
+#include <cassert>
+
+
+CObjectBVH::CObjectBVH()
+    : m_dirty(false)
+{
+}
+
+void CObjectBVH::Add(CObject* object)
+{
+    assert(m_leaves.count(object) == 0);
+
+    m_leaves[object] = -1;
+    m_dirty = true;
+}
+
+void CObjectBVH::Remove(CObject* object)
+{
+    auto it = m_leaves.find(object);
+    if (it == m_leaves.end())
+        return;
+
+    m_leaves.erase(it);
+    m_dirty = true;
+}
+
+void CObjectBVH::Update(CObject* object)
+{
+    if (m_dirty)
+        return; // will be rebuilt anyway
+
+    auto it = m_leaves.find(object);
+    if (it == m_leaves.end())
+        return;
+
+    Node& leaf = m_nodes[it->second];
+    if (leaf.stale)
+        return;
+
+    leaf.stale = true;
+    m_staleObjects.push_back(object);
+}
+
+void CObjectBVH::Clear()
+{
+    m_nodes.clear();
+    m_leaves.clear();
+    m_staleObjects.clear();
+    m_dirty = false;
+}
+
+std::vector<CObject*> CObjectBVH::QueryBox(const Math::Vector& min, const Math::Vector& max)
+{
+    return Query([&](const Bounds& bounds)
+    {
+        return bounds.min.x <= max.x && bounds.max.x >= min.x &&
+               bounds.min.y <= max.y && bounds.max.y >= min.y &&
+               bounds.min.z <= max.z && bounds.max.z >= min.z;
+    });
+}
+
+CObjectBVH::Bounds CObjectBVH::GetObjectBounds(CObject* object)
+{
+    Bounds bounds;
+    bounds.min = bounds.max = object->GetPosition();
+
+    auto addSphere = [&bounds](const Math::Sphere& sphere)
+    {
+        Math::Vector extent(sphere.radius, sphere.radius, sphere.radius);
+        Bounds sphereBounds;
+        sphereBounds.min = sphere.pos - extent;
+        sphereBounds.max = sphere.pos + extent;
+        bounds = Merge(bounds, sphereBounds);
+    };
+
+    for (const CrashSphere& crashSphere : object->GetAllCrashSpheres())
+        addSphere(crashSphere.sphere);
+
+    addSphere(object->GetCameraCollisionSphere());
+
+    return bounds;
+}
+
+CObjectBVH::Bounds CObjectBVH::Merge(const Bounds& a, const Bounds& b)
+{
+    Bounds result;
+    result.min.x = std::min(a.min.x, b.min.x);
+    result.min.y = std::min(a.min.y, b.min.y);
+    result.min.z = std::min(a.min.z, b.min.z);
+    result.max.x = std::max(a.max.x, b.max.x);
+    result.max.y = std::max(a.max.y, b.max.y);
+    result.max.z = std::max(a.max.z, b.max.z);
+    return result;
+}
+
+void CObjectBVH::Refresh()
+{
+    if (m_dirty)
+        Rebuild();
+    else
+        Refit();
+}
+
+void CObjectBVH::Rebuild()
+{
+    m_nodes.clear();
+    m_staleObjects.clear();
+
+    std::vector<Leaf> leaves;
+    leaves.reserve(m_leaves.size());
+    for (const auto& it : m_leaves)
+    {
+        Leaf leaf;
+        leaf.object = it.first;
+        leaf.bounds = GetObjectBounds(it.first);
+        leaf.center = (leaf.bounds.min + leaf.bounds.max) * 0.5f;
+        leaves.push_back(leaf);
+    }
+
+    // Reading crash spheres may finish a pending transform and report a shape change,
+    // which Update() ignores until the tree is built
+    m_dirty = false;
+
+    if (leaves.empty())
+        return;
+
+    // Sort first so that the tree doesn't depend on the hashing order
+    std::sort(leaves.begin(), leaves.end(), [](const Leaf& a, const Leaf& b) { return a.object->GetID() < b.object->GetID(); });
+
+    m_nodes.reserve(2 * leaves.size() - 1);
+    BuildNode(leaves, 0, static_cast<int>(leaves.size()), -1);
+}
+
+int CObjectBVH::BuildNode(std::vector<Leaf>& leaves, int begin, int end, int parent)
+{
+    int index = static_cast<int>(m_nodes.size());
+    m_nodes.push_back(Node());
+    m_nodes[index].parent = parent;
+
+    if (end - begin == 1)
+    {
+        m_nodes[index].bounds = leaves[begin].bounds;
+        m_nodes[index].object = leaves[begin].object;
+        m_leaves[leaves[begin].object] = index;
+        return index;
+    }
+
+    Bounds centers;
+    centers.min = centers.max = leaves[begin].center;
+    for (int i = begin + 1; i < end; ++i)
+    {
+        Bounds point;
+        point.min = point.max = leaves[i].center;
+        centers = Merge(centers, point);
+    }
+
+    // Split at the median along the longest axis
+    Math::Vector size = centers.max - centers.min;
+    int axis = 0;
+    if (size.y > size.Array()[axis]) axis = 1;
+    if (size.z > size.Array()[axis]) axis = 2;
+
+    int middle = begin + (end - begin) / 2;
+    std::nth_element(leaves.begin() + begin, leaves.begin() + middle, leaves.begin() + end,
+                     [axis](const Leaf& a, const Leaf& b) { return a.center.Array()[axis] < b.center.Array()[axis]; });
+
+    // m_nodes may be reallocated by the recursive calls, so no references are kept
+    int left = BuildNode(leaves, begin, middle, index);
+    int right = BuildNode(leaves, middle, end, index);
+    m_nodes[index].left = left;
+    m_nodes[index].right = right;
+    m_nodes[index].bounds = Merge(m_nodes[left].bounds, m_nodes[right].bounds);
+    return index;
+}
+
+void CObjectBVH::Refit()
+{
+    // Objects reported while refitting are left for the next query
+    std::vector<CObject*> staleObjects;
+    staleObjects.swap(m_staleObjects);
+
+    for (CObject* object : staleObjects)
+    {
+        int index = m_leaves[object];
+        // Still marked stale while reading, so a shape change reported meanwhile is ignored
+        m_nodes[index].bounds = GetObjectBounds(object);
+        m_nodes[index].stale = false;
+
+        for (int parent = m_nodes[index].parent; parent != -1; parent = m_nodes[parent].parent)
+        {
+            Node& node = m_nodes[parent];
+            node.bounds = Merge(m_nodes[node.left].bounds, m_nodes[node.right].bounds);
+        }
+    }
+}
+
+template<typename Test>
+std::vector<CObject*> CObjectBVH::Query(Test test)
+{
+    Refresh();
+
+    std::vector<CObject*> result;
+    if (m_nodes.empty())
+        return result;
+
+    std::vector<int> stack;
+    stack.push_back(0);
+    while (!stack.empty())
+    {
+        const Node& node = m_nodes[stack.back()];
+        stack.pop_back();
+
+        if (!test(node.bounds)) continue;
+
+        if (node.object != nullptr)
+        {
+            result.push_back(node.object);
+        }
+        else
+        {
+            stack.push_back(node.left);
+            stack.push_back(node.right);
+        }
+    }
+
+    std::sort(result.begin(), result.end(), [](CObject* a, CObject* b) { return a->GetID() < b->GetID(); });
+    return result;
+}
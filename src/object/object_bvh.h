@@ -0,0 +1,106 @@
+/*
+ * This file is part of the Colobot: Gold Edition source code
+ * Copyright (C) 2001-2016, Daniel Roux, EPSITEC SA & TerranovaTeam
+ * http://epsitec.ch; http://colobot.info; http://github.com/colobot
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://gnu.org/licenses
+ */
+
+/**
+ * \file object/object_bvh.h
+ * \brief Bounding volume hierarchy over objects which don't move
+ */
+
+#pragma once
+
+#include "math/vector.h"
+
+#include <unordered_map>
+#include <vector>
+
+class CObject;
+
+/**
+ * \class CObjectBVH
+ * \brief Tree of axis-aligned boxes enclosing object crash spheres and camera collision spheres
+ *
+ * The tree is owned by CObjectManager and holds objects which can't move by themselves
+ * (buildings, plants, ruins etc.). It is rebuilt only after objects are added or removed.
+ * When an object changes its shape or position, only the boxes on the path from its leaf
+ * to the root are refitted.
+ *
+ * The tree is brought up to date lazily by the next query. Like with CObjectGrid, queries
+ * return candidates sorted by object id and callers do the exact test themselves.
+ */
+class CObjectBVH
+{
+public:
+    CObjectBVH();
+
+    //! Adds object to the tree
+    void Add(CObject* object);
+    //! Removes object from the tree
+    void Remove(CObject* object);
+    //! Marks bounds of object as outdated; ignores objects not added to the tree
+    void Update(CObject* object);
+    //! Removes all objects
+    void Clear();
+
+    //! Returns candidates whose bounds overlap the given box
+    std::vector<CObject*> QueryBox(const Math::Vector& min, const Math::Vector& max);
+
+private:
+    struct Bounds
+    {
+        Math::Vector min;
+        Math::Vector max;
+    };
+
+    struct Node
+    {
+        Bounds bounds;
+        int left = -1;
+        int right = -1;
+        int parent = -1;
+        CObject* object = nullptr;  //!< only in leaves
+        bool stale = false;         //!< bounds of the leaf wait for refitting
+    };
+
+    struct Leaf
+    {
+        CObject* object;
+        Bounds bounds;
+        Math::Vector center;
+    };
+
+    static Bounds GetObjectBounds(CObject* object);
+    static Bounds Merge(const Bounds& a, const Bounds& b);
+
+    //! Rebuilds the tree if objects were added or removed, otherwise refits stale leaves
+    void Refresh();
+    void Rebuild();
+    int BuildNode(std::vector<Leaf>& leaves, int begin, int end, int parent);
+    void Refit();
+
+    template<typename Test>
+    std::vector<CObject*> Query(Test test);
+
+private:
+    std::vector<Node> m_nodes;
+    //! Leaf node of each object, -1 until the tree is rebuilt
+    std::unordered_map<CObject*, int> m_leaves;
+    //! Objects whose leaves wait for refitting
+    std::vector<CObject*> m_staleObjects;
+    bool m_dirty;
+};
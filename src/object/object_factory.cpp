@@ -51,8 +51,86 @@
 
 #include "physics/physics.h"
 
+#include <cassert>
+
 using COldObjectUPtr = std::unique_ptr<COldObject>;
 
+namespace
+{
+
+//! Resources created by CreateResource() which need no auto and no own copy of their model
+bool IsClonableResource(ObjectType type)
+{
+    switch (type)
+    {
+        case OBJECT_STONE:
+        case OBJECT_URANIUM:
+        case OBJECT_METAL:
+        case OBJECT_BULLET:
+        case OBJECT_BBOX:
+        case OBJECT_KEYa:
+        case OBJECT_KEYb:
+        case OBJECT_KEYc:
+        case OBJECT_KEYd:
+        case OBJECT_TNT:
+        case OBJECT_BOMB:
+        case OBJECT_WAYPOINT:
+        case OBJECT_WINFIRE:
+        case OBJECT_BAG:
+        case OBJECT_MARKPOWER:
+        case OBJECT_MARKSTONE:
+        case OBJECT_MARKURANIUM:
+        case OBJECT_MARKKEYa:
+        case OBJECT_MARKKEYb:
+        case OBJECT_MARKKEYc:
+        case OBJECT_MARKKEYd:
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+//! Plants created by CreatePlant()
+bool IsClonablePlant(ObjectType type)
+{
+    switch (type)
+    {
+        case OBJECT_PLANT0:
+        case OBJECT_PLANT1:
+        case OBJECT_PLANT2:
+        case OBJECT_PLANT3:
+        case OBJECT_PLANT4:
+        case OBJECT_PLANT5:
+        case OBJECT_PLANT6:
+        case OBJECT_PLANT7:
+        case OBJECT_PLANT8:
+        case OBJECT_PLANT9:
+        case OBJECT_PLANT10:
+        case OBJECT_PLANT11:
+        case OBJECT_PLANT12:
+        case OBJECT_PLANT13:
+        case OBJECT_PLANT14:
+        case OBJECT_PLANT15:
+        case OBJECT_PLANT16:
+        case OBJECT_PLANT17:
+        case OBJECT_PLANT18:
+        case OBJECT_PLANT19:
+        case OBJECT_TREE0:
+        case OBJECT_TREE1:
+        case OBJECT_TREE2:
+        case OBJECT_TREE3:
+        case OBJECT_TREE4:
+        case OBJECT_TREE5:
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+} // anonymous namespace
+
 CObjectFactory::CObjectFactory(Gfx::CEngine* engine,
                                Gfx::CTerrain* terrain,
                                Gfx::COldModelManager* oldModelManager,
@@ -318,6 +396,117 @@ CObjectUPtr CObjectFactory::CreateObject(const ObjectCreateParams& params)
     return nullptr;
 }
 
+bool CObjectFactory::CanClone(ObjectType type)
+{
+    if (CStaticObject::IsStaticObject(type))
+        return false;
+
+    return IsClonableResource(type) || IsClonablePlant(type);
+}
+
+bool CObjectFactory::IsSamePrototype(const ObjectCreateParams& a, const ObjectCreateParams& b)
+{
+    return a.type    == b.type    &&
+           a.power   == b.power   &&
+           a.height  == b.height  &&
+           a.trainer == b.trainer &&
+           a.toy     == b.toy     &&
+           a.option  == b.option  &&
+           a.team    == b.team;
+}
+
+std::vector<CObjectUPtr> CObjectFactory::CreateObjects(const std::vector<ObjectCreateParams>& params)
+{
+    std::vector<CObjectUPtr> objects;
+    if (params.empty())
+        return objects;
+
+    assert(CanClone(params[0].type));
+
+    objects.reserve(params.size());
+    m_engine->ReserveObjects(params.size());
+
+    objects.push_back(CreateObject(params[0]));
+    COldObject* prototype = dynamic_cast<COldObject*>(objects[0].get());
+    assert(prototype != nullptr);
+
+    // Distance between the floor and the prototype, includes params.height and
+    // any offset added by the type itself
+    Math::Vector floor = prototype->GetPosition();
+    m_terrain->AdjustToFloor(floor);
+    float height = prototype->GetPosition().y - floor.y;
+
+    for (std::size_t i = 1; i < params.size(); i++)
+    {
+        assert(IsSamePrototype(params[0], params[i]));
+        objects.push_back(CloneObject(prototype, params[i], height));
+    }
+
+    return objects;
+}
+
+// Creates a copy of the prototype at another place.
+
+CObjectUPtr CObjectFactory::CloneObject(COldObject* prototype, const ObjectCreateParams& params, float height)
+{
+    auto obj = MakeUnique<COldObject>(params.id);
+
+    obj->SetType(prototype->GetType());
+    obj->SetTeam(prototype->GetTeam());
+
+    // Engine objects share base objects (models) with the prototype
+    for (int i = 0; i < prototype->m_totalPart; i++)
+    {
+        const ObjectPart& part = prototype->m_objectPart[i];
+        if (!part.bUsed)  continue;
+
+        int rank = m_engine->CreateObject();
+        m_engine->SetObjectType(rank, m_engine->GetObjectType(part.object));
+        m_engine->SetObjectBaseRank(rank, m_engine->GetObjectBaseRank(part.object));
+        obj->SetObjectRank(i, rank);
+        obj->SetObjectParent(i, part.parentPart);
+
+        if (i != 0)
+        {
+            obj->SetPartPosition(i, part.position);
+            obj->SetPartRotation(i, part.angle);
+        }
+        if (part.bZoom)
+        {
+            obj->SetPartScale(i, part.zoom);
+        }
+    }
+
+    obj->SetEnergyLevel(prototype->GetEnergyLevel());
+
+    for (const CrashSphere& crashSphere : prototype->m_crashSpheres)
+    {
+        obj->AddCrashSphere(crashSphere);
+    }
+    obj->SetCameraCollisionSphere(prototype->m_cameraCollisionSphere);
+    if (prototype->Implements(ObjectInterfaceType::Jostleable))
+    {
+        obj->SetJostlingSphere(prototype->m_jostlingSphere);
+    }
+
+    m_engine->CopyShadowSpot(prototype->m_objectPart[0].object, obj->m_objectPart[0].object);
+
+    obj->SetPosition(params.pos);
+    obj->SetRotationY(params.angle);
+
+    obj->SetFloorHeight(0.0f);
+    if (IsClonableResource(obj->GetType()))
+    {
+        obj->FloorAdjust();
+    }
+
+    Math::Vector pos = obj->GetPosition();
+    pos.y += height;
+    obj->SetPosition(pos);  // to display the shadows immediately
+
+    return std::move(obj);
+}
+
 // Creates a small resource set on the ground.
 
 CObjectUPtr CObjectFactory::CreateResource(const ObjectCreateParams& params)
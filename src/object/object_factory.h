@@ -29,6 +29,7 @@
 #include "object/object_type.h"
 
 #include <memory>
+#include <vector>
 
 namespace Gfx
 {
@@ -56,6 +57,19 @@ public:
 
     CObjectUPtr CreateObject(const ObjectCreateParams& params);
 
+    //! Returns true if objects of given type can be created in bulk, see CreateObjects()
+    static bool CanClone(ObjectType type);
+    //! Returns true if both params describe the same object, apart from id, position and angle
+    static bool IsSamePrototype(const ObjectCreateParams& a, const ObjectCreateParams& b);
+    //! Creates many objects that differ only in id, position and angle
+    /**
+     * The first object is created normally and serves as prototype. The others are cloned
+     * from it, sharing its models and copying its crash spheres and shadow, which skips
+     * the model lookup and texture loading done for each object by CreateObject().
+     * All params must be of a type accepted by CanClone() and pass IsSamePrototype().
+     */
+    std::vector<CObjectUPtr> CreateObjects(const std::vector<ObjectCreateParams>& params);
+
 private:
     CObjectUPtr CreateResource(const ObjectCreateParams& params);
     CObjectUPtr CreateFlag(const ObjectCreateParams& params);
@@ -69,6 +83,7 @@ private:
     CObjectUPtr CreateRuin(const ObjectCreateParams& params);
     CObjectUPtr CreateApollo(const ObjectCreateParams& params);
     void AddObjectAuto(COldObject* obj);
+    CObjectUPtr CloneObject(COldObject* prototype, const ObjectCreateParams& params, float height);
 
 private:
     Gfx::CEngine* m_engine;
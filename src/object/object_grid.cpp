@@ -0,0 +1,185 @@
+/*
+ * This file is part of the Colobot: Gold Edition source code
+ * Copyright (C) 2001-2016, Daniel Roux, EPSITEC SA & TerranovaTeam
+ * http://epsitec.ch; http://colobot.info; http://github.com/colobot
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://gnu.org/licenses
+ */
+
+#include "object/object_grid.h"
+
+#include "object/object.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+
+namespace
+{
+
+//! Maps span at most -1600..1600 on both axes, coordinates are clamped a bit further
+//! so that objects outside and huge query areas end up in the border cells
+const float MAX_COORD = 2000.0f;
+
+} // anonymous namespace
+
+
+CObjectGrid::CObjectGrid(float cellSize)
+    : m_cellSize(cellSize)
+{
+    assert(cellSize > 0.0f);
+}
+
+void CObjectGrid::Add(CObject* object)
+{
+    assert(m_objectCells.count(object) == 0);
+
+    CellKey key = GetCellKey(object->GetPosition());
+    m_objectCells[object] = key;
+    AddToCell(key, object);
+}
+
+void CObjectGrid::Remove(CObject* object)
+{
+    auto it = m_objectCells.find(object);
+    if (it == m_objectCells.end())
+        return;
+
+    RemoveFromCell(it->second, object);
+    m_objectCells.erase(it);
+}
+
+void CObjectGrid::Update(CObject* object)
+{
+    auto it = m_objectCells.find(object);
+    if (it == m_objectCells.end())
+        return;
+
+    CellKey key = GetCellKey(object->GetPosition());
+    if (key == it->second)
+        return;
+
+    RemoveFromCell(it->second, object);
+    AddToCell(key, object);
+    it->second = key;
+}
+
+void CObjectGrid::Clear()
+{
+    m_cells.clear();
+    m_objectCells.clear();
+}
+
+std::vector<CObject*> CObjectGrid::QueryRadius(const Math::Vector& center, float radius) const
+{
+    return CollectCandidates(GetCellRange(center.x - radius, center.z - radius,
+                                          center.x + radius, center.z + radius));
+}
+
+std::vector<CObject*> CObjectGrid::QueryBox(const Math::Vector& min, const Math::Vector& max) const
+{
+    return CollectCandidates(GetCellRange(min.x, min.z, max.x, max.z));
+}
+
+int CObjectGrid::GetCellCoord(float coord) const
+{
+    // Written so that NaN is clamped as well
+    if (!(coord > -MAX_COORD)) coord = -MAX_COORD;
+    if (coord > MAX_COORD) coord = MAX_COORD;
+    return static_cast<int>(std::floor(coord / m_cellSize));
+}
+
+CObjectGrid::CellKey CObjectGrid::GetCellKey(int x, int z) const
+{
+    // Shifted as unsigned, shifting negative values is undefined
+    unsigned long long key = (static_cast<unsigned long long>(static_cast<unsigned int>(x)) << 32) |
+                             static_cast<unsigned int>(z);
+    return static_cast<CellKey>(key);
+}
+
+CObjectGrid::CellKey CObjectGrid::GetCellKey(const Math::Vector& pos) const
+{
+    return GetCellKey(GetCellCoord(pos.x), GetCellCoord(pos.z));
+}
+
+CObjectGrid::CellRange CObjectGrid::GetCellRange(float minX, float minZ, float maxX, float maxZ) const
+{
+    CellRange range;
+    range.minX = GetCellCoord(minX);
+    range.minZ = GetCellCoord(minZ);
+    range.maxX = GetCellCoord(maxX);
+    range.maxZ = GetCellCoord(maxZ);
+    return range;
+}
+
+void CObjectGrid::AddToCell(CellKey key, CObject* object)
+{
+    m_cells[key].push_back(object);
+}
+
+void CObjectGrid::RemoveFromCell(CellKey key, CObject* object)
+{
+    auto cellIt = m_cells.find(key);
+    assert(cellIt != m_cells.end());
+
+    std::vector<CObject*>& cell = cellIt->second;
+    auto it = std::find(cell.begin(), cell.end(), object);
+    assert(it != cell.end());
+
+    // Order inside a cell doesn't matter, results are sorted anyway
+    *it = cell.back();
+    cell.pop_back();
+
+    if (cell.empty())
+        m_cells.erase(cellIt);
+}
+
+std::vector<CObject*> CObjectGrid::CollectCandidates(const CellRange& range) const
+{
+    std::vector<CObject*> result;
+
+    long long cellCount = (static_cast<long long>(range.maxX) - range.minX + 1) *
+                          (static_cast<long long>(range.maxZ) - range.minZ + 1);
+
+    if (cellCount > static_cast<long long>(m_cells.size()))
+    {
+        // Huge query area (e.g. radar with default range) - it is cheaper to go over
+        // occupied cells than over the whole range
+        for (const auto& cell : m_cells)
+        {
+            unsigned long long key = static_cast<unsigned long long>(cell.first);
+            int x = static_cast<int>(static_cast<unsigned int>(key >> 32));
+            int z = static_cast<int>(static_cast<unsigned int>(key & 0xFFFFFFFF));
+            if (x < range.minX || x > range.maxX) continue;
+            if (z < range.minZ || z > range.maxZ) continue;
+            result.insert(result.end(), cell.second.begin(), cell.second.end());
+        }
+    }
+    else
+    {
+        for (int x = range.minX; x <= range.maxX; ++x)
+        {
+            for (int z = range.minZ; z <= range.maxZ; ++z)
+            {
+                auto it = m_cells.find(GetCellKey(x, z));
+                if (it == m_cells.end()) continue;
+                result.insert(result.end(), it->second.begin(), it->second.end());
+            }
+        }
+    }
+
+    std::sort(result.begin(), result.end(), [](CObject* a, CObject* b) { return a->GetID() < b->GetID(); });
+    return result;
+}
@@ -0,0 +1,91 @@
+/*
+ * This file is part of the Colobot: Gold Edition source code
+ * Copyright (C) 2001-2016, Daniel Roux, EPSITEC SA & TerranovaTeam
+ * http://epsitec.ch; http://colobot.info; http://github.com/colobot
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://gnu.org/licenses
+ */
+
+/**
+ * \file object/object_grid.h
+ * \brief Uniform grid spatial index over object positions
+ */
+
+#pragma once
+
+#include "math/vector.h"
+
+#include <unordered_map>
+#include <vector>
+
+class CObject;
+
+/**
+ * \class CObjectGrid
+ * \brief Uniform 2D grid (on XZ plane) indexing objects by their position
+ *
+ * The grid is owned by CObjectManager. Objects are added when they are registered
+ * in the manager, moved whenever their position changes and removed on deletion.
+ *
+ * Queries return candidates only, i.e. all objects in cells touched by the query area.
+ * Callers are expected to do the exact test themselves. Candidates are always
+ * returned sorted by object id, so results don't depend on the hashing order.
+ *
+ * Coordinates are clamped a bit outside of the map, so objects out of it share
+ * the border cells and any query area (even infinite or NaN) stays valid.
+ */
+class CObjectGrid
+{
+public:
+    //! Creates a grid with given cell size (in world units)
+    explicit CObjectGrid(float cellSize);
+
+    //! Adds object to the grid at its current position
+    void Add(CObject* object);
+    //! Removes object from the grid
+    void Remove(CObject* object);
+    //! Updates object after position change; ignores objects not added to the grid
+    void Update(CObject* object);
+    //! Removes all objects
+    void Clear();
+
+    //! Returns candidates closer than radius to center (on XZ plane)
+    std::vector<CObject*> QueryRadius(const Math::Vector& center, float radius) const;
+    //! Returns candidates inside the given box (on XZ plane)
+    std::vector<CObject*> QueryBox(const Math::Vector& min, const Math::Vector& max) const;
+
+private:
+    using CellKey = long long;
+
+    struct CellRange
+    {
+        int minX, minZ;
+        int maxX, maxZ;
+    };
+
+    int GetCellCoord(float coord) const;
+    CellKey GetCellKey(int x, int z) const;
+    CellKey GetCellKey(const Math::Vector& pos) const;
+    CellRange GetCellRange(float minX, float minZ, float maxX, float maxZ) const;
+
+    void AddToCell(CellKey key, CObject* object);
+    void RemoveFromCell(CellKey key, CObject* object);
+
+    std::vector<CObject*> CollectCandidates(const CellRange& range) const;
+
+private:
+    float m_cellSize;
+    std::unordered_map<CellKey, std::vector<CObject*>> m_cells;
+    std::unordered_map<CObject*, CellKey> m_objectCells;
+};
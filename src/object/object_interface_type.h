@@ -58,3 +58,61 @@ enum class ObjectInterfaceType
 };
 
 using ObjectInterfaceTypes = std::array<bool, static_cast<std::size_t>(ObjectInterfaceType::Max)>;
+
+class CInteractiveObject;
+class CTransportableObject;
+class CProgramStorageObject;
+class CProgrammableObject;
+class CTaskExecutorObject;
+class CJostleableObject;
+class CCarrierObject;
+class CPoweredObject;
+class CMovableObject;
+class CFlyingObject;
+class CJetFlyingObject;
+class CControllableObject;
+class CPowerContainerObject;
+class CRangedObject;
+class CTraceDrawingObject;
+class CDamageableObject;
+class CDestroyableObject;
+class CFragileObject;
+class CShieldedObject;
+class CShieldedAutoRegenObject;
+class COldObject;
+
+/**
+ * \struct ObjectInterfaceClass
+ * \brief Maps ObjectInterfaceType to the class implementing it
+ *
+ * Used by CObject::GetInterface() to return a pointer of the right type.
+ */
+template<ObjectInterfaceType type>
+struct ObjectInterfaceClass;
+
+#define OBJECT_INTERFACE_CLASS(type, cls) \
+    template<> struct ObjectInterfaceClass<ObjectInterfaceType::type> { using Type = cls; }
+
+OBJECT_INTERFACE_CLASS(Interactive, CInteractiveObject);
+OBJECT_INTERFACE_CLASS(Transportable, CTransportableObject);
+OBJECT_INTERFACE_CLASS(ProgramStorage, CProgramStorageObject);
+OBJECT_INTERFACE_CLASS(Programmable, CProgrammableObject);
+OBJECT_INTERFACE_CLASS(TaskExecutor, CTaskExecutorObject);
+OBJECT_INTERFACE_CLASS(Jostleable, CJostleableObject);
+OBJECT_INTERFACE_CLASS(Carrier, CCarrierObject);
+OBJECT_INTERFACE_CLASS(Powered, CPoweredObject);
+OBJECT_INTERFACE_CLASS(Movable, CMovableObject);
+OBJECT_INTERFACE_CLASS(Flying, CFlyingObject);
+OBJECT_INTERFACE_CLASS(JetFlying, CJetFlyingObject);
+OBJECT_INTERFACE_CLASS(Controllable, CControllableObject);
+OBJECT_INTERFACE_CLASS(PowerContainer, CPowerContainerObject);
+OBJECT_INTERFACE_CLASS(Ranged, CRangedObject);
+OBJECT_INTERFACE_CLASS(TraceDrawing, CTraceDrawingObject);
+OBJECT_INTERFACE_CLASS(Damageable, CDamageableObject);
+OBJECT_INTERFACE_CLASS(Destroyable, CDestroyableObject);
+OBJECT_INTERFACE_CLASS(Fragile, CFragileObject);
+OBJECT_INTERFACE_CLASS(Shielded, CShieldedObject);
+OBJECT_INTERFACE_CLASS(ShieldedAutoRegen, CShieldedAutoRegenObject);
+OBJECT_INTERFACE_CLASS(Old, COldObject);
+
+#undef OBJECT_INTERFACE_CLASS
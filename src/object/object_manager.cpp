@@ -24,6 +24,7 @@
 
 #include "math/all.h"
 
+#include "object/navigation_grid.h"
 #include "object/object.h"
 #include "object/object_create_exception.h"
 #include "object/object_create_params.h"
@@ -35,24 +36,69 @@
 #include "physics/physics.h"
 
 #include <algorithm>
+#include <iterator>
 
 
 template<> CObjectManager* CSingleton<CObjectManager>::m_instance = nullptr;
 
 
+namespace
+{
+
+//! Number of changes remembered by GetChangedObjects()
+const std::size_t MAX_CHANGED_OBJECTS = 1024;
+
+bool CompareObjectIds(CObject* a, CObject* b)
+{
+    return a->GetID() < b->GetID();
+}
+
+void InsertOrderedById(std::vector<CObject*>& list, CObject* object)
+{
+    // New objects usually have the highest id, so this is normally just push_back
+    auto it = std::upper_bound(list.begin(), list.end(), object, CompareObjectIds);
+    list.insert(it, object);
+}
+
+void EraseOrderedById(std::vector<CObject*>& list, CObject* object)
+{
+    auto it = std::lower_bound(list.begin(), list.end(), object, CompareObjectIds);
+    assert(it != list.end() && *it == object);
+    list.erase(it);
+}
+
+bool IsInSector(const Math::Vector& center, const Math::Vector& pos, float angle, float focus, float minDist, float maxDist)
+{
+    float d = Math::DistanceProjected(center, pos);
+    if ( d < minDist || d > maxDist )  return false;  // too close or too far?
+
+    float a = Math::RotateAngle(pos.x-center.x, center.z-pos.z);  // CW !
+    return Math::TestAngle(a, angle-focus/2.0f, angle+focus/2.0f) || focus >= Math::PI*2.0f;
+}
+
+} // anonymous namespace
+
+
+
 CObjectManager::CObjectManager(Gfx::CEngine* engine,
                                Gfx::CTerrain* terrain,
                                Gfx::COldModelManager* oldModelManager,
                                Gfx::CModelManager* modelManager,
                                Gfx::CParticle* particle)
-  : m_objectFactory(MakeUnique<CObjectFactory>(engine,
+  : m_grid(10.0f*g_unit),
+    m_navigationGrid(MakeUnique<CNavigationGrid>(engine, terrain)),
+    m_indexRevision(0),
+    m_changeRevision(0),
+    m_changedObjectsRevision(0),
+    m_objectFactory(MakeUnique<CObjectFactory>(engine,
                                                terrain,
                                                oldModelManager,
                                                modelManager,
                                                particle)),
+    m_removedObjectCount(0),
+    m_maxCrashSphereExtent(0.0f),
     m_nextId(0),
-    m_activeObjectIterators(0),
-    m_shouldCleanRemovedObjects(false)
+    m_activeObjectIterators(0)
 {
 }
 
@@ -60,6 +106,34 @@ CObjectManager::~CObjectManager()
 {
 }
 
+ObjectHandle CObjectManager::AllocateSlot(std::unique_ptr<CObject> object)
+{
+    ObjectHandle handle;
+    if (!m_freeSlots.empty())
+    {
+        handle.index = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    }
+    else
+    {
+        handle.index = m_slots.size();
+        m_slots.emplace_back();
+    }
+
+    ObjectSlot& slot = m_slots[handle.index];
+    slot.object = std::move(object);
+    handle.generation = slot.generation;
+    return handle;
+}
+
+void CObjectManager::FreeSlot(ObjectHandle handle)
+{
+    ObjectSlot& slot = m_slots[handle.index];
+    slot.object.reset();
+    ++slot.generation;
+    m_freeSlots.push_back(handle.index);
+}
+
 bool CObjectManager::DeleteObject(CObject* instance)
 {
     assert(instance != nullptr);
@@ -69,11 +143,21 @@ bool CObjectManager::DeleteObject(CObject* instance)
     if (oldObj != nullptr)
         oldObj->DeleteObject();
 
-    auto it = m_objects.find(instance->GetID());
-    if (it != m_objects.end())
+    auto it = m_handlesById.find(instance->GetID());
+    if (it != m_handlesById.end())
     {
-        it->second.reset();
-        m_shouldCleanRemovedObjects = true;
+        ObjectHandle handle = it->second;
+        m_handlesById.erase(it);
+
+        m_grid.Remove(instance);
+        m_navigationGrid->RemoveObject(instance);
+        RemoveFromIndexes(instance);
+
+        // Iterators may be active, so only mark the entry; the list is compacted later
+        m_objectList[m_slots[handle.index].listIndex] = nullptr;
+        ++m_removedObjectCount;
+
+        FreeSlot(handle);
         return true;
     }
 
@@ -85,25 +169,28 @@ void CObjectManager::CleanRemovedObjectsIfNeeded()
     if (m_activeObjectIterators != 0)
         return;
 
-    if (! m_shouldCleanRemovedObjects)
+    if (m_removedObjectCount == 0)
         return;
 
-    auto it = m_objects.begin();
-    if (it != m_objects.end())
+    std::size_t count = 0;
+    for (CObject* object : m_objectList)
     {
-        if (it->second == nullptr)
-            it = m_objects.erase(it);
+        if (object == nullptr) continue;
+
+        m_slots[m_handlesById[object->GetID()].index].listIndex = count;
+        m_objectList[count++] = object;
     }
+    m_objectList.resize(count);
 
-    m_shouldCleanRemovedObjects = false;
+    m_removedObjectCount = 0;
 }
 
 void CObjectManager::DeleteAllObjects()
 {
-    for (auto& it : m_objects)
+    for (std::size_t i = 0; i < m_objectList.size(); ++i)
     {
         // TODO: temporarily...
-        auto oldObj = dynamic_cast<COldObject*>(it.second.get());
+        auto oldObj = dynamic_cast<COldObject*>(m_objectList[i]);
         if (oldObj != nullptr)
         {
             bool all = true;
@@ -111,19 +198,53 @@ void CObjectManager::DeleteAllObjects()
         }
     }
 
-    m_objects.clear();
+    m_objectList.clear();
+    m_removedObjectCount = 0;
+    m_handlesById.clear();
+    m_freeSlots.clear();
+    for (auto& slot : m_slots)
+    {
+        slot.object.reset();
+        ++slot.generation;
+    }
+    for (unsigned int i = m_slots.size(); i > 0; --i)
+        m_freeSlots.push_back(i - 1);
+
+    m_grid.Clear();
+    m_staticObjects.Clear();
+    m_navigationGrid->Clear();
+    m_maxCrashSphereExtent = 0.0f;
+    m_objectsByType.clear();
+    m_objectsByTeam.clear();
+    for (auto& list : m_objectsByInterface)
+        list.clear();
+    m_indexedObjects.clear();
+    m_indexRevision++;
+    m_changedObjects.clear();
+    m_changedObjectsRevision = ++m_changeRevision;
+    m_radarCache.clear();
 
     m_nextId = 0;
 }
 
 CObject* CObjectManager::GetObjectById(unsigned int id)
 {
-    if (m_objects.count(id) == 0) return nullptr;
-    return m_objects[id].get();
+    auto it = m_handlesById.find(id);
+    if (it == m_handlesById.end()) return nullptr;
+    return m_slots[it->second.index].object.get();
 }
 
 CObject* CObjectManager::GetObjectByRank(unsigned int id)
 {
+    CleanRemovedObjectsIfNeeded();
+
+    if (m_removedObjectCount == 0)
+    {
+        if (id >= m_objectList.size()) return nullptr;
+        return m_objectList[id];
+    }
+
+    // Called while iterating over objects, have to skip removed ones
     auto objects = GetAllObjects();
     auto it = objects.begin();
     for (unsigned int i = 0; i < id && it != objects.end(); i++, ++it);
@@ -131,7 +252,57 @@ CObject* CObjectManager::GetObjectByRank(unsigned int id)
     return *it;
 }
 
+ObjectHandle CObjectManager::GetObjectHandle(CObject* object)
+{
+    assert(object != nullptr);
+    auto it = m_handlesById.find(object->GetID());
+    assert(it != m_handlesById.end());
+    return it->second;
+}
+
+CObject* CObjectManager::GetObjectByHandle(ObjectHandle handle)
+{
+    if (handle.index >= m_slots.size()) return nullptr;
+
+    const ObjectSlot& slot = m_slots[handle.index];
+    if (slot.generation != handle.generation) return nullptr;
+    return slot.object.get();
+}
+
 CObject* CObjectManager::CreateObject(ObjectCreateParams params)
+{
+    AssignId(params);
+
+    auto objectUPtr = m_objectFactory->CreateObject(params);
+
+    if (objectUPtr == nullptr)
+        throw CObjectCreateException("Something went wrong in CObjectFactory", params.type);
+
+    return AddObject(std::move(objectUPtr));
+}
+
+std::vector<CObject*> CObjectManager::CreateObjects(std::vector<ObjectCreateParams> params)
+{
+    for (ObjectCreateParams& objectParams : params)
+    {
+        AssignId(objectParams);
+    }
+
+    std::vector<CObject*> objects;
+    objects.reserve(params.size());
+    m_objectList.reserve(m_objectList.size() + params.size());
+
+    for (auto& objectUPtr : m_objectFactory->CreateObjects(params))
+    {
+        if (objectUPtr == nullptr)
+            throw CObjectCreateException("Something went wrong in CObjectFactory", params[0].type);
+
+        objects.push_back(AddObject(std::move(objectUPtr)));
+    }
+    return objects;
+}
+
+void CObjectManager::AssignId(ObjectCreateParams& params)
 {
     if (params.id < 0)
     {
@@ -146,16 +317,37 @@ CObject* CObjectManager::CreateObject(ObjectCreateParams params)
         }
     }
 
-    assert(m_objects.find(params.id) == m_objects.end());
+    assert(m_handlesById.find(params.id) == m_handlesById.end());
+}
 
-    auto objectUPtr = m_objectFactory->CreateObject(params);
+CObject* CObjectManager::AddObject(std::unique_ptr<CObject> objectUPtr)
+{
+    CObject* objectPtr = objectUPtr.get();
+    int id = objectPtr->GetID();
 
-    if (objectUPtr == nullptr)
-        throw CObjectCreateException("Something went wrong in CObjectFactory", params.type);
+    ObjectHandle handle = AllocateSlot(std::move(objectUPtr));
+    m_handlesById[id] = handle;
 
-    CObject* objectPtr = objectUPtr.get();
+    // Ids normally grow, but objects loaded from saved games may come in any order
+    std::size_t listIndex = m_objectList.size();
+    for (std::size_t i = m_objectList.size(); i > 0; --i)
+    {
+        CObject* object = m_objectList[i-1];
+        if (object == nullptr) continue;
+        if (object->GetID() < id) break;
+        listIndex = i-1;
+    }
+    m_objectList.insert(m_objectList.begin() + listIndex, objectPtr);
+    for (std::size_t i = listIndex; i < m_objectList.size(); ++i)
+    {
+        if (m_objectList[i] == nullptr) continue;
+        m_slots[m_handlesById[m_objectList[i]->GetID()].index].listIndex = i;
+    }
 
-    m_objects[params.id] = std::move(objectUPtr);
+    m_grid.Add(objectPtr);
+    m_navigationGrid->AddObject(objectPtr);
+    AddToIndexes(objectPtr);
+    m_maxCrashSphereExtent = std::max(m_maxCrashSphereExtent, objectPtr->GetCrashSphereExtent());
 
     return objectPtr;
 }
@@ -173,27 +365,36 @@ CObject* CObjectManager::CreateObject(Math::Vector pos, float angle, ObjectType
 
 std::vector<CObject*> CObjectManager::GetObjectsOfTeam(int team)
 {
-    std::vector<CObject*> result;
-    for (CObject* object : GetAllObjects())
-    {
-        if (object->GetTeam() == team)
-        {
-            result.push_back(object);
-        }
-    }
-    return result;
+    auto it = m_objectsByTeam.find(team);
+    if (it == m_objectsByTeam.end())
+        return std::vector<CObject*>();
+    return it->second;
+}
+
+std::vector<CObject*> CObjectManager::GetObjectsOfType(ObjectType type)
+{
+    auto it = m_objectsByType.find(type);
+    if (it == m_objectsByType.end())
+        return std::vector<CObject*>();
+    return it->second;
+}
+
+std::vector<CObject*> CObjectManager::GetObjectsImplementing(ObjectInterfaceType interface)
+{
+    return m_objectsByInterface[static_cast<int>(interface)];
 }
 
 bool CObjectManager::TeamExists(int team)
 {
     if(team == 0) return true;
 
-    for (CObject* object : GetAllObjects())
-    {
-        if (!object->GetActive())
-            continue;
+    auto it = m_objectsByTeam.find(team);
+    if (it == m_objectsByTeam.end())
+        return false;
 
-        if (object->GetTeam() == team)
+    for (CObject* object : it->second)
+    {
+        if (object->GetActive())
             return true;
     }
     return false;
@@ -203,31 +404,241 @@ void CObjectManager::DestroyTeam(int team)
 {
     assert(team != 0);
 
-    for (CObject* object : GetAllObjects())
+    // Destroying an object may delete others (e.g. its power cell), so remember ids first
+    std::vector<int> ids;
+    for (CObject* object : GetObjectsOfTeam(team))
+        ids.push_back(object->GetID());
+
+    for (int id : ids)
     {
-        if (object->GetTeam() == team)
+        CObject* object = GetObjectById(id);
+        if (object == nullptr) continue;
+
+        if (object->Implements(ObjectInterfaceType::Destroyable))
         {
-            if (object->Implements(ObjectInterfaceType::Destroyable))
-            {
-                dynamic_cast<CDestroyableObject*>(object)->DestroyObject(DestructionType::Explosion);
-            }
-            else
-            {
-                DeleteObject(object);
-            }
+            dynamic_cast<CDestroyableObject*>(object)->DestroyObject(DestructionType::Explosion);
+        }
+        else
+        {
+            DeleteObject(object);
         }
     }
 }
 
 int CObjectManager::CountObjectsImplementing(ObjectInterfaceType interface)
 {
-    int count = 0;
+    return m_objectsByInterface[static_cast<int>(interface)].size();
+}
+
+std::map<ObjectType, CObjectManager::MemoryUsage> CObjectManager::GetMemoryReport()
+{
+    std::map<ObjectType, MemoryUsage> report;
     for (CObject* object : GetAllObjects())
     {
-        if (object->Implements(interface))
-            count++;
+        MemoryUsage& usage = report[object->GetType()];
+        usage.count++;
+        usage.bytes += object->GetMemoryUsage();
+    }
+    return report;
+}
+
+void CObjectManager::AddToIndexes(CObject* object)
+{
+    IndexedObjectState state;
+    state.type = object->GetType();
+    state.team = object->GetTeam();
+    for (int i = 0; i < static_cast<int>(ObjectInterfaceType::Max); ++i)
+    {
+        state.interfaces[i] = object->Implements(static_cast<ObjectInterfaceType>(i));
+        if (state.interfaces[i])
+            InsertOrderedById(m_objectsByInterface[i], object);
+    }
+
+    InsertOrderedById(m_objectsByType[state.type], object);
+    InsertOrderedById(m_objectsByTeam[state.team], object);
+
+    if (!state.interfaces[static_cast<int>(ObjectInterfaceType::Movable)] &&
+        !state.interfaces[static_cast<int>(ObjectInterfaceType::Transportable)])
+    {
+        m_staticObjects.Add(object);
+    }
+
+    m_indexedObjects[object] = state;
+    m_indexRevision++;
+    m_radarCache.clear();
+}
+
+void CObjectManager::RemoveFromIndexes(CObject* object)
+{
+    auto it = m_indexedObjects.find(object);
+    if (it == m_indexedObjects.end())
+        return;
+
+    const IndexedObjectState& state = it->second;
+    for (int i = 0; i < static_cast<int>(ObjectInterfaceType::Max); ++i)
+    {
+        if (state.interfaces[i])
+            EraseOrderedById(m_objectsByInterface[i], object);
     }
-    return count;
+
+    EraseOrderedById(m_objectsByType[state.type], object);
+    EraseOrderedById(m_objectsByTeam[state.team], object);
+    m_staticObjects.Remove(object);
+
+    m_indexedObjects.erase(it);
+    m_indexRevision++;
+    m_radarCache.clear();  // it mustn't be found anymore
+}
+
+void CObjectManager::UpdateObjectIndexes(CObject* object)
+{
+    // Objects which are still being created are indexed only after registration
+    if (m_indexedObjects.count(object) == 0)
+        return;
+
+    RemoveFromIndexes(object);
+    AddToIndexes(object);
+}
+
+unsigned int CObjectManager::GetIndexRevision()
+{
+    return m_indexRevision;
+}
+
+void CObjectManager::UpdateObjectState(CObject* object)
+{
+    AddChange(object);
+}
+
+unsigned int CObjectManager::GetChangeRevision()
+{
+    return m_changeRevision;
+}
+
+bool CObjectManager::GetChangedObjects(unsigned int revision, std::vector<CObject*>& objects)
+{
+    objects.clear();
+    if (revision < m_changedObjectsRevision)
+        return false;
+
+    for (const ChangedObject& changed : m_changedObjects)
+    {
+        if (changed.revision > revision)
+            objects.push_back(changed.object);
+    }
+    return true;
+}
+
+void CObjectManager::AddChange(CObject* object)
+{
+    // Objects which are still being created are recorded with their registration,
+    // which changes the index revision
+    if (m_indexedObjects.count(object) == 0)
+        return;
+
+    // Moving objects change every frame, record them once
+    if (!m_changedObjects.empty() && m_changedObjects.back().object == object)
+    {
+        m_changedObjects.back().revision = ++m_changeRevision;
+        return;
+    }
+
+    ChangedObject changed;
+    changed.revision = ++m_changeRevision;
+    changed.object = object;
+    m_changedObjects.push_back(changed);
+
+    if (m_changedObjects.size() > MAX_CHANGED_OBJECTS)
+    {
+        m_changedObjectsRevision = m_changedObjects.front().revision;
+        m_changedObjects.pop_front();
+    }
+}
+
+void CObjectManager::UpdateObjectPosition(CObject* object)
+{
+    m_grid.Update(object);
+    m_staticObjects.Update(object);
+    m_navigationGrid->UpdateObject(object);
+    AddChange(object);
+}
+
+void CObjectManager::UpdateObjectShape(CObject* object)
+{
+    // Objects may grow after they were added (scale, new crash spheres)
+    m_maxCrashSphereExtent = std::max(m_maxCrashSphereExtent, object->GetCrashSphereExtent());
+    m_staticObjects.Update(object);
+    m_navigationGrid->UpdateObject(object);
+    m_radarCache.clear();  // transported objects are not found by radar
+    AddChange(object);
+}
+
+CNavigationGrid* CObjectManager::GetNavigationGrid()
+{
+    return m_navigationGrid.get();
+}
+
+std::vector<CObject*> CObjectManager::GetObjectsInRadius(const Math::Vector& center, float radius)
+{
+    std::vector<CObject*> result;
+    for (CObject* object : m_grid.QueryRadius(center, radius))
+    {
+        if (Math::DistanceProjected(center, object->GetPosition()) > radius) continue;
+        result.push_back(object);
+    }
+    return result;
+}
+
+std::vector<CObject*> CObjectManager::GetObjectsInSector(const Math::Vector& center, float angle, float focus, float minDist, float maxDist)
+{
+    std::vector<CObject*> result;
+    for (CObject* object : m_grid.QueryRadius(center, maxDist))
+    {
+        if (IsInSector(center, object->GetPosition(), angle, focus, minDist, maxDist))
+            result.push_back(object);
+    }
+    return result;
+}
+
+std::vector<CObject*> CObjectManager::GetObjectsInBox(const Math::Vector& min, const Math::Vector& max)
+{
+    std::vector<CObject*> result;
+    for (CObject* object : m_grid.QueryBox(min, max))
+    {
+        Math::Vector pos = object->GetPosition();
+        if (pos.x < min.x || pos.y < min.y || pos.z < min.z) continue;
+        if (pos.x > max.x || pos.y > max.y || pos.z > max.z) continue;
+        result.push_back(object);
+    }
+    return result;
+}
+
+std::vector<CObject*> CObjectManager::GetObjectsNearBox(const Math::Vector& min, const Math::Vector& max)
+{
+    return AddMovingObjects(m_staticObjects.QueryBox(min, max));
+}
+
+std::vector<CObject*> CObjectManager::AddMovingObjects(std::vector<CObject*> objects)
+{
+    // Objects which can move are few, so they are always returned instead of being
+    // kept in the tree, which would have to be refitted every frame
+    for (ObjectInterfaceType type : {ObjectInterfaceType::Movable, ObjectInterfaceType::Transportable})
+    {
+        const std::vector<CObject*>& moving = m_objectsByInterface[static_cast<int>(type)];
+        std::vector<CObject*> merged;
+        merged.reserve(objects.size() + moving.size());
+        std::set_union(objects.begin(), objects.end(), moving.begin(), moving.end(), std::back_inserter(merged),
+                       [](CObject* a, CObject* b) { return a->GetID() < b->GetID(); });
+        objects.swap(merged);
+    }
+    return objects;
+}
+
+std::vector<CObject*> CObjectManager::GetCollisionCandidates(const Math::Vector& center, float radius)
+{
+    // Objects are indexed by their origin, so the search area has to be extended
+    // by the largest crash sphere extent, plus a bit for vibrations applied to the world matrix
+    return GetObjectsInRadius(center, radius + m_maxCrashSphereExtent + g_unit);
 }
 
 std::vector<CObject*> CObjectManager::RadarAll(CObject* pThis, ObjectType type, float angle, float focus, float minDist, float maxDist, bool furthest, RadarFilter filter, bool cbotTypes)
@@ -266,10 +677,8 @@ std::vector<CObject*> CObjectManager::RadarAll(CObject* pThis, Math::Vector this
 
 std::vector<CObject*> CObjectManager::RadarAll(CObject* pThis, Math::Vector thisPosition, float thisAngle, std::vector<ObjectType> type, float angle, float focus, float minDist, float maxDist, bool furthest, RadarFilter filter, bool cbotTypes)
 {
-    CObject     *pObj;
-    Math::Vector    iPos, oPos;
-    float       iAngle, d, a;
-    ObjectType  oType;
+    Math::Vector    iPos;
+    float       iAngle;
 
     minDist *= g_unit;
     maxDist *= g_unit;
@@ -281,65 +690,32 @@ std::vector<CObject*> CObjectManager::RadarAll(CObject* pThis, Math::Vector this
     int filter_team = filter & 0xFF;
     RadarFilter filter_flying = static_cast<RadarFilter>(filter & (FILTER_ONLYLANDING | FILTER_ONLYFLYING));
     RadarFilter filter_enemy = static_cast<RadarFilter>(filter & (FILTER_FRIENDLY | FILTER_ENEMY | FILTER_NEUTRAL));
+    RadarFilter filter_common = static_cast<RadarFilter>(filter_team | filter_flying);
 
-    std::map<float, CObject*> best;
-    for ( auto it = m_objects.begin() ; it != m_objects.end() ; ++it )
+    std::vector<CObject*> candidates;
+    if (type.empty())
     {
-        pObj = it->second.get();
-        if ( pObj == pThis )  continue; // pThis may be nullptr but it doesn't matter
-
-        if (pObj == nullptr) continue;
-        if (IsObjectBeingTransported(pObj))  continue;
-        if ( !pObj->GetDetectable() )  continue;
-        if ( pObj->GetProxyActivate() )  continue;
-
-        oType = pObj->GetType();
-
-        if (cbotTypes)
-        {
-            // TODO: handle this differently (new class describing types? CObjectType::GetBaseType()?)
-            if ( oType == OBJECT_RUINmobilew2 ||
-                oType == OBJECT_RUINmobilet1 ||
-                oType == OBJECT_RUINmobilet2 ||
-                oType == OBJECT_RUINmobiler1 ||
-                oType == OBJECT_RUINmobiler2 )
-            {
-                oType = OBJECT_RUINmobilew1;  // any ruin
-            }
-
-            if ( oType == OBJECT_BARRIER2 ||
-                oType == OBJECT_BARRIER3 )  // barriers?
-            {
-                oType = OBJECT_BARRIER1;  // any barrier
-            }
-            // END OF TODO
-        }
-
-        if ( std::find(type.begin(), type.end(), oType) == type.end() && type.size() > 0 )  continue;
-
-        if ( (oType == OBJECT_TOTO || oType == OBJECT_CONTROLLER) && type.size() == 0 )  continue; // allow OBJECT_TOTO and OBJECT_CONTROLLER only if explicitly asked in type parameter
-
-        if ( filter_flying == FILTER_ONLYLANDING )
+        for (CObject* pObj : GetObjectsInSector(iPos, iAngle, focus, minDist, maxDist))
         {
-            if ( pObj->Implements(ObjectInterfaceType::Movable) )
-            {
-                CPhysics* physics = dynamic_cast<CMovableObject*>(pObj)->GetPhysics();
-                if ( physics != nullptr )
-                {
-                    if ( !physics->GetLand() )  continue;
-                }
-            }
+            if (IsRadarCandidate(pObj, type, filter_common, cbotTypes))
+                candidates.push_back(pObj);
         }
-        if ( filter_flying == FILTER_ONLYFLYING )
+    }
+    else
+    {
+        // Looking for specific types - many robots ask the same during one tick,
+        // so only the part depending on who asks is done for each of them
+        for (CObject* pObj : GetRadarCandidates(type, filter_common, cbotTypes))
         {
-            if ( !pObj->Implements(ObjectInterfaceType::Movable) ) continue;
-            CPhysics* physics = dynamic_cast<CMovableObject*>(pObj)->GetPhysics();
-            if ( physics == nullptr ) continue;
-            if ( physics->GetLand() ) continue;
+            if (IsInSector(iPos, pObj->GetPosition(), iAngle, focus, minDist, maxDist))
+                candidates.push_back(pObj);
         }
+    }
 
-        if ( filter_team != 0 && pObj->GetTeam() != filter_team )
-            continue;
+    std::map<float, CObject*> best;
+    for (CObject* pObj : candidates)
+    {
+        if ( pObj == pThis )  continue; // pThis may be nullptr but it doesn't matter
 
         if( pThis != nullptr )
         {
@@ -350,15 +726,8 @@ std::vector<CObject*> CObjectManager::RadarAll(CObject* pThis, Math::Vector this
             if ( filter_enemy != 0 && (filter_enemy & enemy) == 0 ) continue;
         }
 
-        oPos = pObj->GetPosition();
-        d = Math::DistanceProjected(iPos, oPos);
-        if ( d < minDist || d > maxDist )  continue;  // too close or too far?
-
-        a = Math::RotateAngle(oPos.x-iPos.x, iPos.z-oPos.z);  // CW !
-        if ( Math::TestAngle(a, iAngle-focus/2.0f, iAngle+focus/2.0f) || focus >= Math::PI*2.0f )
-        {
-            best[d] = pObj;
-        }
+        // Distance and angle were already checked when collecting candidates
+        best[Math::DistanceProjected(iPos, pObj->GetPosition())] = pObj;
     }
 
     std::vector<CObject*> sortedBest;
@@ -380,6 +749,123 @@ std::vector<CObject*> CObjectManager::RadarAll(CObject* pThis, Math::Vector this
     return sortedBest;
 }
 
+void CObjectManager::InvalidateRadarCache()
+{
+    m_radarCache.clear();
+}
+
+const std::vector<CObject*>& CObjectManager::GetRadarCandidates(const std::vector<ObjectType>& type, RadarFilter filter, bool cbotTypes)
+{
+    std::vector<ObjectType> sortedType = type;
+    std::sort(sortedType.begin(), sortedType.end());
+    sortedType.erase(std::unique(sortedType.begin(), sortedType.end()), sortedType.end());
+
+    for (const RadarCacheEntry& entry : m_radarCache)
+    {
+        if (entry.filter == filter && entry.cbotTypes == cbotTypes && entry.type == sortedType)
+            return entry.objects;
+    }
+
+    // Start from the type index instead of the grid
+    std::vector<ObjectType> indexTypes = sortedType;
+    if (cbotTypes)
+    {
+        // Aliases handled in IsRadarCandidate(), see the TODO
+        if (std::find(type.begin(), type.end(), OBJECT_RUINmobilew1) != type.end())
+        {
+            indexTypes.insert(indexTypes.end(), { OBJECT_RUINmobilew2, OBJECT_RUINmobilet1, OBJECT_RUINmobilet2,
+                                                  OBJECT_RUINmobiler1, OBJECT_RUINmobiler2 });
+        }
+        if (std::find(type.begin(), type.end(), OBJECT_BARRIER1) != type.end())
+        {
+            indexTypes.insert(indexTypes.end(), { OBJECT_BARRIER2, OBJECT_BARRIER3 });
+        }
+        std::sort(indexTypes.begin(), indexTypes.end());
+        indexTypes.erase(std::unique(indexTypes.begin(), indexTypes.end()), indexTypes.end());
+    }
+
+    RadarCacheEntry entry;
+    entry.type = sortedType;
+    entry.filter = filter;
+    entry.cbotTypes = cbotTypes;
+    for (ObjectType indexType : indexTypes)
+    {
+        auto it = m_objectsByType.find(indexType);
+        if (it == m_objectsByType.end()) continue;
+        for (CObject* object : it->second)
+        {
+            if (IsRadarCandidate(object, sortedType, filter, cbotTypes))
+                entry.objects.push_back(object);
+        }
+    }
+    std::sort(entry.objects.begin(), entry.objects.end(), CompareObjectIds);
+
+    m_radarCache.push_back(std::move(entry));
+    return m_radarCache.back().objects;
+}
+
+bool CObjectManager::IsRadarCandidate(CObject* pObj, const std::vector<ObjectType>& type, RadarFilter filter, bool cbotTypes)
+{
+    int filter_team = filter & 0xFF;
+    RadarFilter filter_flying = static_cast<RadarFilter>(filter & (FILTER_ONLYLANDING | FILTER_ONLYFLYING));
+
+    if (IsObjectBeingTransported(pObj))  return false;
+    if ( !pObj->GetDetectable() )  return false;
+    if ( pObj->GetProxyActivate() )  return false;
+
+    ObjectType oType = pObj->GetType();
+
+    if (cbotTypes)
+    {
+        // TODO: handle this differently (new class describing types? CObjectType::GetBaseType()?)
+        if ( oType == OBJECT_RUINmobilew2 ||
+            oType == OBJECT_RUINmobilet1 ||
+            oType == OBJECT_RUINmobilet2 ||
+            oType == OBJECT_RUINmobiler1 ||
+            oType == OBJECT_RUINmobiler2 )
+        {
+            oType = OBJECT_RUINmobilew1;  // any ruin
+        }
+
+        if ( oType == OBJECT_BARRIER2 ||
+            oType == OBJECT_BARRIER3 )  // barriers?
+        {
+            oType = OBJECT_BARRIER1;  // any barrier
+        }
+        // END OF TODO
+    }
+
+    if ( std::find(type.begin(), type.end(), oType) == type.end() && type.size() > 0 )  return false;
+
+    if ( (oType == OBJECT_TOTO || oType == OBJECT_CONTROLLER) && type.size() == 0 )  return false; // allow OBJECT_TOTO and OBJECT_CONTROLLER only if explicitly asked in type parameter
+
+    if ( filter_flying == FILTER_ONLYLANDING )
+    {
+        CMovableObject* movable = pObj->GetInterface<ObjectInterfaceType::Movable>();
+        if ( movable != nullptr )
+        {
+            CPhysics* physics = movable->GetPhysics();
+            if ( physics != nullptr )
+            {
+                if ( !physics->GetLand() )  return false;
+            }
+        }
+    }
+    if ( filter_flying == FILTER_ONLYFLYING )
+    {
+        CMovableObject* movable = pObj->GetInterface<ObjectInterfaceType::Movable>();
+        if ( movable == nullptr ) return false;
+        CPhysics* physics = movable->GetPhysics();
+        if ( physics == nullptr ) return false;
+        if ( physics->GetLand() ) return false;
+    }
+
+    if ( filter_team != 0 && pObj->GetTeam() != filter_team )
+        return false;
+
+    return true;
+}
+
 CObject* CObjectManager::Radar(CObject* pThis, ObjectType type, float angle, float focus, float minDist, float maxDist, bool furthest, RadarFilter filter, bool cbotTypes)
 {
     std::vector<CObject*> best = RadarAll(pThis, type, angle, focus, minDist, maxDist, furthest, filter, cbotTypes);
@@ -29,13 +29,18 @@
 #include "math/const.h"
 #include "math/vector.h"
 
+#include "object/object_bvh.h"
 #include "object/object_create_params.h"
+#include "object/object_grid.h"
 #include "object/object_interface_type.h"
 #include "object/object_type.h"
 
+#include <array>
+#include <deque>
 #include <map>
-#include <vector>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 namespace Gfx
 {
@@ -46,6 +51,7 @@ class CParticle;
 class CTerrain;
 } // namespace Gfx
 
+class CNavigationGrid;
 class CObject;
 class CObjectFactory;
 
@@ -61,52 +67,76 @@ enum RadarFilter
     FILTER_NEUTRAL     = 1 << (8+4),
 };
 
-using CObjectMap = std::map<int, std::unique_ptr<CObject>>;
-using CObjectMapCIt = std::map<int, std::unique_ptr<CObject>>::const_iterator;
+/**
+ * \struct ObjectHandle
+ * \brief Generational handle to object stored in CObjectManager
+ *
+ * Slots are reused after objects are deleted; the generation is increased every time,
+ * so a handle to a deleted object never resolves to a new one.
+ */
+struct ObjectHandle
+{
+    unsigned int index = 0;
+    unsigned int generation = 0;
+};
+
+//! Objects ordered by id, nullptr marks objects removed while iterating
+using CObjectList = std::vector<CObject*>;
 
 class CObjectIteratorProxy
 {
 private:
     friend class CObjectContainerProxy;
 
-    CObjectIteratorProxy(CObjectMapCIt currentIt, CObjectMapCIt endIt)
-     : m_currentIt(currentIt)
-     , m_endIt(endIt)
+    CObjectIteratorProxy(const CObjectList& list, std::size_t index)
+     : m_list(&list)
+     , m_index(index)
     {
-        while (m_currentIt != m_endIt && m_currentIt->second == nullptr)
-        {
-            ++m_currentIt;
-        }
+        SkipRemoved();
     }
 
 public:
     CObject* operator*()
     {
-        return m_currentIt->second.get();
+        return (*m_list)[m_index];
     }
 
     void operator++()
     {
-        do
-        {
-            ++m_currentIt;
-        }
-        while (m_currentIt != m_endIt && m_currentIt->second == nullptr);
+        ++m_index;
+        SkipRemoved();
     }
 
+    //! Objects created while iterating are visited as well, so the end is checked against current size
     bool operator==(const CObjectIteratorProxy& other)
     {
-        return m_currentIt == other.m_currentIt;
+        if (IsEnd() || other.IsEnd())
+            return IsEnd() == other.IsEnd();
+        return m_index == other.m_index;
     }
 
     bool operator!=(const CObjectIteratorProxy& other)
     {
-        return m_currentIt != other.m_currentIt;
+        return !(*this == other);
     }
 
 private:
-    CObjectMapCIt m_currentIt;
-    CObjectMapCIt m_endIt;
+    bool IsEnd() const
+    {
+        return m_index >= m_list->size();
+    }
+
+    void SkipRemoved()
+    {
+        while (!IsEnd() && (*m_list)[m_index] == nullptr)
+        {
+            ++m_index;
+        }
+    }
+
+private:
+    const CObjectList* m_list;
+    std::size_t m_index;
 };
 
 class CObjectContainerProxy
@@ -114,8 +144,8 @@ class CObjectContainerProxy
 private:
     friend class CObjectManager;
 
-    CObjectContainerProxy(const CObjectMap& map, int& activeIteratorsCounter)
-     : m_map(map),
+    CObjectContainerProxy(const CObjectList& list, int& activeIteratorsCounter)
+     : m_list(list),
        m_activeIteratorsCounter(activeIteratorsCounter)
     {
         ++m_activeIteratorsCounter;
@@ -129,15 +159,15 @@ public:
 
     CObjectIteratorProxy begin() const
     {
-        return CObjectIteratorProxy(m_map.begin(), m_map.end());
+        return CObjectIteratorProxy(m_list, 0);
     }
     CObjectIteratorProxy end() const
     {
-        return CObjectIteratorProxy(m_map.end(), m_map.end());
+        return CObjectIteratorProxy(m_list, m_list.size());
     }
 
 private:
-    const CObjectMap& m_map;
+    const CObjectList& m_list;
     int& m_activeIteratorsCounter;
 };
 
@@ -160,6 +190,8 @@ public:
     CObject*  CreateObject(ObjectCreateParams params);
     CObject*  CreateObject(Math::Vector pos, float angle, ObjectType type, float power = -1.0f);
     //@}
+    //! Creates many objects cloned from one prototype, see CObjectFactory::CreateObjects()
+    std::vector<CObject*> CreateObjects(std::vector<ObjectCreateParams> params);
 
     //! Deletes the object
     bool      DeleteObject(CObject* instance);
@@ -172,8 +204,17 @@ public:
     //! Gets object by id in range <0; number of objects - 1>
     CObject*  GetObjectByRank(unsigned int id);
 
+    //! Returns handle which can be stored to refer to the object later
+    ObjectHandle GetObjectHandle(CObject* object);
+    //! Returns object referred to by the handle or nullptr if it was deleted
+    CObject*  GetObjectByHandle(ObjectHandle handle);
+
     //! Gets all objects of given team
     std::vector<CObject*> GetObjectsOfTeam(int team);
+    //! Gets all objects of given type
+    std::vector<CObject*> GetObjectsOfType(ObjectType type);
+    //! Gets all objects implementing given interface
+    std::vector<CObject*> GetObjectsImplementing(ObjectInterfaceType interface);
 
     //! Checks if any of team's objects exist
     bool TeamExists(int team);
@@ -185,13 +226,64 @@ public:
     //! Counts all objects implementing given interface
     int CountObjectsImplementing(ObjectInterfaceType interface);
 
+    //! Memory used by all objects of one type, see GetMemoryReport()
+    struct MemoryUsage
+    {
+        int count = 0;
+        std::size_t bytes = 0;
+    };
+    //! Returns approximate memory used by objects, grouped by type
+    std::map<ObjectType, MemoryUsage> GetMemoryReport();
+
     //! Returns all objects
     CObjectContainerProxy GetAllObjects()
     {
         CleanRemovedObjectsIfNeeded();
-        return CObjectContainerProxy(m_objects, m_activeObjectIterators);
+        return CObjectContainerProxy(m_objectList, m_activeObjectIterators);
     }
 
+    //! Updates spatial index after change of object's position
+    void UpdateObjectPosition(CObject* object);
+    //! Updates navigation grid and collision search radius after change of object's crash spheres, scale or transport state
+    void UpdateObjectShape(CObject* object);
+    //! Updates type, team and interface indexes after change of object's type or team
+    void UpdateObjectIndexes(CObject* object);
+    //! Returns a number which changes whenever an object is created, deleted or changes type or team
+    unsigned int GetIndexRevision();
+    //! Records change of object's energy, active state or power cell, see GetChangedObjects()
+    void UpdateObjectState(CObject* object);
+    //! Returns a number which changes whenever an object moves or changes its shape or state
+    unsigned int GetChangeRevision();
+    //! Gives objects which moved or changed since given GetChangeRevision(), returns false if they are not known anymore
+    /**
+     * Objects may repeat. Deleted objects are also given, callers have to check
+     * first that GetIndexRevision() is the same as when they read the revision.
+     */
+    bool GetChangedObjects(unsigned int revision, std::vector<CObject*>& objects);
+
+    //! Spatial queries, distances are measured on XZ plane and results are ordered by object id
+    //@{
+    //! Returns all objects not further than radius from center
+    std::vector<CObject*> GetObjectsInRadius(const Math::Vector& center, float radius);
+    //! Returns all objects in circular sector defined like in radar() (angle is CW, 0..2*PI)
+    std::vector<CObject*> GetObjectsInSector(const Math::Vector& center,
+                                             float angle,
+                                             float focus,
+                                             float minDist,
+                                             float maxDist);
+    //! Returns all objects inside the axis aligned box
+    std::vector<CObject*> GetObjectsInBox(const Math::Vector& min, const Math::Vector& max);
+    //! Returns objects whose crash spheres may be closer than radius to center (collision broadphase)
+    std::vector<CObject*> GetCollisionCandidates(const Math::Vector& center, float radius);
+    //@}
+
+    //! Returns objects whose crash spheres or camera collision sphere may overlap the axis aligned box
+    /** Results are candidates only, ordered by object id; objects which can move are always included */
+    std::vector<CObject*> GetObjectsNearBox(const Math::Vector& min, const Math::Vector& max);
+
+    //! Returns navigation grid shared by path finding
+    CNavigationGrid* GetNavigationGrid();
+
     //! Finds an object, like radar() in CBot
     //@{
     std::vector<CObject*> RadarAll(CObject* pThis,
@@ -278,6 +370,8 @@ public:
                     RadarFilter filter = FILTER_NONE,
                     bool cbotTypes = false);
     //@}
+    //! Forgets radar candidates, called at the end of each simulation tick
+    void      InvalidateRadarCache();
     //! Returns nearest object that's closer than maxDist
     //@{
     CObject*  FindNearest(CObject* pThis,
@@ -300,13 +394,89 @@ public:
                           bool cbotTypes = false);
     //@}
 
+protected:
+    //! Registers object which already has its id assigned
+    CObject* AddObject(std::unique_ptr<CObject> object);
+
 private:
     void CleanRemovedObjectsIfNeeded();
 
+    ObjectHandle AllocateSlot(std::unique_ptr<CObject> object);
+    void AssignId(ObjectCreateParams& params);
+    void FreeSlot(ObjectHandle handle);
+
+    void AddToIndexes(CObject* object);
+    void RemoveFromIndexes(CObject* object);
+    void AddChange(CObject* object);
+    //! Merges objects which can move into candidates from m_staticObjects
+    std::vector<CObject*> AddMovingObjects(std::vector<CObject*> objects);
+
+    const std::vector<CObject*>& GetRadarCandidates(const std::vector<ObjectType>& type, RadarFilter filter, bool cbotTypes);
+    static bool IsRadarCandidate(CObject* object, const std::vector<ObjectType>& type, RadarFilter filter, bool cbotTypes);
+
 private:
-    CObjectMap m_objects;
+    //! Type, team and interfaces under which object is currently indexed
+    struct IndexedObjectState
+    {
+        ObjectType type;
+        int team;
+        ObjectInterfaceTypes interfaces;
+    };
+
+    //! Objects radar() may find for given types and filters, whoever asks
+    struct RadarCacheEntry
+    {
+        std::vector<ObjectType> type;   //!< sorted
+        RadarFilter filter;             //!< without the filters relative to the caller
+        bool cbotTypes;
+        std::vector<CObject*> objects;  //!< ordered by id
+    };
+
+    //! Slot owning an object, see ObjectHandle
+    struct ObjectSlot
+    {
+        std::unique_ptr<CObject> object;
+        unsigned int generation = 0;
+        std::size_t listIndex = 0; //!< position in m_objectList
+    };
+
+    CObjectGrid m_grid;
+    //! Objects which are neither movable nor transportable, by their spheres
+    CObjectBVH m_staticObjects;
+    std::unique_ptr<CNavigationGrid> m_navigationGrid;
+    //! Slot map storage, slots are reused through m_freeSlots
+    //@{
+    std::vector<ObjectSlot> m_slots;
+    std::vector<unsigned int> m_freeSlots;
+    std::unordered_map<int, ObjectHandle> m_handlesById;
+    //@}
+    //! Dense list of objects ordered by id, used for iteration and lookup by rank
+    CObjectList m_objectList;
+    //! Secondary indexes, objects in each list are ordered by id
+    //@{
+    std::unordered_map<ObjectType, std::vector<CObject*>, ObjectTypeHash> m_objectsByType;
+    std::map<int, std::vector<CObject*>> m_objectsByTeam;
+    std::array<std::vector<CObject*>, static_cast<std::size_t>(ObjectInterfaceType::Max)> m_objectsByInterface;
+    std::unordered_map<CObject*, IndexedObjectState> m_indexedObjects;
+    unsigned int m_indexRevision;
+    //@}
+    //! Objects changed by the last revisions, see GetChangedObjects()
+    //@{
+    struct ChangedObject
+    {
+        unsigned int revision;
+        CObject* object;
+    };
+    std::deque<ChangedObject> m_changedObjects;
+    unsigned int m_changeRevision;
+    //! Revision after which all changes are in m_changedObjects
+    unsigned int m_changedObjectsRevision;
+    //@}
+    //! Radar candidates found during the current simulation tick
+    std::vector<RadarCacheEntry> m_radarCache;
     std::unique_ptr<CObjectFactory> m_objectFactory;
+    int m_removedObjectCount; //!< number of nullptr entries in m_objectList
+    float m_maxCrashSphereExtent;
     int m_nextId;
     int m_activeObjectIterators;
-    bool m_shouldCleanRemovedObjects;
 };
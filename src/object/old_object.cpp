@@ -65,6 +65,8 @@
 #include "ui/controls/edit.h"
 
 #include <boost/lexical_cast.hpp>
+#include <algorithm>
+#include <cassert>
 #include <iomanip>
 
 
@@ -84,7 +86,7 @@ COldObject::COldObject(int id)
       CPoweredObject(m_implementedInterfaces),
       CJetFlyingObject(m_implementedInterfaces),
       CControllableObject(m_implementedInterfaces),
-      CPowerContainerObjectImpl(m_implementedInterfaces),
+      CPowerContainerObjectImpl(m_implementedInterfaces, this),
       CRangedObject(m_implementedInterfaces),
       CTraceDrawingObject(m_implementedInterfaces),
       CShieldedAutoRegenObject(m_implementedInterfaces),
@@ -100,6 +102,28 @@ COldObject::COldObject(int id)
 
     m_implementedInterfaces[static_cast<int>(ObjectInterfaceType::Old)] = true;
 
+    // Interfaces can be switched on and off later, but the pointers stay the same
+    SetInterfacePointer<ObjectInterfaceType::Interactive>(this);
+    SetInterfacePointer<ObjectInterfaceType::Transportable>(this);
+    SetInterfacePointer<ObjectInterfaceType::ProgramStorage>(this);
+    SetInterfacePointer<ObjectInterfaceType::Programmable>(this);
+    SetInterfacePointer<ObjectInterfaceType::TaskExecutor>(this);
+    SetInterfacePointer<ObjectInterfaceType::Jostleable>(this);
+    SetInterfacePointer<ObjectInterfaceType::Carrier>(this);
+    SetInterfacePointer<ObjectInterfaceType::Powered>(this);
+    SetInterfacePointer<ObjectInterfaceType::Movable>(this);
+    SetInterfacePointer<ObjectInterfaceType::Flying>(this);
+    SetInterfacePointer<ObjectInterfaceType::JetFlying>(this);
+    SetInterfacePointer<ObjectInterfaceType::Controllable>(this);
+    SetInterfacePointer<ObjectInterfaceType::PowerContainer>(this);
+    SetInterfacePointer<ObjectInterfaceType::Ranged>(this);
+    SetInterfacePointer<ObjectInterfaceType::TraceDrawing>(this);
+    SetInterfacePointer<ObjectInterfaceType::Damageable>(this);
+    SetInterfacePointer<ObjectInterfaceType::Destroyable>(this);
+    SetInterfacePointer<ObjectInterfaceType::Shielded>(this);
+    SetInterfacePointer<ObjectInterfaceType::ShieldedAutoRegen>(this);
+    SetInterfacePointer<ObjectInterfaceType::Old>(this);
+
     m_sound       = CApplication::GetInstancePointer()->GetSound();
     m_engine      = Gfx::CEngine::GetInstancePointer();
     m_lightMan    = m_engine->GetLightManager();
@@ -152,10 +176,7 @@ COldObject::COldObject(int id)
     m_cameraType = Gfx::CAM_TYPE_BACK;
     m_bCameraLock = false;
 
-    for (int i=0 ; i<OBJECTMAXPART ; i++ )
-    {
-        m_objectPart[i].bUsed = false;
-    }
+    m_objectPart.resize(1);  // the main part is always present
     m_totalPart = 0;
 
     for (int i=0 ; i<4 ; i++ )
@@ -260,7 +281,7 @@ void COldObject::DeleteObject(bool bAll)
         m_auto->DeleteObject(bAll);
     }
 
-    for (int i=0 ; i<OBJECTMAXPART ; i++ )
+    for (int i=0 ; i<static_cast<int>(m_objectPart.size()) ; i++ )
     {
         if ( m_objectPart[i].bUsed )
         {
@@ -304,8 +325,8 @@ void COldObject::Simplify()
     }
     m_main->SaveOneScript(this);
 
-    m_implementedInterfaces[static_cast<int>(ObjectInterfaceType::ProgramStorage)] = false;
-    m_implementedInterfaces[static_cast<int>(ObjectInterfaceType::Programmable)] = false;
+    SetImplements(ObjectInterfaceType::ProgramStorage, false);
+    SetImplements(ObjectInterfaceType::Programmable, false);
 
     if ( m_physics != nullptr )
     {
@@ -317,7 +338,7 @@ void COldObject::Simplify()
         m_motion->DeleteObject();
         m_motion.reset();
     }
-    m_implementedInterfaces[static_cast<int>(ObjectInterfaceType::Movable)] = false;
+    SetImplements(ObjectInterfaceType::Movable, false);
 
     if ( m_objectInterface != nullptr )
     {
@@ -558,33 +579,35 @@ void COldObject::DestroyObject(DestructionType type)
 
 void COldObject::InitPart(int part)
 {
-    m_objectPart[part].bUsed      = true;
-    m_objectPart[part].object     = -1;
-    m_objectPart[part].parentPart = -1;
+    ObjectPart& objectPart = GetPart(part);
 
-    m_objectPart[part].position   = Math::Vector(0.0f, 0.0f, 0.0f);
-    m_objectPart[part].angle.y    = 0.0f;
-    m_objectPart[part].angle.x    = 0.0f;
-    m_objectPart[part].angle.z    = 0.0f;
-    m_objectPart[part].zoom       = Math::Vector(1.0f, 1.0f, 1.0f);
+    objectPart.bUsed      = true;
+    objectPart.object     = -1;
+    objectPart.parentPart = -1;
 
-    m_objectPart[part].bTranslate = true;
-    m_objectPart[part].bRotate    = true;
-    m_objectPart[part].bZoom      = false;
+    objectPart.position   = Math::Vector(0.0f, 0.0f, 0.0f);
+    objectPart.angle.y    = 0.0f;
+    objectPart.angle.x    = 0.0f;
+    objectPart.angle.z    = 0.0f;
+    objectPart.zoom       = Math::Vector(1.0f, 1.0f, 1.0f);
 
-    m_objectPart[part].matTranslate.LoadIdentity();
-    m_objectPart[part].matRotate.LoadIdentity();
-    m_objectPart[part].matTransform.LoadIdentity();
-    m_objectPart[part].matWorld.LoadIdentity();;
+    objectPart.bTranslate = true;
+    objectPart.bRotate    = true;
+    objectPart.bZoom      = false;
 
-    m_objectPart[part].masterParti = -1;
+    objectPart.matTranslate.LoadIdentity();
+    objectPart.matRotate.LoadIdentity();
+    objectPart.matTransform.LoadIdentity();
+    objectPart.matWorld.LoadIdentity();;
+
+    objectPart.masterParti = -1;
 }
 
 // Removes part.
 
 void COldObject::DeletePart(int part)
 {
-    if ( !m_objectPart[part].bUsed )  return;
+    if ( !ReadPart(part).bUsed )  return;
 
     if ( m_objectPart[part].masterParti != -1 )
     {
@@ -602,13 +625,42 @@ void COldObject::UpdateTotalPart()
     int     i;
 
     m_totalPart = 0;
-    for ( i=0 ; i<OBJECTMAXPART ; i++ )
+    for ( i=0 ; i<static_cast<int>(m_objectPart.size()) ; i++ )
     {
         if ( m_objectPart[i].bUsed )
         {
             m_totalPart = i+1;
         }
     }
+
+    // Drop unused parts at the end, but keep the main part
+    m_objectPart.resize(std::max(m_totalPart, 1));
+}
+
+// Returns a part for modification, allocating it if necessary.
+
+ObjectPart& COldObject::GetPart(int part)
+{
+    assert(part >= 0 && part < OBJECTMAXPART);
+
+    if ( part >= static_cast<int>(m_objectPart.size()) )
+    {
+        m_objectPart.resize(part+1);
+    }
+    return m_objectPart[part];
+}
+
+// Returns a part for reading. Parts not allocated are reported as unused.
+
+const ObjectPart& COldObject::ReadPart(int part) const
+{
+    static const ObjectPart unusedPart;
+
+    if ( part < 0 || part >= static_cast<int>(m_objectPart.size()) )
+    {
+        return unusedPart;
+    }
+    return m_objectPart[part];
 }
 
 
@@ -616,20 +668,22 @@ void COldObject::UpdateTotalPart()
 
 void COldObject::SetObjectRank(int part, int objRank)
 {
-    if ( !m_objectPart[part].bUsed )  // object not created?
+    ObjectPart& objectPart = GetPart(part);
+
+    if ( !objectPart.bUsed )  // object not created?
     {
         InitPart(part);
         UpdateTotalPart();
     }
-    m_objectPart[part].object = objRank;
+    objectPart.object = objRank;
 }
 
 // Returns the number of part.
 
 int COldObject::GetObjectRank(int part)
 {
-    if ( !m_objectPart[part].bUsed )  return -1;
-    return m_objectPart[part].object;
+    if ( !ReadPart(part).bUsed )  return -1;
+    return ReadPart(part).object;
 }
 
 // Specifies what is the parent of a part.
@@ -638,7 +692,7 @@ int COldObject::GetObjectRank(int part)
 
 void COldObject::SetObjectParent(int part, int parent)
 {
-    m_objectPart[part].parentPart = parent;
+    GetPart(part).parentPart = parent;
 }
 
 
@@ -909,6 +963,11 @@ void COldObject::SetType(ObjectType type)
     {
         m_cameraType = Gfx::CAM_TYPE_ONBOARD;
     }
+
+    if ( CObjectManager::IsCreated() )
+    {
+        CObjectManager::GetInstancePointer()->UpdateObjectIndexes(this);
+    }
 }
 
 const char* COldObject::GetName()
@@ -1163,6 +1222,15 @@ int COldObject::SearchDescendant(int parent, int n)
     return -1;
 }
 
+void COldObject::UpdatePendingTransform()
+{
+    if (m_objectPart[0].bTranslate ||
+        m_objectPart[0].bRotate)
+    {
+        UpdateTransformObject();
+    }
+}
+
 void COldObject::TransformCrashSphere(Math::Sphere& crashSphere)
 {
     crashSphere.radius *= GetScaleX();
@@ -1201,7 +1269,7 @@ void COldObject::TransformCameraCollisionSphere(Math::Sphere& collisionSphere)
 void COldObject::SetJostlingSphere(const Math::Sphere& jostlingSphere)
 {
     m_jostlingSphere = jostlingSphere;
-    m_implementedInterfaces[static_cast<int>(ObjectInterfaceType::Jostleable)] = true;
+    SetImplements(ObjectInterfaceType::Jostleable, true);
 }
 
 // Specifies the sphere of jostling, in the world.
@@ -1311,8 +1379,15 @@ Math::Vector COldObject::GetTilt()
 
 void COldObject::SetPartPosition(int part, const Math::Vector &pos)
 {
-    m_objectPart[part].position = pos;
-    m_objectPart[part].bTranslate = true;  // it will recalculate the matrices
+    ObjectPart& objectPart = GetPart(part);
+
+    objectPart.position = pos;
+    objectPart.bTranslate = true;  // it will recalculate the matrices
+
+    if ( part == 0 && CObjectManager::IsCreated() )
+    {
+        CObjectManager::GetInstancePointer()->UpdateObjectPosition(this);
+    }
 
     if ( part == 0 && !m_bFlat )  // main part?
     {
@@ -1342,15 +1417,17 @@ void COldObject::SetPartPosition(int part, const Math::Vector &pos)
 
 Math::Vector COldObject::GetPartPosition(int part) const
 {
-    return m_objectPart[part].position;
+    return ReadPart(part).position;
 }
 
 // Getes the rotation around three axis.
 
 void COldObject::SetPartRotation(int part, const Math::Vector &angle)
 {
-    m_objectPart[part].angle = angle;
-    m_objectPart[part].bRotate = true;  // it will recalculate the matrices
+    ObjectPart& objectPart = GetPart(part);
+
+    objectPart.angle = angle;
+    objectPart.bRotate = true;  // it will recalculate the matrices
 
     if ( part == 0 && !m_bFlat )  // main part?
     {
@@ -1360,15 +1437,17 @@ void COldObject::SetPartRotation(int part, const Math::Vector &angle)
 
 Math::Vector COldObject::GetPartRotation(int part) const
 {
-    return m_objectPart[part].angle;
+    return ReadPart(part).angle;
 }
 
 // Getes the rotation about the axis Y.
 
 void COldObject::SetPartRotationY(int part, float angle)
 {
-    m_objectPart[part].angle.y = angle;
-    m_objectPart[part].bRotate = true;  // it will recalculate the matrices
+    ObjectPart& objectPart = GetPart(part);
+
+    objectPart.angle.y = angle;
+    objectPart.bRotate = true;  // it will recalculate the matrices
 
     if ( part == 0 && !m_bFlat )  // main part?
     {
@@ -1380,31 +1459,35 @@ void COldObject::SetPartRotationY(int part, float angle)
 
 void COldObject::SetPartRotationX(int part, float angle)
 {
-    m_objectPart[part].angle.x = angle;
-    m_objectPart[part].bRotate = true;  // it will recalculate the matrices
+    ObjectPart& objectPart = GetPart(part);
+
+    objectPart.angle.x = angle;
+    objectPart.bRotate = true;  // it will recalculate the matrices
 }
 
 // Getes the rotation about the axis Z.
 
 void COldObject::SetPartRotationZ(int part, float angle)
 {
-    m_objectPart[part].angle.z = angle;
-    m_objectPart[part].bRotate = true;  //it will recalculate the matrices
+    ObjectPart& objectPart = GetPart(part);
+
+    objectPart.angle.z = angle;
+    objectPart.bRotate = true;  //it will recalculate the matrices
 }
 
 float COldObject::GetPartRotationY(int part)
 {
-    return m_objectPart[part].angle.y;
+    return ReadPart(part).angle.y;
 }
 
 float COldObject::GetPartRotationX(int part)
 {
-    return m_objectPart[part].angle.x;
+    return ReadPart(part).angle.x;
 }
 
 float COldObject::GetPartRotationZ(int part)
 {
-    return m_objectPart[part].angle.z;
+    return ReadPart(part).angle.z;
 }
 
 
@@ -1412,74 +1495,84 @@ float COldObject::GetPartRotationZ(int part)
 
 void COldObject::SetPartScale(int part, float zoom)
 {
-    m_objectPart[part].bTranslate = true;  // it will recalculate the matrices
-    m_objectPart[part].zoom.x = zoom;
-    m_objectPart[part].zoom.y = zoom;
-    m_objectPart[part].zoom.z = zoom;
+    ObjectPart& objectPart = GetPart(part);
 
-    m_objectPart[part].bZoom = ( m_objectPart[part].zoom.x != 1.0f ||
-                                 m_objectPart[part].zoom.y != 1.0f ||
-                                 m_objectPart[part].zoom.z != 1.0f );
+    objectPart.bTranslate = true;  // it will recalculate the matrices
+    objectPart.zoom.x = zoom;
+    objectPart.zoom.y = zoom;
+    objectPart.zoom.z = zoom;
+
+    objectPart.bZoom = ( objectPart.zoom.x != 1.0f ||
+                         objectPart.zoom.y != 1.0f ||
+                         objectPart.zoom.z != 1.0f );
 }
 
 void COldObject::SetPartScale(int part, Math::Vector zoom)
 {
-    m_objectPart[part].bTranslate = true;  // it will recalculate the matrices
-    m_objectPart[part].zoom = zoom;
+    ObjectPart& objectPart = GetPart(part);
+
+    objectPart.bTranslate = true;  // it will recalculate the matrices
+    objectPart.zoom = zoom;
 
-    m_objectPart[part].bZoom = ( m_objectPart[part].zoom.x != 1.0f ||
-                                 m_objectPart[part].zoom.y != 1.0f ||
-                                 m_objectPart[part].zoom.z != 1.0f );
+    objectPart.bZoom = ( objectPart.zoom.x != 1.0f ||
+                         objectPart.zoom.y != 1.0f ||
+                         objectPart.zoom.z != 1.0f );
 }
 
 Math::Vector COldObject::GetPartScale(int part) const
 {
-    return m_objectPart[part].zoom;
+    return ReadPart(part).zoom;
 }
 
 void COldObject::SetPartScaleX(int part, float zoom)
 {
-    m_objectPart[part].bTranslate = true;  // it will recalculate the matrices
-    m_objectPart[part].zoom.x = zoom;
+    ObjectPart& objectPart = GetPart(part);
 
-    m_objectPart[part].bZoom = ( m_objectPart[part].zoom.x != 1.0f ||
-                                 m_objectPart[part].zoom.y != 1.0f ||
-                                 m_objectPart[part].zoom.z != 1.0f );
+    objectPart.bTranslate = true;  // it will recalculate the matrices
+    objectPart.zoom.x = zoom;
+
+    objectPart.bZoom = ( objectPart.zoom.x != 1.0f ||
+                         objectPart.zoom.y != 1.0f ||
+                         objectPart.zoom.z != 1.0f );
 }
 
 void COldObject::SetPartScaleY(int part, float zoom)
 {
-    m_objectPart[part].bTranslate = true;  // it will recalculate the matrices
-    m_objectPart[part].zoom.y = zoom;
+    ObjectPart& objectPart = GetPart(part);
+
+    objectPart.bTranslate = true;  // it will recalculate the matrices
+    objectPart.zoom.y = zoom;
 
-    m_objectPart[part].bZoom = ( m_objectPart[part].zoom.x != 1.0f ||
-                                 m_objectPart[part].zoom.y != 1.0f ||
-                                 m_objectPart[part].zoom.z != 1.0f );
+    objectPart.bZoom = ( objectPart.zoom.x != 1.0f ||
+                         objectPart.zoom.y != 1.0f ||
+                         objectPart.zoom.z != 1.0f );
 }
 
 void COldObject::SetPartScaleZ(int part, float zoom)
 {
-    m_objectPart[part].bTranslate = true;  // it will recalculate the matrices
-    m_objectPart[part].zoom.z = zoom;
+    ObjectPart& objectPart = GetPart(part);
 
-    m_objectPart[part].bZoom = ( m_objectPart[part].zoom.x != 1.0f ||
-                                 m_objectPart[part].zoom.y != 1.0f ||
-                                 m_objectPart[part].zoom.z != 1.0f );
+    objectPart.bTranslate = true;  // it will recalculate the matrices
+    objectPart.zoom.z = zoom;
+
+    objectPart.bZoom = ( objectPart.zoom.x != 1.0f ||
+                         objectPart.zoom.y != 1.0f ||
+                         objectPart.zoom.z != 1.0f );
 }
 
 float COldObject::GetPartScaleX(int part)
 {
-    return m_objectPart[part].zoom.x;
+    return ReadPart(part).zoom.x;
 }
 
 float COldObject::GetPartScaleY(int part)
 {
-    return m_objectPart[part].zoom.y;
+    return ReadPart(part).zoom.y;
 }
 
 float COldObject::GetPartScaleZ(int part)
 {
-    return m_objectPart[part].zoom.z;
+    return ReadPart(part).zoom.z;
 }
 
 void COldObject::SetTrainer(bool bEnable)
@@ -1521,7 +1614,7 @@ bool COldObject::GetManual()
 
 void COldObject::SetMasterParticle(int part, int parti)
 {
-    m_objectPart[part].masterParti = parti;
+    GetPart(part).masterParti = parti;
 }
 
 
@@ -1530,6 +1623,11 @@ void COldObject::SetMasterParticle(int part, int parti)
 void COldObject::SetPower(CObject* power)
 {
     m_power = power;
+
+    if ( CObjectManager::IsCreated() )
+    {
+        CObjectManager::GetInstancePointer()->UpdateObjectState(this);
+    }
 }
 
 CObject* COldObject::GetPower()
@@ -1553,6 +1651,11 @@ Math::Vector COldObject::GetPowerPosition()
 void COldObject::SetCargo(CObject* cargo)
 {
     m_cargo = cargo;
+
+    if ( CObjectManager::IsCreated() )
+    {
+        CObjectManager::GetInstancePointer()->UpdateObjectState(this);
+    }
 }
 
 CObject* COldObject::GetCargo()
@@ -1568,6 +1671,12 @@ void COldObject::SetTransporter(CObject* transporter)
 
     // Invisible shadow if the object is transported.
     m_engine->SetObjectShadowSpotHide(m_objectPart[0].object, (m_transporter != nullptr));
+
+    // Transported objects are not obstacles
+    if ( CObjectManager::IsCreated() )
+    {
+        CObjectManager::GetInstancePointer()->UpdateObjectShape(this);
+    }
 }
 
 CObject* COldObject::GetTransporter()
@@ -1587,7 +1696,7 @@ void COldObject::SetTransporterPart(int part)
 
 Math::Matrix* COldObject::GetRotateMatrix(int part)
 {
-    return &m_objectPart[part].matRotate;
+    return &GetPart(part).matRotate;
 }
 
 Math::Matrix* COldObject::GetWorldMatrix(int part)
@@ -1598,7 +1707,7 @@ Math::Matrix* COldObject::GetWorldMatrix(int part)
         UpdateTransformObject();
     }
 
-    return &m_objectPart[part].matWorld;
+    return &GetPart(part).matWorld;
 }
 
 
@@ -1608,7 +1717,7 @@ void COldObject::SetDrawFront(bool bDraw)
 {
     int     i;
 
-    for ( i=0 ; i<OBJECTMAXPART ; i++ )
+    for ( i=0 ; i<static_cast<int>(m_objectPart.size()) ; i++ )
     {
         if ( m_objectPart[i].bUsed )
         {
@@ -1773,6 +1882,8 @@ bool COldObject::UpdateTransformObject(int part, bool bForceUpdate)
     {
         m_engine->SetObjectTransform(m_objectPart[part].object,
                                      m_objectPart[part].matWorld);
+
+        if ( part == 0 )  InvalidateCrashSpheres();
     }
 
     m_objectPart[part].bTranslate = false;
@@ -1869,6 +1980,7 @@ void COldObject::FlatParent()
     }
 
     m_bFlat = true;
+    InvalidateCrashSpheres();
 }
 
 
@@ -2068,7 +2180,7 @@ bool COldObject::EventProcess(const Event &event)
     {
         if (!GetLock())
         {
-            m_auto->EventProcess(event);
+            m_auto->DispatchEvent(event);
         }
 
         if ( event.type == EVENT_FRAME &&
@@ -2178,7 +2290,7 @@ void COldObject::PartiFrame(float rTime)
     Math::Vector    pos, angle, factor;
     int         i, channel;
 
-    for ( i=0 ; i<OBJECTMAXPART ; i++ )
+    for ( i=0 ; i<static_cast<int>(m_objectPart.size()) ; i++ )
     {
         if ( !m_objectPart[i].bUsed )  continue;
 
@@ -2314,8 +2426,8 @@ void COldObject::AdjustCamera(Math::Vector &eye, float &dirH, float &dirV,
     lookat.y = eye.y+0.0f;
     lookat.z = eye.z+0.0f;
 
-    eye    = Math::Transform(m_objectPart[part].matWorld, eye);
-    lookat = Math::Transform(m_objectPart[part].matWorld, lookat);
+    eye    = Math::Transform(ReadPart(part).matWorld, eye);
+    lookat = Math::Transform(ReadPart(part).matWorld, lookat);
 
     // Camera tilts when turning.
     upVec = Math::Vector(0.0f, 1.0f, 0.0f);
@@ -2340,7 +2452,7 @@ void COldObject::AdjustCamera(Math::Vector &eye, float &dirH, float &dirV,
     }
     upVec = Math::Transform(m_objectPart[0].matRotate, upVec);
 
-    dirH = -(m_objectPart[part].angle.y+Math::PI/2.0f);
+    dirH = -(ReadPart(part).angle.y+Math::PI/2.0f);
     dirV = 0.0f;
 
 }
@@ -2638,6 +2750,11 @@ void COldObject::SetDying(DeathType deathType)
     m_dying = deathType;
     m_burnTime = 0.0f;
 
+    if ( CObjectManager::IsCreated() )
+    {
+        CObjectManager::GetInstancePointer()->UpdateObjectState(this);
+    }
+
     if ( IsDying() && Implements(ObjectInterfaceType::Programmable) )
     {
         StopProgram();  // stops the current task
@@ -2664,6 +2781,14 @@ bool COldObject::GetDetectable()
     return GetActive() && !m_underground;
 }
 
+// Returns the memory used by the object and its parts.
+
+std::size_t COldObject::GetMemoryUsage() const
+{
+    return CObject::GetMemoryUsage() + (sizeof(COldObject) - sizeof(CObject)) +
+           m_objectPart.capacity() * sizeof(ObjectPart);
+}
+
 
 // Management of the point of aim.
 
@@ -2988,8 +3113,8 @@ CMotion* COldObject::GetMotion()
 // TODO: Temporary hack until we'll have subclasses for objects
 void COldObject::SetProgrammable()
 {
-    m_implementedInterfaces[static_cast<int>(ObjectInterfaceType::ProgramStorage)] = true;
-    m_implementedInterfaces[static_cast<int>(ObjectInterfaceType::Programmable)] = true;
+    SetImplements(ObjectInterfaceType::ProgramStorage, true);
+    SetImplements(ObjectInterfaceType::Programmable, true);
 }
 
 // TODO: Another hack
@@ -2997,7 +3122,7 @@ void COldObject::SetMovable(std::unique_ptr<CMotion> motion, std::unique_ptr<CPh
 {
     m_motion = std::move(motion);
     m_physics = std::move(physics);
-    m_implementedInterfaces[static_cast<int>(ObjectInterfaceType::Movable)] = true;
+    SetImplements(ObjectInterfaceType::Movable, true);
 }
 
 // Returns the controller associated to the object.
@@ -244,6 +244,8 @@ public:
     bool        GetActive() override;
     bool        GetDetectable() override;
 
+    std::size_t GetMemoryUsage() const override;
+
     void        SetGunGoalV(float gunGoal);
     void        SetGunGoalH(float gunGoal);
     float       GetGunGoalV();
@@ -293,12 +295,15 @@ protected:
     void        VirusFrame(float rTime);
     void        PartiFrame(float rTime);
     void        InitPart(int part);
+    ObjectPart& GetPart(int part);
+    const ObjectPart& ReadPart(int part) const;
     void        UpdateTotalPart();
     int         SearchDescendant(int parent, int n);
     void        UpdateEnergyMapping();
     bool        UpdateTransformObject(int part, bool bForceUpdate);
     bool        UpdateTransformObject();
     void        UpdateSelectParticle();
+    void        UpdatePendingTransform() override;
     void        TransformCrashSphere(Math::Sphere &crashSphere) override;
     void TransformCameraCollisionSphere(Math::Sphere& collisionSphere) override;
 
@@ -356,7 +361,8 @@ protected:
     float       m_shieldRadius;
 
     int         m_totalPart;
-    ObjectPart  m_objectPart[OBJECTMAXPART];
+    //! Parts are only allocated up to the highest one used, most objects have a single part
+    std::vector<ObjectPart> m_objectPart;
 
     int         m_partiSel[4];
 
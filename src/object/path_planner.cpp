@@ -0,0 +1,315 @@
+/*
+ * This file is part of the Colobot: Gold Edition source code
+ * Copyright (C) 2001-2016, Daniel Roux, EPSITEC SA & TerranovaTeam
+ * http://epsitec.ch; http://colobot.info; http://github.com/colobot
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://gnu.org/licenses
+ */
+
+#include "object/path_planner.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+
+
+namespace
+{
+
+//! Length of a move over dx:dy cells in straight and diagonal steps
+float OctileDistance(int dx, int dy)
+{
+    dx = abs(dx);
+    dy = abs(dy);
+    return static_cast<float>(std::max(dx, dy)) + (sqrtf(2.0f)-1.0f)*std::min(dx, dy);
+}
+
+} // anonymous namespace
+
+
+CPathPlanner::CPathPlanner(std::shared_ptr<const PathMap> map,
+                           Math::IntPoint start, Math::IntPoint goal, float goalRadius)
+    : m_map(std::move(map)),
+      m_goal(goal),
+      m_goalRadius(goalRadius),
+      m_status(PathStatus::Searching),
+      m_expanded(0)
+{
+    assert(m_map != nullptr);
+
+    start.x = std::max(m_map->minX, std::min(start.x, m_map->minX+m_map->width-1));
+    start.y = std::max(m_map->minY, std::min(start.y, m_map->minY+m_map->height-1));
+    Push(start.x, start.y, -1, 0.0f);
+}
+
+PathStatus CPathPlanner::Run(int maxNodes)
+{
+    int expanded = 0;
+    while ( m_status == PathStatus::Searching )
+    {
+        if ( m_open.empty() )
+        {
+            m_status = PathStatus::Impossible;
+            break;
+        }
+
+        std::pop_heap(m_open.begin(), m_open.end(), OpenGreater);
+        Open open = m_open.back();
+        m_open.pop_back();
+
+        Node& node = m_nodes[open.index];
+        if ( node.closed )  continue;  // already reached by a shorter path
+        node.closed = true;
+
+        int x = m_map->minX + open.index%m_map->width;
+        int y = m_map->minY + open.index/m_map->width;
+        if ( IsGoal(x, y) )
+        {
+            MakePath(open.index);
+            m_status = PathStatus::Found;
+            break;
+        }
+
+        Expand(open.index);
+        m_expanded ++;
+
+        expanded ++;
+        if ( maxNodes > 0 && expanded >= maxNodes )  break;
+    }
+    return m_status;
+}
+
+PathStatus CPathPlanner::GetStatus() const
+{
+    return m_status;
+}
+
+int CPathPlanner::GetExpandedCount() const
+{
+    return m_expanded;
+}
+
+const std::vector<Math::IntPoint>& CPathPlanner::GetPath() const
+{
+    return m_path;
+}
+
+std::vector<Math::IntPoint> CPathPlanner::GetExpandedCells() const
+{
+    std::vector<Math::IntPoint> cells;
+    for ( const auto& node : m_nodes )
+    {
+        if ( !node.second.closed )  continue;
+        cells.push_back(Math::IntPoint(m_map->minX + node.first%m_map->width,
+                                       m_map->minY + node.first/m_map->width));
+    }
+    return cells;
+}
+
+// Orders the open list, the best node comes first.
+// Ties are broken by the index, so the result doesn't depend on the heap.
+
+bool CPathPlanner::OpenGreater(const Open& a, const Open& b)
+{
+    if ( a.f != b.f )  return a.f > b.f;
+    if ( a.h != b.h )  return a.h > b.h;
+    return a.index > b.index;
+}
+
+int CPathPlanner::GetIndex(int x, int y) const
+{
+    return (y-m_map->minY)*m_map->width + (x-m_map->minX);
+}
+
+bool CPathPlanner::IsFree(int x, int y) const
+{
+    return m_map->IsFree(x, y);
+}
+
+bool CPathPlanner::IsGoal(int x, int y) const
+{
+    return Math::IntPoint(x-m_goal.x, y-m_goal.y).Length() <= m_goalRadius;
+}
+
+// Estimates the length of the path from a cell to the goal.
+
+float CPathPlanner::Heuristic(int x, int y) const
+{
+    return std::max(OctileDistance(x-m_goal.x, y-m_goal.y)-m_goalRadius, 0.0f);
+}
+
+// Looks for the jump points reachable from a closed node.
+// Neighbours are pruned according to the direction we came from.
+
+void CPathPlanner::Expand(int index)
+{
+    int x = m_map->minX + index%m_map->width;
+    int y = m_map->minY + index/m_map->width;
+    float g = m_nodes[index].g;
+    int parent = m_nodes[index].parent;
+
+    int dirs[8][2];
+    int nbDirs = 0;
+    auto addDir = [&](int dx, int dy)
+    {
+        dirs[nbDirs][0] = dx;
+        dirs[nbDirs][1] = dy;
+        nbDirs ++;
+    };
+
+    if ( parent == -1 )  // start?
+    {
+        for ( int dy=-1 ; dy<=1 ; dy++ )
+        {
+            for ( int dx=-1 ; dx<=1 ; dx++ )
+            {
+                if ( dx == 0 && dy == 0 )  continue;
+                if ( dx != 0 && dy != 0 &&
+                     (!IsFree(x+dx, y) || !IsFree(x, y+dy)) )  continue;
+                addDir(dx, dy);
+            }
+        }
+    }
+    else
+    {
+        int px = m_map->minX + parent%m_map->width;
+        int py = m_map->minY + parent/m_map->width;
+        int dx = (x > px) - (x < px);
+        int dy = (y > py) - (y < py);
+
+        if ( dx != 0 && dy != 0 )  // diagonal move?
+        {
+            bool freeX = IsFree(x+dx, y);
+            bool freeY = IsFree(x, y+dy);
+            if ( freeY )  addDir(0, dy);
+            if ( freeX )  addDir(dx, 0);
+            if ( freeX && freeY )  addDir(dx, dy);
+        }
+        else if ( dx != 0 )  // horizontal move?
+        {
+            bool freeNext = IsFree(x+dx, y);
+            bool freeUp   = IsFree(x, y+1);
+            bool freeDown = IsFree(x, y-1);
+            if ( freeNext )
+            {
+                addDir(dx, 0);
+                if ( freeUp   )  addDir(dx,  1);
+                if ( freeDown )  addDir(dx, -1);
+            }
+            if ( freeUp   )  addDir(0,  1);
+            if ( freeDown )  addDir(0, -1);
+        }
+        else    // vertical move
+        {
+            bool freeNext  = IsFree(x, y+dy);
+            bool freeRight = IsFree(x+1, y);
+            bool freeLeft  = IsFree(x-1, y);
+            if ( freeNext )
+            {
+                addDir(0, dy);
+                if ( freeRight )  addDir( 1, dy);
+                if ( freeLeft  )  addDir(-1, dy);
+            }
+            if ( freeRight )  addDir( 1, 0);
+            if ( freeLeft  )  addDir(-1, 0);
+        }
+    }
+
+    for ( int i=0 ; i<nbDirs ; i++ )
+    {
+        int jx, jy;
+        if ( !Jump(x+dirs[i][0], y+dirs[i][1], dirs[i][0], dirs[i][1], jx, jy) )  continue;
+        Push(jx, jy, index, g+OctileDistance(jx-x, jy-y));
+    }
+}
+
+// Adds a node to the open list, if the path to it is shorter than the known one.
+
+void CPathPlanner::Push(int x, int y, int parent, float g)
+{
+    int index = GetIndex(x, y);
+
+    auto it = m_nodes.find(index);
+    if ( it != m_nodes.end() )
+    {
+        if ( it->second.closed || it->second.g <= g )  return;
+    }
+
+    Node& node = m_nodes[index];
+    node.g = g;
+    node.parent = parent;
+    node.closed = false;
+
+    Open open;
+    open.h = Heuristic(x, y);
+    open.f = g+open.h;
+    open.index = index;
+    m_open.push_back(open);
+    std::push_heap(m_open.begin(), m_open.end(), OpenGreater);
+}
+
+// Goes from x:y in direction dx:dy until it finds a jump point,
+// that is the goal or a cell where the shortest paths can turn.
+
+bool CPathPlanner::Jump(int x, int y, int dx, int dy, int& jx, int& jy) const
+{
+    while ( true )
+    {
+        if ( !IsFree(x, y) )  return false;
+
+        bool bJump = IsGoal(x, y);
+
+        if ( !bJump && dx != 0 && dy != 0 )  // diagonal?
+        {
+            int tx, ty;
+            bJump = Jump(x+dx, y, dx, 0, tx, ty) ||
+                    Jump(x, y+dy, 0, dy, tx, ty);
+        }
+        else if ( !bJump && dx != 0 )  // horizontal?
+        {
+            bJump = (IsFree(x, y-1) && !IsFree(x-dx, y-1)) ||
+                    (IsFree(x, y+1) && !IsFree(x-dx, y+1));
+        }
+        else if ( !bJump )  // vertical?
+        {
+            bJump = (IsFree(x-1, y) && !IsFree(x-1, y-dy)) ||
+                    (IsFree(x+1, y) && !IsFree(x+1, y-dy));
+        }
+
+        if ( bJump )
+        {
+            jx = x;
+            jy = y;
+            return true;
+        }
+
+        if ( !IsFree(x+dx, y) || !IsFree(x, y+dy) )  return false;
+        x += dx;
+        y += dy;
+    }
+}
+
+// Makes the list of jump points from the start to the given node.
+
+void CPathPlanner::MakePath(int index)
+{
+    m_path.clear();
+    for ( int i=index ; i!=-1 ; i=m_nodes[i].parent )
+    {
+        m_path.push_back(Math::IntPoint(m_map->minX + i%m_map->width,
+                                        m_map->minY + i/m_map->width));
+    }
+    std::reverse(m_path.begin(), m_path.end());
+}
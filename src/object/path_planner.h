@@ -0,0 +1,131 @@
+/*
+ * This file is part of the Colobot: Gold Edition source code
+ * Copyright (C) 2001-2016, Daniel Roux, EPSITEC SA & TerranovaTeam
+ * http://epsitec.ch; http://colobot.info; http://github.com/colobot
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://gnu.org/licenses
+ */
+
+/**
+ * \file object/path_planner.h
+ * \brief Grid path search used by goto()
+ */
+
+#pragma once
+
+#include "math/intpoint.h"
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * \struct PathMap
+ * \brief Obstacles in a rectangle of the navigation grid, frozen at some moment
+ *
+ * The map is never changed once a search uses it, so it can be read
+ * by a worker thread while the world goes on.
+ */
+struct PathMap
+{
+    //! First cell of the rectangle
+    int     minX = 0, minY = 0;
+    //! Size of the rectangle (in cells)
+    int     width = 0, height = 0;
+    //! One byte per cell, row by row, non zero if the cell is blocked
+    std::vector<unsigned char> blocked;
+
+    //! Tests if a cell can be crossed; cells outside the rectangle are blocked
+    bool    IsFree(int x, int y) const
+    {
+        x -= minX;
+        y -= minY;
+        if ( x < 0 || x >= width || y < 0 || y >= height )  return false;
+        return blocked[y*width + x] == 0;
+    }
+};
+
+enum class PathStatus
+{
+    Searching,
+    Found,
+    Impossible,
+};
+
+/**
+ * \class CPathPlanner
+ * \brief A* with jump point search over a PathMap
+ *
+ * Moves go in 8 directions; diagonal moves are possible only if both adjacent
+ * cells are free, so robots never cut corners of obstacles. Ties in the open list
+ * are broken by cell coordinates, so the result depends only on the map.
+ *
+ * The search can be run in several steps with Run(). A planner may be used
+ * by one thread at a time.
+ */
+class CPathPlanner
+{
+public:
+    //! Prepares a search from start to any cell closer than goalRadius (in cells) to goal
+    CPathPlanner(std::shared_ptr<const PathMap> map,
+                 Math::IntPoint start, Math::IntPoint goal, float goalRadius);
+
+    //! Continues the search, expanding at most maxNodes nodes (no limit if <= 0)
+    PathStatus  Run(int maxNodes = 0);
+
+    //! Returns the state of the search
+    PathStatus  GetStatus() const;
+    //! Returns the number of nodes expanded so far
+    int         GetExpandedCount() const;
+    //! Returns the jump points from the start to the goal, once the path is found
+    const std::vector<Math::IntPoint>& GetPath() const;
+    //! Returns all cells expanded so far
+    std::vector<Math::IntPoint> GetExpandedCells() const;
+
+protected:
+    struct Node
+    {
+        float   g;          //!< length of the best known path from the start (in cells)
+        int     parent;     //!< index of the previous jump point, -1 for the start
+        bool    closed;
+    };
+
+    struct Open
+    {
+        float   f;          //!< g + heuristic
+        float   h;
+        int     index;
+    };
+
+    static bool OpenGreater(const Open& a, const Open& b);
+
+    int         GetIndex(int x, int y) const;
+    bool        IsFree(int x, int y) const;
+    bool        IsGoal(int x, int y) const;
+    float       Heuristic(int x, int y) const;
+    void        Expand(int index);
+    void        Push(int x, int y, int parent, float g);
+    bool        Jump(int x, int y, int dx, int dy, int& jx, int& jy) const;
+    void        MakePath(int index);
+
+protected:
+    std::shared_ptr<const PathMap> m_map;
+    Math::IntPoint  m_goal;
+    float           m_goalRadius;
+    PathStatus      m_status;
+    int             m_expanded;
+    std::unordered_map<int, Node> m_nodes;
+    std::vector<Open> m_open;
+    std::vector<Math::IntPoint> m_path;
+};
@@ -110,6 +110,11 @@ void CStaticObject::SetTransparency(float value)
     m_engine->SetStaticMeshTransparency(m_meshHandle, value);
 }
 
+std::size_t CStaticObject::GetMemoryUsage() const
+{
+    return CObject::GetMemoryUsage() + (sizeof(CStaticObject) - sizeof(CObject));
+}
+
 bool CStaticObject::IsStaticObject(ObjectType type)
 {
     return m_staticModelNames.count(type) > 0;
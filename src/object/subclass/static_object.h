@@ -53,6 +53,8 @@ public:
 
     void SetTransparency(float value) override;
 
+    std::size_t GetMemoryUsage() const override;
+
 public:
     static bool IsStaticObject(ObjectType type);
 
@@ -20,18 +20,29 @@
 
 #include "object/task/taskgoto.h"
 
+#include "app/app.h"
+#include "app/system.h"
+
 #include "common/event.h"
 #include "common/global.h"
 #include "common/image.h"
+#include "common/logger.h"
 #include "common/make_unique.h"
+#include "common/thread/job_system.h"
+#include "common/thread/sdl_cond_wrapper.h"
+#include "common/thread/sdl_mutex_wrapper.h"
 
 #include "graphics/engine/terrain.h"
 #include "graphics/engine/water.h"
 
+#include "level/robotmain.h"
+
 #include "math/geometry.h"
 
+#include "object/flow_field.h"
 #include "object/object_manager.h"
 #include "object/old_object.h"
+#include "object/path_planner.h"
 
 #include "object/interface/transportable_object.h"
 
@@ -39,15 +50,23 @@
 
 #include "physics/physics.h"
 
+#include <algorithm>
+#include <cstdlib>
 #include <string.h>
+#include <vector>
+
+#include <SDL_timer.h>
 
 
 const float FLY_DIST_GROUND = 80.0f;    // minimum distance to remain on the ground
 const float FLY_DEF_HEIGHT  = 50.0f;    // default flying height
 
 // Settings that define goto() accuracy:
-const float BM_DIM_STEP     = 5.0f;     // Size of one pixel on the bitmap. Setting 5 means that 5x5 square (in game units) will be represented by 1 px on the bitmap. Decreasing this value will make a bigger bitmap, and may increase accuracy. TODO: Check how it actually impacts goto() accuracy
-const float BEAM_ACCURACY   = 5.0f;    // higher value = more accurate, but slower
+const float BM_DIM_STEP     = NAVIGATION_CELL_SIZE;     // Size of one pixel on the bitmap (the cell of CNavigationGrid). Setting 5 means that 5x5 square (in game units) will be represented by 1 px on the bitmap. Decreasing this value will make a bigger bitmap, and may increase accuracy. TODO: Check how it actually impacts goto() accuracy
+const int   PATH_NODES_PER_FRAME = 200;  // nodes expanded per frame on this thread when the time budget is off (recorded games)
+const int   PATH_NODES_PER_STEP = 32;   // nodes expanded by a worker thread between two checks for cancellation
+const int   PATH_RESULT_FRAME = 5;      // frame of the search in which its result is taken, whatever the machine
+const int   PATH_MAP_MARGIN = 40;       // smallest margin around start and goal copied for the search (in cells)
 const float SAFETY_MARGIN   = 0.5f;     // Smallest distance between two objects. Smaller = less "no route to destination", but higher probability of collisions between objects.
 // Changing SAFETY_MARGIN (old value was 4.0f) seems to have fixed many issues with goto(). TODO: maybe we could make it even smaller? Did changing it introduce any new bugs?
 
@@ -59,6 +78,10 @@ const float SAFETY_MARGIN   = 0.5f;     // Smallest distance between two objects
 CTaskGoto::CTaskGoto(COldObject* object) : CForegroundTask(object)
 {
     m_bmArray = nullptr;
+
+    CSystemUtils* systemUtils = CApplication::GetInstancePointer()->GetSystemUtils();
+    m_pathTimeBegin = systemUtils->CreateTimeStamp();
+    m_pathTimeEnd = systemUtils->CreateTimeStamp();
 }
 
 // Object's destructor.
@@ -67,6 +90,10 @@ CTaskGoto::~CTaskGoto()
 {
     BitmapClose();
 
+    CSystemUtils* systemUtils = CApplication::GetInstancePointer()->GetSystemUtils();
+    systemUtils->DestroyTimeStamp(m_pathTimeBegin);
+    systemUtils->DestroyTimeStamp(m_pathTimeEnd);
+
     if (m_engine->GetDebugGoto() && m_object->GetSelect())
         m_engine->SetDebugGotoBitmap(std::move(nullptr));
 }
@@ -1586,20 +1613,7 @@ int CTaskGoto::BeamShortcut()
 
 void CTaskGoto::BeamStart()
 {
-    Math::Vector    min, max;
-
     BitmapOpen();
-    BitmapObject();
-
-    min = m_object->GetPosition();
-    max = m_goal;
-    if ( min.x > max.x )  Math::Swap(min.x, max.x);
-    if ( min.z > max.z )  Math::Swap(min.z, max.z);
-    min.x -= 10.0f*BM_DIM_STEP;
-    min.z -= 10.0f*BM_DIM_STEP;
-    max.x += 10.0f*BM_DIM_STEP;
-    max.z += 10.0f*BM_DIM_STEP;
-    BitmapTerrain(min, max);
 
     if ( LeakSearch(m_leakPos, m_leakDelay) )
     {
@@ -1619,137 +1633,374 @@ void CTaskGoto::BeamStart()
 
 void CTaskGoto::BeamInit()
 {
-    int     i;
-
-    for ( i=0 ; i<MAXPOINTS ; i++ )
-    {
-        m_bmIter[i] = -1;
-    }
+    PathCancel();
     m_bmStep = 0;
 }
 
+// Path search done by a worker thread.
+// The map is a snapshot, so the search doesn't touch the world.
+
+struct CTaskGoto::PathRequest
+{
+    PathRequest(std::shared_ptr<const PathMap> map, Math::IntPoint start,
+                Math::IntPoint goal, float goalRadius)
+        : planner(map, start, goal, goalRadius)
+    {}
+
+    CPathPlanner        planner;
+    CSDLMutexWrapper    mutex;
+    CSDLCondWrapper     finished;
+    // The following members are protected by the mutex
+    bool                started = false;    // the worker has the planner
+    bool                taken = false;      // the task has the planner, the worker mustn't start
+    bool                done = false;
+    bool                cancelled = false;
+    long long           time = 0;   // [ns]
+};
+
 // Calculates points and passes to go from start to goal.
+// The search is an A* with jump points over a snapshot of the bitmap.
+// It runs on a worker thread if there is one, otherwise it is spread
+// over several frames so that the framerate doesn't drop.
+// Either way the result is taken in the frame PATH_RESULT_FRAME, waiting
+// for the search if it is late, so that the robots move the same way
+// on every machine (and in replays of recorded games).
 // Returns:
 // ERR_OK if it's good
 // ERR_GOTO_IMPOSSIBLE if impossible
-// ERR_GOTO_ITER if aborts because too many recursions
+// ERR_GOTO_ITER if the path has too many points
 // ERR_CONTINUE if not done yet
 // goalRadius: distance at which we must approach the goal
 
 Error CTaskGoto::BeamSearch(const Math::Vector &start, const Math::Vector &goal,
                             float goalRadius)
 {
-    float     step, len;
-    int       nbIter;
+    CSystemUtils* systemUtils = CApplication::GetInstancePointer()->GetSystemUtils();
+    long long budget = CApplication::GetInstancePointer()->GetPathSearchBudget()*1000LL;
 
     m_bmStep ++;
+    if ( m_bmStep == 1 )
+    {
+        PathCancel();
+        m_pathTime = 0;
 
-    len = Math::DistanceProjected(start, goal);
-    step = len/BEAM_ACCURACY;
-    if ( step < BM_DIM_STEP*2.1f )  step = BM_DIM_STEP*2.1f;
-    if ( step > 20.0f            )  step = 20.0f;
-    nbIter = 200;  // in order not to lower the framerate
-    m_bmIterCounter = 0;
-    return BeamExplore(start, start, goal, goalRadius, 165.0f*Math::PI/180.0f, 22, step, 0, nbIter);
-}
-
-// prevPos: previous position
-// curPos:  current position
-// goalPos: position that seeks to achieve
-// angle:   angle to the goal we explores
-// nbDiv:   number of subdivisions being done with angle
-// step     length of a step
-// i        number of recursions made
-// nbIter   maximum number of iterations you have the right to make before temporarily interrupt
-
-Error CTaskGoto::BeamExplore(const Math::Vector &prevPos, const Math::Vector &curPos,
-                             const Math::Vector &goalPos, float goalRadius,
-                             float angle, int nbDiv, float step,
-                             int i, int nbIter)
-{
-    Math::Vector    newPos;
-    Error       ret;
-    int         iDiv, iClear, iLar;
+        if ( PathFromCache(start, goal, goalRadius) == ERR_OK )
+        {
+            return ERR_OK;
+        }
+        if ( PathFromFlowField(start, goal, goalRadius) == ERR_OK )
+        {
+            m_bmGrid->AddFlowFieldPath();
+            return ERR_OK;
+        }
 
-    iLar = 0;
-    if ( i >= MAXPOINTS )  return ERR_GOTO_ITER;  // too many recursions
+        std::shared_ptr<PathMap> map = PathSnapshot(start, goal);
+        Math::IntPoint startCell(static_cast<int>((start.x+1600.0f)/BM_DIM_STEP),
+                                 static_cast<int>((start.z+1600.0f)/BM_DIM_STEP));
+        Math::IntPoint goalCell(static_cast<int>((goal.x+1600.0f)/BM_DIM_STEP),
+                                static_cast<int>((goal.z+1600.0f)/BM_DIM_STEP));
+        float cellRadius = Math::Max(goalRadius/BM_DIM_STEP, 1.0f);
 
-    m_bmTotal = i;
+        auto request = std::make_shared<PathRequest>(map, startCell, goalCell, cellRadius);
+        CJobSystem* jobSystem = m_main->GetJobSystem();
+        if ( jobSystem != nullptr &&
+             jobSystem->Submit([request]() { PathWorker(request); }, JobPriority::High) )
+        {
+            m_pathRequest = request;
+        }
+        else
+        {
+            m_pathPlanner = MakeUnique<CPathPlanner>(map, startCell, goalCell, cellRadius);
+        }
+    }
 
-    if ( m_bmIter[i] == -1 )
+    if ( m_pathRequest != nullptr )
     {
-        m_bmIter[i] = 0;
+        if ( m_bmStep < PATH_RESULT_FRAME )  return ERR_CONTINUE;
 
-        if ( i == 0 )
+        PathRequest& request = *m_pathRequest;
+        SDL_LockMutex(*request.mutex);
+        if ( !request.started )  // still waiting for a worker?
         {
-            m_bmPoints[i] = curPos;
+            request.taken = true;
+            m_pathPlanner = MakeUnique<CPathPlanner>(request.planner);  // nothing searched yet
         }
         else
         {
-            if ( !BitmapTestLine(prevPos, curPos, angle/nbDiv, true) )  return ERR_GOTO_IMPOSSIBLE;
-
-            m_bmPoints[i] = curPos;
+            while ( !request.done )
+            {
+                SDL_CondWait(*request.finished, *request.mutex);
+            }
+            m_pathTime = request.time;
+        }
+        SDL_UnlockMutex(*request.mutex);
+    }
 
-            if ( Math::DistanceProjected(curPos, goalPos)-goalRadius <= step )
+    const CPathPlanner* planner = nullptr;
+    if ( m_pathPlanner != nullptr )
+    {
+        systemUtils->GetCurrentTimeStamp(m_pathTimeBegin);
+        if ( m_bmStep >= PATH_RESULT_FRAME )
+        {
+            m_pathPlanner->Run();  // late, the frame has to wait
+            systemUtils->GetCurrentTimeStamp(m_pathTimeEnd);
+        }
+        else if ( budget == 0 )
+        {
+            m_pathPlanner->Run(PATH_NODES_PER_FRAME);
+            systemUtils->GetCurrentTimeStamp(m_pathTimeEnd);
+        }
+        else
+        {
+            // In order not to lower the framerate
+            do
             {
-                if ( goalRadius == 0.0f )
-                {
-                    newPos = goalPos;
-                }
-                else
-                {
-                    newPos = BeamPoint(curPos, goalPos, 0, Math::DistanceProjected(curPos, goalPos)-goalRadius);
-                }
-                if ( BitmapTestLine(curPos, newPos, angle/nbDiv, false) )
-                {
-                    m_bmPoints[i+1] = newPos;
-                    m_bmTotal = i+1;
-                    return ERR_OK;
-                }
+                m_pathPlanner->Run(16);
+                systemUtils->GetCurrentTimeStamp(m_pathTimeEnd);
             }
+            while ( m_pathPlanner->GetStatus() == PathStatus::Searching &&
+                    systemUtils->TimeStampExactDiff(m_pathTimeBegin, m_pathTimeEnd) < budget );
+        }
+        m_pathTime += systemUtils->TimeStampExactDiff(m_pathTimeBegin, m_pathTimeEnd);
+
+        if ( m_bmStep < PATH_RESULT_FRAME )  return ERR_CONTINUE;
+        planner = m_pathPlanner.get();
+    }
+    else
+    {
+        planner = &m_pathRequest->planner;
+    }
+
+    for ( const Math::IntPoint& cell : planner->GetExpandedCells() )
+    {
+        BitmapSetDot(cell.x, cell.y);  // visible in the debug bitmap
+    }
+
+    Error ret = ERR_GOTO_IMPOSSIBLE;
+    if ( planner->GetStatus() == PathStatus::Found )
+    {
+        ret = PathFinish(planner->GetPath(), start, goal, goalRadius);
+        if ( ret == ERR_OK )  m_bmGrid->AddCachedPath(m_pathKey, planner->GetPath());
+    }
+    if ( ret != ERR_OK )
+    {
+        GetLogger()->Trace("goto(): no path found in %d frames, %.2f ms, %d cells visited\n",
+                           m_bmStep, m_pathTime/1000000.0f, planner->GetExpandedCount());
+    }
+    PathStatistics(ret == ERR_OK);
+    PathCancel();
+    return ret;
+}
+
+// Runs a path search on a worker thread.
+// The search stops early if the task doesn't want it anymore,
+// and doesn't start if the task got tired of waiting for a worker.
+
+void CTaskGoto::PathWorker(const std::shared_ptr<PathRequest> &request)
+{
+    SDL_LockMutex(*request->mutex);
+    bool taken = request->taken || request->cancelled;
+    request->started = !taken;
+    SDL_UnlockMutex(*request->mutex);
+    if ( taken )  return;
+
+    Uint64 begin = SDL_GetPerformanceCounter();
+
+    while ( true )
+    {
+        PathStatus status = request->planner.Run(PATH_NODES_PER_STEP);
+        long long time = static_cast<long long>((SDL_GetPerformanceCounter()-begin)*1000000000.0/SDL_GetPerformanceFrequency());
+
+        SDL_LockMutex(*request->mutex);
+        request->done = status != PathStatus::Searching;
+        request->time = time;
+        bool stop = request->done || request->cancelled;
+        if ( request->done )  SDL_CondSignal(*request->finished);
+        SDL_UnlockMutex(*request->mutex);
+
+        if ( stop )  break;
+    }
+}
+
+// Takes the path found by an earlier search between the same cells.
+// Objects may have come near the path without touching the cells
+// the cache watches, so it is checked again.
+
+Error CTaskGoto::PathFromCache(const Math::Vector &start, const Math::Vector &goal,
+                               float goalRadius)
+{
+    m_pathKey = PathCacheKey();
+    m_pathKey.mobility = m_bmMobility;
+    m_pathKey.radius = m_bmObjects->GetRadius();
+    m_pathKey.altitude = m_bmObjects->GetAltitude();
+    m_pathKey.start = Math::IntPoint(static_cast<int>((start.x+1600.0f)/BM_DIM_STEP),
+                                     static_cast<int>((start.z+1600.0f)/BM_DIM_STEP));
+    m_pathKey.goal = Math::IntPoint(static_cast<int>((goal.x+1600.0f)/BM_DIM_STEP),
+                                    static_cast<int>((goal.z+1600.0f)/BM_DIM_STEP));
+    m_pathKey.goalRadius = Math::Max(goalRadius/BM_DIM_STEP, 1.0f);
+
+    std::vector<Math::IntPoint> cells;
+    Error ret = ERR_GOTO_IMPOSSIBLE;
+    if ( m_bmGrid->FindCachedPath(m_pathKey, cells) )
+    {
+        if ( PathIsClear(cells) )
+        {
+            ret = PathFinish(cells, start, goal, goalRadius);
         }
+        if ( ret != ERR_OK )  m_bmGrid->RemoveCachedPath(m_pathKey);
     }
+    m_bmGrid->AddPathCacheLookup(ret == ERR_OK);
+    return ret;
+}
+
+// Reads the path from the flow field of the goal, if there is one.
+// The field only knows the terrain, so the path is checked against
+// the objects; the search is done as usual if they are in the way.
+
+Error CTaskGoto::PathFromFlowField(const Math::Vector &start, const Math::Vector &goal,
+                                   float goalRadius)
+{
+    Math::IntPoint startCell(static_cast<int>((start.x+1600.0f)/BM_DIM_STEP),
+                             static_cast<int>((start.z+1600.0f)/BM_DIM_STEP));
+    Math::IntPoint goalCell(static_cast<int>((goal.x+1600.0f)/BM_DIM_STEP),
+                            static_cast<int>((goal.z+1600.0f)/BM_DIM_STEP));
+
+    std::shared_ptr<const CFlowField> field = m_bmGrid->GetFlowField(m_bmMobility, goalCell, m_main->GetJobSystem());
+    if ( field == nullptr )  return ERR_GOTO_IMPOSSIBLE;
 
-    if ( iLar >= m_bmIter[i] )
+    std::vector<Math::IntPoint> cells;
+    if ( !field->Trace(startCell, Math::Max(goalRadius/BM_DIM_STEP, 1.0f), cells) )
     {
-        newPos = BeamPoint(curPos, goalPos, 0, step);
-        ret = BeamExplore(curPos, newPos, goalPos, goalRadius, angle, nbDiv, step, i+1, nbIter);
-        if ( ret != ERR_GOTO_IMPOSSIBLE )  return ret;
-        m_bmIter[i] = iLar+1;
-        for ( iClear=i+1 ; iClear<=MAXPOINTS ; iClear++ )  m_bmIter[iClear] = -1;
-        m_bmIterCounter ++;
-        if ( m_bmIterCounter >= nbIter )  return ERR_CONTINUE;
+        return ERR_GOTO_IMPOSSIBLE;
     }
-    iLar ++;
+    if ( !PathIsClear(cells) )  return ERR_GOTO_IMPOSSIBLE;
 
-    for ( iDiv=1 ; iDiv<=nbDiv ; iDiv++ )
+    return PathFinish(cells, start, goal, goalRadius);
+}
+
+// Tests if the robot can go along jump points found elsewhere
+// (flow field, path cache) in the current state of the bitmap.
+
+bool CTaskGoto::PathIsClear(const std::vector<Math::IntPoint> &cells)
+{
+    for ( std::size_t i=1 ; i<cells.size() ; i++ )
     {
-        if ( iLar >= m_bmIter[i] )
+        int dx = (cells[i].x > cells[i-1].x) - (cells[i].x < cells[i-1].x);
+        int dy = (cells[i].y > cells[i-1].y) - (cells[i].y < cells[i-1].y);
+        Math::IntPoint cell = cells[i-1];
+        while ( cell != cells[i] )
         {
-            newPos = BeamPoint(curPos, goalPos, angle*iDiv/nbDiv, step);
-            ret = BeamExplore(curPos, newPos, goalPos, goalRadius, angle, nbDiv, step, i+1, nbIter);
-            if ( ret != ERR_GOTO_IMPOSSIBLE )  return ret;
-            m_bmIter[i] = iLar+1;
-            for ( iClear=i+1 ; iClear<=MAXPOINTS ; iClear++ )  m_bmIter[iClear] = -1;
-            m_bmIterCounter ++;
-            if ( m_bmIterCounter >= nbIter )  return ERR_CONTINUE;
+            if ( dx != 0 && dy != 0 &&
+                 (BitmapTestDot(0, cell.x+dx, cell.y) ||
+                  BitmapTestDot(0, cell.x, cell.y+dy)) )  return false;
+            cell.x += dx;
+            cell.y += dy;
+            if ( BitmapTestDot(0, cell.x, cell.y) )  return false;
         }
-        iLar ++;
+    }
+    return true;
+}
+
+// Copies the state of the bitmap around start and goal,
+// with enough margin to go around the obstacles between them.
 
-        if ( iLar >= m_bmIter[i] )
+std::shared_ptr<PathMap> CTaskGoto::PathSnapshot(const Math::Vector &start, const Math::Vector &goal)
+{
+    int sx = static_cast<int>((start.x+1600.0f)/BM_DIM_STEP);
+    int sy = static_cast<int>((start.z+1600.0f)/BM_DIM_STEP);
+    int gx = static_cast<int>((goal.x+1600.0f)/BM_DIM_STEP);
+    int gy = static_cast<int>((goal.z+1600.0f)/BM_DIM_STEP);
+    int margin = std::max(PATH_MAP_MARGIN, std::max(abs(gx-sx), abs(gy-sy))/2);
+
+    int minX = std::max(std::min(sx, gx)-margin, 0);
+    int minY = std::max(std::min(sy, gy)-margin, 0);
+    int maxX = std::min(std::max(sx, gx)+margin, m_bmSize-1);
+    int maxY = std::min(std::max(sy, gy)+margin, m_bmSize-1);
+
+    auto map = std::make_shared<PathMap>();
+    map->minX = minX;
+    map->minY = minY;
+    map->width  = std::max(maxX-minX+1, 0);
+    map->height = std::max(maxY-minY+1, 0);
+    map->blocked.resize(map->width*map->height);
+
+    unsigned char* dot = map->blocked.data();
+    for ( int y=minY ; y<=maxY ; y++ )
+    {
+        for ( int x=minX ; x<=maxX ; x++ )
         {
-            newPos = BeamPoint(curPos, goalPos, -angle*iDiv/nbDiv, step);
-            ret = BeamExplore(curPos, newPos, goalPos, goalRadius, angle, nbDiv, step, i+1, nbIter);
-            if ( ret != ERR_GOTO_IMPOSSIBLE )  return ret;
-            m_bmIter[i] = iLar+1;
-            for ( iClear=i+1 ; iClear<=MAXPOINTS ; iClear++ )  m_bmIter[iClear] = -1;
-            m_bmIterCounter ++;
-            if ( m_bmIterCounter >= nbIter )  return ERR_CONTINUE;
+            *dot++ = BitmapTestDot(0, x, y) ? 1 : 0;
         }
-        iLar ++;
     }
+    return map;
+}
 
-    return ERR_GOTO_IMPOSSIBLE;
+// Stops the current path search.
+// A worker still running the search drops it at its next step.
+
+void CTaskGoto::PathCancel()
+{
+    if ( m_pathRequest != nullptr )
+    {
+        SDL_LockMutex(*m_pathRequest->mutex);
+        m_pathRequest->cancelled = true;
+        SDL_UnlockMutex(*m_pathRequest->mutex);
+        m_pathRequest.reset();
+    }
+    m_pathPlanner.reset();
+}
+
+// Makes the list of points from the found jump points.
+// Points which can be skipped by going straight are removed.
+
+Error CTaskGoto::PathFinish(const std::vector<Math::IntPoint> &cells, const Math::Vector &start,
+                            const Math::Vector &goal, float goalRadius)
+{
+    std::vector<Math::Vector> path;
+    for ( const Math::IntPoint& cell : cells )
+    {
+        Math::Vector pos;
+        pos.x = (cell.x+0.5f)*BM_DIM_STEP-1600.0f;
+        pos.z = (cell.y+0.5f)*BM_DIM_STEP-1600.0f;
+        pos.y = 0.0f;
+        path.push_back(pos);
+    }
+    if ( path.empty() )  return ERR_GOTO_IMPOSSIBLE;
+    path.front() = start;  // the start cell is where we stand
+
+    if ( goalRadius == 0.0f )
+    {
+        path.push_back(goal);
+    }
+    else
+    {
+        const Math::Vector& last = path.back();
+        path.push_back(BeamPoint(last, goal, 0, Math::DistanceProjected(last, goal)-goalRadius));
+    }
+
+    // Smoothes the path; neighbouring jump points are kept even if
+    // the line test fails, the cells between them are known to be free
+    m_bmTotal = 0;
+    m_bmPoints[0] = path[0];
+    std::size_t i = 0;
+    while ( i < path.size()-1 )
+    {
+        std::size_t j = path.size()-1;
+        while ( j > i+1 && !BitmapTestLine(path[i], path[j], 0.0f, false) )  j --;
+
+        if ( m_bmTotal >= MAXPOINTS )  return ERR_GOTO_ITER;
+        m_bmPoints[++m_bmTotal] = path[j];
+        i = j;
+    }
+
+    return ERR_OK;
+}
+
+// Records the result of the search.
+
+void CTaskGoto::PathStatistics(bool found)
+{
+    m_bmGrid->AddPathSearch(found, m_pathTime, m_bmStep);
 }
 
 // Is a right "start-goal". Calculates the point located at the distance "step"
@@ -1796,7 +2047,7 @@ bool CTaskGoto::BitmapTestLine(const Math::Vector &start, const Math::Vector &go
     {
         x = static_cast<int>((pos.x+1600.0f)/BM_DIM_STEP);
         y = static_cast<int>((pos.z+1600.0f)/BM_DIM_STEP);
-        BitmapSetDot(1, x, y);  // puts the flag as the starting point
+        BitmapSetDot(x, y);  // puts the flag as the starting point
     }
 
     max = static_cast<int>(dist/step);
@@ -1823,7 +2074,7 @@ bool CTaskGoto::BitmapTestLine(const Math::Vector &start, const Math::Vector &go
 
             if ( step*(i+1) > distNoB2 && i < max-2 )
             {
-                BitmapSetDot(1, x, y);
+                BitmapSetDot(x, y);
             }
         }
 
@@ -1832,213 +2083,31 @@ bool CTaskGoto::BitmapTestLine(const Math::Vector &start, const Math::Vector &go
     return true;
 }
 
-// Adds the objects in the bitmap.
-
-void CTaskGoto::BitmapObject()
-{
-    auto firstCrashSphere = m_object->GetFirstCrashSphere();
-    float iRadius = firstCrashSphere.sphere.radius;
-
-    for (CObject* pObj : CObjectManager::GetInstancePointer()->GetAllObjects())
-    {
-        ObjectType type = pObj->GetType();
-
-        if ( pObj == m_object )  continue;
-        if ( pObj == m_bmCargoObject )  continue;
-        if (IsObjectBeingTransported(pObj))  continue;
-
-        float h = m_terrain->GetFloorLevel(pObj->GetPosition(), false);
-        if ( m_object->Implements(ObjectInterfaceType::Flying) && m_altitude > 0.0f )
-        {
-            h += m_altitude;
-        }
-
-        for (const auto& crashSphere : pObj->GetAllCrashSpheres())
-        {
-            Math::Vector oPos = crashSphere.sphere.pos;
-            float oRadius = crashSphere.sphere.radius;
-
-            if ( m_object->Implements(ObjectInterfaceType::Flying) && m_altitude > 0.0f )  // flying?
-            {
-                if ( oPos.y-oRadius > h+8.0f ||
-                     oPos.y+oRadius < h-8.0f )  continue;
-            }
-            else    // crawling?
-            {
-                if ( oPos.y-oRadius > h+8.0f )  continue;
-            }
-
-            if ( type == OBJECT_PARA )  oRadius -= 2.0f;
-            BitmapSetCircle(oPos, oRadius+iRadius+SAFETY_MARGIN);
-        }
-    }
-}
-
-// Adds a section of land in the bitmap.
-
-void CTaskGoto::BitmapTerrain(const Math::Vector &min, const Math::Vector &max)
-{
-    int     minx, miny, maxx, maxy;
-
-    minx = static_cast<int>((min.x+1600.0f)/BM_DIM_STEP);
-    miny = static_cast<int>((min.z+1600.0f)/BM_DIM_STEP);
-    maxx = static_cast<int>((max.x+1600.0f)/BM_DIM_STEP);
-    maxy = static_cast<int>((max.z+1600.0f)/BM_DIM_STEP);
-
-    BitmapTerrain(minx, miny, maxx, maxy);
-}
-
-// Adds a section of land in the bitmap.
-
-void CTaskGoto::BitmapTerrain(int minx, int miny, int maxx, int maxy)
-{
-    ObjectType  type;
-    Math::Vector    p;
-    float       aLimit, angle, h;
-    int         x, y;
-    bool        bAcceptWater, bFly;
-
-    if ( minx > maxx )  Math::Swap(minx, maxx);
-    if ( miny > maxy )  Math::Swap(miny, maxy);
-
-    if ( minx < 0          )  minx = 0;
-    if ( miny < 0          )  miny = 0;
-    if ( maxx > m_bmSize-1 )  maxx = m_bmSize-1;
-    if ( maxy > m_bmSize-1 )  maxy = m_bmSize-1;
-
-    if ( minx > m_bmMinX )  minx = m_bmMinX;
-    if ( miny > m_bmMinY )  miny = m_bmMinY;
-    if ( maxx < m_bmMaxX )  maxx = m_bmMaxX;
-    if ( maxy < m_bmMaxY )  maxy = m_bmMaxY;
-
-    if ( minx >= m_bmMinX && maxx <= m_bmMaxX &&
-         miny >= m_bmMinY && maxy <= m_bmMaxY )  return;
-
-    aLimit = 20.0f*Math::PI/180.0f;
-    bAcceptWater = false;
-    bFly = false;
-
-    type = m_object->GetType();
-
-    if ( type == OBJECT_MOBILEwa ||
-         type == OBJECT_MOBILEwc ||
-         type == OBJECT_MOBILEws ||
-         type == OBJECT_MOBILEwi ||
-         type == OBJECT_MOBILEwt ||
-         type == OBJECT_MOBILEtg )  // wheels?
-    {
-        aLimit = 20.0f*Math::PI/180.0f;
-    }
-
-    if ( type == OBJECT_MOBILEta ||
-         type == OBJECT_MOBILEtc ||
-         type == OBJECT_MOBILEti ||
-         type == OBJECT_MOBILEts )  // caterpillars?
-    {
-        aLimit = 35.0f*Math::PI/180.0f;
-    }
-
-    if ( type == OBJECT_MOBILErt ||
-         type == OBJECT_MOBILErc ||
-         type == OBJECT_MOBILErr ||
-         type == OBJECT_MOBILErs )  // large caterpillars?
-    {
-        aLimit = 35.0f*Math::PI/180.0f;
-    }
-
-    if ( type == OBJECT_MOBILEsa )  // submarine caterpillars?
-    {
-        aLimit = 35.0f*Math::PI/180.0f;
-        bAcceptWater = true;
-    }
-
-    if ( type == OBJECT_MOBILEdr )  // designer caterpillars?
-    {
-        aLimit = 35.0f*Math::PI/180.0f;
-    }
-
-    if ( type == OBJECT_MOBILEfa ||
-         type == OBJECT_MOBILEfc ||
-         type == OBJECT_MOBILEfs ||
-         type == OBJECT_MOBILEfi ||
-         type == OBJECT_MOBILEft )  // flying?
-    {
-        aLimit = 15.0f*Math::PI/180.0f;
-        bFly = true;
-    }
-
-    if ( type == OBJECT_MOBILEia ||
-         type == OBJECT_MOBILEic ||
-         type == OBJECT_MOBILEis ||
-         type == OBJECT_MOBILEii )  // insect legs?
-    {
-        aLimit = 60.0f*Math::PI/180.0f;
-    }
-
-    for ( y=miny ; y<=maxy ; y++ )
-    {
-        for ( x=minx ; x<=maxx ; x++ )
-        {
-            if ( x >= m_bmMinX && x <= m_bmMaxX &&
-                 y >= m_bmMinY && y <= m_bmMaxY )  continue;
-
-            p.x = x*BM_DIM_STEP-1600.0f;
-            p.z = y*BM_DIM_STEP-1600.0f;
-
-            if ( bFly )  // flying robot?
-            {
-                h = m_terrain->GetFloorLevel(p, true);
-                if ( h >= m_terrain->GetFlyingMaxHeight()-5.0f )
-                {
-                    BitmapSetDot(0, x, y);
-                }
-                continue;
-            }
-
-            if ( !bAcceptWater )  // not going underwater?
-            {
-                h = m_terrain->GetFloorLevel(p, true);
-                if ( h < m_water->GetLevel()-2.0f )  // under water (*)?
-                {
-//?                 BitmapSetDot(0, x, y);
-                    BitmapSetCircle(p, BM_DIM_STEP*1.0f);
-                    continue;
-                }
-            }
-
-            angle = m_terrain->GetFineSlope(p);
-            if ( angle > aLimit )
-            {
-                BitmapSetDot(0, x, y);
-            }
-        }
-    }
-
-    m_bmMinX = minx;
-    m_bmMinY = miny;
-    m_bmMaxX = maxx;
-    m_bmMaxY = maxy;  // expanded rectangular area
-}
-
-// (*)  Accepts that a robot is 50cm under water, for example Tropica 3!
-
 // Opens an empty bitmap.
+// Only the flags are private, obstacles come from the navigation grid
+// shared by all robots of the same kind.
 
 bool CTaskGoto::BitmapOpen()
 {
     BitmapClose();
 
-    m_bmSize = static_cast<int>(3200.0f/BM_DIM_STEP);
-    m_bmArray = MakeUniqueArray<unsigned char>(m_bmSize*m_bmSize/8*2);
+    m_bmSize = NAVIGATION_GRID_SIZE;
+    m_bmArray = MakeUniqueArray<unsigned char>(m_bmSize*m_bmSize/8);
     m_bmChanged = true;
 
-    m_bmOffset = m_bmSize/2;
     m_bmLine = m_bmSize/8;
 
-    m_bmMinX = m_bmSize;  // non-existent rectangular area
-    m_bmMinY = m_bmSize;
-    m_bmMaxX = 0;
-    m_bmMaxY = 0;
+    float altitude = 0.0f;
+    if ( m_object->Implements(ObjectInterfaceType::Flying) && m_altitude > 0.0f )
+    {
+        altitude = m_altitude;
+    }
+    float iRadius = m_object->GetFirstCrashSphere().sphere.radius;
+
+    m_bmGrid = CObjectManager::GetInstancePointer()->GetNavigationGrid();
+    m_bmMobility = CNavigationGrid::GetMobilityClass(m_object->GetType());
+    m_bmObjects = m_bmGrid->GetObjectLayer(iRadius+SAFETY_MARGIN, altitude);
+    m_bmFreeCircles.clear();
 
     return true;
 }
@@ -2047,92 +2116,63 @@ bool CTaskGoto::BitmapOpen()
 
 bool CTaskGoto::BitmapClose()
 {
+    PathCancel();
     m_bmArray.reset();
+    m_bmObjects.reset();
+    m_bmFreeCircles.clear();
     m_bmChanged = true;
     return true;
 }
 
-// Puts a circle in the bitmap.
-
-void CTaskGoto::BitmapSetCircle(const Math::Vector &pos, float radius)
-{
-    float   d, r;
-    int     cx, cy, ix, iy;
-
-    cx = static_cast<int>((pos.x+1600.0f)/BM_DIM_STEP);
-    cy = static_cast<int>((pos.z+1600.0f)/BM_DIM_STEP);
-    r = radius/BM_DIM_STEP;
-
-    for ( iy=cy-static_cast<int>(r) ; iy<=cy+static_cast<int>(r) ; iy++ )
-    {
-        for ( ix=cx-static_cast<int>(r) ; ix<=cx+static_cast<int>(r) ; ix++ )
-        {
-            d = Math::Point(static_cast<float>(ix-cx), static_cast<float>(iy-cy)).Length();
-            if ( d > r )  continue;
-            BitmapSetDot(0, ix, iy);
-        }
-    }
-}
-
 // Removes a circle in the bitmap.
-//TODO this method is almost same as above one
-void CTaskGoto::BitmapClearCircle(const Math::Vector &pos, float radius)
-{
-    float   d, r;
-    int     cx, cy, ix, iy;
-
-    cx = static_cast<int>((pos.x+1600.0f)/BM_DIM_STEP);
-    cy = static_cast<int>((pos.z+1600.0f)/BM_DIM_STEP);
-    r = radius/BM_DIM_STEP;
-
-    for ( iy=cy-static_cast<int>(r) ; iy<=cy+static_cast<int>(r) ; iy++ )
-    {
-        for ( ix=cx-static_cast<int>(r) ; ix<=cx+static_cast<int>(r) ; ix++ )
-        {
-            d = Math::Point(static_cast<float>(ix-cx), static_cast<float>(iy-cy)).Length();
-            if ( d > r )  continue;
-            BitmapClearDot(0, ix, iy);
-        }
-    }
-}
-
-// Makes a point in the bitmap.
-// x:y: 0..m_bmSize-1
 
-void CTaskGoto::BitmapSetDot(int rank, int x, int y)
+void CTaskGoto::BitmapClearCircle(const Math::Vector &pos, float radius)
 {
-    if ( x < 0 || x >= m_bmSize ||
-         y < 0 || y >= m_bmSize )  return;
-
-    m_bmArray[rank*m_bmLine*m_bmSize + m_bmLine*y + x/8] |= (1<<x%8);
+    BitmapCircle circle;
+    circle.x = static_cast<int>((pos.x+1600.0f)/BM_DIM_STEP);
+    circle.y = static_cast<int>((pos.z+1600.0f)/BM_DIM_STEP);
+    circle.radius = radius/BM_DIM_STEP;
+    m_bmFreeCircles.push_back(circle);
     m_bmChanged = true;
 }
 
-// Removes a point in the bitmap.
+// Makes a point in the bitmap of flags.
 // x:y: 0..m_bmSize-1
 
-void CTaskGoto::BitmapClearDot(int rank, int x, int y)
+void CTaskGoto::BitmapSetDot(int x, int y)
 {
     if ( x < 0 || x >= m_bmSize ||
          y < 0 || y >= m_bmSize )  return;
 
-    m_bmArray[rank*m_bmLine*m_bmSize + m_bmLine*y + x/8] &= ~(1<<x%8);
+    m_bmArray[m_bmLine*y + x/8] |= (1<<x%8);
     m_bmChanged = true;
 }
 
 // Tests a point in the bitmap.
+// rank 0: obstacles, rank 1: flags
 // x:y: 0..m_bmSize-1
 
 bool CTaskGoto::BitmapTestDot(int rank, int x, int y)
 {
+    if ( m_bmArray == nullptr )  return false;
+
     if ( x < 0 || x >= m_bmSize ||
          y < 0 || y >= m_bmSize )  return false;
 
-    if ( x < m_bmMinX || x > m_bmMaxX ||
-         y < m_bmMinY || y > m_bmMaxY )
+    if ( rank == 1 )
     {
-        BitmapTerrain(x-10,y-10, x+10,y+10);  // remade a layer
+        return m_bmArray[m_bmLine*y + x/8] & (1<<x%8);
     }
 
-    return m_bmArray[rank*m_bmLine*m_bmSize + m_bmLine*y + x/8] & (1<<x%8);
+    for ( const BitmapCircle& circle : m_bmFreeCircles )
+    {
+        float d = Math::Point(static_cast<float>(x-circle.x), static_cast<float>(y-circle.y)).Length();
+        if ( d <= circle.radius )  return false;
+    }
+
+    if ( m_bmGrid->IsTerrainBlocked(m_bmMobility, x, y) )  return true;
+
+    // The robot and the cargo it goes to take are not obstacles
+    CObject* ignored[2] = { m_object, m_bmCargoObject };
+    return m_bmObjects->IsBlocked(x, y, ignored, m_bmCargoObject == nullptr ? 1 : 2);
 }
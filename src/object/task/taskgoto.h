@@ -23,7 +23,10 @@
 
 #include "math/vector.h"
 
+#include "object/navigation_grid.h"
+
 #include <memory>
+#include <vector>
 
 namespace Math
 {
@@ -32,6 +35,9 @@ struct Point;
 
 
 class CObject;
+class CPathPlanner;
+struct PathMap;
+struct SystemTimeStamp;
 
 const int MAXPOINTS = 500;
 
@@ -103,21 +109,35 @@ protected:
     void        BeamStart();
     void        BeamInit();
     Error       BeamSearch(const Math::Vector &start, const Math::Vector &goal, float goalRadius);
-    Error       BeamExplore(const Math::Vector &prevPos, const Math::Vector &curPos, const Math::Vector &goalPos, float goalRadius, float angle, int nbDiv, float step, int i, int nbIter);
     Math::Vector    BeamPoint(const Math::Vector &startPoint, const Math::Vector &goalPoint, float angle, float step);
 
+    std::shared_ptr<PathMap> PathSnapshot(const Math::Vector &start, const Math::Vector &goal);
+    void        PathCancel();
+    Error       PathFromCache(const Math::Vector &start, const Math::Vector &goal, float goalRadius);
+    Error       PathFromFlowField(const Math::Vector &start, const Math::Vector &goal, float goalRadius);
+    bool        PathIsClear(const std::vector<Math::IntPoint> &cells);
+    Error       PathFinish(const std::vector<Math::IntPoint> &cells, const Math::Vector &start, const Math::Vector &goal, float goalRadius);
+    void        PathStatistics(bool found);
+
     bool        BitmapTestLine(const Math::Vector &start, const Math::Vector &goal, float stepAngle, bool bSecond);
-    void        BitmapObject();
-    void        BitmapTerrain(const Math::Vector &min, const Math::Vector &max);
-    void        BitmapTerrain(int minx, int miny, int maxx, int maxy);
     bool        BitmapOpen();
     bool        BitmapClose();
-    void        BitmapSetCircle(const Math::Vector &pos, float radius);
     void        BitmapClearCircle(const Math::Vector &pos, float radius);
-    void        BitmapSetDot(int rank, int x, int y);
-    void        BitmapClearDot(int rank, int x, int y);
+    void        BitmapSetDot(int x, int y);
     bool        BitmapTestDot(int rank, int x, int y);
 
+protected:
+    //! Area where obstacles are ignored, in cells of the bitmap
+    struct BitmapCircle
+    {
+        int     x, y;
+        float   radius;
+    };
+
+    //! Path search running on a worker thread
+    struct PathRequest;
+    static void PathWorker(const std::shared_ptr<PathRequest> &request);
+
 protected:
     Math::Vector        m_goal;
     Math::Vector        m_goalObject;
@@ -139,16 +159,21 @@ protected:
 
     bool            m_bmChanged = true;
     int             m_bmSize = 0;       // width or height of the table
-    int             m_bmOffset = 0;     // m_bmSize/2
     int             m_bmLine = 0;       // increment line m_bmSize/8
-    std::unique_ptr<unsigned char[]> m_bmArray;      // bit table
-    int             m_bmMinX = 0, m_bmMinY = 0;
-    int             m_bmMaxX = 0, m_bmMaxY = 0;
+    std::unique_ptr<unsigned char[]> m_bmArray;      // bit table of flags (rank 1)
+    CNavigationGrid* m_bmGrid = nullptr;    // obstacles (rank 0), shared by all robots
+    MobilityClass   m_bmMobility = MobilityClass::Wheeled;
+    std::shared_ptr<const CNavigationObjectLayer> m_bmObjects;
+    std::vector<BitmapCircle> m_bmFreeCircles;  // cleared areas of rank 0
     int             m_bmTotal = 0;      // number of points in m_bmPoints
     int             m_bmIndex = 0;      // index in m_bmPoints
     Math::Vector        m_bmPoints[MAXPOINTS+2];
-    char            m_bmIter[MAXPOINTS+2] = {};
-    int             m_bmIterCounter = 0;
+    std::unique_ptr<CPathPlanner> m_pathPlanner;   // search done on this thread
+    std::shared_ptr<PathRequest> m_pathRequest;    // search done by a worker thread
+    long long       m_pathTime = 0;     // time spent in the search [ns]
+    PathCacheKey    m_pathKey;          // the search in the path cache
+    SystemTimeStamp* m_pathTimeBegin = nullptr;
+    SystemTimeStamp* m_pathTimeEnd = nullptr;
     CObject*        m_bmCargoObject = nullptr;
     float           m_bmFinalMove = 0.0f;  // final advance distance
     float           m_bmFinalDist = 0.0f;  // effective distance to advance
@@ -727,10 +727,8 @@ CObject* CTaskManip::SearchTakeUnderObject(Math::Vector &pos, float dLimit)
 
     min = 1000000.0f;
     pBest = nullptr;
-    for (CObject* pObj : CObjectManager::GetInstancePointer()->GetAllObjects())
+    for (CObject* pObj : CObjectManager::GetInstancePointer()->GetObjectsImplementing(ObjectInterfaceType::Transportable))
     {
-        if ( !pObj->Implements(ObjectInterfaceType::Transportable) )  continue;
-
         if (IsObjectBeingTransported(pObj))  continue;
         if ( pObj->GetLock() )  continue;
         if ( pObj->GetScaleY() != 1.0f )  continue;
@@ -779,10 +777,8 @@ CObject* CTaskManip::SearchTakeFrontObject(bool bAdvance, Math::Vector &pos,
     min = 1000000.0f;
     pBest = nullptr;
     bAngle = 0.0f;
-    for (CObject* pObj : CObjectManager::GetInstancePointer()->GetAllObjects())
+    for (CObject* pObj : CObjectManager::GetInstancePointer()->GetObjectsImplementing(ObjectInterfaceType::Transportable))
     {
-        if ( !pObj->Implements(ObjectInterfaceType::Transportable) )  continue;
-
         if (IsObjectBeingTransported(pObj))  continue;
         if ( pObj->GetLock() )  continue;
         if ( pObj->GetScaleY() != 1.0f )  continue;
@@ -846,10 +842,8 @@ CObject* CTaskManip::SearchTakeBackObject(bool bAdvance, Math::Vector &pos,
     min = 1000000.0f;
     pBest = nullptr;
     bAngle = 0.0f;
-    for (CObject* pObj : CObjectManager::GetInstancePointer()->GetAllObjects())
+    for (CObject* pObj : CObjectManager::GetInstancePointer()->GetObjectsImplementing(ObjectInterfaceType::Transportable))
     {
-        if ( !pObj->Implements(ObjectInterfaceType::Transportable) )  continue;
-
         if (IsObjectBeingTransported(pObj))  continue;
         if ( pObj->GetLock() )  continue;
         if ( pObj->GetScaleY() != 1.0f )  continue;
@@ -300,10 +300,8 @@ CObject* CTaskTake::SearchTakeObject(float &angle,
     min = 1000000.0f;
     pBest = nullptr;
     bAngle = 0.0f;
-    for (CObject* pObj : CObjectManager::GetInstancePointer()->GetAllObjects())
+    for (CObject* pObj : CObjectManager::GetInstancePointer()->GetObjectsImplementing(ObjectInterfaceType::Transportable))
     {
-        if ( !pObj->Implements(ObjectInterfaceType::Transportable) )  continue;
-
         if (IsObjectBeingTransported(pObj))  continue;
         if ( pObj->GetLock() )  continue;
         if ( pObj->GetScaleY() != 1.0f )  continue;
@@ -278,26 +278,26 @@ Error CTaskTerraform::IsEnded()
         max= static_cast<int>(50.0f*m_engine->GetParticleDensity());
         for ( i=0 ; i<max ; i++ )
         {
-            pos.x = m_terraPos.x+(Math::Rand()-0.5f)*80.0f;
-            pos.z = m_terraPos.z+(Math::Rand()-0.5f)*80.0f;
+            pos.x = m_terraPos.x+(Math::EffectRand()-0.5f)*80.0f;
+            pos.z = m_terraPos.z+(Math::EffectRand()-0.5f)*80.0f;
             pos.y = m_terraPos.y;
             m_terrain->AdjustToFloor(pos);
             dist = Math::Distance(pos, m_terraPos);
             speed = Math::Vector(0.0f, 0.0f, 0.0f);
-            dim.x = 2.0f+(40.0f-dist)/(1.0f+Math::Rand()*4.0f);
+            dim.x = 2.0f+(40.0f-dist)/(1.0f+Math::EffectRand()*4.0f);
             dim.y = dim.x;
             m_particle->CreateParticle(pos, speed, dim, Gfx::PARTICRASH, 2.0f);
 
             pos = m_terraPos;
-            speed.x = (Math::Rand()-0.5f)*40.0f;
-            speed.z = (Math::Rand()-0.5f)*40.0f;
-            speed.y = Math::Rand()*15.0f+15.0f;
+            speed.x = (Math::EffectRand()-0.5f)*40.0f;
+            speed.z = (Math::EffectRand()-0.5f)*40.0f;
+            speed.y = Math::EffectRand()*15.0f+15.0f;
             dim.x = 0.6f;
             dim.y = dim.x;
             pos.y += dim.y;
-            duration = Math::Rand()*3.0f+3.0f;
+            duration = Math::EffectRand()*3.0f+3.0f;
             m_particle->CreateTrack(pos, speed, dim, Gfx::PARTITRACK5,
-                                     duration, Math::Rand()*10.0f+15.0f,
+                                     duration, Math::EffectRand()*10.0f+15.0f,
                                      duration*0.2f, 1.0f);
         }
 
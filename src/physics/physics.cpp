@@ -64,6 +64,9 @@ const float LANDING_SPEED   = 3.0f;
 const float LANDING_ACCEL   = 5.0f;
 const float LANDING_ACCELh  = 1.5f;
 
+const float SLEEP_SPEED     = 0.01f;    // maximum speed of a resting body
+const float SLEEP_DELAY     = 1.0f;     // time of rest before the body falls asleep
+
 
 
 
@@ -123,6 +126,10 @@ CPhysics::CPhysics(COldObject* object)
     m_minFallingHeight = 20.0f;
     m_fallDamageFraction = 0.007f;
     m_floorLevel = 0.0f;
+    m_bSleeping = false;
+    m_sleepTime = 0.0f;
+    m_sleepEnergy = 0.0f;
+    m_sleepTerrainRevision = 0;
 }
 
 // Object's destructor.
@@ -1448,6 +1455,12 @@ bool CPhysics::EventFrame(const Event &event)
     m_timeUnderWater += event.rTime;
     m_soundTimeJostle += event.rTime;
 
+    if ( m_bSleeping )
+    {
+        if ( !IsDisturbed() )  return true;
+        WakeUp();
+    }
+
     type = m_object->GetType();
 
     FrameParticle(m_time, event.rTime);
@@ -1459,7 +1472,8 @@ bool CPhysics::EventFrame(const Event &event)
     iAngle = angle = m_object->GetRotation();
 
     // Accelerate is the descent, brake is the ascent.
-    if ( m_bFreeze || (m_object->Implements(ObjectInterfaceType::Destroyable) && dynamic_cast<CDestroyableObject*>(m_object)->IsDying()) )
+    CDestroyableObject* destroyable = m_object->GetInterface<ObjectInterfaceType::Destroyable>();
+    if ( m_bFreeze || (destroyable != nullptr && destroyable->IsDying()) )
     {
         m_linMotion.terrainSpeed.x = 0.0f;
         m_linMotion.terrainSpeed.z = 0.0f;
@@ -1467,8 +1481,9 @@ bool CPhysics::EventFrame(const Event &event)
     }
     else
     {
+        bool sampled = IsTerrainSampleValid(pos, angle);
         tAngle = angle;
-        h = m_terrain->GetBuildingFactor(pos);
+        h = sampled ? m_terrainSample.buildingFactor : m_terrain->GetBuildingFactor(pos);
         if ( type == OBJECT_HUMAN ||
              type == OBJECT_TECH  )
         {
@@ -1476,7 +1491,8 @@ bool CPhysics::EventFrame(const Event &event)
             {
                 h *= 0.5f;  // immobile man -> slippage
             }
-            FloorAngle(pos, tAngle);  // calculates the angle with the ground
+            if ( sampled )  tAngle = m_terrainSample.floorAngle;
+            else            FloorAngle(pos, tAngle);  // calculates the angle with the ground
         }
 
         if ( pos.y < m_water->GetLevel(m_object) )  // underwater?
@@ -1516,20 +1532,7 @@ bool CPhysics::EventFrame(const Event &event)
     UpdateMotionStruct(event.rTime, m_linMotion);
     UpdateMotionStruct(event.rTime, m_cirMotion);
 
-    newangle = angle + event.rTime*m_cirMotion.realSpeed;
-    Math::LoadRotationZXYMatrix(matRotate, newangle);
-    newpos = event.rTime*m_linMotion.realSpeed;
-    newpos = Transform(matRotate, newpos);
-    newpos += pos;
-
-    m_terrain->AdjustToStandardBounds(newpos);
-
-    if ( m_object->Implements(ObjectInterfaceType::Flying) && !m_bLand )
-    {
-        h = m_terrain->GetFlyingLimit(newpos, type==OBJECT_BEE);
-        h += m_object->GetCharacter()->height;
-        if ( newpos.y > h )  newpos.y = h;
-    }
+    MoveBySpeed(event.rTime, pos, angle, newpos, newangle);
 
     if ( m_bForceUpdate        ||
          newpos.x   != pos.x   ||
@@ -1541,6 +1544,7 @@ bool CPhysics::EventFrame(const Event &event)
     {
         FloorAdapt(m_time, event.rTime, newpos, newangle);
     }
+    m_terrainSample.valid = false;  // used only once
 
     if ( m_bForceUpdate    ||
          newpos.x != pos.x ||
@@ -1588,11 +1592,223 @@ bool CPhysics::EventFrame(const Event &event)
         m_fallingHeight = 0.0f;
     }
 
+    if ( IsResting() )
+    {
+        m_sleepTime += event.rTime;
+        if ( m_sleepTime >= SLEEP_DELAY )  FallAsleep();
+    }
+    else
+    {
+        m_sleepTime = 0.0f;
+    }
+
     m_bForceUpdate = false;
 
     return true;
 }
 
+// Indicates whether the body is sleeping, i.e. not simulated at all.
+
+bool CPhysics::IsSleeping()
+{
+    return m_bSleeping;
+}
+
+// Makes the body simulated again, starting with the next frame.
+
+void CPhysics::WakeUp()
+{
+    m_bSleeping = false;
+    m_sleepTime = 0.0f;
+}
+
+// Stops simulating a resting body until something disturbs it.
+
+void CPhysics::FallAsleep()
+{
+    m_bSleeping = true;
+    m_sleepPosition = m_object->GetPosition();
+    m_sleepRotation = m_object->GetRotation();
+    m_sleepEnergy = GetObjectEnergyLevel(m_object);
+    m_sleepTerrainRevision = m_terrain->GetRevision();
+    m_terrainSample.valid = false;
+}
+
+// Checks whether the body doesn't move and nothing else
+// needs to be updated every frame.
+
+bool CPhysics::IsResting()
+{
+    if ( m_bForceUpdate || !m_bLand || m_bSwim )  return false;
+    if ( m_motorSpeed.x != 0.0f ||
+         m_motorSpeed.y != 0.0f ||
+         m_motorSpeed.z != 0.0f )  return false;
+
+    if ( m_linMotion.currentSpeed.Length() > SLEEP_SPEED ||
+         m_linMotion.realSpeed.Length()    > SLEEP_SPEED ||
+         m_cirMotion.currentSpeed.Length() > SLEEP_SPEED ||
+         m_cirMotion.realSpeed.Length()    > SLEEP_SPEED )  return false;
+
+    if ( m_fallingHeight != 0.0f || m_restBreakParticle > 0.0f )  return false;
+    if ( m_soundChannel != -1 || m_soundChannelSlide != -1 )  return false;
+
+    // The selected object has camera and interface effects
+    if ( m_object->GetSelect() )  return false;
+
+    if ( m_object->GetPosition().y < m_water->GetLevel(m_object) )  return false;
+
+    CDestroyableObject* destroyable = m_object->GetInterface<ObjectInterfaceType::Destroyable>();
+    if ( destroyable != nullptr && destroyable->IsDying() )  return false;
+
+    // The reactor is still cooling down
+    CJetFlyingObject* jetFlying = m_object->GetInterface<ObjectInterfaceType::JetFlying>();
+    if ( jetFlying != nullptr && jetFlying->GetRange() > 0.0f &&
+         jetFlying->GetReactorRange() < 1.0f )  return false;
+
+    return true;
+}
+
+// Checks whether a sleeping body has to be simulated again: motor commands,
+// being pushed by a collision, moved by somebody else, terrain changes etc.
+
+bool CPhysics::IsDisturbed()
+{
+    if ( m_bForceUpdate )  return true;
+    if ( m_motorSpeed.x != 0.0f ||
+         m_motorSpeed.y != 0.0f ||
+         m_motorSpeed.z != 0.0f )  return true;
+
+    if ( m_linMotion.currentSpeed.Length() > SLEEP_SPEED ||
+         m_cirMotion.currentSpeed.Length() > SLEEP_SPEED )  return true;
+
+    if ( m_terrain->GetRevision() != m_sleepTerrainRevision )  return true;
+
+    Math::Vector pos = m_object->GetPosition();
+    Math::Vector angle = m_object->GetRotation();
+    if ( pos.x   != m_sleepPosition.x ||
+         pos.y   != m_sleepPosition.y ||
+         pos.z   != m_sleepPosition.z ||
+         angle.x != m_sleepRotation.x ||
+         angle.y != m_sleepRotation.y ||
+         angle.z != m_sleepRotation.z )  return true;
+
+    if ( GetObjectEnergyLevel(m_object) != m_sleepEnergy )  return true;
+    if ( m_object->GetSelect() )  return true;
+
+    CDestroyableObject* destroyable = m_object->GetInterface<ObjectInterfaceType::Destroyable>();
+    if ( destroyable != nullptr && destroyable->IsDying() )  return true;
+
+    return false;
+}
+
+// Moves the object by its current speeds during rTime, without
+// changing anything. Shared by EventFrame() and PrepareFrame(), so
+// that a prediction made with unchanged speeds is exactly the result.
+
+void CPhysics::MoveBySpeed(float rTime, const Math::Vector &pos, const Math::Vector &angle,
+                           Math::Vector &newpos, Math::Vector &newangle)
+{
+    Math::Matrix matRotate;
+
+    newangle = angle + rTime*m_cirMotion.realSpeed;
+    Math::LoadRotationZXYMatrix(matRotate, newangle);
+    newpos = rTime*m_linMotion.realSpeed;
+    newpos = Transform(matRotate, newpos);
+    newpos += pos;
+
+    m_terrain->AdjustToStandardBounds(newpos);
+
+    if ( m_object->Implements(ObjectInterfaceType::Flying) && !m_bLand )
+    {
+        float h = m_terrain->GetFlyingLimit(newpos, m_object->GetType()==OBJECT_BEE);
+        h += m_object->GetCharacter()->height;
+        if ( newpos.y > h )  newpos.y = h;
+    }
+}
+
+// Prefetches the terrain under the object before the frame update.
+// Only reads the terrain and the object, so it can be called for many
+// objects in parallel. The update itself stays sequential: EventFrame()
+// and FloorAdapt() take the samples instead of querying the terrain again
+// when they are given exactly the same arguments, so that the results
+// don't depend on whether the samples were used.
+
+void CPhysics::PrepareFrame(float rTime)
+{
+    m_terrainSample.valid = false;
+
+    Math::Vector pos = m_object->GetPosition();
+    Math::Vector angle = m_object->GetRotation();
+    ObjectType type = m_object->GetType();
+
+    m_terrainSample.terrainRevision = m_terrain->GetRevision();
+    m_terrainSample.position = pos;
+    m_terrainSample.rotation = angle;
+    m_terrainSample.buildingFactor = m_terrain->GetBuildingFactor(pos);
+    m_terrainSample.floorAngle = angle;
+    if ( type == OBJECT_HUMAN ||
+         type == OBJECT_TECH  )
+    {
+        FloorAngle(pos, m_terrainSample.floorAngle);
+    }
+
+    // Where EventFrame() moves the object if the speeds stay the same
+    Math::Vector nextPos, nextAngle;
+    MoveBySpeed(rTime, pos, angle, nextPos, nextAngle);
+
+    bool flying = m_object->Implements(ObjectInterfaceType::Flying);
+
+    m_terrainSample.nextPosition = nextPos;
+    m_terrainSample.nextFloorLevel = m_terrain->GetFloorLevel(nextPos);
+    m_terrainSample.nextNormalValid = flying && m_terrain->GetNormal(m_terrainSample.nextNormal, nextPos);
+
+    if ( type != OBJECT_HUMAN &&
+         type != OBJECT_TECH  &&
+         type != OBJECT_WORM  )
+    {
+        // FloorAdapt() plates objects on the ground before adjusting the angle
+        Math::Vector anglePos = nextPos;
+        float h = anglePos.y-m_terrainSample.nextFloorLevel;
+        h -= m_object->GetCharacter()->height;
+        if ( !flying )
+        {
+            anglePos.y -= h;
+            anglePos.y += m_object->GetCharacter()->height;
+        }
+        else if ( m_bLand || h <= 0.0f )
+        {
+            anglePos.y -= h;
+        }
+        m_terrainSample.nextAnglePosition = anglePos;
+        m_terrainSample.nextAngleYaw = nextAngle.y;
+        m_terrainSample.nextFloorAngle = nextAngle;
+        FloorAngle(anglePos, m_terrainSample.nextFloorAngle);
+    }
+
+    m_terrainSample.valid = true;
+}
+
+bool CPhysics::IsTerrainSampleValid(const Math::Vector &pos, const Math::Vector &angle)
+{
+    return m_terrainSample.valid &&
+           m_terrainSample.terrainRevision == m_terrain->GetRevision() &&
+           m_terrainSample.position.x == pos.x &&
+           m_terrainSample.position.y == pos.y &&
+           m_terrainSample.position.z == pos.z &&
+           m_terrainSample.rotation.x == angle.x &&
+           m_terrainSample.rotation.y == angle.y &&
+           m_terrainSample.rotation.z == angle.z;
+}
+
+bool CPhysics::IsNextTerrainSampleValid(const Math::Vector &pos)
+{
+    return m_terrainSample.valid &&
+           m_terrainSample.terrainRevision == m_terrain->GetRevision() &&
+           m_terrainSample.nextPosition.x == pos.x &&
+           m_terrainSample.nextPosition.y == pos.y &&
+           m_terrainSample.nextPosition.z == pos.z;
+}
+
 // Starts or stops the engine sounds.
 
 void CPhysics::SoundMotor(float rTime)
@@ -2048,19 +2264,19 @@ void CPhysics::SoundMotorSlow(float rTime, ObjectType type)
             for ( i=0 ; i<max ; i++ )
             {
                 pos = Math::Vector(-5.0f, 2.0f, 0.0f);
-                pos.x += Math::Rand()*4.0f;
-                pos.z += (Math::Rand()-0.5f)*2.0f;
+                pos.x += Math::EffectRand()*4.0f;
+                pos.z += (Math::EffectRand()-0.5f)*2.0f;
 
                 speed = pos;
-                speed.x -= Math::Rand()*4.0f;
-                speed.y -= Math::Rand()*3.0f;
-                speed.z += (Math::Rand()-0.5f)*6.0f;
+                speed.x -= Math::EffectRand()*4.0f;
+                speed.y -= Math::EffectRand()*3.0f;
+                speed.z += (Math::EffectRand()-0.5f)*6.0f;
 
                 mat = m_object->GetWorldMatrix(0);
                 pos   = Transform(*mat, pos);
                 speed = Transform(*mat, speed)-pos;
 
-                dim.x = Math::Rand()*1.0f+1.0f;
+                dim.x = Math::EffectRand()*1.0f+1.0f;
                 dim.y = dim.x;
 
                 m_particle->CreateParticle(pos, speed, dim, Gfx::PARTIMOTOR, 2.0f);
@@ -2276,7 +2492,9 @@ void CPhysics::FloorAdapt(float aTime, float rTime,
     level = m_water->GetLevel(m_object);
     SetSwim( pos.y < level );
 
-    m_floorLevel = m_terrain->GetFloorLevel(pos);  // height above the ground
+    bool sampled = IsNextTerrainSampleValid(pos);
+    if ( sampled )  m_floorLevel = m_terrainSample.nextFloorLevel;
+    else            m_floorLevel = m_terrain->GetFloorLevel(pos);  // height above the ground
     h = pos.y-m_floorLevel;
     h -= character->height;
     m_floorHeight = h;
@@ -2298,7 +2516,8 @@ void CPhysics::FloorAdapt(float aTime, float rTime,
 
         if ( !m_bLand )  // in flight?
         {
-            m_terrain->GetNormal(norm, pos);
+            if ( sampled && m_terrainSample.nextNormalValid )  norm = m_terrainSample.nextNormal;
+            else                                                m_terrain->GetNormal(norm, pos);
             a1 = fabs(Math::RotateAngle(Math::Point(norm.x, norm.z).Length(), norm.y));
             if ( a1 < (90.0f-55.0f)*Math::PI/180.0f )  // slope exceeds 55 degrees?
             {
@@ -2414,7 +2633,20 @@ void CPhysics::FloorAdapt(float aTime, float rTime,
          type == OBJECT_TECH  ||
          type == OBJECT_WORM  )  return;  // always right
 
-    FloorAngle(pos, angle);  // adjusts the angle at the ground
+    if ( m_terrainSample.valid &&
+         m_terrainSample.terrainRevision == m_terrain->GetRevision() &&
+         m_terrainSample.nextAnglePosition.x == pos.x &&
+         m_terrainSample.nextAnglePosition.y == pos.y &&
+         m_terrainSample.nextAnglePosition.z == pos.z &&
+         m_terrainSample.nextAngleYaw == angle.y )
+    {
+        angle.x = m_terrainSample.nextFloorAngle.x;
+        angle.z = m_terrainSample.nextFloorAngle.z;
+    }
+    else
+    {
+        FloorAngle(pos, angle);  // adjusts the angle at the ground
+    }
 
     if ( m_object->Implements(ObjectInterfaceType::Flying) && !m_bLand )  // flying in the air?
     {
@@ -2482,7 +2714,8 @@ int CPhysics::ObjectAdapt(const Math::Vector &pos, const Math::Vector &angle)
     int             colType;
     ObjectType      iType, oType;
 
-    if ( m_object->Implements(ObjectInterfaceType::Destroyable) && dynamic_cast<CDestroyableObject*>(m_object)->IsDying() )  return 0;  // is burning or exploding?
+    CDestroyableObject* destroyable = m_object->GetInterface<ObjectInterfaceType::Destroyable>();
+    if ( destroyable != nullptr && destroyable->IsDying() )  return 0;  // is burning or exploding?
     if ( !m_object->GetCollisions() )  return 0;
 
     // iiPos = sphere center is the old position.
@@ -2497,19 +2730,23 @@ int CPhysics::ObjectAdapt(const Math::Vector &pos, const Math::Vector &angle)
     iPos = iiPos + (pos - m_object->GetPosition());
     iType = m_object->GetType();
 
-    for (CObject* pObj : CObjectManager::GetInstancePointer()->GetAllObjects())
+    // Jostling spheres and waypoints are all within 15 units from the object's center
+    float searchRadius = iRad + 15.0f;
+    for (CObject* pObj : CObjectManager::GetInstancePointer()->GetCollisionCandidates(iPos, searchRadius))
     {
         if ( pObj == m_object )  continue;  // yourself?
         if (IsObjectBeingTransported(pObj))  continue;
-        if ( pObj->Implements(ObjectInterfaceType::Destroyable) && dynamic_cast<CDestroyableObject*>(pObj)->IsDying() )  continue;  // is burning or exploding?
+        CDestroyableObject* otherDestroyable = pObj->GetInterface<ObjectInterfaceType::Destroyable>();
+        if ( otherDestroyable != nullptr && otherDestroyable->IsDying() )  continue;  // is burning or exploding?
 
         oType = pObj->GetType();
         if ( oType == OBJECT_TOTO            )  continue;
         if ( !m_object->CanCollideWith(pObj) )  continue;
 
-        if (pObj->Implements(ObjectInterfaceType::Jostleable))
+        CJostleableObject* jostleable = pObj->GetInterface<ObjectInterfaceType::Jostleable>();
+        if (jostleable != nullptr)
         {
-            JostleObject(dynamic_cast<CJostleableObject*>(pObj), iPos, iRad);
+            JostleObject(jostleable, iPos, iRad);
         }
 
         if ( oType == OBJECT_WAYPOINT &&
@@ -2536,8 +2773,11 @@ int CPhysics::ObjectAdapt(const Math::Vector &pos, const Math::Vector &angle)
             }
         }
 
-        for (const auto& crashSphere : pObj->GetAllCrashSpheres())
+        // Collision handling below may rebuild crash spheres of pObj (e.g. when it gets destroyed)
+        const std::vector<CrashSphere>& crashSpheres = pObj->GetAllCrashSpheres();
+        for (std::size_t i = 0; i < crashSpheres.size(); ++i)
         {
+            const CrashSphere crashSphere = crashSpheres[i];
             Math::Vector oPos = crashSphere.sphere.pos;
             float oRad = crashSphere.sphere.radius;
 
@@ -2602,8 +2842,8 @@ int CPhysics::ObjectAdapt(const Math::Vector &pos, const Math::Vector &angle)
 
 
                     CPhysics* ph = nullptr;
-                    if (pObj->Implements(ObjectInterfaceType::Movable))
-                        ph = dynamic_cast<CMovableObject*>(pObj)->GetPhysics();
+                    if (CMovableObject* movable = pObj->GetInterface<ObjectInterfaceType::Movable>())
+                        ph = movable->GetPhysics();
                     if ( ph != nullptr )
                     {
                         oAngle = pObj->GetRotation();
@@ -2666,11 +2906,10 @@ bool CPhysics::JostleObject(CJostleableObject* pObj, Math::Vector iPos, float iR
 
 bool CPhysics::JostleObject(CObject* pObj, float force)
 {
-    if (! pObj->Implements(ObjectInterfaceType::Jostleable))
+    CJostleableObject* jostleableObject = pObj->GetInterface<ObjectInterfaceType::Jostleable>();
+    if (jostleableObject == nullptr)
         return false;
 
-    CJostleableObject* jostleableObject = dynamic_cast<CJostleableObject*>(pObj);
-
     if ( m_soundTimeJostle >= 0.20f )
     {
         m_soundTimeJostle = 0.0f;
@@ -2981,9 +3220,9 @@ void CPhysics::CrashParticle(float crash)
 
     for ( i=0 ; i<max ; i++ )
     {
-        ppos.x = pos.x + (Math::Rand()-0.5f)*15.0f*crash;
-        ppos.z = pos.z + (Math::Rand()-0.5f)*15.0f*crash;
-        ppos.y = pos.y + Math::Rand()*4.0f;
+        ppos.x = pos.x + (Math::EffectRand()-0.5f)*15.0f*crash;
+        ppos.z = pos.z + (Math::EffectRand()-0.5f)*15.0f*crash;
+        ppos.y = pos.y + Math::EffectRand()*4.0f;
         len = 1.0f-(Math::Distance(ppos, pos)/(15.0f+5.0f));
         if ( len <= 0.0f )  continue;
         speed.x = (ppos.x-pos.x)*0.1f;
@@ -3569,12 +3808,12 @@ void CPhysics::WaterParticle(float aTime, Math::Vector pos, ObjectType type,
         for ( i=0 ; i<nb ; i++ )
         {
             ppos = pos;
-            ppos.x += (Math::Rand()-0.5f)*4.0f;
-            ppos.z += (Math::Rand()-0.5f)*4.0f;
+            ppos.x += (Math::EffectRand()-0.5f)*4.0f;
+            ppos.z += (Math::EffectRand()-0.5f)*4.0f;
             ppos.y += 0.6f;
-            speed.x = (Math::Rand()-0.5f)*12.0f*force;
-            speed.z = (Math::Rand()-0.5f)*12.0f*force;
-            speed.y = 6.0f+Math::Rand()*6.0f*force;
+            speed.x = (Math::EffectRand()-0.5f)*12.0f*force;
+            speed.z = (Math::EffectRand()-0.5f)*12.0f*force;
+            speed.y = 6.0f+Math::EffectRand()*6.0f*force;
             dim.x = 0.5f;
             dim.y = dim.x;
             m_particle->CreateParticle(ppos, speed, dim, Gfx::PARTIDROP, 2.0f, 20.0f, 0.2f);
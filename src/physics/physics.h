@@ -91,6 +91,26 @@ struct Motion
     Math::Vector    finalInclin;    // final inclination
 };
 
+//! Terrain data sampled by CPhysics::PrepareFrame() before the frame update
+struct TerrainSample
+{
+    bool            valid = false;
+    unsigned int    terrainRevision = 0;
+    Math::Vector    position;       // object position at sampling time
+    Math::Vector    rotation;       // object rotation at sampling time
+    float           buildingFactor = 1.0f;
+    Math::Vector    floorAngle;     // rotation adjusted by FloorAngle()
+
+    // Terrain at the end of the frame, if the speeds stay the same
+    Math::Vector    nextPosition;
+    float           nextFloorLevel = 0.0f;
+    bool            nextNormalValid = false;
+    Math::Vector    nextNormal;
+    Math::Vector    nextAnglePosition;  // position passed to FloorAngle()
+    float           nextAngleYaw = 0.0f;
+    Math::Vector    nextFloorAngle;
+};
+
 
 
 
@@ -103,6 +123,12 @@ public:
     void        DeleteObject(bool bAll=false);
 
     bool        EventProcess(const Event &event);
+    void        PrepareFrame(float rTime);
+
+    //! Returns true if the body rests and is not simulated until something disturbs it
+    bool        IsSleeping();
+    //! Forces the body to be simulated again
+    void        WakeUp();
 
     void        SetMotion(CMotion* motion);
 
@@ -181,8 +207,11 @@ protected:
     void        MotorUpdate(float aTime, float rTime);
     void        EffectUpdate(float aTime, float rTime);
     void        UpdateMotionStruct(float rTime, Motion &motion);
+    void        MoveBySpeed(float rTime, const Math::Vector &pos, const Math::Vector &angle, Math::Vector &newpos, Math::Vector &newangle);
     void        FloorAdapt(float aTime, float rTime, Math::Vector &pos, Math::Vector &angle);
     void        FloorAngle(const Math::Vector &pos, Math::Vector &angle);
+    bool        IsTerrainSampleValid(const Math::Vector &pos, const Math::Vector &angle);
+    bool        IsNextTerrainSampleValid(const Math::Vector &pos);
     int         ObjectAdapt(const Math::Vector &pos, const Math::Vector &angle);
     bool        JostleObject(CJostleableObject* pObj, Math::Vector iPos, float iRad);
     bool        JostleObject(CObject* pObj, float force);
@@ -196,6 +225,10 @@ protected:
     void        WheelParticle(TraceColor color, float width);
     void        SetFalling();
 
+    void        FallAsleep();
+    bool        IsResting();
+    bool        IsDisturbed();
+
 protected:
     Gfx::CEngine*       m_engine;
     Gfx::CLightManager* m_lightMan;
@@ -253,4 +286,11 @@ protected:
     float       m_fallingHeight;
     float       m_fallDamageFraction;
     float       m_minFallingHeight;
+    TerrainSample m_terrainSample;
+    bool        m_bSleeping;
+    float       m_sleepTime;        // time spent resting
+    Math::Vector    m_sleepPosition;    // position when the body fell asleep
+    Math::Vector    m_sleepRotation;
+    float       m_sleepEnergy;
+    unsigned int m_sleepTerrainRevision;
 };
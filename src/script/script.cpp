@@ -936,6 +936,14 @@ bool CScript::SendScript(const char* text)
     return true;
 }
 
+// Returns the source of the script.
+
+std::string CScript::GetScriptText()
+{
+    if (m_script == nullptr) return "";
+    return std::string(m_script.get(), m_len);
+}
+
 // Reads a script as a text file.
 
 bool CScript::ReadScript(const char* filename)
@@ -86,6 +86,7 @@ public:
 
     void        New(Ui::CEdit* edit, const char* name);
     bool        SendScript(const char* text);
+    std::string GetScriptText();
     bool        ReadScript(const char* filename);
     bool        WriteScript(const char* filename);
     bool        ReadStack(FILE *file);
@@ -40,6 +40,7 @@
 
 #include "math/all.h"
 
+#include "object/navigation_grid.h"
 #include "object/object.h"
 #include "object/object_manager.h"
 
@@ -1453,6 +1454,88 @@ bool CScriptFunctions::rDistance2d(CBotVar* var, CBotVar* result, int& exception
 }
 
 
+// Compilation of the instruction "reachable(goal)" or "reachable(start, goal)".
+
+CBotTypResult CScriptFunctions::cReachable(CBotVar* &var, void* user)
+{
+    CBotTypResult   ret;
+
+    if ( var == nullptr )  return CBotTypResult(CBotErrLowParam);
+    ret = cPoint(var, user);
+    if ( ret.GetType() != 0 )  return ret;
+
+    if ( var != nullptr )
+    {
+        ret = cPoint(var, user);
+        if ( ret.GetType() != 0 )  return ret;
+    }
+
+    if ( var != nullptr )  return CBotTypResult(CBotErrOverParam);
+
+    return CBotTypResult(CBotTypBoolean);
+}
+
+// Instruction "reachable(goal)" or "reachable(start, goal)".
+// Tells if the robot could drive from start (its position by default)
+// to goal on this terrain; objects in the way are not considered.
+// After the terrain has changed, the answer may take a few frames.
+
+bool CScriptFunctions::rReachable(CBotVar* var, CBotVar* result, int& exception, void* user)
+{
+    CScript*        script = static_cast<CScript*>(user);
+    CObject*        pThis = script->m_object;
+    Math::Vector    start, goal;
+
+    if ( !GetPoint(var, exception, goal) )  return true;
+    if ( var == nullptr )
+    {
+        start = pThis->GetPosition();
+    }
+    else
+    {
+        start = goal;
+        if ( !GetPoint(var, exception, goal) )  return true;
+    }
+
+    // Outside of the map (or not a number), nothing can be reached
+    auto isOnMap = [](const Math::Vector& pos)
+    {
+        return fabs(pos.x) < 1600.0f && fabs(pos.z) < 1600.0f;
+    };
+    if ( !isOnMap(start) || !isOnMap(goal) )
+    {
+        result->SetValInt(false);
+        return true;
+    }
+
+    CNavigationGrid* grid = CObjectManager::GetInstancePointer()->GetNavigationGrid();
+    MobilityClass mobility = CNavigationGrid::GetMobilityClass(pThis->GetType());
+    Math::IntPoint startCell(static_cast<int>((start.x+1600.0f)/NAVIGATION_CELL_SIZE),
+                             static_cast<int>((start.z+1600.0f)/NAVIGATION_CELL_SIZE));
+    Math::IntPoint goalCell(static_cast<int>((goal.x+1600.0f)/NAVIGATION_CELL_SIZE),
+                            static_cast<int>((goal.z+1600.0f)/NAVIGATION_CELL_SIZE));
+
+    // The frame in which a worker thread is done depends on the machine,
+    // recorded games label the terrain right away
+    CJobSystem* jobSystem = nullptr;
+    if ( CApplication::GetInstancePointer()->GetPathSearchBudget() != 0 )
+    {
+        jobSystem = CRobotMain::GetInstancePointer()->GetJobSystem();
+    }
+
+    bool reachable = false;
+    if ( !grid->IsReachable(mobility, startCell, goalCell, jobSystem, reachable) )
+    {
+        script->m_bContinue = true;
+        return false;  // asks again in the next frame
+    }
+
+    script->m_bContinue = false;
+    result->SetValInt(reachable);
+    return true;
+}
+
+
 // Compilation of the instruction "space(center, rMin, rMax, dist)".
 
 CBotTypResult CScriptFunctions::cSpace(CBotVar* &var, void* user)
@@ -3233,6 +3316,7 @@ void CScriptFunctions::Init()
     CBotProgram::AddFunction("produce",   rProduce,   cProduce);
     CBotProgram::AddFunction("distance",  rDistance,  cDistance);
     CBotProgram::AddFunction("distance2d",rDistance2d,cDistance);
+    CBotProgram::AddFunction("reachable", rReachable, cReachable);
     CBotProgram::AddFunction("space",     rSpace,     cSpace);
     CBotProgram::AddFunction("flatspace", rFlatSpace, cFlatSpace);
     CBotProgram::AddFunction("flatground",rFlatGround,cFlatGround);
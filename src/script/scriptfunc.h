@@ -63,6 +63,7 @@ private:
     static CBot::CBotTypResult cDirection(CBot::CBotVar* &var, void* user);
     static CBot::CBotTypResult cProduce(CBot::CBotVar* &var, void* user);
     static CBot::CBotTypResult cDistance(CBot::CBotVar* &var, void* user);
+    static CBot::CBotTypResult cReachable(CBot::CBotVar* &var, void* user);
     static CBot::CBotTypResult cSpace(CBot::CBotVar* &var, void* user);
     static CBot::CBotTypResult cFlatSpace(CBot::CBotVar* &var, void* user);
     static CBot::CBotTypResult cFlatGround(CBot::CBotVar* &var, void* user);
@@ -109,6 +110,7 @@ private:
     static bool rProduce(CBot::CBotVar* var, CBot::CBotVar* result, int& exception, void* user);
     static bool rDistance(CBot::CBotVar* var, CBot::CBotVar* result, int& exception, void* user);
     static bool rDistance2d(CBot::CBotVar* var, CBot::CBotVar* result, int& exception, void* user);
+    static bool rReachable(CBot::CBotVar* var, CBot::CBotVar* result, int& exception, void* user);
     static bool rSpace(CBot::CBotVar* var, CBot::CBotVar* result, int& exception, void* user);
     static bool rFlatSpace(CBot::CBotVar* var, CBot::CBotVar* result, int& exception, void* user);
     static bool rFlatGround(CBot::CBotVar* var, CBot::CBotVar* result, int& exception, void* user);
@@ -59,6 +59,16 @@ public:
     {
         return CApplication::CreateUpdateEvent();
     }
+
+    int PrepareFixedSteps() override
+    {
+        return CApplication::PrepareFixedSteps();
+    }
+
+    Event CreateFixedStepEvent() override
+    {
+        return CApplication::CreateFixedStepEvent();
+    }
 };
 
 class CApplicationUT : public testing::Test
@@ -325,3 +335,61 @@ TEST_F(CApplicationUT, UpdateEventTimeCalculation_SuspendingAndResumingSimulatio
 
     TestCreateUpdateEvent(relTimeExact, absTimeExact, relTime, absTime, relTimeReal, absTimeReal);
 }
+
+TEST_F(CApplicationUT, FixedStepTimeCalculation)
+{
+    const long long stepLength = 10000000; // 10 ms
+    m_app->SetFixedTimeStep(0.01f);
+
+    // 25 ms -- two steps, 5 ms left for next frame
+
+    NextInstant(25000000);
+
+    EXPECT_EQ(2, m_app->PrepareFixedSteps());
+    for (int i = 1; i <= 2; ++i)
+    {
+        Event event = m_app->CreateFixedStepEvent();
+        EXPECT_EQ(EVENT_FRAME, event.type);
+        EXPECT_FLOAT_EQ(stepLength / 1e9f, event.rTime);
+        EXPECT_EQ(stepLength, m_app->GetExactRelTime());
+        EXPECT_EQ(stepLength * i, m_app->GetExactAbsTime());
+    }
+
+    // 4 ms -- not enough for another step
+
+    NextInstant(4000000);
+
+    EXPECT_EQ(0, m_app->PrepareFixedSteps());
+
+    // 1 ms -- leftover from previous frames makes a full step
+
+    NextInstant(1000000);
+
+    EXPECT_EQ(1, m_app->PrepareFixedSteps());
+    m_app->CreateFixedStepEvent();
+    EXPECT_EQ(stepLength * 3, m_app->GetExactAbsTime());
+    EXPECT_EQ(30000000, m_app->GetRealAbsTime());
+
+    // Speed 4x -- same step length, more steps per frame
+
+    m_app->SetSimulationSpeed(4.0f);
+    NextInstant(10000000);
+
+    EXPECT_EQ(4, m_app->PrepareFixedSteps());
+    for (int i = 0; i < 4; ++i)
+    {
+        Event event = m_app->CreateFixedStepEvent();
+        EXPECT_FLOAT_EQ(stepLength / 1e9f, event.rTime);
+    }
+    EXPECT_EQ(stepLength * 7, m_app->GetExactAbsTime());
+}
+
+TEST_F(CApplicationUT, FixedStepTimeCalculation_SimulationSuspended)
+{
+    m_app->SetFixedTimeStep(0.01f);
+    m_app->SuspendSimulation();
+
+    NextInstant(25000000);
+
+    EXPECT_EQ(0, m_app->PrepareFixedSteps());
+}
@@ -0,0 +1,191 @@
+/*
+ * This file is part of the Colobot: Gold Edition source code
+ * Copyright (C) 2001-2016, Daniel Roux, EPSITEC SA & TerranovaTeam
+ * http://epsitec.ch; http://colobot.info; http://github.com/colobot
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://gnu.org/licenses
+ */
+
+#include "app/replay.h"
+
+#include "common/make_unique.h"
+
+#include "math/func.h"
+
+#include <cstdio>
+#include <cstring>
+#include <gtest/gtest.h>
+
+
+class CReplayTest : public testing::Test
+{
+protected:
+    void TearDown() override
+    {
+        std::remove(FILENAME);
+    }
+
+    static constexpr const char* FILENAME = "replay_test.txt";
+};
+
+constexpr const char* CReplayTest::FILENAME;
+
+namespace
+{
+
+//! Runs simulation steps, rendering given number of frames between them, and stores checksums like CApplication does
+void RunSteps(int framesPerStep, CReplayRecorder* recorder, const CReplayPlayer* player)
+{
+    const int steps = 600;
+    const int checksumInterval = 60;
+
+    srand(1234);
+    unsigned long long checksum = 0;
+    for (int step = 1; step <= steps; step++)
+    {
+        // Camera shake and particles drawn in the frame
+        for (int frame = 0; frame < framesPerStep; frame++)
+        {
+            Math::EffectRand();
+            Math::EffectRandom();
+        }
+
+        float value = Math::Rand();
+        unsigned int bits = 0;
+        std::memcpy(&bits, &value, sizeof(bits));
+        checksum = checksum * 31 + bits;
+
+        if (step % checksumInterval != 0) continue;
+        if (recorder != nullptr)
+            recorder->RecordChecksum(step, checksum);
+        if (player != nullptr)
+        {
+            EXPECT_TRUE(player->CheckChecksum(step, checksum)) << "desynchronized at step " << step;
+        }
+    }
+}
+
+} // namespace
+
+TEST_F(CReplayTest, RecordedDataIsReadBack)
+{
+    ReplayHeader header;
+    header.seed = 1234;
+    header.scene = "custom101";
+    header.stepLength = 16666666;
+    header.checksumInterval = 60;
+    header.batchMode = true;
+    header.batchTimeLimit = 0.1f;
+
+    {
+        CReplayRecorder recorder;
+        ASSERT_TRUE(recorder.Open(FILENAME, header));
+
+        ReplayProgram program;
+        program.objectId = 7;
+        program.index = 1;
+        program.source = "extern void object::Test()\n{\n\tmove(10);\n}\n";
+        recorder.RecordProgram(program);
+
+        // Stored again after the mission was restarted
+        program.restart = 1;
+        program.source = "extern void object::Test()\n{\n\tmove(20);\n}\n";
+        recorder.RecordProgram(program);
+
+        Event key(EVENT_KEY_DOWN);
+        auto keyData = MakeUnique<KeyEventData>();
+        keyData->key = 97;
+        keyData->slot = INPUT_SLOT_UP;
+        key.data = std::move(keyData);
+        key.kmodState = 3;
+        key.mousePos = Math::Point(0.123f, 0.456f);
+        recorder.RecordEvent(key);
+
+        Event text(EVENT_TEXT_INPUT);
+        auto textData = MakeUnique<TextInputData>();
+        textData->text = "a b\n";
+        text.data = std::move(textData);
+        recorder.RecordEvent(text);
+
+        recorder.RecordFrameEnd(2);
+        recorder.RecordFrameEnd(0); // empty, not stored
+        recorder.RecordChecksum(60, 0xFEDCBA9876543210ULL);
+        recorder.RecordFrameEnd(1);
+    }
+
+    CReplayPlayer player;
+    ASSERT_TRUE(player.Open(FILENAME));
+
+    EXPECT_EQ(1234u, player.GetHeader().seed);
+    EXPECT_EQ("custom101", player.GetHeader().scene);
+    EXPECT_EQ(16666666, player.GetHeader().stepLength);
+    EXPECT_EQ(60, player.GetHeader().checksumInterval);
+    EXPECT_TRUE(player.GetHeader().batchMode);
+    EXPECT_EQ(0.1f, player.GetHeader().batchTimeLimit);
+
+    const ReplayProgram* program = player.GetProgram(7, 1);
+    ASSERT_NE(nullptr, program);
+    EXPECT_EQ("extern void object::Test()\n{\n\tmove(10);\n}\n", program->source);
+    EXPECT_EQ(nullptr, player.GetProgram(7, 0));
+    program = player.GetProgram(7, 1, 1);
+    ASSERT_NE(nullptr, program);
+    EXPECT_EQ("extern void object::Test()\n{\n\tmove(20);\n}\n", program->source);
+    EXPECT_EQ(nullptr, player.GetProgram(7, 1, 2));
+
+    ASSERT_FALSE(player.IsFinished());
+    EXPECT_EQ(2, player.GetNextFrameSteps());
+    ReplayFrame frame = player.TakeNextFrame();
+    ASSERT_EQ(2u, frame.events.size());
+
+    EXPECT_EQ(EVENT_KEY_DOWN, frame.events[0].type);
+    EXPECT_EQ(97u, frame.events[0].GetData<KeyEventData>()->key);
+    EXPECT_EQ(INPUT_SLOT_UP, frame.events[0].GetData<KeyEventData>()->slot);
+    EXPECT_EQ(3u, frame.events[0].kmodState);
+    EXPECT_EQ(0.123f, frame.events[0].mousePos.x);
+    EXPECT_EQ(0.456f, frame.events[0].mousePos.y);
+
+    EXPECT_EQ(EVENT_TEXT_INPUT, frame.events[1].type);
+    EXPECT_EQ("a b\n", frame.events[1].GetData<TextInputData>()->text);
+
+    frame = player.TakeNextFrame();
+    EXPECT_EQ(1, frame.steps);
+    EXPECT_TRUE(frame.events.empty());
+    EXPECT_TRUE(player.IsFinished());
+
+    EXPECT_TRUE(player.CheckChecksum(60, 0xFEDCBA9876543210ULL));
+    EXPECT_FALSE(player.CheckChecksum(60, 0x0123456789ABCDEFULL));
+    EXPECT_TRUE(player.CheckChecksum(120, 0)); // not recorded
+}
+
+TEST_F(CReplayTest, RenderedFramesDontChangeSimulation)
+{
+    ReplayHeader header;
+    header.seed = 1234;
+    header.scene = "custom101";
+    header.stepLength = 16666666;
+    header.checksumInterval = 60;
+
+    {
+        CReplayRecorder recorder;
+        ASSERT_TRUE(recorder.Open(FILENAME, header));
+        RunSteps(1, &recorder, nullptr);
+    }
+
+    CReplayPlayer player;
+    ASSERT_TRUE(player.Open(FILENAME));
+
+    // Slower and faster machines render different number of frames per step
+    RunSteps(0, nullptr, &player);
+    RunSteps(3, nullptr, &player);
+}
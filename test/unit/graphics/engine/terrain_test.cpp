@@ -0,0 +1,217 @@
+/*
+ * This file is part of the Colobot: Gold Edition source code
+ * Copyright (C) 2001-2016, Daniel Roux, EPSITEC SA & TerranovaTeam
+ * http://epsitec.ch; http://colobot.info; http://github.com/colobot
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://gnu.org/licenses
+ */
+
+#include "graphics/engine/terrain.h"
+
+#include "graphics/engine/engine.h"
+
+#include "math/func.h"
+
+#include <cmath>
+
+#include <gtest/gtest.h>
+#include <hippomocks.h>
+
+using namespace Gfx;
+using namespace HippoMocks;
+
+namespace
+{
+
+const int   BRICK_COUNT = 16;
+const float BRICK_SIZE  = 10.0f;
+const float HALF_SIZE   = BRICK_COUNT*BRICK_SIZE/2.0f;
+
+//! Terrain made of one mosaic with heights given directly
+class CTestTerrain : public CTerrain
+{
+public:
+    template<typename F>
+    explicit CTestTerrain(F height)
+    {
+        m_mosaicCount = 1;
+        m_brickCount = BRICK_COUNT;
+        m_brickSize = BRICK_SIZE;
+
+        m_relief.resize((BRICK_COUNT+1)*(BRICK_COUNT+1));
+        for (int y = 0; y <= BRICK_COUNT; y++)
+        {
+            for (int x = 0; x <= BRICK_COUNT; x++)
+            {
+                m_relief[x+y*(BRICK_COUNT+1)] = height(x*BRICK_SIZE-HALF_SIZE, y*BRICK_SIZE-HALF_SIZE);
+            }
+        }
+        m_heightBoundsDirty = true;
+    }
+};
+
+//! Pseudo-random hills, same on every platform
+float Hills(float x, float z)
+{
+    return 20.0f*sinf(x*0.07f)*cosf(z*0.05f) + 8.0f*sinf(x*0.3f+z*0.2f);
+}
+
+} // namespace
+
+class CTerrainUT : public testing::Test
+{
+protected:
+    ~CTerrainUT() NOEXCEPT
+    {}
+
+    void SetUp() override
+    {
+        m_engine = m_mocks.Mock<CEngine>();
+        CEngine::ReplaceInstance(m_engine);
+    }
+
+    void TearDown() override
+    {
+        CEngine::ReplaceInstance(nullptr);
+    }
+
+    MockRepository m_mocks;
+    CEngine* m_engine = nullptr;
+};
+
+TEST_F(CTerrainUT, IntersectRayFlat)
+{
+    CTestTerrain terrain([](float, float) { return 5.0f; });
+
+    Math::Vector hit;
+    ASSERT_TRUE(terrain.IntersectRay(Math::Vector(12.0f, 50.0f, -7.0f), Math::Vector(0.0f, -2.0f, 0.0f), 100.0f, hit));
+    EXPECT_NEAR(12.0f, hit.x, 1e-3f);
+    EXPECT_NEAR( 5.0f, hit.y, 1e-3f);
+    EXPECT_NEAR(-7.0f, hit.z, 1e-3f);
+
+    // Too short, parallel, pointing away and outside of the terrain
+    EXPECT_FALSE(terrain.IntersectRay(Math::Vector(12.0f, 50.0f, -7.0f), Math::Vector(0.0f, -1.0f, 0.0f), 40.0f, hit));
+    EXPECT_FALSE(terrain.IntersectRay(Math::Vector(-70.0f, 6.0f, 0.0f), Math::Vector(1.0f, 0.0f, 0.0f), 1000.0f, hit));
+    EXPECT_FALSE(terrain.IntersectRay(Math::Vector(0.0f, 6.0f, 0.0f), Math::Vector(0.0f, 1.0f, 0.0f), 1000.0f, hit));
+    EXPECT_FALSE(terrain.IntersectRay(Math::Vector(500.0f, 50.0f, 0.0f), Math::Vector(0.0f, -1.0f, 0.0f), 1000.0f, hit));
+}
+
+TEST_F(CTerrainUT, IntersectRaySlope)
+{
+    // A plane is represented exactly by the triangles
+    CTestTerrain terrain([](float x, float z) { return 0.5f*x + 0.25f*z + 3.0f; });
+
+    Math::Vector origin(-60.0f, 40.0f, 10.0f);
+    Math::Vector dir(1.0f, -0.5f, 0.2f);
+    Math::Vector hit;
+    ASSERT_TRUE(terrain.IntersectRay(origin, dir, 1000.0f, hit));
+
+    // origin.y + t*dir.y = 0.5*(origin.x + t*dir.x) + 0.25*(origin.z + t*dir.z) + 3
+    float t = (0.5f*origin.x + 0.25f*origin.z + 3.0f - origin.y) /
+              (dir.y - 0.5f*dir.x - 0.25f*dir.z);
+    Math::Vector expected = origin + dir*t;
+    EXPECT_NEAR(expected.x, hit.x, 1e-3f);
+    EXPECT_NEAR(expected.y, hit.y, 1e-3f);
+    EXPECT_NEAR(expected.z, hit.z, 1e-3f);
+}
+
+TEST_F(CTerrainUT, IntersectRayNearestHill)
+{
+    // Two walls across the x axis, the ray has to stop at the first one
+    CTestTerrain terrain([](float x, float) { return (x == -20.0f || x == 30.0f) ? 50.0f : 0.0f; });
+
+    Math::Vector hit;
+    ASSERT_TRUE(terrain.IntersectRay(Math::Vector(-70.0f, 10.0f, 1.0f), Math::Vector(1.0f, 0.0f, 0.0f), 1000.0f, hit));
+    EXPECT_NEAR(-28.0f, hit.x, 1e-3f);  // wall rises from 0 to 50 between -30 and -20
+
+    ASSERT_TRUE(terrain.IntersectRay(Math::Vector(70.0f, 10.0f, 1.0f), Math::Vector(-1.0f, 0.0f, 0.0f), 1000.0f, hit));
+    EXPECT_NEAR(38.0f, hit.x, 1e-3f);
+}
+
+TEST_F(CTerrainUT, IntersectRayMatchesFloorLevel)
+{
+    CTestTerrain terrain(Hills);
+
+    int hits = 0;
+    for (int i = 0; i < 200; i++)
+    {
+        Math::Vector origin(-70.0f + (i%20)*7.0f, 40.0f + (i%7)*3.0f, -70.0f + (i/20)*14.0f);
+        Math::Vector dir(cosf(i*0.37f), -0.2f - (i%5)*0.15f, sinf(i*0.37f));
+
+        Math::Vector hit;
+        bool found = terrain.IntersectRay(origin, dir, 400.0f, hit);
+
+        // Marches along the ray with small steps
+        const float STEP = 0.05f;
+        Math::Vector d = Math::Normalize(dir);
+        float marched = -1.0f;
+        for (float t = 0.0f; t < 400.0f; t += STEP)
+        {
+            Math::Vector p = origin + d*t;
+            if (fabs(p.x) >= HALF_SIZE || fabs(p.z) >= HALF_SIZE) break;
+            if (p.y <= terrain.GetFloorLevel(p, true))
+            {
+                marched = t;
+                break;
+            }
+        }
+
+        ASSERT_EQ(marched >= 0.0f, found) << "ray " << i;
+        if (!found) continue;
+
+        hits++;
+        EXPECT_NEAR(terrain.GetFloorLevel(hit, true), hit.y, 1e-2f) << "ray " << i;
+        EXPECT_NEAR(marched, Math::Distance(origin, hit), STEP*2.0f) << "ray " << i;
+    }
+    EXPECT_GT(hits, 50);
+}
+
+TEST_F(CTerrainUT, ChangedAreas)
+{
+    CTestTerrain terrain([](float, float) { return 0.0f; });
+    unsigned int revision = terrain.GetRevision();
+
+    std::vector<CTerrain::ChangedArea> areas;
+    ASSERT_TRUE(terrain.GetChangedAreas(revision, areas));
+    EXPECT_TRUE(areas.empty());
+
+    terrain.AddBuildingLevel(Math::Vector(10.0f, 0.0f, -20.0f), 5.0f, 15.0f, 1.0f, 0.5f);
+    terrain.AddBuildingLevel(Math::Vector(-30.0f, 0.0f, 40.0f), 5.0f, 10.0f, 1.0f, 0.5f);
+    ASSERT_TRUE(terrain.GetChangedAreas(revision, areas));
+    ASSERT_EQ(2u, areas.size());
+    EXPECT_EQ(revision+1, areas[0].revision);
+    EXPECT_FLOAT_EQ( -5.0f, areas[0].min.x);
+    EXPECT_FLOAT_EQ(-35.0f, areas[0].min.y);
+    EXPECT_FLOAT_EQ( 25.0f, areas[0].max.x);
+    EXPECT_FLOAT_EQ( -5.0f, areas[0].max.y);
+
+    // Only the areas after given revision
+    ASSERT_TRUE(terrain.GetChangedAreas(revision+1, areas));
+    ASSERT_EQ(1u, areas.size());
+    EXPECT_FLOAT_EQ(-40.0f, areas[0].min.x);
+
+    // Deleting a level changes where it was, deleting a missing one changes nothing
+    unsigned int deleted = terrain.GetRevision();
+    EXPECT_TRUE(terrain.DeleteBuildingLevel(Math::Vector(10.0f, 0.0f, -20.0f)));
+    EXPECT_FALSE(terrain.DeleteBuildingLevel(Math::Vector(70.0f, 0.0f, 70.0f)));
+    ASSERT_TRUE(terrain.GetChangedAreas(deleted, areas));
+    ASSERT_EQ(1u, areas.size());
+    EXPECT_FLOAT_EQ(25.0f, areas[0].max.x);
+
+    // A change of the whole terrain can't be narrowed
+    terrain.FlushBuildingLevel();
+    EXPECT_FALSE(terrain.GetChangedAreas(revision, areas));
+    EXPECT_TRUE(terrain.GetChangedAreas(terrain.GetRevision(), areas));
+    EXPECT_TRUE(areas.empty());
+}
@@ -0,0 +1,82 @@
+/*
+ * This file is part of the Colobot: Gold Edition source code
+ * Copyright (C) 2001-2016, Daniel Roux, EPSITEC SA & TerranovaTeam
+ * http://epsitec.ch; http://colobot.info; http://github.com/colobot
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://gnu.org/licenses
+ */
+
+/**
+ * \file object/fake_object.h
+ * \brief Minimal object for tests of containers and indexes of objects
+ */
+
+#pragma once
+
+#include "object/object.h"
+#include "object/object_manager.h"
+
+#include <algorithm>
+
+/**
+ * \class CFakeObject
+ * \brief Object without model, whose crash spheres are only moved by its position and scaled
+ */
+class CFakeObject : public CObject
+{
+public:
+    explicit CFakeObject(int id, ObjectType type = OBJECT_STONE)
+        : CObject(id, type)
+    {}
+
+    void Write(CLevelParserLine*) override {}
+    void Read(CLevelParserLine*) override {}
+    void SetTransparency(float) override {}
+
+    //! Switches interface like COldObject does with SetMovable() etc.
+    void SetInterface(ObjectInterfaceType type, bool implements)
+    {
+        SetImplements(type, implements);
+    }
+
+    void SetPosition(const Math::Vector& pos) override
+    {
+        m_position = pos;
+        InvalidateCrashSpheres();
+        if (CObjectManager::IsCreated())
+            CObjectManager::GetInstancePointer()->UpdateObjectPosition(this);
+    }
+
+    using CObject::SetScale;
+    void SetScale(const Math::Vector& scale) override
+    {
+        m_scale = scale;
+        InvalidateCrashSpheres();
+    }
+
+protected:
+    void TransformCrashSphere(Math::Sphere& crashSphere) override
+    {
+        crashSphere.pos.x *= m_scale.x;
+        crashSphere.pos.y *= m_scale.y;
+        crashSphere.pos.z *= m_scale.z;
+        crashSphere.radius *= std::max(m_scale.x, std::max(m_scale.y, m_scale.z));
+        crashSphere.pos += m_position;
+    }
+
+    void TransformCameraCollisionSphere(Math::Sphere& collisionSphere) override
+    {
+        collisionSphere.pos += m_position;
+    }
+};
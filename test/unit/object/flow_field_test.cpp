@@ -0,0 +1,119 @@
+/*
+ * This file is part of the Colobot: Gold Edition source code
+ * Copyright (C) 2001-2016, Daniel Roux, EPSITEC SA & TerranovaTeam
+ * http://epsitec.ch; http://colobot.info; http://github.com/colobot
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://gnu.org/licenses
+ */
+
+#include "object/flow_field.h"
+
+#include "object/path_planner.h"
+
+#include <cstring>
+#include <gtest/gtest.h>
+
+
+namespace
+{
+
+// Builds a map from rows of text, '#' being a blocked cell
+std::shared_ptr<PathMap> MakeMap(const std::vector<const char*>& rows)
+{
+    auto map = std::make_shared<PathMap>();
+    map->width = static_cast<int>(strlen(rows[0]));
+    map->height = static_cast<int>(rows.size());
+    for (const char* row : rows)
+    {
+        for (int x = 0; x < map->width; ++x)
+            map->blocked.push_back(row[x] == '#' ? 1 : 0);
+    }
+    return map;
+}
+
+} // namespace
+
+TEST(CFlowFieldTest, DistancesMatchPlanner)
+{
+    auto map = MakeMap({
+        "..........#.........",
+        "...####...#...####..",
+        "......#...#......#..",
+        "......#......#...#..",
+        "..#####......#......",
+        ".............#####..",
+    });
+    CFlowField field(map, Math::IntPoint(19, 5));
+
+    for (int y = 0; y < map->height; ++y)
+    {
+        for (int x = 0; x < map->width; ++x)
+        {
+            if (!map->IsFree(x, y)) continue;
+
+            std::vector<Math::IntPoint> path;
+            ASSERT_TRUE(field.Trace(Math::IntPoint(x, y), 0.0f, path));
+            EXPECT_EQ(19, path.back().x);
+            EXPECT_EQ(5, path.back().y);
+
+            // The field gives a shortest path, like the planner
+            CPathPlanner planner(map, Math::IntPoint(x, y), Math::IntPoint(19, 5), 0.0f);
+            ASSERT_EQ(PathStatus::Found, planner.Run());
+            float length = 0.0f;
+            const std::vector<Math::IntPoint>& jumps = planner.GetPath();
+            for (std::size_t i = 1; i < jumps.size(); ++i)
+            {
+                int dx = abs(jumps[i].x - jumps[i-1].x);
+                int dy = abs(jumps[i].y - jumps[i-1].y);
+                length += std::max(dx, dy) + (sqrtf(2.0f) - 1.0f) * std::min(dx, dy);
+            }
+            EXPECT_NEAR(length, field.GetDistance(x, y), 1e-3f);
+        }
+    }
+}
+
+TEST(CFlowFieldTest, UnreachableCells)
+{
+    auto map = MakeMap({
+        "..#...",
+        "..#...",
+        "###...",
+        "......",
+    });
+    CFlowField field(map, Math::IntPoint(5, 3));
+
+    std::vector<Math::IntPoint> path;
+    EXPECT_FALSE(field.Trace(Math::IntPoint(0, 0), 0.0f, path));
+    EXPECT_TRUE(path.empty());
+    EXPECT_EQ(-1, field.GetDirection(1, 1));
+    EXPECT_EQ(4*3 + 3, field.GetReachableCount());
+}
+
+TEST(CFlowFieldTest, BlockedGoal)
+{
+    auto map = MakeMap({
+        "......",
+        "......",
+        ".....#",
+    });
+    CFlowField field(map, Math::IntPoint(5, 2));
+
+    std::vector<Math::IntPoint> path;
+    ASSERT_TRUE(field.Trace(Math::IntPoint(0, 0), 0.0f, path));
+    EXPECT_EQ(5, path.back().x);
+    EXPECT_EQ(2, path.back().y);
+
+    ASSERT_TRUE(field.Trace(Math::IntPoint(0, 0), 2.0f, path));
+    EXPECT_LE(Math::IntPoint(path.back().x - 5, path.back().y - 2).Length(), 2.0f);
+}
@@ -0,0 +1,236 @@
+/*
+ * This file is part of the Colobot: Gold Edition source code
+ * Copyright (C) 2001-2016, Daniel Roux, EPSITEC SA & TerranovaTeam
+ * http://epsitec.ch; http://colobot.info; http://github.com/colobot
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://gnu.org/licenses
+ */
+
+#include "object/object_bvh.h"
+
+#include "object/fake_object.h"
+
+#include "math/geometry.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+
+namespace
+{
+
+//! Deterministic numbers in [0, 1)
+class CSequence
+{
+public:
+    float Next()
+    {
+        m_state = m_state * 1103515245u + 12345u;
+        return ((m_state >> 8) & 0xFFFF) / 65536.0f;
+    }
+
+    float Next(float min, float max)
+    {
+        return min + Next() * (max - min);
+    }
+
+private:
+    unsigned int m_state = 1;
+};
+
+std::unique_ptr<CFakeObject> MakeObject(int id, CSequence& sequence)
+{
+    std::unique_ptr<CFakeObject> object(new CFakeObject(id));
+    object->SetPosition(Math::Vector(sequence.Next(-500.0f, 500.0f), sequence.Next(0.0f, 50.0f), sequence.Next(-500.0f, 500.0f)));
+
+    int sphereCount = static_cast<int>(sequence.Next(0.0f, 3.0f));
+    for (int i = 0; i < sphereCount; ++i)
+    {
+        Math::Vector offset(sequence.Next(-10.0f, 10.0f), sequence.Next(0.0f, 10.0f), sequence.Next(-10.0f, 10.0f));
+        object->AddCrashSphere(CrashSphere(offset, sequence.Next(0.0f, 8.0f)));
+    }
+    object->SetCameraCollisionSphere(Math::Sphere(Math::Vector(0.0f, 5.0f, 0.0f), sequence.Next(0.0f, 15.0f)));
+    return object;
+}
+
+//! Objects whose box enclosing the position and all spheres overlaps the query box, like in the tree
+std::vector<CObject*> BruteForceBox(const std::vector<std::unique_ptr<CFakeObject>>& objects,
+                                    const Math::Vector& min, const Math::Vector& max)
+{
+    std::vector<CObject*> result;
+    for (const auto& object : objects)
+    {
+        if (object == nullptr) continue;
+
+        std::vector<Math::Sphere> spheres = { Math::Sphere(object->GetPosition(), 0.0f), object->GetCameraCollisionSphere() };
+        for (const CrashSphere& crashSphere : object->GetAllCrashSpheres())
+            spheres.push_back(crashSphere.sphere);
+
+        Math::Vector boundsMin = object->GetPosition();
+        Math::Vector boundsMax = object->GetPosition();
+        for (const Math::Sphere& sphere : spheres)
+        {
+            boundsMin.x = std::min(boundsMin.x, sphere.pos.x - sphere.radius);
+            boundsMin.y = std::min(boundsMin.y, sphere.pos.y - sphere.radius);
+            boundsMin.z = std::min(boundsMin.z, sphere.pos.z - sphere.radius);
+            boundsMax.x = std::max(boundsMax.x, sphere.pos.x + sphere.radius);
+            boundsMax.y = std::max(boundsMax.y, sphere.pos.y + sphere.radius);
+            boundsMax.z = std::max(boundsMax.z, sphere.pos.z + sphere.radius);
+        }
+
+        if (boundsMin.x <= max.x && boundsMax.x >= min.x &&
+            boundsMin.y <= max.y && boundsMax.y >= min.y &&
+            boundsMin.z <= max.z && boundsMax.z >= min.z)
+        {
+            result.push_back(object.get());
+        }
+    }
+    return result;
+}
+
+//! Objects whose camera collision sphere is crossed by the segment
+std::vector<CObject*> SegmentHits(const std::vector<CObject*>& objects, const Math::Vector& start, const Math::Vector& end)
+{
+    std::vector<CObject*> result;
+    for (CObject* object : objects)
+    {
+        Math::Sphere sphere = object->GetCameraCollisionSphere();
+        if (sphere.radius == 0.0f) continue;
+
+        Math::Vector dir = end - start;
+        float t = Math::DotProduct(sphere.pos - start, dir) / Math::DotProduct(dir, dir);
+        t = Math::Clamp(t, 0.0f, 1.0f);
+        if (Math::Distance(start + dir * t, sphere.pos) <= sphere.radius)
+            result.push_back(object);
+    }
+    return result;
+}
+
+class CObjectBVHTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        for (int id = 0; id < 300; ++id)
+        {
+            m_objects.push_back(MakeObject(id, m_sequence));
+            m_bvh.Add(m_objects.back().get());
+        }
+    }
+
+    //! Compares random box queries with brute force
+    void CheckBoxes(int count)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            Math::Vector center(m_sequence.Next(-550.0f, 550.0f), m_sequence.Next(-10.0f, 60.0f), m_sequence.Next(-550.0f, 550.0f));
+            Math::Vector extent(m_sequence.Next(0.0f, 80.0f), m_sequence.Next(0.0f, 30.0f), m_sequence.Next(0.0f, 80.0f));
+            ASSERT_EQ(BruteForceBox(m_objects, center - extent, center + extent), m_bvh.QueryBox(center - extent, center + extent));
+        }
+    }
+
+    CSequence m_sequence;
+    std::vector<std::unique_ptr<CFakeObject>> m_objects;
+    CObjectBVH m_bvh;
+};
+
+} // namespace
+
+TEST_F(CObjectBVHTest, BuildAndQueryBox)
+{
+    CheckBoxes(200);
+
+    // Everything and nothing
+    EXPECT_EQ(m_objects.size(), m_bvh.QueryBox(Math::Vector(-1000.0f, -1000.0f, -1000.0f), Math::Vector(1000.0f, 1000.0f, 1000.0f)).size());
+    EXPECT_TRUE(m_bvh.QueryBox(Math::Vector(2000.0f, 0.0f, 0.0f), Math::Vector(2100.0f, 10.0f, 10.0f)).empty());
+}
+
+TEST_F(CObjectBVHTest, RefitAfterMoves)
+{
+    CheckBoxes(20);
+
+    for (int i = 0; i < 100; ++i)
+    {
+        CFakeObject* object = m_objects[static_cast<int>(m_sequence.Next(0.0f, 300.0f))].get();
+        Math::Vector oldPosition = object->GetPosition();
+        object->SetPosition(oldPosition + Math::Vector(m_sequence.Next(-200.0f, 200.0f), 0.0f, m_sequence.Next(-200.0f, 200.0f)));
+        m_bvh.Update(object);
+    }
+    CheckBoxes(200);
+
+    // Change of shape only
+    for (int i = 0; i < 50; ++i)
+    {
+        CFakeObject* object = m_objects[i].get();
+        object->SetCameraCollisionSphere(Math::Sphere(Math::Vector(0.0f, 5.0f, 0.0f), m_sequence.Next(0.0f, 40.0f)));
+        m_bvh.Update(object);
+    }
+    CheckBoxes(200);
+}
+
+TEST_F(CObjectBVHTest, AddAndRemove)
+{
+    for (int i = 0; i < 300; i += 3)
+    {
+        m_bvh.Remove(m_objects[i].get());
+        m_objects[i].reset();
+    }
+    CheckBoxes(100);
+
+    for (int id = 300; id < 350; ++id)
+    {
+        m_objects.push_back(MakeObject(id, m_sequence));
+        m_bvh.Add(m_objects.back().get());
+    }
+    CheckBoxes(100);
+
+    m_bvh.Clear();
+    EXPECT_TRUE(m_bvh.QueryBox(Math::Vector(-1000.0f, -1000.0f, -1000.0f), Math::Vector(1000.0f, 1000.0f, 1000.0f)).empty());
+}
+
+TEST_F(CObjectBVHTest, SegmentsLikeCamera)
+{
+    // CCamera::IsCollisionBack() queries the box around the eye and lookat
+    // and tests the segment on the candidates; this has to find the same
+    // objects as the test on all of them
+    std::vector<CObject*> all;
+    for (const auto& object : m_objects)
+        all.push_back(object.get());
+
+    int hits = 0;
+    for (int i = 0; i < 300; ++i)
+    {
+        Math::Vector start(m_sequence.Next(-500.0f, 500.0f), m_sequence.Next(0.0f, 60.0f), m_sequence.Next(-500.0f, 500.0f));
+        Math::Vector end = start + Math::Vector(m_sequence.Next(-100.0f, 100.0f), m_sequence.Next(-30.0f, 30.0f), m_sequence.Next(-100.0f, 100.0f));
+
+        Math::Vector min(std::min(start.x, end.x), std::min(start.y, end.y), std::min(start.z, end.z));
+        Math::Vector max(std::max(start.x, end.x), std::max(start.y, end.y), std::max(start.z, end.z));
+
+        std::vector<CObject*> expected = SegmentHits(all, start, end);
+        ASSERT_EQ(expected, SegmentHits(m_bvh.QueryBox(min, max), start, end));
+        hits += static_cast<int>(expected.size());
+    }
+    EXPECT_GT(hits, 0);
+}
+
+TEST_F(CObjectBVHTest, ResultsOrderedById)
+{
+    std::vector<CObject*> result = m_bvh.QueryBox(Math::Vector(-300.0f, -100.0f, -300.0f), Math::Vector(300.0f, 100.0f, 300.0f));
+    ASSERT_FALSE(result.empty());
+    for (std::size_t i = 1; i < result.size(); ++i)
+        EXPECT_LT(result[i-1]->GetID(), result[i]->GetID());
+}
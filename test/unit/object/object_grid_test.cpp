@@ -0,0 +1,131 @@
+/*
+ * This file is part of the Colobot: Gold Edition source code
+ * Copyright (C) 2001-2016, Daniel Roux, EPSITEC SA & TerranovaTeam
+ * http://epsitec.ch; http://colobot.info; http://github.com/colobot
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://gnu.org/licenses
+ */
+
+#include "object/object_grid.h"
+
+#include "object/fake_object.h"
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+
+namespace
+{
+
+const float CELL_SIZE = 40.0f;
+
+bool Contains(const std::vector<CObject*>& objects, CObject* object)
+{
+    return std::find(objects.begin(), objects.end(), object) != objects.end();
+}
+
+} // namespace
+
+TEST(CObjectGridTest, AddMoveRemove)
+{
+    CObjectGrid grid(CELL_SIZE);
+    CFakeObject object(1);
+    object.SetPosition(Math::Vector(10.0f, 0.0f, 10.0f));
+    grid.Add(&object);
+
+    EXPECT_TRUE(Contains(grid.QueryRadius(Math::Vector(10.0f, 0.0f, 10.0f), 1.0f), &object));
+
+    object.SetPosition(Math::Vector(500.0f, 0.0f, -300.0f));
+    grid.Update(&object);
+    EXPECT_FALSE(Contains(grid.QueryRadius(Math::Vector(10.0f, 0.0f, 10.0f), 1.0f), &object));
+    EXPECT_TRUE(Contains(grid.QueryRadius(Math::Vector(500.0f, 0.0f, -300.0f), 1.0f), &object));
+
+    grid.Remove(&object);
+    EXPECT_TRUE(grid.QueryRadius(Math::Vector(500.0f, 0.0f, -300.0f), 1.0f).empty());
+
+    // Not added objects are ignored
+    grid.Update(&object);
+    grid.Remove(&object);
+    EXPECT_TRUE(grid.QueryRadius(Math::Vector(500.0f, 0.0f, -300.0f), 1.0f).empty());
+}
+
+TEST(CObjectGridTest, CellBorders)
+{
+    CObjectGrid grid(CELL_SIZE);
+    CFakeObject onBorder(1);
+    onBorder.SetPosition(Math::Vector(CELL_SIZE, 0.0f, 0.0f));
+    grid.Add(&onBorder);
+    CFakeObject belowZero(2);
+    belowZero.SetPosition(Math::Vector(-0.1f, 0.0f, 0.0f));
+    grid.Add(&belowZero);
+
+    // The border belongs to the cell above it
+    EXPECT_TRUE(Contains(grid.QueryBox(Math::Vector(CELL_SIZE, 0.0f, 0.0f), Math::Vector(CELL_SIZE, 0.0f, 0.0f)), &onBorder));
+    EXPECT_FALSE(Contains(grid.QueryBox(Math::Vector(0.0f, 0.0f, 0.0f), Math::Vector(CELL_SIZE - 0.1f, 0.0f, 0.0f)), &onBorder));
+
+    EXPECT_FALSE(Contains(grid.QueryBox(Math::Vector(0.0f, 0.0f, 0.0f), Math::Vector(1.0f, 0.0f, 1.0f)), &belowZero));
+    EXPECT_TRUE(Contains(grid.QueryBox(Math::Vector(-0.1f, 0.0f, 0.0f), Math::Vector(0.0f, 0.0f, 0.0f)), &belowZero));
+
+    // Query touching both cells
+    std::vector<CObject*> both = grid.QueryRadius(Math::Vector(CELL_SIZE / 2.0f, 0.0f, 0.0f), CELL_SIZE / 2.0f + 0.1f);
+    ASSERT_EQ(2u, both.size());
+    EXPECT_EQ(&onBorder, both[0]);
+    EXPECT_EQ(&belowZero, both[1]);
+}
+
+TEST(CObjectGridTest, ResultsOrderedById)
+{
+    CObjectGrid grid(CELL_SIZE);
+    std::vector<std::unique_ptr<CFakeObject>> objects;
+    for (int i = 0; i < 50; ++i)
+    {
+        // Ids in reverse order of cells
+        objects.push_back(std::unique_ptr<CFakeObject>(new CFakeObject(100 - i)));
+        objects.back()->SetPosition(Math::Vector(i * 13.0f - 300.0f, 0.0f, i * 7.0f));
+        grid.Add(objects.back().get());
+    }
+
+    std::vector<CObject*> result = grid.QueryBox(Math::Vector(-400.0f, 0.0f, -400.0f), Math::Vector(400.0f, 0.0f, 400.0f));
+    ASSERT_EQ(objects.size(), result.size());
+    for (std::size_t i = 1; i < result.size(); ++i)
+        EXPECT_LT(result[i-1]->GetID(), result[i]->GetID());
+}
+
+TEST(CObjectGridTest, HugeQueries)
+{
+    CObjectGrid grid(CELL_SIZE);
+    CFakeObject inside(1);
+    inside.SetPosition(Math::Vector(100.0f, 0.0f, 100.0f));
+    grid.Add(&inside);
+    CFakeObject outside(2);
+    outside.SetPosition(Math::Vector(1.0e6f, 0.0f, -1.0e30f));
+    grid.Add(&outside);
+
+    EXPECT_EQ(2u, grid.QueryRadius(Math::Vector(0.0f, 0.0f, 0.0f), 1.0e30f).size());
+    EXPECT_EQ(2u, grid.QueryRadius(Math::Vector(0.0f, 0.0f, 0.0f), std::numeric_limits<float>::infinity()).size());
+    EXPECT_EQ(2u, grid.QueryBox(Math::Vector(-1.0e30f, -1.0e30f, -1.0e30f), Math::Vector(1.0e30f, 1.0e30f, 1.0e30f)).size());
+
+    // Objects out of the map are still found around their position
+    EXPECT_TRUE(Contains(grid.QueryRadius(outside.GetPosition(), 1.0f), &outside));
+    EXPECT_FALSE(Contains(grid.QueryRadius(outside.GetPosition(), 1.0f), &inside));
+
+    // Invalid values must not crash
+    float nan = std::numeric_limits<float>::quiet_NaN();
+    grid.QueryRadius(Math::Vector(nan, nan, nan), 10.0f);
+    grid.QueryRadius(Math::Vector(0.0f, 0.0f, 0.0f), nan);
+}
@@ -0,0 +1,193 @@
+/*
+ * This file is part of the Colobot: Gold Edition source code
+ * Copyright (C) 2001-2016, Daniel Roux, EPSITEC SA & TerranovaTeam
+ * http://epsitec.ch; http://colobot.info; http://github.com/colobot
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://gnu.org/licenses
+ */
+
+#include "object/object_manager.h"
+
+#include "common/make_unique.h"
+
+#include "object/fake_object.h"
+
+#include <algorithm>
+
+#include <gtest/gtest.h>
+
+
+namespace
+{
+
+//! Manager without engine, objects are registered directly
+class CTestObjectManager : public CObjectManager
+{
+public:
+    CTestObjectManager()
+        : CObjectManager(nullptr, nullptr, nullptr, nullptr, nullptr)
+    {}
+
+    CFakeObject* AddFakeObject(int id, const Math::Vector& pos = Math::Vector())
+    {
+        auto object = MakeUnique<CFakeObject>(id);
+        object->SetPosition(pos);
+        return static_cast<CFakeObject*>(AddObject(std::move(object)));
+    }
+};
+
+bool Contains(const std::vector<CObject*>& objects, CObject* object)
+{
+    return std::find(objects.begin(), objects.end(), object) != objects.end();
+}
+
+} // namespace
+
+TEST(CObjectManagerTest, InterfaceIndexFollowsChanges)
+{
+    CTestObjectManager manager;
+    CFakeObject* object = manager.AddFakeObject(1, Math::Vector(100.0f, 0.0f, 100.0f));
+    Math::Vector farMin(-500.0f, -10.0f, -500.0f);
+    Math::Vector farMax(-400.0f, 10.0f, -400.0f);
+
+    EXPECT_TRUE(manager.GetObjectsImplementing(ObjectInterfaceType::Movable).empty());
+    EXPECT_EQ(0, manager.CountObjectsImplementing(ObjectInterfaceType::Movable));
+    EXPECT_FALSE(Contains(manager.GetObjectsNearBox(farMin, farMax), object));
+
+    // Objects which can move are candidates of every broadphase query
+    object->SetInterface(ObjectInterfaceType::Movable, true);
+    EXPECT_TRUE(Contains(manager.GetObjectsImplementing(ObjectInterfaceType::Movable), object));
+    EXPECT_EQ(1, manager.CountObjectsImplementing(ObjectInterfaceType::Movable));
+    EXPECT_TRUE(Contains(manager.GetObjectsNearBox(farMin, farMax), object));
+
+    object->SetInterface(ObjectInterfaceType::Movable, false);
+    EXPECT_TRUE(manager.GetObjectsImplementing(ObjectInterfaceType::Movable).empty());
+    EXPECT_EQ(0, manager.CountObjectsImplementing(ObjectInterfaceType::Movable));
+    EXPECT_FALSE(Contains(manager.GetObjectsNearBox(farMin, farMax), object));
+    EXPECT_TRUE(Contains(manager.GetObjectsNearBox(object->GetPosition(), object->GetPosition()), object));
+}
+
+TEST(CObjectManagerTest, IndexesOrderedById)
+{
+    CTestObjectManager manager;
+    CFakeObject* second = manager.AddFakeObject(2);
+    CFakeObject* first = manager.AddFakeObject(1);
+
+    second->SetInterface(ObjectInterfaceType::Programmable, true);
+    first->SetInterface(ObjectInterfaceType::Programmable, true);
+    std::vector<CObject*> programmable = manager.GetObjectsImplementing(ObjectInterfaceType::Programmable);
+    ASSERT_EQ(2u, programmable.size());
+    EXPECT_EQ(first, programmable[0]);
+    EXPECT_EQ(second, programmable[1]);
+
+    second->SetTeam(3);
+    EXPECT_TRUE(Contains(manager.GetObjectsOfTeam(3), second));
+    EXPECT_FALSE(Contains(manager.GetObjectsOfTeam(0), second));
+
+    manager.DeleteObject(first);
+    programmable = manager.GetObjectsImplementing(ObjectInterfaceType::Programmable);
+    ASSERT_EQ(1u, programmable.size());
+    EXPECT_EQ(second, programmable[0]);
+}
+
+TEST(CObjectManagerTest, SlotsReusedAfterDelete)
+{
+    CTestObjectManager manager;
+    CFakeObject* first = manager.AddFakeObject(1);
+    ObjectHandle firstHandle = manager.GetObjectHandle(first);
+    EXPECT_EQ(first, manager.GetObjectByHandle(firstHandle));
+
+    manager.DeleteObject(first);
+    EXPECT_EQ(nullptr, manager.GetObjectByHandle(firstHandle));
+    EXPECT_EQ(nullptr, manager.GetObjectById(1));
+
+    // The freed slot is reused, but the old handle still doesn't resolve
+    CFakeObject* second = manager.AddFakeObject(2);
+    ObjectHandle secondHandle = manager.GetObjectHandle(second);
+    EXPECT_EQ(firstHandle.index, secondHandle.index);
+    EXPECT_NE(firstHandle.generation, secondHandle.generation);
+    EXPECT_EQ(nullptr, manager.GetObjectByHandle(firstHandle));
+    EXPECT_EQ(second, manager.GetObjectByHandle(secondHandle));
+    EXPECT_EQ(second, manager.GetObjectById(2));
+}
+
+TEST(CObjectManagerTest, StaleHandlesRejected)
+{
+    CTestObjectManager manager;
+    CFakeObject* object = manager.AddFakeObject(1);
+    ObjectHandle handle = manager.GetObjectHandle(object);
+
+    // Ids start again from 0 after all objects are deleted
+    manager.DeleteAllObjects();
+    EXPECT_EQ(nullptr, manager.GetObjectByHandle(handle));
+
+    CFakeObject* sameId = manager.AddFakeObject(1);
+    EXPECT_EQ(sameId, manager.GetObjectById(1));
+    EXPECT_EQ(nullptr, manager.GetObjectByHandle(handle));
+
+    ObjectHandle outOfRange;
+    outOfRange.index = 1000;
+    EXPECT_EQ(nullptr, manager.GetObjectByHandle(outOfRange));
+}
+
+TEST(CObjectManagerTest, CollisionCandidatesFollowGrowingObjects)
+{
+    CTestObjectManager manager;
+    CFakeObject* object = manager.AddFakeObject(1, Math::Vector(100.0f, 0.0f, 0.0f));
+    object->AddCrashSphere(CrashSphere(Math::Vector(), 2.0f));
+    Math::Vector center(130.0f, 0.0f, 0.0f);
+
+    EXPECT_FALSE(Contains(manager.GetCollisionCandidates(center, 1.0f), object));
+
+    // Scaled up after it was added, like a building being built
+    object->SetScale(20.0f);
+    EXPECT_FALSE(object->GetAllCrashSpheres().empty());
+    EXPECT_GT(object->GetAllCrashSpheres()[0].sphere.radius, 30.0f);
+    EXPECT_TRUE(Contains(manager.GetCollisionCandidates(center, 1.0f), object));
+}
+
+TEST(CObjectManagerTest, ChangedObjectsFollowMovesAndState)
+{
+    CTestObjectManager manager;
+    CFakeObject* moved = manager.AddFakeObject(1);
+    CFakeObject* locked = manager.AddFakeObject(2);
+    manager.AddFakeObject(3);
+
+    unsigned int revision = manager.GetChangeRevision();
+    std::vector<CObject*> changed;
+    ASSERT_TRUE(manager.GetChangedObjects(revision, changed));
+    EXPECT_TRUE(changed.empty());
+
+    moved->SetPosition(Math::Vector(10.0f, 0.0f, 0.0f));
+    moved->SetPosition(Math::Vector(20.0f, 0.0f, 0.0f));
+    locked->SetLock(true);
+    ASSERT_TRUE(manager.GetChangedObjects(revision, changed));
+    ASSERT_EQ(2u, changed.size());
+    EXPECT_EQ(moved, changed[0]);
+    EXPECT_EQ(locked, changed[1]);
+
+    revision = manager.GetChangeRevision();
+    ASSERT_TRUE(manager.GetChangedObjects(revision, changed));
+    EXPECT_TRUE(changed.empty());
+
+    // Too many changes to remember, the caller has to check all objects
+    for (int i = 0; i < 5000; i++)
+    {
+        moved->SetLock(i % 2 == 0);
+        locked->SetLock(i % 2 == 0);
+    }
+    EXPECT_FALSE(manager.GetChangedObjects(revision, changed));
+    revision = manager.GetChangeRevision();
+    EXPECT_TRUE(manager.GetChangedObjects(revision, changed));
+}
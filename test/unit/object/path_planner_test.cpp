@@ -0,0 +1,250 @@
+/*
+ * This file is part of the Colobot: Gold Edition source code
+ * Copyright (C) 2001-2016, Daniel Roux, EPSITEC SA & TerranovaTeam
+ * http://epsitec.ch; http://colobot.info; http://github.com/colobot
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://gnu.org/licenses
+ */
+
+#include "object/path_planner.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <queue>
+#include <gtest/gtest.h>
+
+
+namespace
+{
+
+// Builds a map from rows of text, '#' being a blocked cell
+std::shared_ptr<PathMap> MakeMap(const std::vector<const char*>& rows)
+{
+    auto map = std::make_shared<PathMap>();
+    map->width = static_cast<int>(strlen(rows[0]));
+    map->height = static_cast<int>(rows.size());
+    for (const char* row : rows)
+    {
+        for (int x = 0; x < map->width; ++x)
+            map->blocked.push_back(row[x] == '#' ? 1 : 0);
+    }
+    return map;
+}
+
+float OctileDistance(int dx, int dy)
+{
+    dx = abs(dx);
+    dy = abs(dy);
+    return std::max(dx, dy) + (sqrtf(2.0f)-1.0f)*std::min(dx, dy);
+}
+
+// Length of the path through the jump points
+float PathLength(const std::vector<Math::IntPoint>& path)
+{
+    float length = 0.0f;
+    for (std::size_t i = 1; i < path.size(); ++i)
+        length += OctileDistance(path[i].x-path[i-1].x, path[i].y-path[i-1].y);
+    return length;
+}
+
+// Length of the shortest path found by plain Dijkstra over all 8 neighbours
+// with the same corner rule, or -1 if there is none
+float ReferenceLength(const PathMap& map, Math::IntPoint start, Math::IntPoint goal)
+{
+    typedef std::pair<float, int> Entry;
+    std::vector<float> dist(map.width*map.height, -1.0f);
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+    dist[start.y*map.width + start.x] = 0.0f;
+    open.push(Entry(0.0f, start.y*map.width + start.x));
+
+    while (!open.empty())
+    {
+        Entry entry = open.top();
+        open.pop();
+        int x = entry.second%map.width;
+        int y = entry.second/map.width;
+        if (entry.first > dist[entry.second]) continue;
+        if (x == goal.x && y == goal.y) return entry.first;
+
+        for (int dy = -1; dy <= 1; ++dy)
+        {
+            for (int dx = -1; dx <= 1; ++dx)
+            {
+                if (dx == 0 && dy == 0) continue;
+                if (!map.IsFree(x+dx, y+dy)) continue;
+                if (dx != 0 && dy != 0 && (!map.IsFree(x+dx, y) || !map.IsFree(x, y+dy))) continue;
+
+                int next = (y+dy)*map.width + (x+dx);
+                float g = entry.first + OctileDistance(dx, dy);
+                if (dist[next] >= 0.0f && dist[next] <= g) continue;
+                dist[next] = g;
+                open.push(Entry(g, next));
+            }
+        }
+    }
+    return -1.0f;
+}
+
+// Deterministic map with random blocks and walls
+std::shared_ptr<PathMap> MakeRandomMap(int width, int height, unsigned int seed)
+{
+    auto next = [&seed]()
+    {
+        seed = seed * 1103515245u + 12345u;
+        return (seed >> 8) & 0xFFFF;
+    };
+
+    auto map = std::make_shared<PathMap>();
+    map->width = width;
+    map->height = height;
+    map->blocked.resize(width*height);
+    for (unsigned char& cell : map->blocked)
+        cell = (next() % 100) < 20 ? 1 : 0;
+
+    for (int i = 0; i < 6; ++i)
+    {
+        int x = next() % width;
+        int y = next() % height;
+        int length = next() % (width/2);
+        bool horizontal = (next() % 2) == 0;
+        for (int j = 0; j < length; ++j)
+        {
+            int cx = horizontal ? x+j : x;
+            int cy = horizontal ? y : y+j;
+            if (cx < width && cy < height)
+                map->blocked[cy*width + cx] = 1;
+        }
+    }
+    return map;
+}
+
+} // namespace
+
+TEST(CPathPlannerTest, StraightLine)
+{
+    auto map = MakeMap({
+        "..........",
+        "..........",
+        "..........",
+    });
+    CPathPlanner planner(map, Math::IntPoint(0, 1), Math::IntPoint(9, 1), 0.0f);
+    EXPECT_EQ(PathStatus::Found, planner.Run());
+
+    const std::vector<Math::IntPoint>& path = planner.GetPath();
+    ASSERT_EQ(2u, path.size());
+    EXPECT_EQ(0, path.front().x);
+    EXPECT_EQ(9, path.back().x);
+    EXPECT_EQ(1, path.back().y);
+}
+
+TEST(CPathPlannerTest, GoesAroundWall)
+{
+    auto map = MakeMap({
+        ".....#....",
+        ".....#....",
+        ".....#....",
+        "..........",
+    });
+    CPathPlanner planner(map, Math::IntPoint(0, 0), Math::IntPoint(9, 0), 0.0f);
+    EXPECT_EQ(PathStatus::Found, planner.Run());
+
+    // Every cell between two jump points must be free
+    const std::vector<Math::IntPoint>& path = planner.GetPath();
+    for (std::size_t i = 1; i < path.size(); ++i)
+    {
+        int dx = (path[i].x > path[i-1].x) - (path[i].x < path[i-1].x);
+        int dy = (path[i].y > path[i-1].y) - (path[i].y < path[i-1].y);
+        for (Math::IntPoint p = path[i-1]; p.x != path[i].x || p.y != path[i].y; p.x += dx, p.y += dy)
+            EXPECT_TRUE(map->IsFree(p.x, p.y));
+    }
+    EXPECT_EQ(9, path.back().x);
+    EXPECT_EQ(0, path.back().y);
+}
+
+TEST(CPathPlannerTest, NoCornerCutting)
+{
+    auto map = MakeMap({
+        ".#",
+        "#.",
+    });
+    CPathPlanner planner(map, Math::IntPoint(0, 0), Math::IntPoint(1, 1), 0.0f);
+    EXPECT_EQ(PathStatus::Impossible, planner.Run());
+}
+
+TEST(CPathPlannerTest, GoalRadius)
+{
+    auto map = MakeMap({
+        "........",
+        "......##",
+        "......#.",
+    });
+    CPathPlanner planner(map, Math::IntPoint(0, 0), Math::IntPoint(7, 2), 2.0f);
+    EXPECT_EQ(PathStatus::Found, planner.Run());
+}
+
+TEST(CPathPlannerTest, SlicedSearchGivesSameResult)
+{
+    auto map = MakeMap({
+        "..........#.........",
+        "...####...#...####..",
+        "......#...#......#..",
+        "......#......#...#..",
+        "..#####......#......",
+        ".............#####..",
+    });
+    CPathPlanner whole(map, Math::IntPoint(0, 0), Math::IntPoint(19, 5), 0.0f);
+    ASSERT_EQ(PathStatus::Found, whole.Run());
+
+    CPathPlanner sliced(map, Math::IntPoint(0, 0), Math::IntPoint(19, 5), 0.0f);
+    while (sliced.Run(1) == PathStatus::Searching) {}
+    ASSERT_EQ(PathStatus::Found, sliced.GetStatus());
+
+    EXPECT_EQ(whole.GetExpandedCount(), sliced.GetExpandedCount());
+    ASSERT_EQ(whole.GetPath().size(), sliced.GetPath().size());
+    for (std::size_t i = 0; i < whole.GetPath().size(); ++i)
+    {
+        EXPECT_EQ(whole.GetPath()[i].x, sliced.GetPath()[i].x);
+        EXPECT_EQ(whole.GetPath()[i].y, sliced.GetPath()[i].y);
+    }
+}
+
+TEST(CPathPlannerTest, SameLengthsAsPlainSearch)
+{
+    int found = 0;
+    for (unsigned int seed = 1; seed <= 40; ++seed)
+    {
+        auto map = MakeRandomMap(48, 40, seed);
+        for (int i = 0; i < 5; ++i)
+        {
+            Math::IntPoint start((seed*7 + i*13) % map->width, (seed*3 + i*5) % map->height);
+            Math::IntPoint goal((seed*11 + i*29 + 17) % map->width, (seed*5 + i*23 + 11) % map->height);
+            map->blocked[start.y*map->width + start.x] = 0;
+            map->blocked[goal.y*map->width + goal.x] = 0;
+
+            float expected = ReferenceLength(*map, start, goal);
+
+            CPathPlanner planner(map, start, goal, 0.0f);
+            PathStatus status = planner.Run();
+            ASSERT_EQ(expected >= 0.0f ? PathStatus::Found : PathStatus::Impossible, status)
+                << "seed " << seed << " pair " << i;
+            if (status != PathStatus::Found) continue;
+
+            found++;
+            EXPECT_NEAR(expected, PathLength(planner.GetPath()), 1e-3f) << "seed " << seed << " pair " << i;
+        }
+    }
+    EXPECT_GT(found, 100);
+}
@@ -0,0 +1,18 @@
+#!/bin/bash
+# Runs many matches in batch mode in parallel and collects their results
+# Usage: batch-run.sh <match list> <results file> [parallel jobs]
+#
+# Every line of the match list is one match: scene followed by options for it, e.g.
+#   custom101 -teamprogram 1=programs/attack.txt -teamprogram 2=programs/defend.txt -timelimit 600
+# Every finished match appends one JSON line to the results file
+
+if [ $# -lt 2 ]; then
+	echo "Usage: $0 <match list> <results file> [parallel jobs]" >&2
+	exit 1
+fi
+
+LIST=$1
+RESULTS=$2
+JOBS=${3:-$(nproc)}
+
+grep -v '^[[:space:]]*\(#\|$\)' "$LIST" | xargs -P "$JOBS" -L 1 colobot -batch -loglevel error -results "$RESULTS" -runscene